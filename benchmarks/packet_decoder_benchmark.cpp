@@ -0,0 +1,167 @@
+/**
+ * Single core throughput of PacketDecoder and InternetChecksum.
+ *
+ * Frames come from TrafficGenerator and are copied out of the capture
+ * before timing, so only decoding is measured. Build with
+ * -DPROJECT_BUILD_BENCHMARKS=ON -DCMAKE_RELEASE=ON, numbers of a debug
+ * build mean nothing.
+ *
+ *     packet_decoder_benchmark [seconds per measurement]
+ */
+#include "net_checksum.hpp"
+#include "packet_decoder.hpp"
+#include "pcap_reader.hpp"
+#include "traffic_generator.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+constexpr std::string_view k_scenario = "repeat 2000\n"
+										"icmp 192.168.100.10 > 1.1.1.1 count=2\n"
+										"tcp  10.0.0.1:40000 > 10.0.0.2:80 payload=\"GET / HTTP/1.1\\r\\n\\r\\n\" "
+										"response=\"HTTP/1.1 200 OK\\r\\n\\r\\n\"\n"
+										"udp  10.0.0.1 > 10.0.0.2:514 payload=\"<13>test\"\n"
+										"dns  10.0.0.1 > 8.8.8.8 query=example.com answer=93.184.216.34\n";
+
+constexpr double	  k_default_seconds = 2.0;
+constexpr std::size_t k_segment_length	= 1460;
+
+struct Frame
+{
+	std::size_t offset;
+	std::size_t length;
+};
+
+struct Capture
+{
+	std::vector<uint8_t> bytes;
+	std::vector<Frame>	 frames;
+	uint32_t			 link_type = UTILS::PacketDecoder::d_link_type_ethernet;
+};
+
+bool loadCapture(const std::string &path, Capture &capture)
+{
+	UTILS::PcapReader reader;
+	if (!reader.open(path))
+	{
+		return false;
+	}
+
+	std::array<UTILS::PcapPacket, 256> batch;
+	while (const std::size_t count = reader.read(batch))
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			capture.frames.push_back({capture.bytes.size(), batch[i].captured_length});
+			capture.bytes.insert(capture.bytes.end(), batch[i].data, batch[i].data + batch[i].captured_length);
+			capture.link_type = batch[i].link_type;
+		}
+	}
+	return reader.error() == 0 && !capture.frames.empty();
+}
+
+double elapsedSeconds(std::chrono::steady_clock::time_point started)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+}
+
+/**
+ * Whole passes over the capture until the time is up, packets per second.
+ */
+double measureDecoder(const Capture &capture, bool verify_checksums, double seconds)
+{
+	UTILS::PacketDecoder decoder;
+	decoder.setVerifyChecksums(verify_checksums);
+
+	UTILS::DecodedPacket packet;
+	uint64_t			 packets = 0;
+	const auto			 started = std::chrono::steady_clock::now();
+	do
+	{
+		for (const Frame &frame : capture.frames)
+		{
+			decoder.decode(capture.bytes.data() + frame.offset, frame.length, capture.link_type, packet);
+		}
+		packets += capture.frames.size();
+	}
+	while (elapsedSeconds(started) < seconds);
+
+	return static_cast<double>(packets) / elapsedSeconds(started);
+}
+
+/**
+ * Bytes per second over segments of the given length.
+ */
+double measureChecksum(std::size_t length, double seconds)
+{
+	std::vector<uint8_t> buffer(length + 8);
+	for (std::size_t i = 0; i < buffer.size(); ++i)
+	{
+		buffer[i] = static_cast<uint8_t>(i * 131 + 7);
+	}
+
+	volatile uint16_t sink	  = 0;
+	uint64_t		  blocks  = 0;
+	const auto		  started = std::chrono::steady_clock::now();
+	do
+	{
+		// Shifting the start by a few bytes keeps unaligned loads in the mix
+		for (std::size_t i = 0; i < 4096; ++i)
+		{
+			sink = sink + UTILS::InternetChecksum::compute(buffer.data() + (i & 7), length);
+		}
+		blocks += 4096;
+	}
+	while (elapsedSeconds(started) < seconds);
+
+	return static_cast<double>(blocks * length) / elapsedSeconds(started);
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	const double seconds = argc > 1 ? std::atof(argv[1]) : k_default_seconds;
+	if (seconds <= 0)
+	{
+		std::fprintf(stderr, "usage: %s [seconds per measurement]\n", argv[0]);
+		return 2;
+	}
+
+	UTILS::TrafficScenario scenario;
+	std::string			   error;
+	if (!UTILS::TrafficScenario::parse(k_scenario, scenario, error))
+	{
+		std::fprintf(stderr, "Invalid scenario: %s\n", error.c_str());
+		return 1;
+	}
+
+	const std::string path = (std::filesystem::temp_directory_path() / "packet_decoder_benchmark.pcap").string();
+
+	UTILS::TrafficGenerator generator(scenario);
+	Capture					capture;
+	const bool				loaded = generator.generate(path) && loadCapture(path, capture);
+	std::error_code			ignored;
+	std::filesystem::remove(path, ignored);
+	if (!loaded)
+	{
+		std::fprintf(stderr, "Unable to generate %s\n", path.c_str());
+		return 1;
+	}
+
+	std::printf("%zu frames, %zu bytes, checksums with %s\n", capture.frames.size(), capture.bytes.size(),
+				UTILS::InternetChecksum::instructionSet());
+
+	std::printf("decode:                %6.1f Mpps\n", measureDecoder(capture, false, seconds) / 1e6);
+	std::printf("decode with checksums: %6.1f Mpps\n", measureDecoder(capture, true, seconds) / 1e6);
+	std::printf("checksum of %zu bytes: %6.1f GB/s\n", k_segment_length, measureChecksum(k_segment_length, seconds) / 1e9);
+	return 0;
+}
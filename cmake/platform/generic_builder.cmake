@@ -74,6 +74,11 @@ endif()
 # [THREAD FIX]
 list(APPEND PROJECT_LIBRARIES_LIST pthread)
 
+# [BENCHMARKS]
+if(PROJECT_BUILD_BENCHMARKS)
+    include(cmake/utils/benchmarks.cmake)
+endif()
+
 # [TARGET LNKING]
 target_include_directories(${PROJECT_NAME} PRIVATE ${PROJECT_INCLUDE_DIRS})
 target_include_directories(${PROJECT_NAME} PRIVATE ${PROJECT_DIRECTORIES_LIST})
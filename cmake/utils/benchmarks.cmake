@@ -0,0 +1,18 @@
+set(PROJECT_BENCHMARK_DIR "${CMAKE_SOURCE_DIR}/benchmarks")
+
+file(GLOB PROJECT_BENCHMARK_FILES CONFIGURE_DEPENDS
+    "${PROJECT_BENCHMARK_DIR}/*.cpp"
+)
+
+source_group("Benchmarks" FILES ${PROJECT_BENCHMARK_FILES})
+
+# One executable per source file, none of them is installed
+foreach(BENCHMARK_FILE ${PROJECT_BENCHMARK_FILES})
+    get_filename_component(BENCHMARK_NAME ${BENCHMARK_FILE} NAME_WE)
+
+    add_executable(${BENCHMARK_NAME} ${BENCHMARK_FILE})
+
+    target_include_directories(${BENCHMARK_NAME} PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_link_directories(${BENCHMARK_NAME}    PRIVATE ${PROJECT_INCLUDE_DIRS})
+    target_link_libraries(${BENCHMARK_NAME}      PRIVATE ${PROJECT_LIBRARIES_LIST})
+endforeach()
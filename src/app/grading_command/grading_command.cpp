@@ -0,0 +1,145 @@
+#include "grading_command.hpp"
+
+#include "batch_grader.hpp"
+#include "spdlog_wrapper.hpp"
+#include "suricata_validator.hpp"
+
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+
+namespace APP
+{
+namespace
+{
+	constexpr int k_exit_passed = 0;
+	constexpr int k_exit_failed = 1;
+	constexpr int k_exit_error	= 2;
+} // namespace
+
+GradingCommand::GradingCommand(QCommandLineParser &parser) :
+	m_parser(parser),
+	m_grade_option("grade", "Grade every *.rules file of <directory> and exit.", "directory"),
+	m_capture_option("capture", "Reference capture replayed for every submission.", "pcap"),
+	m_expect_option("expect", "Comma separated SIDs a submission has to raise, and no others.", "sids"),
+	m_jobs_option("jobs", "Submissions graded at once, one per CPU by default.", "count"),
+	m_builtin_option("builtin", "Evaluate the rules in process instead of running Suricata, an approximation.")
+{
+	m_parser.addOption(m_grade_option);
+	m_parser.addOption(m_capture_option);
+	m_parser.addOption(m_expect_option);
+	m_parser.addOption(m_jobs_option);
+	m_parser.addOption(m_builtin_option);
+}
+
+bool GradingCommand::isRequested() const
+{
+	return m_parser.isSet(m_grade_option);
+}
+
+int GradingCommand::run()
+{
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+
+	const QString directory	   = m_parser.value(m_grade_option);
+	const QString capture_path = m_parser.value(m_capture_option);
+
+	if (capture_path.isEmpty() || !QFileInfo(capture_path).isFile())
+	{
+		err << "A reference capture is required, see --capture\n";
+		return k_exit_error;
+	}
+
+	QList<quint32> expected_sids;
+	for (const QString &value : m_parser.value(m_expect_option).split(',', Qt::SkipEmptyParts))
+	{
+		bool		  ok  = false;
+		const quint32 sid = value.trimmed().toUInt(&ok);
+		if (!ok)
+		{
+			err << QString("Invalid SID in --expect: %1\n").arg(value);
+			return k_exit_error;
+		}
+		expected_sids.append(sid);
+	}
+
+	int jobs = 0;
+	if (m_parser.isSet(m_jobs_option))
+	{
+		bool ok = false;
+		jobs	= m_parser.value(m_jobs_option).toInt(&ok);
+		if (!ok || jobs <= 0)
+		{
+			err << QString("Invalid --jobs: %1\n").arg(m_parser.value(m_jobs_option));
+			return k_exit_error;
+		}
+	}
+
+	const QList<UTILS::BatchGrader::Submission> submissions = UTILS::BatchGrader::collectSubmissions(directory);
+	if (submissions.isEmpty())
+	{
+		err << QString("No *.rules files in %1\n").arg(directory);
+		return k_exit_error;
+	}
+
+	// stdout carries only the result table
+	spdlog::set_default_logger(spdlog::stderr_color_mt("grading"));
+
+	const auto grade = [&](UTILS::BatchGrader &grader) {
+		grader.setCapture(capture_path);
+		grader.setExpectedSids(expected_sids);
+		grader.setParallelism(jobs);
+		grader.setResultHandler([&err](const UTILS::BatchGrader::Result &result, int finished, int total) {
+			err << QString("[%1/%2] %3\n").arg(QString::number(finished), QString::number(total), result.name);
+			err.flush();
+		});
+
+		const QList<UTILS::BatchGrader::Result> results = grader.run(submissions);
+		out << UTILS::BatchGrader::formatTable(results);
+
+		const bool passed = std::all_of(results.begin(), results.end(), [](const UTILS::BatchGrader::Result &result) {
+			return result.passed();
+		});
+		return passed ? k_exit_passed : k_exit_failed;
+	};
+
+	if (m_parser.isSet(m_builtin_option))
+	{
+		err << QString("Grading %1 submissions with the builtin evaluator\n").arg(submissions.size());
+		err.flush();
+
+		UTILS::BatchGrader grader(QString(), QString());
+		grader.setEngine(UTILS::BatchGrader::Engine::Builtin);
+		return grade(grader);
+	}
+
+	// The validator runs on its own once constructed, wait for it to pick the binary and the config. Only that part of
+	// the pipeline runs: no Suricata is started, no interface is touched and nothing is captured.
+	SuricataValidatorWidget validator(nullptr, ValidationScope::Installation);
+
+	QString	   reason;
+	QEventLoop loop;
+	QObject::connect(&validator, &SuricataValidatorWidget::reasonChanged, &loop, [&reason](const QString &text) {
+		reason = text;
+	});
+	QObject::connect(&validator, &SuricataValidatorWidget::validationFinished, &loop, &QEventLoop::quit);
+	loop.exec();
+
+	const QString suricata_path = validator.getSuricataPath();
+	const QString config_path	= validator.getSelectedConfigFilePath();
+	if (validator.getCurrentStatus() != ValidationStatus::Success || suricata_path.isEmpty() || config_path.isEmpty())
+	{
+		err << QString("No usable Suricata installation: %1\n").arg(reason);
+		return k_exit_error;
+	}
+
+	err << QString("Grading %1 submissions with %2 -c %3\n")
+			   .arg(QString::number(submissions.size()), suricata_path, config_path);
+	err.flush();
+
+	UTILS::BatchGrader grader(suricata_path, config_path);
+	return grade(grader);
+}
+} // namespace APP
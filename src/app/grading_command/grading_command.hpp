@@ -0,0 +1,45 @@
+#ifndef GRADING_COMMAND_HPP
+#define GRADING_COMMAND_HPP
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+
+namespace APP
+{
+/**
+ * @brief `--grade <directory>` mode of the executable, no window is shown.
+ *
+ * Every *.rules file of the directory is graded with UTILS::BatchGrader
+ * against the reference capture and the result table is printed to
+ * stdout, progress goes to stderr. The Suricata binary and config are the
+ * ones SuricataValidatorWidget discovers and tests with suricata -T, so
+ * submissions are graded by the same installation the lab is validated
+ * with. Its live and capture checks are skipped. With --builtin the rules
+ * are evaluated in process by UTILS::RuleEvaluator instead and Suricata is
+ * not needed at all.
+ *
+ * Exit status: 0 when every submission passed, 1 when some did not, 2 when
+ * grading could not start.
+ */
+class GradingCommand
+{
+public:
+	/**
+	 * Registers the options, call before QCommandLineParser::process().
+	 */
+	explicit GradingCommand(QCommandLineParser &parser);
+
+	bool isRequested() const;
+	int	 run();
+
+private:
+	QCommandLineParser &m_parser;
+	QCommandLineOption	m_grade_option;
+	QCommandLineOption	m_capture_option;
+	QCommandLineOption	m_expect_option;
+	QCommandLineOption	m_jobs_option;
+	QCommandLineOption	m_builtin_option;
+};
+} // namespace APP
+
+#endif // GRADING_COMMAND_HPP
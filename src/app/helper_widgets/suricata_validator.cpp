@@ -1,21 +1,128 @@
 #include "suricata_validator.hpp"
 
+#include "byte_scanner.hpp"
+#include "content_hash.hpp"
+#include "directory_walker.hpp"
+#include "discovery_cache.hpp"
+#include "eve_parser.hpp"
+#include "fast_log_parser.hpp"
+#include "file_change_waiter.hpp"
+#include "file_watcher.hpp"
+#include "interface_selector.hpp"
+#include "line_tailer.hpp"
+#include "pcap_reader.hpp"
+#include "process_pool.hpp"
+#include "process_scanner.hpp"
+#include "rule_index.hpp"
+#include "rule_profile.hpp"
 #include "settings_manager.hpp"
 #include "spdlog_wrapper.hpp"
-
+#include "stage_timer.hpp"
+#include "suricata_config.hpp"
+#include "suricata_diagnostic.hpp"
+#include "suricata_socket.hpp"
+#include "task_graph.hpp"
+#include "traffic_generator.hpp"
+#include "validation_cache.hpp"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QLabel>
-#include <QNetworkInterface>
 #include <QProcess>
+#include <QPushButton>
+#include <QSysInfo>
+#include <QTemporaryDir>
 #include <QTimer>
+#include <QToolButton>
 #include <QVBoxLayout>
 #include <QtConcurrent>
+#include <array>
+#include <cstring>
 
 namespace APP
 {
-SuricataValidatorWidget::SuricataValidatorWidget(QWidget *parent) :
+namespace
+{
+	const QString k_engine_started_notice = "engine started";
+
+	constexpr unsigned long k_session_poll_interval = 20; // ms
+
+	constexpr int k_watch_coalesce_interval = 1000; // ms, suricata-update rewrites rule files one by one
+
+	// Stages of the validation pipeline, as they appear in the log and the timings file
+	const std::string k_stage_binary	  = "binary";
+	const std::string k_stage_process	  = "process";
+	const std::string k_stage_discovery	  = "discovery";
+	const std::string k_stage_parse		  = "parse";
+	const std::string k_stage_rules		  = "rules";
+	const std::string k_stage_config_test = "config_test";
+	const std::string k_stage_interfaces  = "interfaces";
+	const std::string k_stage_engine	  = "engine";
+	const std::string k_stage_capture	  = "capture";
+	const std::string k_stage_replay	  = "replay";
+	const std::string k_stage_alerts	  = "alerts";
+
+	constexpr uint64_t k_regression_min_runs = 5; // history needed before a slow run is flagged
+
+	constexpr int k_diagnostics_shown = 5; // config test messages quoted in the reason
+	constexpr int k_duplicates_shown  = 3; // duplicate SIDs quoted in the reason
+
+	// Profiling dumps, written to the -l directory when the engine shuts down
+	const QString k_rule_perf_name	  = "rule_perf.log";
+	const QString k_keyword_perf_name = "keyword_perf.log";
+
+	constexpr int		  k_profile_rule_limit	   = 1000000; // every rule, the ranking is done here
+	constexpr std::size_t k_profile_keywords_shown = 5;
+
+	QString stageTitle(const std::string &stage)
+	{
+		static const QMap<QString, QString> titles = {
+			{QString::fromStdString(k_stage_binary), "Поиск Suricata"},
+			{QString::fromStdString(k_stage_process), "Проверка процессов"},
+			{QString::fromStdString(k_stage_discovery), "Поиск конфигураций"},
+			{QString::fromStdString(k_stage_parse), "Разбор конфигураций"},
+			{QString::fromStdString(k_stage_rules), "Чтение правил"},
+			{QString::fromStdString(k_stage_config_test), "Проверка suricata -T"},
+			{QString::fromStdString(k_stage_interfaces), "Выбор интерфейсов"},
+			{QString::fromStdString(k_stage_engine), "Запуск Suricata"},
+			{QString::fromStdString(k_stage_capture), "Подготовка трафика"},
+			{QString::fromStdString(k_stage_replay), "Обработка трафика"},
+			{QString::fromStdString(k_stage_alerts), "Ожидание оповещений"},
+		};
+		const QString name = QString::fromStdString(stage);
+		return titles.value(name, name);
+	}
+
+	QString milliseconds(std::chrono::microseconds elapsed)
+	{
+		return QString::number(static_cast<double>(elapsed.count()) / 1000.0, 'f', 1);
+	}
+
+	// Files a configuration reads besides itself: what it includes and the rule files it loads
+	QStringList configInputs(const UTILS::SuricataConfig &config)
+	{
+		QStringList inputs;
+		for (const std::string &include : config.includes)
+		{
+			inputs.append(QDir::cleanPath(QString::fromStdString(include)));
+		}
+		for (const std::string &rule_file : config.resolveRuleFiles())
+		{
+			inputs.append(QDir::cleanPath(QString::fromStdString(rule_file)));
+		}
+		return inputs;
+	}
+} // namespace
+
+SuricataValidatorWidget::SuricataValidatorWidget(QWidget *parent, ValidationScope scope) :
 	QWidget(parent),
 	m_current_status(ValidationStatus::Checking),
+	m_file_watcher(new UTILS::FileWatcher(this)),
+	m_validation_running(false),
+	m_watching_enabled(scope == ValidationScope::Full),
+	m_live_check_passed(false),
+	m_validation_scope(scope),
 	m_suricata_path("")
 {
 	initialize();
@@ -23,13 +130,103 @@ SuricataValidatorWidget::SuricataValidatorWidget(QWidget *parent) :
 }
 
 SuricataValidatorWidget::~SuricataValidatorWidget()
-{}
+{
+	m_session.stop();
+}
 
 void SuricataValidatorWidget::initialize()
 {
 	setupUi();
 	setupStyle();
 	setupConnections();
+	readSettings();
+
+	if (m_stage_timings.load(QFile::encodeName(stageTimingsPath()).toStdString()))
+	{
+		setTimings(timingsBreakdown());
+	}
+}
+
+void SuricataValidatorWidget::readSettings()
+{
+	UTILS::SettingsManager *settings = UTILS::SettingsManager::instance();
+
+	const QString mode = settings->getValue(UTILS::SettingsManager::Setting::VALIDATION_MODE).toString().trimmed();
+	if (mode.compare("offline", Qt::CaseInsensitive) == 0)
+	{
+		setValidationMode(ValidationMode::Offline);
+	}
+	else if (mode.isEmpty() || mode.compare("live", Qt::CaseInsensitive) == 0)
+	{
+		setValidationMode(ValidationMode::Live);
+	}
+	else
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Unknown validation mode \"%1\", using live capture").arg(mode));
+	}
+
+	bool	  alerts_ok		  = false;
+	const int expected_alerts = settings->getValue(UTILS::SettingsManager::Setting::OFFLINE_EXPECTED_ALERTS).toInt(&alerts_ok);
+	if (alerts_ok && expected_alerts > 0)
+	{
+		m_offline_expected_alerts = expected_alerts;
+	}
+	else
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Invalid expected alert count, using %1").arg(m_offline_expected_alerts));
+	}
+
+	const QString capture_path = settings->getValue(UTILS::SettingsManager::Setting::OFFLINE_CAPTURE).toString().trimmed();
+	if (!capture_path.isEmpty())
+	{
+		setOfflineCapture(capture_path, m_offline_expected_alerts);
+	}
+
+	// Without them any alert passes, even one from a rule unrelated to the test traffic
+	QList<quint32> expected_sids;
+	const QString  sids = settings->getValue(UTILS::SettingsManager::Setting::EXPECTED_SIDS).toString();
+	for (const QString &value : sids.split(',', Qt::SkipEmptyParts))
+	{
+		bool		  ok  = false;
+		const quint32 sid = value.trimmed().toUInt(&ok);
+		if (ok)
+		{
+			expected_sids.append(sid);
+		}
+		else
+		{
+			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Ignoring invalid expected SID \"%1\"").arg(value.trimmed()));
+		}
+	}
+	setExpectedSids(expected_sids);
+
+	// The scenario is several lines long, the setting names the file holding it
+	const QString scenario_path = settings->getValue(UTILS::SettingsManager::Setting::OFFLINE_SCENARIO).toString().trimmed();
+	if (!scenario_path.isEmpty())
+	{
+		QFile scenario_file(scenario_path);
+		if (scenario_file.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			setOfflineScenario(QString::fromUtf8(scenario_file.readAll()), m_offline_expected_alerts);
+		}
+		else
+		{
+			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Unable to read traffic scenario %1: %2").arg(scenario_path, scenario_file.errorString()));
+		}
+	}
+
+	const bool profiling = settings->getValue(UTILS::SettingsManager::Setting::RULE_PROFILING).toBool();
+	if (profiling && m_validation_mode != ValidationMode::Offline)
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Rule profiling needs the offline validation mode, it stays off"));
+	}
+	// Live checks never replay a capture, enabling it there would only bypass the validation cache
+	setRuleProfilingEnabled(profiling && m_validation_mode == ValidationMode::Offline);
 }
 
 void SuricataValidatorWidget::setupUi()
@@ -50,9 +247,43 @@ void SuricataValidatorWidget::setupUi()
 	m_status_label->setAlignment(Qt::AlignCenter);
 	m_status_label->setFont(title_font);
 
+	m_timings_button = new QToolButton(this);
+	m_timings_button->setText("Время этапов");
+	m_timings_button->setCheckable(true);
+	m_timings_button->setEnabled(false);
+	m_timings_button->setArrowType(Qt::RightArrow);
+	m_timings_button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+
+	m_timings_label = new QLabel("", this);
+	m_timings_label->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+	m_timings_label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	m_timings_label->setVisible(false);
+
+	m_profile_button = new QToolButton(this);
+	m_profile_button->setText("Профиль правил");
+	m_profile_button->setCheckable(true);
+	m_profile_button->setEnabled(false);
+	m_profile_button->setVisible(false);
+	m_profile_button->setArrowType(Qt::RightArrow);
+	m_profile_button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+
+	m_profile_label = new QLabel("", this);
+	m_profile_label->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+	m_profile_label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	m_profile_label->setVisible(false);
+
+	m_revalidate_button = new QPushButton("Перепроверить", this);
+	m_revalidate_button->setToolTip("Проверить Suricata заново, не используя сохранённый результат");
+	m_revalidate_button->setEnabled(false);
+
 	m_main_layout = new QVBoxLayout(this);
 	m_main_layout->addWidget(m_status_label);
 	m_main_layout->addWidget(m_reason_label);
+	m_main_layout->addWidget(m_revalidate_button, 0, Qt::AlignHCenter);
+	m_main_layout->addWidget(m_timings_button, 0, Qt::AlignHCenter);
+	m_main_layout->addWidget(m_timings_label);
+	m_main_layout->addWidget(m_profile_button, 0, Qt::AlignHCenter);
+	m_main_layout->addWidget(m_profile_label);
 	setLayout(m_main_layout);
 
 	setMinimumSize(400, 100);
@@ -124,11 +355,43 @@ void SuricataValidatorWidget::updateStatusDisplay()
 }
 
 void SuricataValidatorWidget::setupConnections()
-{}
+{
+	m_file_watcher->setCoalesceInterval(k_watch_coalesce_interval);
+	connect(m_file_watcher, &UTILS::FileWatcher::pathsChanged, this, &SuricataValidatorWidget::onWatchedPathsChanged);
+
+	// Emitted from validation threads, labels are only touched on the GUI thread
+	connect(this, &SuricataValidatorWidget::reasonChanged, m_reason_label, &QLabel::setText, Qt::QueuedConnection);
+	connect(
+		this, &SuricataValidatorWidget::timingsChanged, this,
+		[this](const QString &text) {
+			m_timings_label->setText(text);
+			m_timings_button->setEnabled(!text.isEmpty());
+		},
+		Qt::QueuedConnection);
+	connect(
+		this, &SuricataValidatorWidget::profileChanged, this,
+		[this](const QString &text) {
+			m_profile_label->setText(text);
+			m_profile_button->setEnabled(!text.isEmpty());
+			m_profile_button->setVisible(!text.isEmpty());
+		},
+		Qt::QueuedConnection);
+	connect(m_revalidate_button, &QPushButton::clicked, this, &SuricataValidatorWidget::forceRevalidate);
+	connect(m_timings_button, &QToolButton::toggled, this, [this](bool expanded) {
+		m_timings_button->setArrowType(expanded ? Qt::DownArrow : Qt::RightArrow);
+		m_timings_label->setVisible(expanded);
+	});
+	connect(m_profile_button, &QToolButton::toggled, this, [this](bool expanded) {
+		m_profile_button->setArrowType(expanded ? Qt::DownArrow : Qt::RightArrow);
+		m_profile_label->setVisible(expanded);
+	});
+}
 
-void SuricataValidatorWidget::startValidation()
+void SuricataValidatorWidget::startValidation(const QStringList &changed_paths)
 {
-	m_current_status = ValidationStatus::Checking;
+	m_validation_running = true;
+	m_current_status	 = ValidationStatus::Checking;
+	m_revalidate_button->setEnabled(false);
 	updateStatusDisplay();
 
 	QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
@@ -142,327 +405,1869 @@ void SuricataValidatorWidget::startValidation()
 		{
 			m_current_status = ValidationStatus::Failure;
 		}
+		m_validation_running = false;
+		m_revalidate_button->setEnabled(true);
 		updateStatusDisplay();
+		updateWatchedPaths();
 		watcher->deleteLater();
 		emit validationFinished(m_current_status);
+
+		if (!m_pending_changes.isEmpty())
+		{
+			const QStringList pending_changes = m_pending_changes.values();
+			m_pending_changes.clear();
+			startValidation(pending_changes);
+		}
 	});
 
-	QFuture<bool> future = QtConcurrent::run([this]() {
-		return checkSuricata();
+	QFuture<bool> future = QtConcurrent::run([this, changed_paths]() {
+		m_stage_timings.beginRun();
+		const bool result = changed_paths.isEmpty() ? checkSuricata() : revalidate(changed_paths);
+		finishStageRun();
+		return result;
 	});
 	watcher->setFuture(future);
 }
 
-bool SuricataValidatorWidget::checkSuricata()
+void SuricataValidatorWidget::onWatchedPathsChanged(const QStringList &paths)
 {
-	// Check suricata executable
-	for (const QString &path : m_suricata_paths)
+	if (!m_watching_enabled)
 	{
-		if (QFile::exists(path) && QFileInfo(path).isExecutable())
-		{
-			m_suricata_path = path;
-			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Found suricata executable: " + path);
-			break;
-		}
+		return;
 	}
 
-	if (m_suricata_path.isEmpty())
+	if (m_validation_running)
 	{
-		m_reason_label->setText("Suricata не установлен");
-		return false;
+		for (const QString &path : paths)
+		{
+			m_pending_changes.insert(path);
+		}
+		return;
 	}
 
-	// Validate suricata is disabled
-	QProcess suricata_process;
-	suricata_process.start("pidof", {"suricata"});
-	suricata_process.waitForFinished();
+	startValidation(paths);
+}
+
+void SuricataValidatorWidget::updateWatchedPaths()
+{
+	m_file_watcher->clear();
 
-	if (!suricata_process.readAllStandardOutput().trimmed().isEmpty())
+	if (!m_watching_enabled)
 	{
-		m_reason_label->setText("Suricata уже запущен");
-		return false;
+		return;
 	}
 
-	// Check suricata configuration files
+	QSet<QString> directories;
 	for (const QString &dir_path : m_suricata_conf_dirs)
 	{
-		QDir dir(dir_path);
-		if (dir.exists())
+		if (QFileInfo(dir_path).isDir())
 		{
-			searchDirectoryRecursive(dir);
+			directories.insert(QDir::cleanPath(dir_path));
 		}
 	}
 
-	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-				   "Found: " + QString::number(m_config_file_paths.count()) + " config files");
-
-	if (m_config_file_paths.isEmpty())
+	for (const QString &config_path : getConfigFilePaths())
 	{
-		m_reason_label->setText("Файл конфигурации Suricata не найден");
-		return false;
+		directories.insert(QFileInfo(config_path).absolutePath());
 	}
 
-	// Validate suricata configuration files
-	for (const QString &config_path : m_config_file_paths)
+	// Included files and rule files often live elsewhere, e.g. /var/lib/suricata/rules, next to files that do not matter
+	QSet<QString> files;
+	for (auto it = m_config_checks.cbegin(); it != m_config_checks.cend(); ++it)
 	{
-		QFile config_file(config_path);
-		if (!config_file.open(QIODevice::ReadOnly | QIODevice::Text))
+		for (const QString &input : configInputs(it.value().config))
 		{
-			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-							QString("Unable to open configuration file: %1").arg(config_path));
-			m_reason_label->setText(QString("Не удалось прочитать файл конфигурации Suricata: %1").arg(config_path));
-			continue;
+			if (QFileInfo(QFileInfo(input).absolutePath()).isDir())
+			{
+				files.insert(input);
+			}
 		}
+	}
+
+	for (const QString &directory : directories)
+	{
+		m_file_watcher->watchDirectory(directory);
+	}
+
+	for (const QString &file : files)
+	{
+		m_file_watcher->watchFile(file);
+	}
+
+	if (!m_suricata_log_dir.isEmpty() && QFileInfo(m_suricata_log_dir).isDir())
+	{
+		m_file_watcher->watchDirectory(m_suricata_log_dir, UTILS::FileWatcher::d_self_mask);
+	}
+}
+
+bool SuricataValidatorWidget::checkSuricata()
+{
+	const bool live = m_validation_mode == ValidationMode::Live;
+
+	// Probes that do not depend on each other run side by side, the capture check waits for all of them
+	UTILS::TaskGraph graph;
+	connect(&graph, &UTILS::TaskGraph::taskFinished, &graph, [](const QString &name, bool succeeded, qint64 elapsed_ms) {
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Check %1 %2 in %3 ms").arg(name, succeeded ? "passed" : "failed").arg(elapsed_ms));
+	});
+
+	const int binary = graph.addTask("binary", [this]() {
+		return locateSuricataBinary();
+	});
+
+	const int discovery = graph.addTask("discovery", [this]() {
+		discoverConfigFiles();
 
-		QTextStream in(&config_file);
-		bool		fast_log_enabled = false;
-		bool		in_fast_section	 = false;
+		const int count = getConfigFilePaths().count();
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Found: " + QString::number(count) + " config files");
 
-		while (!in.atEnd())
+		if (count == 0)
 		{
-			QString line = in.readLine().trimmed();
+			setReason("Файл конфигурации Suricata не найден");
+			return false;
+		}
+		return true;
+	});
 
-			if (line.startsWith("#") || line.isEmpty())
+	const int parse = graph.addTask(
+		"parse",
+		[this]() {
+			m_config_checks.clear();
+			for (const QString &config_path : getConfigFilePaths())
 			{
-				continue;
+				m_config_checks.insert(config_path, parseConfigFile(config_path));
 			}
-
-			if (line.contains("default-log-dir:"))
+			return true;
+		},
+		{discovery});
+
+	// Hashing every input is far cheaper than suricata -T and an engine start
+	const int cache = graph.addTask(
+		"cache",
+		[this]() {
+			// A profiling run exists to replay the capture, a cached verdict has no profile to show. The cache holds
+			// verdicts of full validations only.
+			m_validation_cache_hit = m_validation_scope == ValidationScope::Full && !m_force_revalidate && !m_rule_profiling
+									 && restoreCachedValidation();
+			return true;
+		},
+		{binary, parse});
+
+	// Waits for the cache as well, restoring it writes the same ConfigCheck entries the index is stored in
+	const int rules = graph.addTask(
+		"rules",
+		[this]() {
+			indexRuleFiles();
+			return true;
+		},
+		{parse, cache});
+
+	const int config_test = graph.addTask(
+		"config_test",
+		[this]() {
+			if (!m_validation_cache_hit)
 			{
-				m_suricata_log_dir = line.split(":").last().trimmed();
-				SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-							   QString("Fast log dir found: %1").arg(m_suricata_log_dir));
+				testPendingConfigFiles();
 			}
+			return selectConfigFile();
+		},
+		{cache, rules});
 
-			if (line.contains("- fast:"))
-			{
-				in_fast_section	 = true;
-				fast_log_enabled = false;
-			}
-			else if (in_fast_section)
+	m_validation_cache_hit = false;
+
+	if (m_validation_scope == ValidationScope::Installation)
+	{
+		const bool passed = graph.run();
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Installation check %1 in %2 ms")
+						   .arg(passed ? QString("passed") : QString("failed"), QString::number(graph.elapsedMs())));
+		return passed;
+	}
+
+	QList<int> capture_inputs = {config_test};
+	if (live)
+	{
+		capture_inputs << graph.addTask("process", [this]() {
+			return checkSuricataNotRunning();
+		});
+		capture_inputs << graph.addTask("interfaces", [this]() {
+			m_active_interfaces = selectCaptureInterfaces();
+			return true;
+		});
+	}
+
+	graph.addTask(
+		"capture",
+		[this, live]() {
+			if (m_validation_cache_hit)
 			{
-				if (line.contains("enabled:"))
-				{
-					QString enabled_value = line.split(":").last().trimmed();
-					if (enabled_value == "yes")
-					{
-						fast_log_enabled = true;
-					}
-					else if (enabled_value == "no")
-					{
-						fast_log_enabled = false;
-						in_fast_section	 = false;
-					}
-					else
-					{
-						fast_log_enabled = false;
-						in_fast_section	 = false;
-					}
-				}
-				else if (fast_log_enabled && line.contains("filename:"))
-				{
-					m_suricata_log_path = line.split(":").last().trimmed();
-					in_fast_section		= false;
-					break;
-				}
-				else if (line.startsWith("- "))
-				{
-					in_fast_section	 = false;
-					fast_log_enabled = false;
-				}
+				m_live_check_passed = true;
+				return true;
 			}
-		}
+			return live ? checkLiveCapture() : checkOfflineReplay();
+		},
+		capture_inputs);
 
-		config_file.close();
+	const bool passed = graph.run();
 
-		if (!fast_log_enabled || m_suricata_log_path.isEmpty())
+	storeValidation(passed, graph.elapsedMs());
+	m_force_revalidate = false;
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   passed ? QString("Validation passed in %1 ms").arg(graph.elapsedMs())
+						  : QString("Validation failed at %1 after %2 ms").arg(graph.firstFailure()).arg(graph.elapsedMs()));
+	return passed;
+}
+
+bool SuricataValidatorWidget::revalidate(const QStringList &changed_paths)
+{
+	if (m_suricata_path.isEmpty() || m_config_checks.isEmpty())
+	{
+		return checkSuricata();
+	}
+
+	// The live check only depends on the selected configuration, the files it reads and the log directory
+	QSet<QString> live_inputs;
+	for (const QString &input : sessionInputStamps().keys())
+	{
+		live_inputs.insert(QDir::cleanPath(input));
+	}
+
+	// Configurations to parse and test again because one of their included or rule files changed
+	QMap<QString, QStringList> dependent_configs;
+	for (auto it = m_config_checks.cbegin(); it != m_config_checks.cend(); ++it)
+	{
+		for (const QString &input : configInputs(it.value().config))
 		{
-			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Fast log not enabled or log path is missing");
-			m_reason_label->setText(QString("В файле конфигурации Suricata: %1 выключен fast лог").arg(config_path));
-			continue;
+			dependent_configs[input].append(it.key());
 		}
+	}
 
-		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-					   QString("Fast log enabled for: %1").arg(m_suricata_log_path));
+	bool live_affected = false;
 
-		QProcess	process;
-		QString		program = m_suricata_path;
-		QStringList arguments;
-		arguments << "-T" << "-c" << config_path;
-		process.start(program, arguments);
-		process.waitForFinished();
+	for (const QString &path : changed_paths)
+	{
+		const QFileInfo info(path);
+
+		if (path == QDir::cleanPath(m_suricata_log_dir))
+		{
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Suricata log directory changed: " + path);
+			live_affected = true;
+			continue;
+		}
 
-		QString		output		= process.readAllStandardError();
-		int			error_count = 0;
-		QStringList lines		= output.split('\n');
+		live_affected = live_affected || live_inputs.contains(QDir::cleanPath(path));
 
-		for (const QString &line : lines)
+		if (!isConfigFileName(info.fileName()))
 		{
-			if (line.startsWith("E:") || line.startsWith("Error:"))
+			for (const QString &config_path : dependent_configs.value(QDir::cleanPath(path)))
 			{
-				error_count++;
+				if (m_config_checks.contains(config_path))
+				{
+					SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+								   QString("%1 changed, retesting %2").arg(path, config_path));
+					m_config_checks.insert(config_path, parseConfigFile(config_path));
+				}
 			}
+			continue;
 		}
 
-		if (error_count > 0)
-		{
-			QString sudo_message;
+		QMutexLocker locker(&m_config_file_paths_mutex);
 
-			if (error_count == 1)
+		if (info.isFile() && info.isReadable())
+		{
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Suricata configuration changed: " + path);
+			if (!m_config_file_paths.contains(path))
 			{
-				sudo_message = "\nВозможно стоит запустить Suricata с правами суперпользователя";
+				m_config_file_paths.append(path);
 			}
+			locker.unlock();
 
-			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-						   QString("Suricata config error count: %1 in file %2").arg(error_count).arg(config_path));
-			m_reason_label->setText(QString("Обнаружено %1 ошибок в файле конфигурации Suricata: %2%3\n")
-										.arg(error_count)
-										.arg(config_path)
-										.arg(sudo_message));
-			return false;
+			m_config_checks.insert(path, parseConfigFile(path));
 		}
 		else
 		{
-			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-						   QString("Suricata config test passed for file: %1").arg(config_path));
-			m_reason_label->clear();
-			m_suricata_config_path = config_path;
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Suricata configuration removed: " + path);
+			m_config_file_paths.removeAll(path);
+			m_config_checks.remove(path);
 		}
 	}
 
-	if (m_suricata_config_path.isEmpty() || m_suricata_log_path.isEmpty())
+	indexRuleFiles();
+	testPendingConfigFiles();
+
+	const QString previous_config_path = m_suricata_config_path;
+
+	if (!selectConfigFile())
 	{
-		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Suricata config not found"));
+		m_live_check_passed = false;
 		return false;
 	}
 
-	m_active_interfaces.clear();
-	const auto interfaces = QNetworkInterface::allInterfaces();
+	// A failed live check stands until one of its inputs changes
+	if (!live_affected && previous_config_path == m_suricata_config_path)
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Selected configuration unchanged, skipping live check");
+		if (m_live_check_passed)
+		{
+			setReason("");
+		}
+		return m_live_check_passed;
+	}
+
+	return checkCapture();
+}
+
+bool SuricataValidatorWidget::locateSuricataBinary()
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_binary);
+
+	m_suricata_path.clear();
 
-	for (const QNetworkInterface &iface : interfaces)
+	// Check suricata executable
+	for (const QString &path : m_suricata_paths)
 	{
-		if (iface.flags().testFlag(QNetworkInterface::IsUp) && iface.flags().testFlag(QNetworkInterface::IsRunning) &&
-			!iface.flags().testFlag(QNetworkInterface::IsLoopBack))
+		if (QFile::exists(path) && QFileInfo(path).isExecutable())
 		{
-			m_active_interfaces.append(iface.humanReadableName());
-			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-						   QString("Found interface: %1").arg(iface.humanReadableName()));
+			m_suricata_path = path;
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Found suricata executable: " + path);
+			break;
 		}
 	}
 
-	if (m_active_interfaces.isEmpty())
+	if (m_suricata_path.isEmpty())
 	{
-		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to find any active interfaces"));
-		m_reason_label->setText(QString("Нет подключенных интерфейсов"));
+		setReason("Suricata не установлен");
 		return false;
 	}
 
-	QStringList arguments;
-	arguments << "-c" << m_suricata_config_path << "-i" << m_active_interfaces[0];
+	return true;
+}
 
-	QProcess final_suricata_process;
-	final_suricata_process.start(m_suricata_path, arguments);
+bool SuricataValidatorWidget::checkSuricataNotRunning()
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_process);
 
-	if (!final_suricata_process.waitForStarted())
+	// Validate suricata is disabled, our own long running instance and -T runs do not count
+	const pid_t own_pid = static_cast<pid_t>(QCoreApplication::applicationPid());
+	for (const UTILS::ProcessInfo &process : UTILS::ProcessScanner::findByName("suricata"))
 	{
-		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to start Suricata"));
-		m_reason_label->setText(QString("Невозможно запустить Suricata"));
-		final_suricata_process.kill();
+		if (process.pid == m_session.pid() || process.parent_pid == own_pid)
+		{
+			continue;
+		}
+
+		const QString config_path = QString::fromStdString(std::string(process.argumentValue("-c")));
+		const QString started =
+			QDateTime::fromSecsSinceEpoch(std::chrono::system_clock::to_time_t(process.startTime())).toString(Qt::ISODate);
+
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Suricata already running: pid %1, started %2, executable %3, config %4")
+						   .arg(process.pid)
+						   .arg(started, QString::fromStdString(process.executable), config_path));
+
+		setReason(config_path.isEmpty()
+					  ? QString("Suricata уже запущен (PID %1)").arg(process.pid)
+					  : QString("Suricata уже запущен (PID %1) с конфигурацией %2").arg(process.pid).arg(config_path));
 		return false;
 	}
 
-	QThread::msleep(2500);
+	return true;
+}
 
-	QStringList possible_log_paths = {m_suricata_log_path, m_suricata_log_dir + m_suricata_log_path,
-									  m_suricata_log_dir + "/" + m_suricata_log_path};
+SuricataValidatorWidget::ConfigCheck SuricataValidatorWidget::parseConfigFile(const QString &config_path)
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_parse);
 
-	for (const QString &path : possible_log_paths)
-	{
-		QFile file(path);
-		if (file.exists())
-		{
-			m_suricata_log_path = path;
+	ConfigCheck check;
+	check.verdict = ConfigVerdict::Skipped;
 
-			if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
-			{
-				file.close();
-				SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-							   QString("Cleared log file: %1").arg(m_suricata_log_path));
-			}
-			else
-			{
-				SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-								QString("Failed to clear log file: %1").arg(m_suricata_log_path));
-			}
-			break;
-		}
+	if (!QFileInfo(config_path).isReadable())
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to open configuration file: %1").arg(config_path));
+		check.reason = QString("Не удалось прочитать файл конфигурации Suricata: %1").arg(config_path);
+		return check;
 	}
 
-	if (m_suricata_log_path.isEmpty())
+	UTILS::SuricataConfig &config = check.config;
+	UTILS::SuricataConfigParser::parseFile(config_path.toStdString(), config);
+
+	for (const std::string &error : config.errors)
 	{
-		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to find Suricata log file"));
-		m_reason_label->setText(QString("Невозможно найти файл журнала Suricata"));
-		final_suricata_process.terminate();
-		return false;
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("%1: %2").arg(config_path, QString::fromStdString(error)));
 	}
 
-	QProcess ping_process;
-	ping_process.start("ping", QStringList() << "-c" << "1" << "1.1.1.1");
-	ping_process.waitForFinished();
-
-	QThread::msleep(500);
+	// fast.log is preferred, eve.json only counts when it carries alert records
+	const UTILS::SuricataConfig::LogOutput *output = config.alertOutput();
 
-	QFile file(m_suricata_log_path);
-	if (file.exists() && file.size() > 0)
+	if (output == &config.fast)
 	{
-		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("File has content: %1").arg(m_suricata_log_path));
+		check.log_format   = AlertLogFormat::Fast;
+		check.log_filename = QString::fromStdString(output->filename);
+	}
+	else if (output == &config.eve)
+	{
+		check.log_format   = AlertLogFormat::Eve;
+		check.log_filename = output->filename.empty() ? QString("eve.json") : QString::fromStdString(output->filename);
 	}
 	else
 	{
-		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-						QString("File is empty or does not exist: %1").arg(m_suricata_log_path));
-		m_reason_label->setText(QString("ICMP запрос не перехвачен Suricata"));
-		final_suricata_process.terminate();
-		return false;
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Neither fast nor eve alert log is enabled");
+		check.reason = QString("В файле конфигурации Suricata: %1 выключены fast и eve журналы").arg(config_path);
+		return check;
 	}
 
-	final_suricata_process.terminate();
+	check.verdict  = ConfigVerdict::NotTested;
+	check.log_path = QString::fromStdString(config.resolveLogPath(check.log_filename.toStdString()));
+	check.log_dir  = QFileInfo(check.log_path).absolutePath();
 
-	return true;
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("%1 log enabled for: %2")
+					   .arg(check.log_format == AlertLogFormat::Fast ? "Fast" : "Eve")
+					   .arg(check.log_path));
+	return check;
 }
 
-void SuricataValidatorWidget::searchDirectoryRecursive(const QDir &dir)
+void SuricataValidatorWidget::testPendingConfigFiles()
 {
-	QStringList entries = dir.entryList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Readable | QDir::NoSymLinks);
-
-	for (const QString &entry : entries)
+	// Only configurations ranked above the current winner can change the selection
+	QStringList pending;
+	for (const QString &config_path : getConfigFilePaths())
 	{
-		QFileInfo fileInfo(dir.filePath(entry));
-
-		if (fileInfo.isFile())
+		const ConfigVerdict verdict = m_config_checks.value(config_path).verdict;
+		if (verdict == ConfigVerdict::Passed)
 		{
-			for (const QString &filter : m_suricata_conf_files)
-			{
-				if (QDir::match(filter, entry))
-				{
-					SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
-								   "Found suricata configuration file: " + fileInfo.absoluteFilePath());
-					m_config_file_paths.append(fileInfo.absoluteFilePath());
-					break;
-				}
-			}
+			break;
 		}
-		else if (fileInfo.isDir())
+		if (verdict == ConfigVerdict::NotTested || verdict == ConfigVerdict::Cancelled)
 		{
-			searchDirectoryRecursive(QDir(fileInfo.absoluteFilePath()));
+			pending.append(config_path);
 		}
 	}
+
+	testConfigFiles(pending);
 }
 
-void SuricataValidatorWidget::executeProcessShellMethod(const QString &command)
+void SuricataValidatorWidget::testConfigFiles(const QStringList &config_paths)
 {
-	QProcess process;
-	process.start("bash", QStringList() << "-c" << command << "> /dev/null 2>&");
+	if (config_paths.isEmpty())
+	{
+		return;
+	}
+
+	UTILS::StageScope stage(m_stage_timings, k_stage_config_test);
+
+	QList<UTILS::ProcessPool::Job> jobs;
+	for (const QString &config_path : config_paths)
+	{
+		jobs.append({m_suricata_path, {"-T", "-c", config_path}});
+	}
+
+	const int parallelism = m_config_test_parallelism > 0 ? m_config_test_parallelism : QThread::idealThreadCount();
+
+	UTILS::ProcessPool pool(std::min(parallelism, static_cast<int>(jobs.size())));
+	int				   winner = jobs.size();
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Testing %1 configuration files, %2 at a time").arg(jobs.size()).arg(pool.maxParallel()));
+
+	for (const QString &config_path : config_paths)
+	{
+		m_config_checks[config_path].diagnostics.clear();
+	}
+
+	// Messages are classified while Suricata prints them, a fatal one settles the verdict without waiting for exit
+	pool.setStandardErrorHandler([&](int index, const QByteArray &line) {
+		UTILS::SuricataDiagnostic diagnostic;
+		if (!UTILS::SuricataDiagnostics::classify(std::string_view(line.constData(), line.size()), diagnostic) ||
+			diagnostic.severity == UTILS::SuricataDiagnostic::Severity::Info)
+		{
+			return;
+		}
+
+		const QString &config_path = config_paths[index];
+		if (diagnostic.file.empty() && diagnostic.line > 0)
+		{
+			diagnostic.file = config_path.toStdString();
+		}
+
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("%1: %2").arg(config_path, QString::fromUtf8(line).trimmed()));
+
+		m_config_checks[config_path].diagnostics.push_back(diagnostic);
+
+		if (diagnostic.fatal)
+		{
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Fatal error, stopping config test for file: %1").arg(config_path));
+			pool.abort(index);
+		}
+	});
+
+	pool.run(jobs, [&](const UTILS::ProcessPool::Result &result) {
+		const QString &config_path = config_paths[result.index];
+		ConfigCheck	  &check	   = m_config_checks[config_path];
+		check.elapsed_ms		   = result.elapsed_ms;
+
+		if (result.cancelled)
+		{
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Suricata config test cancelled for file: %1").arg(config_path));
+			check.verdict = ConfigVerdict::Cancelled;
+			return;
+		}
+
+		if (!result.started)
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to start Suricata"));
+			check.verdict = ConfigVerdict::Failed;
+			check.reason  = QString("Невозможно запустить Suricata");
+			return;
+		}
+
+		evaluateConfigTest(config_path, check);
+
+		// Lower ranked configurations can no longer win, stop wasting cores on them
+		if (check.verdict == ConfigVerdict::Passed && result.index < winner)
+		{
+			winner = result.index;
+			for (int i = winner + 1; i < jobs.size(); ++i)
+			{
+				pool.cancel(i);
+			}
+		}
+	});
+}
+
+void SuricataValidatorWidget::evaluateConfigTest(const QString &config_path, ConfigCheck &check) const
+{
+	QStringList errors;
+	int			warning_count = 0;
+
+	for (const UTILS::SuricataDiagnostic &diagnostic : check.diagnostics)
+	{
+		if (diagnostic.severity == UTILS::SuricataDiagnostic::Severity::Warning)
+		{
+			warning_count++;
+			continue;
+		}
+
+		const QString location = QString::fromStdString(diagnostic.location());
+		const QString message  = QString::fromStdString(diagnostic.message);
+		errors.append(location.isEmpty() ? message : QString("%1: %2").arg(location, message));
+	}
+
+	const int error_count = errors.size();
+	check.error_count	  = error_count;
+
+	if (error_count > 0)
+	{
+		QString sudo_message;
+
+		if (error_count == 1)
+		{
+			sudo_message = "\nВозможно стоит запустить Suricata с правами суперпользователя";
+		}
+
+		QStringList shown = errors.mid(0, k_diagnostics_shown);
+		if (error_count > k_diagnostics_shown)
+		{
+			shown.append(QString("… и ещё %1").arg(error_count - k_diagnostics_shown));
+		}
+		if (check.rules)
+		{
+			shown.append(ruleIndexFindings(*check.rules));
+		}
+
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Suricata config error count: %1, warning count: %2 in file %3")
+						   .arg(error_count)
+						   .arg(warning_count)
+						   .arg(config_path));
+		check.verdict = ConfigVerdict::Failed;
+		check.reason  = QString("Обнаружено %1 ошибок в файле конфигурации Suricata: %2\n%3%4\n")
+						   .arg(error_count)
+						   .arg(config_path)
+						   .arg(shown.join('\n'))
+						   .arg(sudo_message);
+		return;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Suricata config test passed for file: %1 in %2 ms, %3 warnings")
+					   .arg(config_path)
+					   .arg(check.elapsed_ms)
+					   .arg(warning_count));
+	check.verdict = ConfigVerdict::Passed;
+	check.reason.clear();
+}
+
+QString SuricataValidatorWidget::verdictSummary() const
+{
+	QStringList lines;
+
+	for (const QString &config_path : getConfigFilePaths())
+	{
+		const ConfigCheck check = m_config_checks.value(config_path);
+
+		QString verdict;
+		switch (check.verdict)
+		{
+			case ConfigVerdict::NotTested:
+				verdict = "не проверялся";
+				break;
+			case ConfigVerdict::Skipped:
+				verdict = "пропущен";
+				break;
+			case ConfigVerdict::Passed:
+				verdict = QString("проверка пройдена за %1 мс").arg(check.elapsed_ms);
+				break;
+			case ConfigVerdict::Failed:
+				verdict = QString("ошибок: %1").arg(check.error_count);
+				break;
+			case ConfigVerdict::Cancelled:
+				verdict = "проверка отменена";
+				break;
+		}
+
+		lines.append(QString("%1 — %2").arg(config_path, verdict));
+	}
+
+	return lines.join('\n');
+}
+
+bool SuricataValidatorWidget::selectConfigFile()
+{
+	m_suricata_config_path.clear();
+	m_suricata_log_path.clear();
+	m_suricata_log_dir.clear();
+	m_suricata_log_format = AlertLogFormat::Fast;
+
+	QString first_reason;
+
+	for (const QString &config_path : getConfigFilePaths())
+	{
+		const ConfigCheck check = m_config_checks.value(config_path);
+		if (check.verdict == ConfigVerdict::Passed)
+		{
+			m_suricata_config_path = config_path;
+			m_suricata_log_path	   = check.log_path;
+			m_suricata_log_dir	   = check.log_dir;
+			m_suricata_log_format  = check.log_format;
+			break;
+		}
+
+		if (first_reason.isEmpty())
+		{
+			first_reason = check.reason;
+		}
+	}
+
+	const QString summary = verdictSummary();
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Suricata configuration verdicts:\n" + summary);
+
+	if (m_suricata_config_path.isEmpty() || m_suricata_log_path.isEmpty())
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Suricata config not found"));
+		setReason(m_config_checks.size() > 1 ? first_reason.trimmed() + "\n\n" + summary : first_reason);
+		return false;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Selected Suricata configuration: %1").arg(m_suricata_config_path));
+	setReason("");
+	return true;
+}
+
+bool SuricataValidatorWidget::checkCapture()
+{
+	switch (m_validation_mode)
+	{
+		case ValidationMode::Offline:
+			return checkOfflineReplay();
+		case ValidationMode::Live:
+			break;
+	}
+
+	if (!checkSuricataNotRunning())
+	{
+		return false;
+	}
+
+	m_active_interfaces = selectCaptureInterfaces();
+	return checkLiveCapture();
+}
+
+bool SuricataValidatorWidget::checkLiveCapture()
+{
+	m_live_check_passed = false;
+
+	if (m_active_interfaces.isEmpty())
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to find any active interfaces"));
+		setReason(QString("Нет подключенных интерфейсов"));
+		return false;
+	}
+
+	const QStringList capture_arguments = captureArguments(m_active_interfaces);
+	if (capture_arguments.isEmpty())
+	{
+		setReason(QString("Не удалось подготовить конфигурацию af-packet"));
+		return false;
+	}
+
+	if (m_reuse_suricata_instance)
+	{
+		QStringList arguments;
+		arguments << "-c" << m_suricata_config_path << capture_arguments << "--set" << "unix-command.enabled=yes"
+				  << "--set" << QString("unix-command.filename=%1").arg(sessionSocketPath());
+
+		if (!ensureSession(arguments))
+		{
+			return false;
+		}
+
+		std::vector<std::string> captured;
+		if (!m_session.socket().interfaces(captured))
+		{
+			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("iface-list failed: %1").arg(QString::fromStdString(m_session.socket().error())));
+		}
+		else
+		{
+			for (const QString &interface : m_active_interfaces)
+			{
+				if (std::find(captured.begin(), captured.end(), interface.toStdString()) == captured.end())
+				{
+					SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+								   QString("Suricata does not capture on %1").arg(interface));
+				}
+			}
+		}
+
+		m_live_check_passed = waitForPingAlert();
+		return m_live_check_passed;
+	}
+
+	QStringList arguments;
+	arguments << "-c" << m_suricata_config_path << capture_arguments;
+
+	UTILS::StageScope engine_stage(m_stage_timings, k_stage_engine);
+
+	QProcess final_suricata_process;
+	final_suricata_process.setProcessChannelMode(QProcess::MergedChannels);
+	final_suricata_process.start(m_suricata_path, arguments);
+
+	if (!final_suricata_process.waitForStarted())
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to start Suricata"));
+		setReason(QString("Невозможно запустить Suricata"));
+		final_suricata_process.kill();
+		return false;
+	}
+
+	if (!waitForEngineStarted(final_suricata_process))
+	{
+		final_suricata_process.terminate();
+		final_suricata_process.waitForFinished();
+		return false;
+	}
+	engine_stage.stop();
+
+	const bool alerts_matched = waitForPingAlert();
+
+	final_suricata_process.terminate();
+	final_suricata_process.waitForFinished();
+
+	m_live_check_passed = alerts_matched;
+	return alerts_matched;
+}
+
+QStringList SuricataValidatorWidget::selectCaptureInterfaces() const
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_interfaces);
+
+	std::vector<UTILS::CaptureInterface> ranked =
+		UTILS::InterfaceSelector::rankedInterfaces(std::chrono::milliseconds(m_interface_sample_window));
+
+	for (const UTILS::CaptureInterface &interface : ranked)
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Interface %1: %2, %3, speed %4, default route %5, %6 packets in %7 ms, score %8")
+						   .arg(QString::fromStdString(interface.name), UTILS::InterfaceSelector::kindName(interface.kind),
+								QString::fromStdString(interface.operstate))
+						   .arg(interface.speed_mbps)
+						   .arg(interface.default_route ? "yes" : "no")
+						   .arg(interface.rx_delta)
+						   .arg(m_interface_sample_window)
+						   .arg(interface.score));
+	}
+
+	QStringList pinned = m_capture_interfaces;
+	if (pinned.isEmpty())
+	{
+		pinned = UTILS::SettingsManager::instance()
+					 ->getValue(UTILS::SettingsManager::Setting::CAPTURE_INTERFACES)
+					 .toString()
+					 .split(',', Qt::SkipEmptyParts);
+	}
+
+	QStringList selected;
+	for (QString name : pinned)
+	{
+		name = name.trimmed();
+		const auto found = std::find_if(ranked.begin(), ranked.end(), [&](const UTILS::CaptureInterface &interface) {
+			return interface.name == name.toStdString();
+		});
+		if (found == ranked.end() || !found->isUsable())
+		{
+			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Pinned interface %1 is missing or down, using it anyway").arg(name));
+		}
+		selected.append(name);
+	}
+
+	for (std::size_t i = 0; pinned.isEmpty() && i < ranked.size() && selected.size() < m_capture_interface_count; ++i)
+	{
+		if (ranked[i].isUsable())
+		{
+			selected.append(QString::fromStdString(ranked[i].name));
+		}
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Capture interfaces%1: %2").arg(pinned.isEmpty() ? "" : " (pinned)", selected.join(", ")));
+	return selected;
+}
+
+QStringList SuricataValidatorWidget::captureArguments(const QStringList &interfaces) const
+{
+	if (interfaces.size() == 1)
+	{
+		return {"-i", interfaces.front()};
+	}
+
+	// Several interfaces need one af-packet entry each, layered over the selected config
+	std::vector<std::string> names;
+	for (const QString &interface : interfaces)
+	{
+		names.push_back(interface.toStdString());
+	}
+
+	const std::string overlay =
+		UTILS::InterfaceSelector::afPacketOverlay(names, m_config_checks.value(m_suricata_config_path).config.af_packet);
+
+	const QString overlay_path = QDir(sessionDirectory()).filePath("af-packet.yaml");
+	QFile		  overlay_file(overlay_path);
+	if (!QDir().mkpath(sessionDirectory()) || !overlay_file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+		overlay_file.write(overlay.data(), static_cast<qint64>(overlay.size())) != static_cast<qint64>(overlay.size()))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to write af-packet overlay: %1").arg(overlay_path));
+		return {};
+	}
+
+	return {"--include", overlay_path, "--af-packet"};
+}
+
+bool SuricataValidatorWidget::waitForPingAlert()
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_alerts);
+
+	const QString log_path = m_suricata_log_path;
+
+	QFile log_file(log_path);
+	if (log_file.exists())
+	{
+		if (log_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			log_file.close();
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Cleared log file: %1").arg(log_path));
+		}
+		else
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							QString("Failed to clear log file: %1").arg(log_path));
+		}
+	}
+
+	// Armed before the ping so the alert cannot slip in unnoticed
+	UTILS::FileChangeWaiter log_waiter(QFile::encodeName(log_path).toStdString());
+	if (!log_waiter.isArmed())
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Unable to watch %1: %2").arg(log_path).arg(log_waiter.error()));
+	}
+
+	UTILS::LineTailer alert_tailer(QFile::encodeName(log_path).toStdString());
+	resetObservedAlerts();
+
+	QElapsedTimer alert_timer;
+	alert_timer.start();
+
+	QProcess ping_process;
+	ping_process.start("ping", QStringList() << "-c" << "1" << "1.1.1.1");
+
+	bool alerts_matched = false;
+	while (!alerts_matched && alert_timer.elapsed() < m_alert_timeout)
+	{
+		const auto remaining = std::chrono::milliseconds(m_alert_timeout - alert_timer.elapsed());
+		if (log_waiter.isArmed() && log_waiter.wait(remaining) != UTILS::FileChangeWaiter::Result::Changed)
+		{
+			break;
+		}
+		if (!log_waiter.isArmed())
+		{
+			QThread::msleep(std::min<qint64>(remaining.count(), 100));
+		}
+		alerts_matched = collectAlerts(alert_tailer, m_suricata_log_format, 1);
+	}
+
+	ping_process.waitForFinished();
+
+	if (!alerts_matched)
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Expected alerts not written to %1 within %2 ms").arg(log_path).arg(m_alert_timeout));
+		setReason(alertsMismatchReason());
+		return false;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Alert written to %1 after %2 ms").arg(log_path).arg(alert_timer.elapsed()));
+	return true;
+}
+
+bool SuricataValidatorWidget::checkOfflineReplay()
+{
+	m_live_check_passed = false;
+
+	QTemporaryDir log_dir;
+	if (!log_dir.isValid())
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to create temporary log directory: %1").arg(log_dir.errorString()));
+		setReason(QString("Не удалось создать временный каталог для журналов Suricata"));
+		return false;
+	}
+
+	const QString capture_path = log_dir.filePath("capture.pcap");
+	if (!prepareOfflineCapture(capture_path))
+	{
+		setReason(QString("Не удалось подготовить файл с трафиком для проверки"));
+		return false;
+	}
+
+	// Relative output names land in the -l directory, absolute ones are honoured as is
+	const QString log_filename = m_config_checks.value(m_suricata_config_path).log_filename;
+	const QString log_path	   = QFileInfo(log_filename).isAbsolute() ? log_filename : log_dir.filePath(log_filename);
+
+	if (QFileInfo(log_filename).isAbsolute() && QFile::exists(log_path))
+	{
+		QFile log_file(log_path);
+		if (!log_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							QString("Failed to clear log file: %1").arg(log_path));
+		}
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// Profiles are only dumped when the engine shuts down, a kept instance never writes them
+	const bool replayed = m_reuse_suricata_instance && !m_rule_profiling ? replayWithSession(capture_path, log_dir.path())
+																		 : replayWithProcess(capture_path, log_dir.path());
+	if (!replayed)
+	{
+		return false;
+	}
+
+	UTILS::StageScope alerts_stage(m_stage_timings, k_stage_alerts);
+
+	UTILS::LineTailer alert_tailer(QFile::encodeName(log_path).toStdString());
+	resetObservedAlerts();
+
+	const bool alerts_matched = collectAlerts(alert_tailer, m_suricata_log_format, m_offline_expected_alerts);
+	alerts_stage.stop();
+
+	if (m_rule_profiling)
+	{
+		collectRuleProfile(log_dir.path());
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Read %1 bytes of %2 with %3 scanning")
+					   .arg(alert_tailer.statistics().bytes)
+					   .arg(log_path)
+					   .arg(UTILS::ByteScanner::instructionSet()));
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Offline replay produced %1 alerts in %2 ms").arg(m_observed_alert_count).arg(timer.elapsed()));
+
+	if (!alerts_matched)
+	{
+		setReason(alertsMismatchReason());
+		return false;
+	}
+
+	m_live_check_passed = true;
+	return true;
+}
+
+bool SuricataValidatorWidget::replayWithProcess(const QString &capture_path, const QString &log_dir)
+{
+	// A one-shot instance, engine start and replay cannot be told apart
+	UTILS::StageScope stage(m_stage_timings, k_stage_replay);
+
+	QStringList arguments;
+	arguments << "-c" << m_suricata_config_path << "-r" << capture_path << "-l" << log_dir << "-k" << "none"
+			  << "--runmode" << "single";
+	if (m_rule_profiling)
+	{
+		arguments << profilingArguments();
+	}
+
+	QProcess replay_process;
+	replay_process.setProcessChannelMode(QProcess::MergedChannels);
+	replay_process.start(m_suricata_path, arguments);
+
+	if (!replay_process.waitForStarted())
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("Unable to start Suricata"));
+		setReason(QString("Невозможно запустить Suricata"));
+		return false;
+	}
+
+	if (!replay_process.waitForFinished(m_offline_timeout))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Suricata did not finish replaying within %1 ms").arg(m_offline_timeout));
+		setReason(QString("Suricata не обработала тестовый трафик за %1 с").arg(m_offline_timeout / 1000));
+		replay_process.kill();
+		replay_process.waitForFinished();
+		return false;
+	}
+
+	if (replay_process.exitStatus() != QProcess::NormalExit || replay_process.exitCode() != 0)
+	{
+		const QString output = QString::fromUtf8(replay_process.readAll()).trimmed();
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Suricata replay failed with code %1: %2").arg(replay_process.exitCode()).arg(output));
+		setReason(QString("Suricata завершилась с ошибкой при обработке тестового трафика"));
+		return false;
+	}
+
+	return true;
+}
+
+QStringList SuricataValidatorWidget::profilingArguments() const
+{
+	// Plain text dumps parse line by line, the json variant puts a whole ranking on a single line
+	QStringList settings;
+	settings << "profiling.rules.enabled=yes" << QString("profiling.rules.filename=%1").arg(k_rule_perf_name)
+			 << "profiling.rules.append=no" << "profiling.rules.json=no" << "profiling.rules.sort=ticks"
+			 << QString("profiling.rules.limit=%1").arg(k_profile_rule_limit) << "profiling.keywords.enabled=yes"
+			 << QString("profiling.keywords.filename=%1").arg(k_keyword_perf_name) << "profiling.keywords.append=no";
+
+	QStringList arguments;
+	for (const QString &setting : settings)
+	{
+		arguments << "--set" << setting;
+	}
+	return arguments;
+}
+
+void SuricataValidatorWidget::collectRuleProfile(const QString &log_dir)
+{
+	const QString rule_perf_path	= QDir(log_dir).filePath(k_rule_perf_name);
+	const QString keyword_perf_path = QDir(log_dir).filePath(k_keyword_perf_name);
+
+	UTILS::RuleProfileParser parser;
+	if (!parser.parseFile(QFile::encodeName(rule_perf_path).toStdString()))
+	{
+		// Builds without --enable-profiling accept the settings and silently ignore them
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("No rule profile written to %1, Suricata is likely built without profiling").arg(log_dir));
+		setProfile(QString("Suricata собрана без поддержки профилирования правил (--enable-profiling)"));
+		return;
+	}
+	parser.parseFile(QFile::encodeName(keyword_perf_path).toStdString());
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Rule profile: %1 rules, %2 keywords, %3 lines, %4 malformed")
+					   .arg(QString::number(parser.rules().size()), QString::number(parser.keywords().size()),
+							QString::number(parser.lines()), QString::number(parser.malformed())));
+
+	if (parser.rules().empty())
+	{
+		setProfile(QString("Профиль правил пуст: ни одно правило не проверялось"));
+		return;
+	}
+
+	const std::shared_ptr<const UTILS::RuleIndex> index = m_config_checks.value(m_suricata_config_path).rules;
+	const auto rule_title = [&index](const UTILS::RuleProfile &rule) {
+		const UTILS::RuleLocation *location = index ? index->find(rule.sid) : nullptr;
+		const QString			   sid		= QString("[%1:%2:%3]").arg(rule.gid).arg(rule.sid).arg(rule.rev);
+		if (location == nullptr || location->msg.empty())
+		{
+			return sid;
+		}
+		return QString("%1 %2").arg(sid, QString::fromStdString(location->msg));
+	};
+
+	const auto ranking = [&](UTILS::RuleProfileParser::SortKey key, const QString &title, QStringList &lines) {
+		lines.append(title);
+		int place = 1;
+		for (const UTILS::RuleProfile &rule : parser.topRules(m_profile_top_count, key))
+		{
+			// Single pass: a rule message containing %N must not be substituted again
+			lines.append(QString("%1. %2: %3 тактов (%4%), проверок %5, совпадений %6, в среднем %7 на проверку")
+							 .arg(QString::number(place++), rule_title(rule), QString::number(rule.ticks),
+								  QString::number(rule.percent, 'f', 2), QString::number(rule.checks),
+								  QString::number(rule.matches), QString::number(rule.average_ticks, 'f', 1)));
+		}
+	};
+
+	QStringList lines;
+	lines.append(QString("Правил в профиле: %1, тактов всего: %2")
+					 .arg(QString::number(parser.rules().size()), QString::number(parser.totalTicks())));
+	ranking(UTILS::RuleProfileParser::SortKey::Ticks, "По тактам:", lines);
+	ranking(UTILS::RuleProfileParser::SortKey::Checks, "По числу проверок:", lines);
+	ranking(UTILS::RuleProfileParser::SortKey::AverageTicks, "По тактам на проверку:", lines);
+
+	const std::vector<UTILS::RuleProfile> costly = parser.topRules(1, UTILS::RuleProfileParser::SortKey::Ticks);
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Most expensive rule: %1:%2, %3 ticks in %4 checks")
+					   .arg(QString::number(costly.front().gid), QString::number(costly.front().sid),
+							QString::number(costly.front().ticks), QString::number(costly.front().checks)));
+
+	const std::vector<UTILS::KeywordProfile> keywords = parser.keywords();
+	if (!keywords.empty())
+	{
+		lines.append("Ключевые слова:");
+		for (std::size_t i = 0; i < keywords.size() && i < k_profile_keywords_shown; ++i)
+		{
+			const UTILS::KeywordProfile &keyword = keywords[i];
+			lines.append(QString("%1: %2 тактов, проверок %3, в среднем %4 на проверку")
+							 .arg(QString::fromStdString(keyword.keyword), QString::number(keyword.ticks),
+								  QString::number(keyword.checks), QString::number(keyword.average_ticks, 'f', 1)));
+		}
+	}
+
+	setProfile(lines.join("\n"));
+}
+
+bool SuricataValidatorWidget::replayWithSession(const QString &capture_path, const QString &log_dir)
+{
+	// Pcap processing mode keeps the detection engine loaded between files
+	QStringList arguments;
+	arguments << "-c" << m_suricata_config_path << QString("--unix-socket=%1").arg(sessionSocketPath()) << "-l"
+			  << sessionDirectory() << "-k" << "none";
+
+	if (!ensureSession(arguments))
+	{
+		return false;
+	}
+
+	UTILS::StageScope stage(m_stage_timings, k_stage_replay);
+
+	UTILS::SuricataSocket &socket		= m_session.socket();
+	const std::string	   capture_file = QFile::encodeName(capture_path).toStdString();
+	if (!socket.submitPcap(capture_file, QFile::encodeName(log_dir).toStdString()))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("pcap-file failed: %1").arg(QString::fromStdString(socket.error())));
+		setReason(QString("Suricata не приняла файл с тестовым трафиком"));
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	// An idle queue only means the replay finished once the file has left it: it showed up as the current file, or the
+	// queue got shorter than right after pcap-file. Nothing waits in front of it if it is already gone by now.
+	UTILS::SuricataSocket::PcapQueue queue;
+	bool							 queried   = socket.pcapQueue(queue);
+	const unsigned					 submitted = queue.pending;
+	bool							 dequeued  = submitted == 0;
+
+	while (queried && timer.elapsed() < m_offline_timeout)
+	{
+		dequeued = dequeued || queue.current == capture_file || queue.pending < submitted;
+		if (dequeued && queue.pending == 0 && queue.current.empty())
+		{
+			return true;
+		}
+		QThread::msleep(k_session_poll_interval);
+		queried = socket.pcapQueue(queue);
+	}
+
+	if (!queried)
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Lost Suricata command socket: %1").arg(QString::fromStdString(socket.error())));
+		setReason(QString("Suricata завершилась с ошибкой при обработке тестового трафика"));
+		m_session.stop();
+		return false;
+	}
+
+	SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					QString("Suricata did not finish replaying within %1 ms").arg(m_offline_timeout));
+	setReason(QString("Suricata не обработала тестовый трафик за %1 с").arg(m_offline_timeout / 1000));
+	m_session.stop();
+	return false;
+}
+
+QString SuricataValidatorWidget::sessionDirectory() const
+{
+	return QDir(QDir::tempPath()).filePath(QString("suricata_validator_%1").arg(QCoreApplication::applicationPid()));
+}
+
+QString SuricataValidatorWidget::sessionSocketPath() const
+{
+	return QDir(sessionDirectory()).filePath("command.socket");
+}
+
+QMap<QString, QDateTime> SuricataValidatorWidget::sessionInputStamps() const
+{
+	QMap<QString, QDateTime> stamps;
+	stamps.insert(m_suricata_config_path, QFileInfo(m_suricata_config_path).lastModified());
+
+	for (const QString &path : configInputs(m_config_checks.value(m_suricata_config_path).config))
+	{
+		stamps.insert(path, QFileInfo(path).lastModified());
+	}
+	return stamps;
+}
+
+bool SuricataValidatorWidget::ensureSession(const QStringList &arguments)
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_engine);
+
+	const QMap<QString, QDateTime> stamps = sessionInputStamps();
+
+	if (m_session_arguments == arguments && m_session.ensureConnected())
+	{
+		if (stamps == m_session_stamps)
+		{
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Reusing Suricata instance %1").arg(m_session.pid()));
+			return true;
+		}
+
+		// Only rule files changed, the running engine can swap them in place
+		const bool config_changed = stamps.value(m_suricata_config_path) != m_session_stamps.value(m_suricata_config_path);
+		if (!config_changed)
+		{
+			QElapsedTimer timer;
+			timer.start();
+
+			if (m_session.socket().reloadRules(std::chrono::milliseconds(m_engine_start_timeout)))
+			{
+				SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							   QString("Suricata rules reloaded in %1 ms").arg(timer.elapsed()));
+				m_session_stamps = stamps;
+				return true;
+			}
+
+			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Rule reload failed, restarting Suricata: %1")
+							   .arg(QString::fromStdString(m_session.socket().error())));
+		}
+	}
+
+	m_session_arguments.clear();
+	m_session_stamps.clear();
+
+	if (!QDir().mkpath(sessionDirectory()))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to create session directory: %1").arg(sessionDirectory()));
+		setReason(QString("Невозможно запустить Suricata"));
+		return false;
+	}
+
+	std::vector<std::string> session_arguments;
+	for (const QString &argument : arguments)
+	{
+		session_arguments.push_back(argument.toStdString());
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	const QString output_path = QDir(sessionDirectory()).filePath("suricata.out");
+	if (!m_session.start(m_suricata_path.toStdString(), session_arguments, sessionSocketPath().toStdString(),
+						 output_path.toStdString(), std::chrono::milliseconds(m_engine_start_timeout)))
+	{
+		QFile	output(output_path);
+		QString last_error;
+		if (output.open(QIODevice::ReadOnly))
+		{
+			for (const QByteArray &line : output.readAll().split('\n'))
+			{
+				if (line.startsWith("E:") || line.startsWith("Error:"))
+				{
+					last_error = QString::fromUtf8(line).trimmed();
+				}
+			}
+		}
+
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to start Suricata session: %1 %2")
+							.arg(QString::fromStdString(m_session.error()), last_error));
+		setReason(QString("Suricata завершилась до начала захвата трафика\n%1").arg(last_error));
+		return false;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Suricata instance %1 ready after %2 ms").arg(m_session.pid()).arg(timer.elapsed()));
+
+	m_session_arguments = arguments;
+	m_session_stamps	= stamps;
+	return true;
+}
+
+void SuricataValidatorWidget::resetObservedAlerts()
+{
+	m_observed_sids.clear();
+	m_observed_alert_count = 0;
+}
+
+bool SuricataValidatorWidget::collectAlerts(UTILS::LineTailer &tailer, AlertLogFormat format, int required_alerts)
+{
+	const auto record = [this](uint32_t gid, uint32_t sid, uint32_t rev, std::string_view message,
+							   std::string_view protocol, std::string_view source, std::string_view destination) {
+		m_observed_alert_count++;
+		m_observed_sids.insert(sid);
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Alert [%1:%2:%3] %4 {%5} %6 -> %7")
+						   .arg(gid)
+						   .arg(sid)
+						   .arg(rev)
+						   .arg(QString::fromUtf8(message.data(), message.size()),
+								QString::fromUtf8(protocol.data(), protocol.size()),
+								QString::fromUtf8(source.data(), source.size()),
+								QString::fromUtf8(destination.data(), destination.size())));
+	};
+
+	tailer.poll([&](std::string_view line) {
+		if (format == AlertLogFormat::Eve)
+		{
+			UTILS::EveEvent event;
+			if (UTILS::EveParser::parse(line, event) && event.isAlert())
+			{
+				record(event.gid, event.signature_id, event.rev, event.signature, event.protocol, event.source_ip,
+					   event.destination_ip);
+			}
+			return;
+		}
+
+		UTILS::FastLogAlert alert;
+		if (UTILS::FastLogAlert::parse(line, alert))
+		{
+			record(alert.gid, alert.sid, alert.rev, alert.message, alert.protocol, alert.source_ip, alert.destination_ip);
+		}
+	});
+
+	if (m_observed_alert_count < required_alerts)
+	{
+		return false;
+	}
+
+	for (const quint32 sid : m_expected_sids)
+	{
+		if (!m_observed_sids.contains(sid))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+QString SuricataValidatorWidget::alertsMismatchReason() const
+{
+	if (m_observed_alert_count == 0)
+	{
+		return QString("ICMP запрос не перехвачен Suricata");
+	}
+
+	QStringList missing;
+	for (const quint32 sid : m_expected_sids)
+	{
+		if (!m_observed_sids.contains(sid))
+		{
+			missing.append(QString::number(sid));
+		}
+	}
+
+	if (missing.isEmpty())
+	{
+		return QString("Suricata сгенерировала недостаточно предупреждений: %1").arg(m_observed_alert_count);
+	}
+
+	std::sort(missing.begin(), missing.end());
+	return QString("Не сработали ожидаемые правила: %1").arg(missing.join(", "));
+}
+
+bool SuricataValidatorWidget::prepareOfflineCapture(const QString &capture_path)
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_capture);
+
+	if (m_offline_scenario.isEmpty())
+	{
+		// Suricata cannot read Qt resources, the capture has to be a real file
+		if (!QFile::copy(m_offline_capture_path, capture_path))
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							QString("Unable to extract capture file: %1").arg(m_offline_capture_path));
+			return false;
+		}
+
+		// The capture may come from the settings, a broken one would only show up as a vague Suricata failure
+		UTILS::PcapReader reader;
+		if (!reader.open(QFile::encodeName(capture_path).toStdString()))
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							QString("Unable to open capture file %1: %2")
+								.arg(m_offline_capture_path, QString::fromLocal8Bit(std::strerror(reader.error()))));
+			return false;
+		}
+
+		std::array<UTILS::PcapPacket, 256> batch;
+		while (reader.read(batch) != 0)
+		{}
+
+		if (reader.error() != 0 || reader.packetCount() == 0)
+		{
+			SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							QString("Capture file %1 is unreadable after %2 packets")
+								.arg(m_offline_capture_path, QString::number(reader.packetCount())));
+			return false;
+		}
+
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Capture file %1: %2 packets, %3 bytes%4")
+						   .arg(m_offline_capture_path, QString::number(reader.packetCount()), QString::number(reader.size()),
+								reader.truncated() ? QString(", last record truncated") : QString()));
+		return true;
+	}
+
+	UTILS::TrafficScenario scenario;
+	std::string			   error;
+	if (!UTILS::TrafficScenario::parse(m_offline_scenario.toStdString(), scenario, error))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Invalid traffic scenario: %1").arg(QString::fromStdString(error)));
+		return false;
+	}
+
+	UTILS::TrafficGenerator generator(std::move(scenario));
+	if (!generator.generate(QFile::encodeName(capture_path).toStdString()))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Unable to write capture file: %1").arg(capture_path));
+		return false;
+	}
+
+	const auto &statistics = generator.statistics();
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Generated %1 packets (%2 bytes) in %3 ms")
+					   .arg(statistics.packets)
+					   .arg(statistics.bytes)
+					   .arg(std::chrono::duration<double, std::milli>(statistics.elapsed).count(), 0, 'f', 1));
+	return true;
+}
+
+bool SuricataValidatorWidget::waitForEngineStarted(QProcess &process)
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QString last_error;
+
+	while (timer.elapsed() < m_engine_start_timeout)
+	{
+		if (!process.canReadLine() && !process.waitForReadyRead(m_engine_start_timeout - timer.elapsed()))
+		{
+			if (process.state() == QProcess::NotRunning)
+			{
+				break;
+			}
+			continue;
+		}
+
+		while (process.canReadLine())
+		{
+			const QString line = QString::fromUtf8(process.readLine()).trimmed();
+
+			if (line.contains(k_engine_started_notice, Qt::CaseInsensitive))
+			{
+				SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+							   QString("Suricata engine started after %1 ms").arg(timer.elapsed()));
+				return true;
+			}
+
+			if (line.startsWith("E:") || line.startsWith("Error:"))
+			{
+				last_error = line;
+			}
+		}
+	}
+
+	if (process.state() == QProcess::NotRunning)
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						QString("Suricata exited before the engine started: %1").arg(last_error));
+		setReason(QString("Suricata завершилась до начала захвата трафика\n%1").arg(last_error));
+		return false;
+	}
+
+	SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					QString("Suricata engine did not start within %1 ms").arg(m_engine_start_timeout));
+	setReason(QString("Suricata не запустилась за %1 с").arg(m_engine_start_timeout / 1000));
+	return false;
+}
+
+void SuricataValidatorWidget::indexRuleFiles()
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_rules);
+
+	// Configurations sharing a rule set share its index
+	QMap<QString, std::shared_ptr<const UTILS::RuleIndex>> indexes;
+
+	for (auto it = m_config_checks.begin(); it != m_config_checks.end(); ++it)
+	{
+		ConfigCheck &check = it.value();
+		if (check.verdict == ConfigVerdict::Skipped)
+		{
+			continue;
+		}
+
+		const std::vector<std::string> rule_files = check.config.resolveRuleFiles();
+
+		QString signature;
+		for (const std::string &rule_file : rule_files)
+		{
+			signature += QString::fromStdString(rule_file) + '\n';
+		}
+
+		std::shared_ptr<const UTILS::RuleIndex> &index = indexes[signature];
+		if (!index)
+		{
+			auto built = std::make_shared<UTILS::RuleIndex>();
+			built->load(rule_files);
+
+			const UTILS::RuleIndex::Statistics &statistics = built->statistics();
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+						   QString("Indexed %1 rules (%2 disabled) from %3 rule files, %4 bytes in %5 chunks, %6 ms")
+							   .arg(statistics.rules)
+							   .arg(statistics.disabled_rules)
+							   .arg(statistics.files)
+							   .arg(statistics.bytes)
+							   .arg(statistics.chunks)
+							   .arg(static_cast<double>(statistics.elapsed.count()) / 1000.0, 0, 'f', 1));
+
+			for (const QString &finding : ruleIndexFindings(*built))
+			{
+				SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, QString("%1: %2").arg(it.key(), finding));
+			}
+			index = std::move(built);
+		}
+		check.rules = index;
+	}
+}
+
+QStringList SuricataValidatorWidget::ruleIndexFindings(const UTILS::RuleIndex &index) const
+{
+	QStringList findings;
+
+	for (const std::string &file : index.missingFiles())
+	{
+		findings.append(QString("Не найден файл правил: %1").arg(QString::fromStdString(file)));
+	}
+
+	const std::vector<UTILS::RuleIndex::Duplicate> &duplicates = index.duplicates();
+	for (std::size_t i = 0; i < duplicates.size() && i < k_duplicates_shown; ++i)
+	{
+		const UTILS::RuleIndex::Duplicate &duplicate = duplicates[i];
+		const QString					   first	 = QString::fromStdString(index.filePath(duplicate.first));
+		const QString					   second	 = QString::fromStdString(index.filePath(duplicate.second));
+		findings.append(QString("Повторяющийся sid %1: %2:%3 и %4:%5")
+							.arg(QString::number(duplicate.first.sid), first, QString::number(duplicate.first.line), second,
+								 QString::number(duplicate.second.line)));
+	}
+	if (duplicates.size() > k_duplicates_shown)
+	{
+		findings.append(QString("… и ещё %1 повторяющихся sid").arg(duplicates.size() - k_duplicates_shown));
+	}
+
+	const std::vector<UTILS::RuleLocation> &without_sid = index.rulesWithoutSid();
+	if (!without_sid.empty())
+	{
+		const QString file = QString::fromStdString(index.filePath(without_sid.front()));
+		findings.append(QString("Правил без sid: %1, первое %2:%3")
+							.arg(QString::number(without_sid.size()), file, QString::number(without_sid.front().line)));
+	}
+
+	return findings;
+}
+
+void SuricataValidatorWidget::forceRevalidate()
+{
+	if (m_validation_running)
+	{
+		return;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Forced revalidation, ignoring the validation cache");
+	m_force_revalidate = true;
+	startValidation();
+}
+
+QString SuricataValidatorWidget::validationCachePath() const
+{
+	return UTILS::SettingsManager::instance()->getSettingsDirectory() + "/" +
+		   m_validation_cache_name.arg(QSysInfo::machineHostName());
+}
+
+bool SuricataValidatorWidget::validationKey(const QString &selected_config, quint64 &key) const
+{
+	// Only configurations ranked up to the selected one can change the selection
+	const QStringList config_paths = getConfigFilePaths();
+	const int		  selected	   = config_paths.indexOf(selected_config);
+	if (selected < 0)
+	{
+		return false;
+	}
+
+	std::vector<std::string> files = {QFile::encodeName(m_suricata_path).toStdString()};
+	for (const QString &config_path : config_paths.mid(0, selected + 1))
+	{
+		const UTILS::SuricataConfig &config = m_config_checks.value(config_path).config;
+		files.push_back(QFile::encodeName(config_path).toStdString());
+		files.insert(files.end(), config.includes.begin(), config.includes.end());
+
+		const std::vector<std::string> rule_files = config.resolveRuleFiles();
+		files.insert(files.end(), rule_files.begin(), rule_files.end());
+	}
+
+	// What passes depends on the expectations too, not only on what is replayed
+	QList<quint32> expected_sids = m_expected_sids.values();
+	std::sort(expected_sids.begin(), expected_sids.end());
+
+	QStringList sids;
+	for (const quint32 sid : expected_sids)
+	{
+		sids.append(QString::number(sid));
+	}
+
+	UTILS::Xxh64 hash;
+	hash.update(QString("%1|%2|%3|%4|%5|%6")
+					.arg(QString::number(static_cast<int>(m_validation_mode)),
+						 m_offline_scenario.isEmpty() ? m_offline_capture_path : m_offline_scenario,
+						 config_paths.join(';'), m_capture_interfaces.join(';'), sids.join(','),
+						 QString::number(m_offline_expected_alerts))
+					.toStdString());
+
+	// A missing rule file is a state of its own, Suricata only warns about it
+	for (const UTILS::ContentHash::FileHash &file : UTILS::ContentHash::hashFiles(files))
+	{
+		hash.update(file.path);
+		hash.update(&file.ok, sizeof(file.ok));
+		hash.update(&file.size, sizeof(file.size));
+		hash.update(&file.hash, sizeof(file.hash));
+	}
+
+	key = hash.digest();
+	return true;
+}
+
+bool SuricataValidatorWidget::restoreCachedValidation()
+{
+	if (m_validation_cache_max_age <= 0)
+	{
+		return false;
+	}
+
+	UTILS::ValidationRecord record;
+	if (!UTILS::ValidationCache(QFile::encodeName(validationCachePath()).toStdString()).load(record))
+	{
+		return false;
+	}
+
+	const qint64 age = QDateTime::currentSecsSinceEpoch() - record.validated_at;
+	if (age < 0 || age > m_validation_cache_max_age)
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Cached validation is %1 s old, revalidating").arg(age));
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	quint64 key = 0;
+	if (!validationKey(QString::fromStdString(record.config_path), key) || key != record.key)
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+					   QString("Suricata setup changed since the cached validation (hashed in %1 ms)").arg(timer.elapsed()));
+		return false;
+	}
+
+	for (const UTILS::ValidationRecord::ConfigVerdict &verdict : record.verdicts)
+	{
+		const QString config_path = QString::fromStdString(verdict.path);
+		if (!m_config_checks.contains(config_path))
+		{
+			continue;
+		}
+		ConfigCheck &check = m_config_checks[config_path];
+		check.verdict	   = static_cast<ConfigVerdict>(verdict.verdict);
+		check.error_count  = verdict.error_count;
+		check.elapsed_ms   = verdict.elapsed_ms;
+	}
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Suricata setup unchanged, reusing validation from %1 (hashed in %2 ms, saves about %3 ms)")
+					   .arg(QDateTime::fromSecsSinceEpoch(record.validated_at).toString(Qt::ISODate))
+					   .arg(timer.elapsed())
+					   .arg(record.elapsed_ms));
+	return true;
+}
+
+void SuricataValidatorWidget::storeValidation(bool passed, qint64 elapsed_ms)
+{
+	UTILS::ValidationCache cache(QFile::encodeName(validationCachePath()).toStdString());
+
+	if (!passed)
+	{
+		cache.clear();
+		return;
+	}
+	if (m_validation_cache_hit || m_validation_cache_max_age <= 0)
+	{
+		return;
+	}
+
+	UTILS::ValidationRecord record;
+	record.validated_at = QDateTime::currentSecsSinceEpoch();
+	record.elapsed_ms	= elapsed_ms;
+	record.config_path	= m_suricata_config_path.toStdString();
+	if (!validationKey(m_suricata_config_path, record.key))
+	{
+		return;
+	}
+
+	for (const QString &config_path : getConfigFilePaths())
+	{
+		const ConfigCheck check = m_config_checks.value(config_path);
+		record.verdicts.push_back(
+			{config_path.toStdString(), static_cast<int>(check.verdict), check.error_count, check.elapsed_ms});
+	}
+
+	QDir().mkpath(QFileInfo(validationCachePath()).absolutePath());
+	if (!cache.save(record))
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Unable to save validation cache");
+	}
+}
+
+void SuricataValidatorWidget::discoverConfigFiles()
+{
+	UTILS::StageScope stage(m_stage_timings, k_stage_discovery);
+
+	{
+		QMutexLocker locker(&m_config_file_paths_mutex);
+		m_config_file_paths.clear();
+	}
+
+	UTILS::DirectoryWalker::Options options;
+	options.max_depth = m_discovery_max_depth;
+	options.prune_names.clear();
+
+	for (const QString &dir_path : m_suricata_conf_dirs)
+	{
+		options.roots.push_back(dir_path.toStdString());
+	}
+	for (const QString &filter : m_suricata_conf_files)
+	{
+		options.name_patterns.push_back(filter.toStdString());
+	}
+	for (const QString &name : m_discovery_prune_names)
+	{
+		options.prune_names.push_back(name.toStdString());
+	}
+
+	const QString cache_directory = UTILS::SettingsManager::instance()->getSettingsDirectory();
+	QDir().mkpath(cache_directory);
+
+	UTILS::DiscoveryCache discovery_cache((cache_directory + "/" + m_discovery_cache_name).toStdString());
+	options.cache = &discovery_cache;
+
+	UTILS::DirectoryWalker walker(std::move(options));
+
+	if (!discovery_cache.load(walker.listingSignature()))
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Discovery cache is empty, performing full scan");
+	}
+
+	const auto statistics = walker.walk([this](const std::string &path) {
+		const QString config_path = QString::fromStdString(path);
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Found suricata configuration file: " + config_path);
+
+		QMutexLocker locker(&m_config_file_paths_mutex);
+		m_config_file_paths.append(config_path);
+	});
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Scanned %1 directories (%2 from cache, %3 entries, %4 unreadable) in %5 ms")
+					   .arg(statistics.directories_scanned + statistics.directories_cached)
+					   .arg(statistics.directories_cached)
+					   .arg(statistics.entries_seen)
+					   .arg(statistics.errors)
+					   .arg(std::chrono::duration<double, std::milli>(statistics.elapsed).count(), 0, 'f', 1));
+
+	if (!discovery_cache.save())
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Unable to save discovery cache");
+	}
+
+	// With the trailing separator /etc/suricata-old does not rank as /etc/suricata
+	QStringList roots;
+	for (const QString &dir_path : m_suricata_conf_dirs)
+	{
+		const QString root = QDir(dir_path).absolutePath();
+		roots.append(root.endsWith('/') ? root : root + '/');
+	}
+
+	// Workers finish in arbitrary order, keep the configured directory priority stable
+	QMutexLocker locker(&m_config_file_paths_mutex);
+	std::stable_sort(m_config_file_paths.begin(), m_config_file_paths.end(), [&roots](const QString &lhs, const QString &rhs) {
+		auto root_index = [&roots](const QString &path) {
+			for (int i = 0; i < roots.size(); ++i)
+			{
+				if (path.startsWith(roots[i]))
+				{
+					return i;
+				}
+			}
+			return static_cast<int>(roots.size());
+		};
+
+		const int lhs_index = root_index(lhs);
+		const int rhs_index = root_index(rhs);
+		return lhs_index != rhs_index ? lhs_index < rhs_index : lhs < rhs;
+	});
+}
+
+void SuricataValidatorWidget::executeProcessShellMethod(const QString &command)
+{
+	QProcess process;
+	process.start("bash", QStringList() << "-c" << command << "> /dev/null 2>&");
 	process.waitForFinished();
 }
 
@@ -486,11 +2291,200 @@ void SuricataValidatorWidget::setSuricataConfFiles(const QStringList &files)
 	m_suricata_conf_files = files;
 }
 
+void SuricataValidatorWidget::setDiscoveryMaxDepth(int depth)
+{
+	m_discovery_max_depth = depth;
+}
+
+void SuricataValidatorWidget::setDiscoveryPruneNames(const QStringList &names)
+{
+	m_discovery_prune_names = names;
+}
+
+void SuricataValidatorWidget::setConfigTestParallelism(int parallelism)
+{
+	m_config_test_parallelism = parallelism;
+}
+
+void SuricataValidatorWidget::setEngineStartTimeout(int timeout)
+{
+	m_engine_start_timeout = timeout;
+}
+
+void SuricataValidatorWidget::setAlertTimeout(int timeout)
+{
+	m_alert_timeout = timeout;
+}
+
+void SuricataValidatorWidget::setValidationMode(ValidationMode mode)
+{
+	m_validation_mode = mode;
+}
+
+void SuricataValidatorWidget::setOfflineCapture(const QString &capture_path, int expected_alerts)
+{
+	m_offline_capture_path	  = capture_path;
+	m_offline_expected_alerts = expected_alerts;
+}
+
+void SuricataValidatorWidget::setOfflineScenario(const QString &scenario, int expected_alerts)
+{
+	m_offline_scenario		  = scenario;
+	m_offline_expected_alerts = expected_alerts;
+}
+
+void SuricataValidatorWidget::setExpectedSids(const QList<quint32> &sids)
+{
+	m_expected_sids = QSet<quint32>(sids.begin(), sids.end());
+}
+
+void SuricataValidatorWidget::setCaptureInterfaces(const QStringList &interfaces)
+{
+	m_capture_interfaces = interfaces;
+}
+
+void SuricataValidatorWidget::setCaptureInterfaceCount(int count)
+{
+	m_capture_interface_count = std::max(1, count);
+}
+
+void SuricataValidatorWidget::setValidationCacheMaxAge(int seconds)
+{
+	m_validation_cache_max_age = seconds;
+}
+
+void SuricataValidatorWidget::setReuseSuricataInstance(bool reuse)
+{
+	m_reuse_suricata_instance = reuse;
+}
+
+void SuricataValidatorWidget::setRuleProfilingEnabled(bool enabled)
+{
+	m_rule_profiling = enabled;
+}
+
+void SuricataValidatorWidget::setRuleProfileTopCount(int count)
+{
+	m_profile_top_count = count;
+}
+
 void SuricataValidatorWidget::setReasonLabelText(const QString &text)
 {
 	m_reason_label->setText(text);
 }
 
+void SuricataValidatorWidget::setWatchingEnabled(bool enabled)
+{
+	m_watching_enabled = enabled;
+
+	if (!m_validation_running)
+	{
+		updateWatchedPaths();
+	}
+}
+
+void SuricataValidatorWidget::setReason(const QString &text)
+{
+	emit reasonChanged(text);
+}
+
+void SuricataValidatorWidget::setTimings(const QString &text)
+{
+	emit timingsChanged(text);
+}
+
+void SuricataValidatorWidget::setProfile(const QString &text)
+{
+	emit profileChanged(text);
+}
+
+void SuricataValidatorWidget::finishStageRun()
+{
+	m_stage_timings.endRun();
+
+	SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application,
+				   QString("Validation stages: %1").arg(QString::fromStdString(m_stage_timings.summary())));
+
+	const QString path = stageTimingsPath();
+	QDir().mkpath(QFileInfo(path).absolutePath());
+	if (!m_stage_timings.save(QFile::encodeName(path).toStdString()))
+	{
+		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Unable to save stage timings to " + path);
+	}
+
+	setTimings(timingsBreakdown());
+}
+
+QString SuricataValidatorWidget::timingsBreakdown() const
+{
+	const std::vector<UTILS::StageTimings::Stage> stages = m_stage_timings.stages();
+
+	// Before the first run of this session the history of earlier runs is shown
+	std::vector<UTILS::StageTimings::Sample> samples = m_stage_timings.lastRun();
+	if (samples.empty())
+	{
+		for (const UTILS::StageTimings::Stage &stage : stages)
+		{
+			samples.push_back({stage.name, stage.histogram.last()});
+		}
+	}
+
+	QStringList lines;
+	for (const UTILS::StageTimings::Sample &sample : samples)
+	{
+		const auto stage = std::find_if(stages.begin(), stages.end(), [&](const UTILS::StageTimings::Stage &entry) {
+			return entry.name == sample.stage;
+		});
+		if (stage == stages.end())
+		{
+			continue;
+		}
+
+		const UTILS::StageHistogram &histogram = stage->histogram;
+		const bool slow = histogram.count() >= k_regression_min_runs && sample.elapsed > histogram.percentile(0.9);
+
+		lines.append(QString("%1%2: %3 мс (медиана %4, p90 %5, запусков %6)")
+						 .arg(slow ? "▲ " : "")
+						 .arg(stageTitle(sample.stage))
+						 .arg(milliseconds(sample.elapsed))
+						 .arg(milliseconds(histogram.percentile(0.5)))
+						 .arg(milliseconds(histogram.percentile(0.9)))
+						 .arg(histogram.count()));
+	}
+
+	if (lines.isEmpty())
+	{
+		return QString();
+	}
+
+	// Stages overlap, only the wall clock time adds up to what the user waited for
+	const std::chrono::microseconds wall = m_stage_timings.lastRunWall();
+	if (wall.count() > 0)
+	{
+		lines.append(QString("Всего: %1 мс").arg(milliseconds(wall)));
+	}
+	return lines.join("\n");
+}
+
+QString SuricataValidatorWidget::stageTimingsPath() const
+{
+	// One file per host, lab machines share the settings directory through home
+	return UTILS::SettingsManager::instance()->getSettingsDirectory() + "/" +
+		   m_stage_timings_name.arg(QSysInfo::machineHostName());
+}
+
+bool SuricataValidatorWidget::isConfigFileName(const QString &file_name) const
+{
+	for (const QString &filter : m_suricata_conf_files)
+	{
+		if (QDir::match(filter, file_name))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 ValidationStatus SuricataValidatorWidget::getCurrentStatus() const
 {
 	return m_current_status;
@@ -501,8 +2495,19 @@ QString SuricataValidatorWidget::getSuricataPath() const
 	return m_suricata_path;
 }
 
+QString SuricataValidatorWidget::getSelectedConfigFilePath() const
+{
+	return m_suricata_config_path;
+}
+
+QList<quint32> SuricataValidatorWidget::getObservedSids() const
+{
+	return m_observed_sids.values();
+}
+
 QStringList SuricataValidatorWidget::getConfigFilePaths() const
 {
+	QMutexLocker locker(&m_config_file_paths_mutex);
 	return m_config_file_paths;
 }
 
@@ -1,15 +1,35 @@
 #ifndef SURICATA_VALIDATOR_WIDGET_HPP
 #define SURICATA_VALIDATOR_WIDGET_HPP
 
+#include "stage_timer.hpp"
+#include "suricata_config.hpp"
+#include "suricata_diagnostic.hpp"
+#include "suricata_session.hpp"
+
+#include <QDateTime>
 #include <QDir>
 #include <QFuture>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QWidget>
+#include <memory>
 
 class QLabel;
+class QProcess;
+class QPushButton;
+class QToolButton;
 class QVBoxLayout;
 
+namespace UTILS
+{
+class FileWatcher;
+class LineTailer;
+class RuleIndex;
+} // namespace UTILS
+
 namespace APP
 {
 enum class ValidationStatus
@@ -19,6 +39,18 @@ enum class ValidationStatus
 	Failure
 };
 
+enum class ValidationMode
+{
+	Live,	// capture a ping on the first active interface
+	Offline // replay a bundled capture with suricata -r
+};
+
+enum class ValidationScope
+{
+	Full,		 // up to the capture check, watching for changes afterwards
+	Installation // the binary and a config that passes suricata -T, nothing is started or captured
+};
+
 class SuricataValidatorWidget : public QWidget
 {
 	Q_OBJECT
@@ -26,51 +58,217 @@ class SuricataValidatorWidget : public QWidget
 signals:
 	void validationFinished(ValidationStatus status);
 	void validationStatusChanged(ValidationStatus status);
+	void reasonChanged(const QString& text);
+	void timingsChanged(const QString& text);
+	void profileChanged(const QString& text);
 
 public:
-	explicit SuricataValidatorWidget(QWidget* parent = nullptr);
+	explicit SuricataValidatorWidget(QWidget* parent = nullptr, ValidationScope scope = ValidationScope::Full);
 	~SuricataValidatorWidget() override;
 
 	void setSuricataPaths(const QStringList& paths);
 	void setSuricataConfDirs(const QStringList& dirs);
 	void setSuricataConfFiles(const QStringList& files);
+	void setDiscoveryMaxDepth(int depth);
+	void setDiscoveryPruneNames(const QStringList& names);
 	void setReasonLabelText(const QString& text);
+	void setWatchingEnabled(bool enabled);
+	void setConfigTestParallelism(int parallelism);
+	void setEngineStartTimeout(int timeout);
+	void setAlertTimeout(int timeout);
+	void setValidationMode(ValidationMode mode);
+	void setOfflineCapture(const QString& capture_path, int expected_alerts);
+	void setOfflineScenario(const QString& scenario, int expected_alerts);
+	void setExpectedSids(const QList<quint32>& sids);
+	void setCaptureInterfaces(const QStringList& interfaces);
+	void setCaptureInterfaceCount(int count);
+	void setReuseSuricataInstance(bool reuse);
+	void setValidationCacheMaxAge(int seconds);
+	void setRuleProfilingEnabled(bool enabled);
+	void setRuleProfileTopCount(int count);
 
 	ValidationStatus getCurrentStatus() const;
 	QString			 getSuricataPath() const;
 	QStringList		 getConfigFilePaths() const;
+	QString			 getSelectedConfigFilePath() const; // the config that passed suricata -T, empty before
+	QList<quint32>	 getObservedSids() const;
+
+public slots:
+	/**
+	 * Full validation that ignores and then replaces the cached result.
+	 */
+	void forceRevalidate();
+
+private:
+	enum class ConfigVerdict
+	{
+		NotTested,
+		Skipped,
+		Passed,
+		Failed,
+		Cancelled
+	};
+
+	enum class AlertLogFormat
+	{
+		Fast,
+		Eve
+	};
+
+	struct ConfigCheck
+	{
+		ConfigVerdict		  verdict	  = ConfigVerdict::NotTested;
+		int					  error_count = 0;
+		qint64				  elapsed_ms  = 0;
+		AlertLogFormat		  log_format  = AlertLogFormat::Fast;
+		QString				  log_filename; // as written in the config, relative to default-log-dir or -l
+		QString				  log_dir;
+		QString				  log_path;
+		QString				  reason;
+		UTILS::SuricataConfig config;
+
+		std::vector<UTILS::SuricataDiagnostic>	diagnostics; // warnings and errors of the last -T run
+		std::shared_ptr<const UTILS::RuleIndex> rules;		 // SIDs of the referenced rule files
+	};
 
 private:
 	void initialize();
+	void readSettings();
 	void setupUi();
 	void setupStyle();
 	void setupConnections();
-	void startValidation();
+	void startValidation(const QStringList& changed_paths = {});
 	void updateStatusDisplay();
+	void updateWatchedPaths();
+	void setReason(const QString& text);
+	void setTimings(const QString& text);
+	void setProfile(const QString& text);
+	void finishStageRun();
+	bool isConfigFileName(const QString& file_name) const;
 
 	bool		  checkSuricata();
-	void		  searchDirectoryRecursive(const QDir& dir);
+	bool		  revalidate(const QStringList& changed_paths);
+	bool		  locateSuricataBinary();
+	bool		  checkSuricataNotRunning();
+	void		  discoverConfigFiles();
+	ConfigCheck	  parseConfigFile(const QString& config_path);
+	void		  testPendingConfigFiles();
+	void		  indexRuleFiles();
+	QStringList	  ruleIndexFindings(const UTILS::RuleIndex& index) const;
+	void		  testConfigFiles(const QStringList& config_paths);
+	void		  evaluateConfigTest(const QString& config_path, ConfigCheck& check) const;
+	QString		  verdictSummary() const;
+	bool		  selectConfigFile();
+	bool		  checkCapture();
+	bool		  checkLiveCapture();
+	bool		  checkOfflineReplay();
+	QStringList	  selectCaptureInterfaces() const;
+	QStringList	  captureArguments(const QStringList& interfaces) const;
+	bool		  waitForPingAlert();
+	bool		  replayWithProcess(const QString& capture_path, const QString& log_dir);
+	bool		  replayWithSession(const QString& capture_path, const QString& log_dir);
+	QStringList	  profilingArguments() const;
+	void		  collectRuleProfile(const QString& log_dir);
+	bool		  ensureSession(const QStringList& arguments);
+	QString		  sessionDirectory() const;
+	QString		  sessionSocketPath() const;
+	QMap<QString, QDateTime> sessionInputStamps() const;
+	bool		  prepareOfflineCapture(const QString& capture_path);
+	void		  resetObservedAlerts();
+	bool		  collectAlerts(UTILS::LineTailer& tailer, AlertLogFormat format, int required_alerts);
+	QString		  alertsMismatchReason() const;
+	QString		  timingsBreakdown() const;
+	QString		  stageTimingsPath() const;
+	QString		  validationCachePath() const;
+	bool		  validationKey(const QString& selected_config, quint64& key) const;
+	bool		  restoreCachedValidation();
+	void		  storeValidation(bool passed, qint64 elapsed_ms);
+	bool		  waitForEngineStarted(QProcess& process);
 	static void	  executeProcessShellMethod(const QString& command);
 	QFuture<void> runShellCommandAsync(const QString& command);
 
+private slots:
+	void onWatchedPathsChanged(const QStringList& paths);
+
 private:
 	QLabel*			 m_status_label;
 	QLabel*			 m_reason_label;
+	QPushButton*	 m_revalidate_button;
+	QToolButton*	 m_timings_button;
+	QLabel*			 m_timings_label;
+	QToolButton*	 m_profile_button;
+	QLabel*			 m_profile_label;
 	ValidationStatus m_current_status;
 	QVBoxLayout*	 m_main_layout;
 
-	QStringList m_config_file_paths;
+	UTILS::FileWatcher* m_file_watcher;
+	QSet<QString>		m_pending_changes;
+	bool				m_validation_running;
+	bool				m_watching_enabled;
+	bool				m_live_check_passed;
+	ValidationScope		m_validation_scope;
+
+	QMap<QString, ConfigCheck> m_config_checks;
+
+	QStringList	   m_config_file_paths;
+	mutable QMutex m_config_file_paths_mutex;
+
+	QSet<quint32> m_expected_sids;
+	QSet<quint32> m_observed_sids;
+	int			  m_observed_alert_count = 0;
+
 	QStringList m_active_interfaces;
 	QString		m_suricata_path;
 	QString		m_suricata_config_path;
 	QString		m_suricata_log_path;
 	QString		m_suricata_log_dir;
 
+	AlertLogFormat m_suricata_log_format = AlertLogFormat::Fast;
+
 private:
 	QStringList m_suricata_paths	  = {"/usr/bin/suricata", "/usr/local/bin/suricata", "/sbin/suricata", "/usr/sbin/suricata",
 										 "/opt/suricata/bin/suricata"};
 	QStringList m_suricata_conf_dirs  = {"/etc/suricata", "/home", "/usr/local/etc/suricata", "/opt/suricata/etc"};
 	QStringList m_suricata_conf_files = {"suricata.yaml", "suricata.conf"};
+
+	int			m_discovery_max_depth	= -1;
+	QStringList m_discovery_prune_names = {".cache", "node_modules", ".git"};
+	QString		m_discovery_cache_name	= "suricata_discovery.cache";
+	QString		m_stage_timings_name	= "stage_timings_%1.txt"; // %1 - host name
+	QString		m_validation_cache_name = "validation_cache_%1.txt"; // %1 - host name
+
+	// A success is reused while every hashed input is unchanged, 0 disables the cache
+	int	 m_validation_cache_max_age = 24 * 60 * 60; // s
+	bool m_validation_cache_hit		= false;
+	bool m_force_revalidate			= false;
+
+	// Per-stage durations of every run, kept per host to spot slow lab machines
+	mutable UTILS::StageTimings m_stage_timings;
+
+	int m_config_test_parallelism = 0; // 0 - one suricata -T per core
+
+	QStringList m_capture_interfaces; // pinned, overrides the capture_interfaces setting and the ranking
+	int			m_capture_interface_count = 1;	 // how many of the ranked interfaces to capture on
+	int			m_interface_sample_window = 500; // ms of rx_packets sampling before ranking
+
+	int m_engine_start_timeout = 30000; // ms
+	int m_alert_timeout		   = 5000;	// ms
+
+	ValidationMode m_validation_mode		 = ValidationMode::Live;
+	QString		   m_offline_capture_path	 = ":/validation/app/pcap/icmp_echo.pcap";
+	QString		   m_offline_scenario; // generated capture, takes precedence over m_offline_capture_path
+	int			   m_offline_expected_alerts = 1;
+	int			   m_offline_timeout		 = 60000; // ms
+
+	// Offline replay with rule and keyword profiling, needs Suricata built with profiling support
+	bool m_rule_profiling	 = false;
+	int	 m_profile_top_count = 10; // rules listed per ranking
+
+	// One Suricata kept alive across checks, restarted when its arguments or config change
+	bool					 m_reuse_suricata_instance = true;
+	UTILS::SuricataSession	 m_session;
+	QStringList				 m_session_arguments;
+	QMap<QString, QDateTime> m_session_stamps; // config, includes and rule files at start or last reload
 };
 } // namespace APP
 
@@ -1,5 +1,6 @@
 #include "main_window.hpp"
 
+#include "process_scanner.hpp"
 #include "settings_manager.hpp"
 #include "spdlog_wrapper.hpp"
 #include "user_panel_widget.hpp"
@@ -17,6 +18,7 @@
 #include <QSplitter>
 #include <QTimer>
 #include <QtConcurrent>
+#include <cstring>
 #include <pwd.h>
 #include <unistd.h>
 #include <utmp.h>
@@ -193,40 +195,64 @@ QFuture<void> MainWindow::runShellCommandAsync(const QString &command)
 	return QtConcurrent::run(executeProcessShellMethod, command);
 }
 
-void MainWindow::disableAllGSettingsKeybinds()
+bool MainWindow::findSessionUser(QString &name, QString &uid)
 {
-	QClipboard *clipboard = QGuiApplication::clipboard();
-	clipboard->clear();
-	clipboard->setText(":)", QClipboard::Clipboard);
-
-	QStringList	 users;
 	struct utmp *ut;
 
 	setutent();
 	while ((ut = getutent()) != nullptr)
 	{
-		if (ut->ut_type == USER_PROCESS)
+		if (ut->ut_type == USER_PROCESS && ut->ut_user[0] != '\0')
 		{
-			if (ut->ut_user[0] != '\0')
+			name = QString::fromLocal8Bit(ut->ut_user, static_cast<int>(strnlen(ut->ut_user, sizeof(ut->ut_user))));
+			break;
+		}
+	}
+	endutent();
+
+	struct passwd *pwd = name.isEmpty() ? nullptr : getpwnam(name.toUtf8().constData());
+
+	// Graphical logins do not always reach utmp, the owner of the shell process is the session user
+	if (pwd == nullptr)
+	{
+		for (const UTILS::ProcessInfo &process : UTILS::ProcessScanner::findByName("gnome-shell"))
+		{
+			if (process.uid != 0 && (pwd = getpwuid(process.uid)) != nullptr)
 			{
-				QString username(ut->ut_user);
-				if (!users.contains(username))
-				{
-					users << username;
-				}
+				break;
 			}
 		}
 	}
-	endutent();
 
-	struct passwd *pwd = getpwnam(users[0].toUtf8().constData());
+	if (pwd == nullptr)
+	{
+		return false;
+	}
+
+	name = QString::fromLocal8Bit(pwd->pw_name);
+	uid	 = QString::number(pwd->pw_uid);
+	return true;
+}
+
+void MainWindow::disableAllGSettingsKeybinds()
+{
+	QClipboard *clipboard = QGuiApplication::clipboard();
+	clipboard->clear();
+	clipboard->setText(":)", QClipboard::Clipboard);
 
-	QString user_uid = QString::number(pwd->pw_uid);
+	QString user_name;
+	QString user_uid;
+	if (!findSessionUser(user_name, user_uid))
+	{
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Unable to find the desktop session user");
+		emit keybindsDisabled();
+		return;
+	}
 
 	QFuture<void> future =
 		runShellCommandAsync(QString("sudo -Hu %1 DISPLAY=:0 DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/%2/bus gsettings set "
 									 "org.gnome.shell.extensions.dash-to-dock autohide-in-fullscreen true")
-								 .arg(users[0], user_uid));
+								 .arg(user_name, user_uid));
 
 	SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
 				   "Disabling all GSettings keybinds\nIf application crashed, you can restore them manually by running "
@@ -235,7 +261,7 @@ void MainWindow::disableAllGSettingsKeybinds()
 	QProcess process;
 	process.start("bash", {"-c", QString("sudo -Hu %1 DISPLAY=:0 DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/%2/bus gsettings "
 										 "list-recursively | grep -E \"<[a-zA-Z]*>|(Super|Alt|Control|Meta|Key)\"")
-									 .arg(users[0], user_uid)});
+									 .arg(user_name, user_uid)});
 	process.waitForFinished();
 	QString		output = process.readAllStandardOutput();
 	QStringList lines  = output.split("\n", Qt::SkipEmptyParts);
@@ -262,7 +288,7 @@ void MainWindow::disableAllGSettingsKeybinds()
 
 			future = runShellCommandAsync(
 				QString("sudo -Hu %1 DISPLAY=:0 DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/%2/bus gsettings set %3 %4 %5")
-					.arg(users[0], user_uid, schema, key, new_value));
+					.arg(user_name, user_uid, schema, key, new_value));
 			SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
 						   "\tTemporary removing keybind: " + schema + " " + key + " " + value + " " + new_value);
 		}
@@ -278,29 +304,13 @@ void MainWindow::restoreAllGSettingsKeybinds()
 	QClipboard *clipboard = QGuiApplication::clipboard();
 	clipboard->clear();
 
-	QStringList	 users;
-	struct utmp *ut;
-
-	setutent();
-	while ((ut = getutent()) != nullptr)
+	QString user_name;
+	QString user_uid;
+	if (!findSessionUser(user_name, user_uid))
 	{
-		if (ut->ut_type == USER_PROCESS)
-		{
-			if (ut->ut_user[0] != '\0')
-			{
-				QString username(ut->ut_user);
-				if (!users.contains(username))
-				{
-					users << username;
-				}
-			}
-		}
+		SPD_ERROR_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Unable to find the desktop session user");
+		return;
 	}
-	endutent();
-
-	struct passwd *pwd = getpwnam(users[0].toUtf8().constData());
-
-	QString user_uid = QString::number(pwd->pw_uid);
 
 	SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Restoring all GSettings keybinds");
 
@@ -315,7 +325,7 @@ void MainWindow::restoreAllGSettingsKeybinds()
 
 		future = runShellCommandAsync(
 			QString("sudo -Hu %1 DISPLAY=:0 DBUS_SESSION_BUS_ADDRESS=unix:path=/run/user/%2/bus gsettings set %3 %4 %5")
-				.arg(users[0], user_uid, schema, key, value));
+				.arg(user_name, user_uid, schema, key, value));
 		SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application,
 					   "\tRestoring keybind: " + schema + " " + key + " " + value);
 
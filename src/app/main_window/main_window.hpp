@@ -45,6 +45,7 @@ private:
 	void setupConnections();
 	void setupStyle();
 
+	static bool	  findSessionUser(QString &name, QString &uid);
 	static void	  executeProcessShellMethod(const QString &command);
 	QFuture<void> runShellCommandAsync(const QString &command);
 
@@ -83,18 +83,17 @@ void IntroductionWidget::setupConnections()
 {
 	connect(m_suricata_validator_widget, &SuricataValidatorWidget::validationFinished, this,
 			&IntroductionWidget::onValidationFinished);
-	connect(m_start_test_button, &QPushButton::clicked, this, &IntroductionWidget::onStartTestClicked);
+	connect(m_start_test_button, &QPushButton::clicked, this, [this]() {
+		m_suricata_validator_widget->setWatchingEnabled(false);
+		emit onStartTestClicked();
+	});
 }
 
 void IntroductionWidget::onValidationFinished(ValidationStatus status)
 {
 	emit onValidationDone();
 
-	if (status != ValidationStatus::Success)
-	{
-		return;
-	}
-
-	m_start_test_button->setDisabled(false);
+	// Validation is repeated when watched configuration files change
+	m_start_test_button->setDisabled(status != ValidationStatus::Success);
 }
 } // namespace APP
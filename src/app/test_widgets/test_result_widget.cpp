@@ -224,6 +224,30 @@ QString TestResultWidget::resolveTestName(const QString& test_name)
 	{
 		human_name = "Проверка 7: Наличие обратного порта";
 	}
+	else if (test_name == "test_3_syntax_valid")
+	{
+		human_name = "Проверка 1: Не менее 3х правил без ошибок";
+	}
+	else if (test_name == "test_3_header_valid")
+	{
+		human_name = "Проверка 2: Адреса или порты в заголовке";
+	}
+	else if (test_name == "test_3_content_valid")
+	{
+		human_name = "Проверка 3: Наличие content с модификатором";
+	}
+	else if (test_name == "test_3_pcre_valid")
+	{
+		human_name = "Проверка 4: Наличие pcre";
+	}
+	else if (test_name == "test_3_flow_valid")
+	{
+		human_name = "Проверка 5: Наличие flow с направлением";
+	}
+	else if (test_name == "test_3_sid_valid")
+	{
+		human_name = "Проверка 6: Уникальные sid и наличие rev";
+	}
 	else if (test_name == "test_1_input")
 	{
 		human_name = "Входные данные для теста 1";
@@ -232,6 +256,10 @@ QString TestResultWidget::resolveTestName(const QString& test_name)
 	{
 		human_name = "Входные данные для теста 2";
 	}
+	else if (test_name == "test_3_input")
+	{
+		human_name = "Входные данные для теста 3";
+	}
 	else
 	{
 		human_name = test_name;
@@ -0,0 +1,353 @@
+#include "test_three_widget.hpp"
+
+#include "rule_parser.hpp"
+#include "settings_manager.hpp"
+#include "spdlog_wrapper.hpp"
+
+#include <QGridLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QSet>
+#include <QStringList>
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextEdit>
+
+#include <algorithm>
+
+namespace APP
+{
+namespace
+{
+	constexpr int k_min_rules	 = 3;
+	constexpr int k_errors_shown = 3;
+	constexpr int k_checks_total = 6;
+
+	using RuleErrorCode = UTILS::RuleError::Code;
+	using OptionKind	= UTILS::RuleOption::Kind;
+
+	QString errorText(RuleErrorCode code)
+	{
+		switch (code)
+		{
+			case RuleErrorCode::None:
+				return "нет ошибки";
+			case RuleErrorCode::EmptyRule:
+				return "пустое правило";
+			case RuleErrorCode::UnknownAction:
+				return "неизвестное действие, ожидается alert, drop, pass или reject";
+			case RuleErrorCode::MissingProtocol:
+				return "не указан протокол";
+			case RuleErrorCode::UnknownProtocol:
+				return "неизвестный протокол";
+			case RuleErrorCode::MissingAddress:
+				return "не указан адрес";
+			case RuleErrorCode::InvalidAddress:
+				return "некорректный адрес";
+			case RuleErrorCode::MissingPort:
+				return "не указан порт";
+			case RuleErrorCode::InvalidPort:
+				return "некорректный порт";
+			case RuleErrorCode::UnbalancedList:
+				return "не закрыта квадратная скобка";
+			case RuleErrorCode::InvalidDirection:
+				return "направление должно быть -> или <>";
+			case RuleErrorCode::MissingOptions:
+				return "нет списка опций в круглых скобках";
+			case RuleErrorCode::UnterminatedOptions:
+				return "список опций не закрыт скобкой";
+			case RuleErrorCode::MissingSemicolon:
+				return "опция должна заканчиваться точкой с запятой";
+			case RuleErrorCode::InvalidOptionName:
+				return "некорректное имя опции";
+			case RuleErrorCode::MissingValue:
+				return "опции нужно значение";
+			case RuleErrorCode::UnexpectedValue:
+				return "опция не принимает значение";
+			case RuleErrorCode::UnterminatedString:
+				return "значение должно быть строкой в кавычках";
+			case RuleErrorCode::InvalidContent:
+				return "некорректный content";
+			case RuleErrorCode::InvalidPcre:
+				return "некорректный pcre, ожидается \"/выражение/флаги\"";
+			case RuleErrorCode::InvalidFlow:
+				return "неизвестное ключевое слово flow";
+			case RuleErrorCode::ConflictingFlow:
+				return "взаимоисключающие ключевые слова flow";
+			case RuleErrorCode::InvalidNumber:
+				return "некорректное число";
+			case RuleErrorCode::ModifierWithoutContent:
+				return "модификатор без предшествующего content";
+			case RuleErrorCode::DuplicateOption:
+				return "опция указана дважды";
+			case RuleErrorCode::MissingSid:
+				return "у правила нет sid";
+			case RuleErrorCode::TrailingText:
+				return "лишний текст после списка опций";
+			case RuleErrorCode::TooComplex:
+				return "слишком большой список адресов или портов";
+		}
+		return "неизвестная ошибка";
+	}
+
+	/**
+	 * The parser counts UTF-8 bytes, the editor UTF-16 code units.
+	 */
+	int editorColumn(const std::string &line, uint32_t offset)
+	{
+		return QString::fromUtf8(line.data(), static_cast<qsizetype>(std::min<std::size_t>(offset, line.size()))).size();
+	}
+} // namespace
+
+TestThreeWidget::TestThreeWidget(QWidget *parent) :
+	QWidget(parent),
+	m_is_validated(false),
+	m_invalid_count(0),
+	m_rule_count(0),
+	m_result_map({{"test_3_syntax_valid", false},
+				  {"test_3_header_valid", false},
+				  {"test_3_content_valid", false},
+				  {"test_3_pcre_valid", false},
+				  {"test_3_flow_valid", false},
+				  {"test_3_sid_valid", false}})
+{
+	initialize();
+}
+
+TestThreeWidget::~TestThreeWidget()
+{}
+
+void TestThreeWidget::initialize()
+{
+	setupUi();
+	setupStyle();
+	setupConnections();
+	updateStatus();
+}
+
+void TestThreeWidget::setupUi()
+{
+	m_main_layout = new QGridLayout(this);
+
+	m_title_label	  = new QLabel(this);
+	m_subtitle_label  = new QLabel(this);
+	m_status_label	  = new QLabel(this);
+	m_input_text_edit = new QTextEdit(this);
+	m_check_button	  = new QPushButton(this);
+
+	m_input_text_edit->setEnabled(true);
+	m_input_text_edit->setReadOnly(false);
+	m_input_text_edit->setAcceptRichText(false);
+	m_input_text_edit->setLineWrapMode(QTextEdit::NoWrap);
+	m_input_text_edit->setFocus();
+	m_input_text_edit->raise();
+	m_input_text_edit->setPlaceholderText(
+		"alert tcp $HOME_NET any -> $EXTERNAL_NET 80 (msg:\"example\"; content:\"GET\"; sid:1000001; rev:1;)");
+	m_input_text_edit->setTabStopDistance(4);
+
+	m_status_label->setWordWrap(true);
+	m_status_label->setTextFormat(Qt::PlainText);
+
+	m_title_label->setText("Тест 3: Написание сигнатур");
+	m_subtitle_label->setText("Для выданной схемы написать не менее 3х правил Suricata, по одному на строку. Задействовать "
+							  "адреса или порты схемы, content с модификатором, pcre и flow с направлением, у каждого "
+							  "правила должны быть свой sid и rev.\nПосле нажатия кнопки \"Проверить\" пути назад не "
+							  "будет.");
+	m_subtitle_label->setWordWrap(true);
+	m_check_button->setText("Проверить");
+
+	m_main_layout->addWidget(m_title_label, 0, 0);
+	m_main_layout->addWidget(m_subtitle_label, 1, 0);
+	m_main_layout->addWidget(m_input_text_edit, 2, 0);
+	m_main_layout->addWidget(m_status_label, 3, 0);
+	m_main_layout->addWidget(m_check_button, 4, 0);
+
+	setLayout(m_main_layout);
+}
+
+void TestThreeWidget::setupStyle()
+{
+	m_title_label->setStyleSheet("font-weight: bold; font-size: 16px;");
+	m_subtitle_label->setStyleSheet("font-size: 14px;");
+	m_status_label->setStyleSheet("font-size: 13px;");
+
+	QFont font("Monospace");
+	font.setStyleHint(QFont::TypeWriter);
+	m_input_text_edit->setFont(font);
+}
+
+void TestThreeWidget::setupConnections()
+{
+	connect(m_input_text_edit, &QTextEdit::textChanged, this, &TestThreeWidget::onInputChanged);
+	connect(m_check_button, &QPushButton::clicked, this, &TestThreeWidget::onCheckButtonClicked);
+}
+
+bool TestThreeWidget::validateInput()
+{
+	for (auto it = m_result_map.begin(); it != m_result_map.end(); ++it)
+	{
+		it.value() = false;
+	}
+	m_invalid_count = 0;
+	m_rule_count	= 0;
+	m_errors.clear();
+	m_error_selections.clear();
+
+	QTextCharFormat error_format;
+	error_format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+	error_format.setUnderlineColor(Qt::red);
+
+	QSet<quint32> sids;
+	bool		  all_revs = true;
+
+	// One buffer and one rule for all lines, the parser reuses their storage
+	UTILS::Rule		 rule;
+	UTILS::RuleError error;
+	std::string		 line;
+
+	const QTextDocument *document = m_input_text_edit->document();
+	for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+	{
+		const QString trimmed_line = block.text().trimmed();
+		if (trimmed_line.isEmpty() || trimmed_line.startsWith("#"))
+		{
+			continue;
+		}
+
+		line = block.text().toStdString();
+
+		// Unique within the submission, Suricata refuses to load duplicates
+		const bool duplicate_sid = UTILS::RuleParser::parse(line, rule, error) && sids.contains(rule.sid);
+		if (duplicate_sid)
+		{
+			error.code = RuleErrorCode::DuplicateOption;
+			error.span = rule.find(OptionKind::Sid)->value;
+		}
+
+		if (error.code != RuleErrorCode::None)
+		{
+			m_invalid_count += 1;
+
+			const int column = editorColumn(line, error.span.offset);
+			const int length = std::max(1, editorColumn(line, error.span.offset + error.span.length) - column);
+
+			// Zero length spans sit at the end of the line, underline its last character instead
+			const int line_end = block.position() + block.length() - 1;
+			const int begin	   = std::min(block.position() + column, std::max(block.position(), line_end - 1));
+
+			QTextEdit::ExtraSelection selection;
+			selection.format = error_format;
+			selection.cursor = QTextCursor(block);
+			selection.cursor.setPosition(begin);
+			selection.cursor.setPosition(std::min(begin + length, line_end), QTextCursor::KeepAnchor);
+			m_error_selections.append(selection);
+
+			m_errors.append(QString("Строка %1, позиция %2: %3")
+								.arg(block.blockNumber() + 1)
+								.arg(column + 1)
+								.arg(duplicate_sid ? QString("sid %1 уже используется").arg(rule.sid)
+												   : errorText(error.code)));
+			continue;
+		}
+
+		m_rule_count += 1;
+		sids.insert(rule.sid);
+		all_revs = all_revs && rule.find(OptionKind::Rev);
+
+		const bool any_header = rule.terms[rule.source].kind == UTILS::RuleTerm::Kind::Any &&
+								rule.terms[rule.source_port].kind == UTILS::RuleTerm::Kind::Any &&
+								rule.terms[rule.destination].kind == UTILS::RuleTerm::Kind::Any &&
+								rule.terms[rule.destination_port].kind == UTILS::RuleTerm::Kind::Any;
+		if (!any_header)
+		{
+			m_result_map["test_3_header_valid"] = true;
+		}
+
+		for (const UTILS::RuleOption &option : rule.options)
+		{
+			if (option.kind == OptionKind::Nocase || option.kind == OptionKind::Offset || option.kind == OptionKind::Depth ||
+				option.kind == OptionKind::Distance || option.kind == OptionKind::Within)
+			{
+				m_result_map["test_3_content_valid"] = true;
+			}
+			else if (option.kind == OptionKind::Pcre)
+			{
+				m_result_map["test_3_pcre_valid"] = true;
+			}
+			else if (option.kind == OptionKind::Flow &&
+					 (option.flags & (UTILS::RuleOption::FlowToServer | UTILS::RuleOption::FlowToClient)))
+			{
+				m_result_map["test_3_flow_valid"] = true;
+			}
+		}
+	}
+
+	m_result_map["test_3_syntax_valid"] = m_invalid_count == 0 && m_rule_count >= k_min_rules;
+	m_result_map["test_3_sid_valid"]	= m_invalid_count == 0 && m_rule_count > 0 && all_revs;
+
+	m_input_text_edit->setExtraSelections(m_error_selections);
+	return true;
+}
+
+void TestThreeWidget::updateStatus()
+{
+	int passed = 0;
+	for (auto it = m_result_map.begin(); it != m_result_map.end(); ++it)
+	{
+		passed += it.value() ? 1 : 0;
+	}
+
+	QStringList status;
+	status.append(QString("Правил: %1, с ошибками: %2, выполнено требований: %3/%4")
+					  .arg(m_rule_count)
+					  .arg(m_invalid_count)
+					  .arg(passed)
+					  .arg(k_checks_total));
+	status.append(m_errors.mid(0, k_errors_shown));
+	if (m_errors.size() > k_errors_shown)
+	{
+		status.append(QString("и ещё %1").arg(m_errors.size() - k_errors_shown));
+	}
+
+	m_status_label->setText(status.join('\n'));
+	m_status_label->setStyleSheet(m_errors.isEmpty() ? "font-size: 13px;" : "font-size: 13px; color: #E57373;");
+}
+
+void TestThreeWidget::onInputChanged()
+{
+	if (m_is_validated)
+	{
+		return;
+	}
+
+	validateInput();
+	updateStatus();
+}
+
+void TestThreeWidget::onCheckButtonClicked()
+{
+	if (!m_is_validated)
+	{
+		if (validateInput())
+		{
+			updateStatus();
+			for (const QString &error : m_errors)
+			{
+				SPD_WARN_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Invalid rule: " + error);
+			}
+
+			m_is_validated = true;
+			m_check_button->setText("Перейти к результатам");
+			m_input_text_edit->setEnabled(false);
+			SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Validation passed successfully.");
+		}
+	}
+	else
+	{
+		SPD_INFO_CLASS(UTILS::DEFAULTS::d_settings_group_application, "Test three passed.");
+		emit testResult(m_result_map, m_input_text_edit->toPlainText(), m_invalid_count);
+	}
+}
+} // namespace APP
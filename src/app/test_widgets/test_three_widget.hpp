@@ -0,0 +1,60 @@
+#ifndef TEST_THREE_WIDGET_HPP
+#define TEST_THREE_WIDGET_HPP
+
+#include <QPushButton>
+#include <QStringList>
+#include <QTextEdit>
+#include <QWidget>
+
+class QGridLayout;
+class QLabel;
+
+namespace APP
+{
+/**
+ * @brief Signature writing test, rules are parsed and graded while typing.
+ */
+class TestThreeWidget : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit TestThreeWidget(QWidget *parent = nullptr);
+	~TestThreeWidget();
+
+signals:
+	void testResult(QMap<QString, bool> result, const QString &user_input, int invalid_count);
+
+private:
+	void initialize();
+	void setupUi();
+	void setupStyle();
+	void setupConnections();
+	bool validateInput();
+	void updateStatus();
+
+private slots:
+	void onInputChanged();
+	void onCheckButtonClicked();
+
+private:
+	QGridLayout *m_main_layout;
+
+	QLabel *m_title_label;
+	QLabel *m_subtitle_label;
+	QLabel *m_status_label;
+
+	QTextEdit	*m_input_text_edit;
+	QPushButton *m_check_button;
+
+	bool m_is_validated;
+	int	 m_invalid_count;
+	int	 m_rule_count;
+
+	QStringList						 m_errors;
+	QList<QTextEdit::ExtraSelection> m_error_selections;
+	QMap<QString, bool>				 m_result_map;
+};
+} // namespace APP
+
+#endif // TEST_THREE_WIDGET_HPP
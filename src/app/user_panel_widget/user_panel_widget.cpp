@@ -5,6 +5,7 @@
 #include "test_introduction_widget.hpp"
 #include "test_one_widget.hpp"
 #include "test_result_widget.hpp"
+#include "test_three_widget.hpp"
 #include "test_two_widget.hpp"
 
 #include <QLabel>
@@ -91,12 +92,15 @@ void UserPanelWidget::setupUi()
 									  this->resolveScreenWidget(PanelType::TEST_ONE)};
 	ScreenInfo test_two_screen	   = {PanelType::TEST_TWO, this->resolveScreenText(PanelType::TEST_TWO),
 									  this->resolveScreenWidget(PanelType::TEST_TWO)};
+	ScreenInfo test_three_screen   = {PanelType::TEST_THREE, this->resolveScreenText(PanelType::TEST_THREE),
+									  this->resolveScreenWidget(PanelType::TEST_THREE)};
 	ScreenInfo test_result_screen  = {PanelType::TEST_RESULT, this->resolveScreenText(PanelType::TEST_RESULT),
 									  this->resolveScreenWidget(PanelType::TEST_RESULT)};
 
 	this->addScreen(introduction_screen);
 	this->addScreen(test_one_screen);
 	this->addScreen(test_two_screen);
+	this->addScreen(test_three_screen);
 	this->addScreen(test_result_screen);
 
 	// switchScreen(
@@ -156,6 +160,22 @@ QWidget *UserPanelWidget::resolveScreenWidget(PanelType type)
 						m_result_input_map.insert("test_2_input", user_input);
 						m_result_invalid_map.insert("test_2_input", invalid_count);
 
+						switchScreen(PanelType::TEST_THREE);
+					});
+			return std::move(widget);
+		}
+		case PanelType::TEST_THREE: {
+			TestThreeWidget *widget = new TestThreeWidget();
+			connect(widget, &TestThreeWidget::testResult, this,
+					[this](QMap<QString, bool> result, const QString &user_input, int invalid_count) {
+						for (auto it = result.begin(); it != result.end(); ++it)
+						{
+							m_result_map.insert(it.key(), it.value());
+						}
+
+						m_result_input_map.insert("test_3_input", user_input);
+						m_result_invalid_map.insert("test_3_input", invalid_count);
+
 						emit testFinished();
 
 						switchScreen(PanelType::TEST_RESULT);
@@ -13,6 +13,7 @@ enum class PanelType : quint32
 	TEST_INTRODUCTION,
 	TEST_ONE,
 	TEST_TWO,
+	TEST_THREE,
 	TEST_RESULT,
 	COUNT
 };
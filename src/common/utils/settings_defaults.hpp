@@ -46,12 +46,20 @@ namespace DEFAULTS
 	constexpr auto d_settings_setting_window_rect	   = "window_rect";
 	constexpr auto d_settings_setting_translation_lang = "translation_lang";
 	constexpr auto d_settings_setting_last_open_panel  = "last_open_panel";
+	constexpr auto d_settings_setting_capture_ifaces   = "capture_interfaces";
+	constexpr auto d_settings_setting_validation_mode  = "validation_mode";
+	constexpr auto d_settings_setting_offline_capture  = "offline_capture";
+	constexpr auto d_settings_setting_offline_scenario = "offline_scenario";
+	constexpr auto d_settings_setting_offline_alerts   = "offline_expected_alerts";
+	constexpr auto d_settings_setting_expected_sids	   = "expected_sids";
+	constexpr auto d_settings_setting_rule_profiling   = "rule_profiling";
 
 	constexpr auto d_application_default_panel = APP::PanelType::TEST_INTRODUCTION;
 
 	constexpr auto d_logger_name				= "global_logger";
 	constexpr auto d_logger_settings_manager	= "settings";
 	constexpr auto d_logger_translation_manager = "language";
+	constexpr auto d_logger_file_watcher		= "watcher";
 
 	constexpr auto d_translator_base_name	= "lang_";
 	constexpr auto d_translator_base_dir	= ":/i18n/";
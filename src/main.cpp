@@ -1,9 +1,11 @@
+#include "grading_command.hpp"
 #include "main_window.hpp"
 #include "settings_manager.hpp"
 #include "spdlog_wrapper.hpp"
 #include "translation_manager.hpp"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QDirIterator>
 
 int main(int argc, char *argv[])
@@ -13,6 +15,16 @@ int main(int argc, char *argv[])
 	UTILS::SettingsManager::instance();
 	UTILS::TranslationManager::instance();
 
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	APP::GradingCommand grading(parser);
+	parser.process(app);
+
+	if (grading.isRequested())
+	{
+		return grading.run();
+	}
+
 	spdlog::info(QObject::tr("application_init_message"));
 
 	app.setQuitOnLastWindowClosed(true);
@@ -0,0 +1,432 @@
+#include "batch_grader.hpp"
+
+#include "eve_parser.hpp"
+#include "fast_log_parser.hpp"
+#include "line_tailer.hpp"
+#include "process_pool.hpp"
+#include "rule_evaluator.hpp"
+#include "suricata_config.hpp"
+#include "suricata_diagnostic.hpp"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr const char *k_tmpfs_directory = "/dev/shm";
+
+	QString logRoot()
+	{
+		// Logs are written and read once, keep them off the disk when possible
+		const QFileInfo tmpfs(k_tmpfs_directory);
+		const QString	directory = tmpfs.isDir() && tmpfs.isWritable() ? tmpfs.filePath() : QDir::tempPath();
+		return QDir(directory).filePath("suricata_grader_XXXXXX");
+	}
+
+	QList<quint32> sortedSids(const QSet<quint32> &sids)
+	{
+		QList<quint32> sorted = sids.values();
+		std::sort(sorted.begin(), sorted.end());
+		return sorted;
+	}
+
+	QString joinSids(const QList<quint32> &sids)
+	{
+		QStringList parts;
+		for (const quint32 sid : sids)
+		{
+			parts.append(QString::number(sid));
+		}
+		return parts.join(", ");
+	}
+
+	void compareSids(const QSet<quint32> &observed, const QSet<quint32> &expected, BatchGrader::Result &result)
+	{
+		result.matched	  = sortedSids(observed & expected);
+		result.missing	  = sortedSids(expected - observed);
+		result.unexpected = sortedSids(observed - expected);
+	}
+
+	void evaluateSubmission(const BatchGrader::Submission &submission, const std::string &capture_path,
+							const QSet<quint32> &expected, BatchGrader::Result &result)
+	{
+		QElapsedTimer timer;
+		timer.start();
+		result.started = true;
+
+		RuleEvaluator evaluator;
+		if (!evaluator.loadFile(QFile::encodeName(submission.rules_path).toStdString()))
+		{
+			const QString reason = QString::fromLocal8Bit(std::strerror(evaluator.error()));
+			result.error		 = QString("Unable to read %1: %2").arg(submission.rules_path, reason);
+			return;
+		}
+		evaluator.compile();
+
+		if (!evaluator.evaluateFile(capture_path))
+		{
+			const QString reason = QString::fromLocal8Bit(std::strerror(evaluator.error()));
+			result.error		 = QString("Unable to read the capture: %1").arg(reason);
+			return;
+		}
+
+		QSet<quint32> observed;
+		for (const uint32_t sid : evaluator.alertedSids())
+		{
+			observed.insert(sid);
+		}
+
+		const RuleEvaluator::Statistics &statistics = evaluator.statistics();
+		result.completed							= true;
+		result.exit_code							= 0;
+		result.alert_count							= static_cast<int>(statistics.alerts);
+		result.error_count							= static_cast<int>(statistics.rejected);
+		result.elapsed_ms							= timer.elapsed();
+		compareSids(observed, expected, result);
+
+		if (statistics.rejected != 0)
+		{
+			result.error = QString("%1 rules could not be parsed").arg(statistics.rejected);
+		}
+		else if (statistics.approximated != 0)
+		{
+			result.error = QString("%1 rules evaluated without pcre or other options").arg(statistics.approximated);
+		}
+	}
+
+	void readAlerts(const QString &log_path, bool eve, QSet<quint32> &observed, int &alert_count)
+	{
+		LineTailer tailer(QFile::encodeName(log_path).toStdString());
+		tailer.poll([&](std::string_view line) {
+			if (eve)
+			{
+				EveEvent event;
+				if (EveParser::parse(line, event) && event.isAlert())
+				{
+					alert_count++;
+					observed.insert(event.signature_id);
+				}
+				return;
+			}
+
+			FastLogAlert alert;
+			if (FastLogAlert::parse(line, alert))
+			{
+				alert_count++;
+				observed.insert(alert.sid);
+			}
+		});
+	}
+} // namespace
+
+bool BatchGrader::Result::passed() const
+{
+	return completed && missing.isEmpty() && unexpected.isEmpty();
+}
+
+BatchGrader::BatchGrader(const QString &suricata_path, const QString &config_path) :
+	m_engine(Engine::Suricata),
+	m_suricata_path(suricata_path),
+	m_config_path(config_path),
+	m_parallelism(0),
+	m_cpu_pinning(true)
+{}
+
+void BatchGrader::setEngine(Engine engine)
+{
+	m_engine = engine;
+}
+
+void BatchGrader::setCapture(const QString &capture_path)
+{
+	m_capture_path = capture_path;
+}
+
+void BatchGrader::setExpectedSids(const QList<quint32> &sids)
+{
+	m_expected_sids = QSet<quint32>(sids.begin(), sids.end());
+}
+
+void BatchGrader::setParallelism(int parallelism)
+{
+	m_parallelism = parallelism;
+}
+
+void BatchGrader::setCpuPinning(bool enabled)
+{
+	m_cpu_pinning = enabled;
+}
+
+void BatchGrader::setOverrides(const QStringList &overrides)
+{
+	m_overrides = overrides;
+}
+
+void BatchGrader::setResultHandler(const ResultHandler &on_result)
+{
+	m_on_result = on_result;
+}
+
+QList<BatchGrader::Result> BatchGrader::run(const QList<Submission> &submissions)
+{
+	QList<Result> results;
+	for (const Submission &submission : submissions)
+	{
+		Result result;
+		result.name = submission.name;
+		results.append(result);
+	}
+
+	const auto fail = [&results](const QString &error) {
+		for (Result &result : results)
+		{
+			result.error = error;
+		}
+		return results;
+	};
+
+	if (submissions.isEmpty())
+	{
+		return results;
+	}
+
+	if (!QFileInfo(m_capture_path).isFile())
+	{
+		return fail(QString("Capture not found: %1").arg(m_capture_path));
+	}
+
+	if (m_engine == Engine::Builtin)
+	{
+		return runBuiltin(submissions, results);
+	}
+
+	SuricataConfig config;
+	if (!SuricataConfigParser::parseFile(QFile::encodeName(m_config_path).toStdString(), config))
+	{
+		return fail(QString("Unable to read %1").arg(m_config_path));
+	}
+
+	const SuricataConfig::LogOutput *output = config.alertOutput();
+	if (output == nullptr)
+	{
+		return fail(QString("Neither fast nor eve alert log is enabled in %1").arg(m_config_path));
+	}
+
+	QTemporaryDir log_root(logRoot());
+	if (!log_root.isValid())
+	{
+		return fail(QString("Unable to create log directory: %1").arg(log_root.errorString()));
+	}
+
+	// An absolute filename in the config would make every instance write the same file
+	const bool	  eve		   = output == &config.eve;
+	const QString output_key   = QString("outputs.%1.%2").arg(output->index).arg(eve ? "eve-log" : "fast");
+	QString		  log_filename = QFileInfo(QString::fromStdString(output->filename)).fileName();
+	if (log_filename.isEmpty())
+	{
+		log_filename = eve ? "eve.json" : "fast.log";
+	}
+
+	QStringList overrides;
+	overrides << QString("%1.enabled=yes").arg(output_key) << QString("%1.filename=%2").arg(output_key, log_filename)
+			  << "unix-command.enabled=no";
+	overrides += m_overrides;
+
+	QList<ProcessPool::Job> jobs;
+	QStringList				log_dirs;
+	for (int i = 0; i < submissions.size(); ++i)
+	{
+		const QString log_dir = log_root.filePath(QString::number(i));
+		QDir().mkpath(log_dir);
+
+		QStringList arguments;
+		arguments << "-c" << m_config_path << "-r" << m_capture_path << "-S" << submissions[i].rules_path << "-l"
+				  << log_dir << "-k" << "none" << "--runmode" << "single";
+		for (const QString &override : overrides)
+		{
+			arguments << "--set" << override;
+		}
+
+		jobs.append({m_suricata_path, arguments});
+		log_dirs.append(log_dir);
+	}
+
+	// Single threaded instances, one per CPU unless told otherwise
+	const QVector<int> cpus		   = m_cpu_pinning ? ProcessPool::availableCpus() : QVector<int>();
+	int				   parallelism = m_parallelism;
+	if (parallelism <= 0)
+	{
+		parallelism = cpus.isEmpty() ? QThread::idealThreadCount() : cpus.size();
+	}
+
+	ProcessPool pool(std::min(parallelism, static_cast<int>(jobs.size())));
+	pool.setCpuAffinity(cpus);
+
+	pool.setStandardErrorHandler([&](int index, const QByteArray &line) {
+		SuricataDiagnostic diagnostic;
+		if (!SuricataDiagnostics::classify(std::string_view(line.constData(), line.size()), diagnostic) ||
+			diagnostic.severity == SuricataDiagnostic::Severity::Info ||
+			diagnostic.severity == SuricataDiagnostic::Severity::Warning)
+		{
+			return;
+		}
+
+		Result &result	    = results[index];
+		result.error_count += 1;
+		if (result.error.isEmpty())
+		{
+			const QString location = QString::fromStdString(diagnostic.location());
+			const QString message  = QString::fromStdString(diagnostic.message);
+			result.error		   = location.isEmpty() ? message : QString("%1: %2").arg(location, message);
+		}
+	});
+
+	int finished = 0;
+	pool.run(jobs, [&](const ProcessPool::Result &job) {
+		Result &result	  = results[job.index];
+		result.started	  = job.started;
+		result.exit_code  = job.exit_code;
+		result.elapsed_ms = job.elapsed_ms;
+		result.cpu		  = job.cpu;
+
+		if (!job.started)
+		{
+			result.error = QString("Unable to start %1").arg(m_suricata_path);
+		}
+		else if (job.exit_status != QProcess::NormalExit)
+		{
+			result.error = QString("Suricata crashed");
+		}
+		else if (job.exit_code != 0)
+		{
+			if (result.error.isEmpty())
+			{
+				result.error = QString("Suricata exited with code %1").arg(job.exit_code);
+			}
+		}
+		else
+		{
+			QSet<quint32> observed;
+			readAlerts(QDir(log_dirs[job.index]).filePath(log_filename), eve, observed, result.alert_count);
+
+			result.completed = true;
+			compareSids(observed, m_expected_sids, result);
+		}
+
+		// Free the tmpfs pages right away, a large batch would otherwise hold every log until the end
+		QDir(log_dirs[job.index]).removeRecursively();
+
+		finished += 1;
+		if (m_on_result)
+		{
+			m_on_result(result, finished, results.size());
+		}
+	});
+
+	return results;
+}
+
+QList<BatchGrader::Result> BatchGrader::runBuiltin(const QList<Submission> &submissions, QList<Result> results) const
+{
+	const std::string capture_path = QFile::encodeName(m_capture_path).toStdString();
+
+	QThreadPool pool;
+	pool.setMaxThreadCount(m_parallelism > 0 ? m_parallelism : QThread::idealThreadCount());
+
+	// Every worker writes only its own element, the vector is never resized meanwhile
+	std::vector<Result> evaluated(results.begin(), results.end());
+
+	QList<QFuture<void>> futures;
+	for (int i = 0; i < submissions.size(); ++i)
+	{
+		futures.append(QtConcurrent::run(&pool, [this, &submissions, &capture_path, &evaluated, i]() {
+			evaluateSubmission(submissions[i], capture_path, m_expected_sids, evaluated[i]);
+		}));
+	}
+
+	// Reported in submission order, a slow submission holds back the ones after it
+	for (int i = 0; i < futures.size(); ++i)
+	{
+		futures[i].waitForFinished();
+		results[i] = evaluated[i];
+		if (m_on_result)
+		{
+			m_on_result(results[i], i + 1, results.size());
+		}
+	}
+
+	return results;
+}
+
+QList<BatchGrader::Submission> BatchGrader::collectSubmissions(const QString &directory)
+{
+	QList<Submission> submissions;
+	for (const QFileInfo &file : QDir(directory).entryInfoList({"*.rules"}, QDir::Files, QDir::Name))
+	{
+		submissions.append({file.completeBaseName(), file.absoluteFilePath()});
+	}
+	return submissions;
+}
+
+QString BatchGrader::formatTable(const QList<Result> &results)
+{
+	QList<QStringList> rows;
+	rows.append({"Submission", "Result", "Alerts", "Matched", "Missing", "Unexpected", "Errors", "Time, ms", "CPU", "Note"});
+
+	for (const Result &result : results)
+	{
+		const int expected = result.matched.size() + result.missing.size();
+		rows.append({result.name, result.passed() ? "pass" : (result.completed ? "fail" : "error"),
+					 QString::number(result.alert_count), QString("%1/%2").arg(result.matched.size()).arg(expected),
+					 QString::number(result.missing.size()), QString::number(result.unexpected.size()),
+					 QString::number(result.error_count), QString::number(result.elapsed_ms),
+					 result.cpu >= 0 ? QString::number(result.cpu) : QString("-"), result.error});
+	}
+
+	QVector<int> widths(rows.first().size(), 0);
+	for (const QStringList &row : rows)
+	{
+		for (int column = 0; column < row.size(); ++column)
+		{
+			widths[column] = std::max(widths[column], static_cast<int>(row[column].size()));
+		}
+	}
+
+	QStringList lines;
+	for (const QStringList &row : rows)
+	{
+		QString line;
+		for (int column = 0; column < row.size(); ++column)
+		{
+			line += column + 1 < row.size() ? row[column].leftJustified(widths[column] + 2) : row[column];
+		}
+		lines.append(line.trimmed());
+	}
+
+	for (const Result &result : results)
+	{
+		if (!result.missing.isEmpty())
+		{
+			lines.append(QString("%1: missing %2").arg(result.name, joinSids(result.missing)));
+		}
+		if (!result.unexpected.isEmpty())
+		{
+			lines.append(QString("%1: unexpected %2").arg(result.name, joinSids(result.unexpected)));
+		}
+	}
+
+	return lines.join('\n') + '\n';
+}
+} // namespace UTILS
@@ -0,0 +1,114 @@
+#ifndef BATCH_GRADER_HPP
+#define BATCH_GRADER_HPP
+
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+namespace UTILS
+{
+/**
+ * @brief Grades rule files by replaying a reference capture through real
+ *        Suricata instances and comparing the alerts to the expected SIDs.
+ *
+ * Every submission runs as `suricata -c config -r capture -S rules -l dir`
+ * on a ProcessPool, one single threaded instance per CPU, each pinned to its
+ * own core. The shared suricata.yaml is never copied: the alert output is
+ * redirected into the per-submission log directory with `--set`, the
+ * directories live on tmpfs (/dev/shm) when it is available and are removed
+ * as soon as the alerts have been read.
+ *
+ * The binary and the config are usually the ones SuricataValidatorWidget
+ * discovered. run() blocks on a local event loop, see ProcessPool.
+ *
+ * With the builtin engine no Suricata is started: every submission is
+ * evaluated in process by a RuleEvaluator on a thread of its own, which
+ * grades a class in well under a second at the cost of the approximations
+ * RuleEvaluator documents.
+ */
+class BatchGrader
+{
+public:
+	struct Submission
+	{
+		QString name;
+		QString rules_path;
+	};
+
+	struct Result
+	{
+		QString		   name;
+		bool		   started	   = false;
+		bool		   completed   = false; // Suricata exited cleanly and its alert log was read
+		int			   exit_code   = -1;
+		qint64		   elapsed_ms  = 0;
+		int			   cpu		   = -1;
+		int			   alert_count = 0;
+		int			   error_count = 0; // error messages Suricata printed, mostly rules it could not load
+		QList<quint32> matched;
+		QList<quint32> missing;
+		QList<quint32> unexpected;
+		QString		   error; // why it did not complete, or the first error message when it did
+
+		bool passed() const;
+	};
+
+	using ResultHandler = std::function<void(const Result &result, int finished, int total)>;
+
+	enum class Engine
+	{
+		Suricata,
+		Builtin // RuleEvaluator, the binary and the config are not used
+	};
+
+public:
+	BatchGrader(const QString &suricata_path, const QString &config_path);
+
+	void setEngine(Engine engine);
+	void setCapture(const QString &capture_path);
+	void setExpectedSids(const QList<quint32> &sids);
+	void setParallelism(int parallelism);
+	void setCpuPinning(bool enabled);
+
+	/**
+	 * Extra `--set name=value` overrides, applied after the grader's own.
+	 */
+	void setOverrides(const QStringList &overrides);
+	void setResultHandler(const ResultHandler &on_result);
+
+	/**
+	 * Results come back in submission order. When the config or the capture
+	 * is unusable every result carries the reason and nothing is started.
+	 */
+	QList<Result> run(const QList<Submission> &submissions);
+
+	/**
+	 * One submission per *.rules file of the directory, named after the file.
+	 */
+	static QList<Submission> collectSubmissions(const QString &directory);
+
+	/**
+	 * Plain text table with one row per result followed by the SIDs that
+	 * were missing or unexpected.
+	 */
+	static QString formatTable(const QList<Result> &results);
+
+private:
+	QList<Result> runBuiltin(const QList<Submission> &submissions, QList<Result> results) const;
+
+private:
+	Engine		  m_engine;
+	QString		  m_suricata_path;
+	QString		  m_config_path;
+	QString		  m_capture_path;
+	QSet<quint32> m_expected_sids;
+	QStringList	  m_overrides;
+	int			  m_parallelism;
+	bool		  m_cpu_pinning;
+	ResultHandler m_on_result;
+};
+} // namespace UTILS
+
+#endif // BATCH_GRADER_HPP
@@ -0,0 +1,212 @@
+#include "byte_scanner.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BYTE_SCANNER_X86
+#include <immintrin.h>
+#endif
+
+namespace UTILS
+{
+namespace
+{
+	using FindEither   = const char *(*)(const char *, const char *, char, char);
+	using ClassifyJson = ByteScanner::JsonBlock (*)(const char *);
+
+	const char *findEitherScalar(const char *begin, const char *end, char first, char second)
+	{
+		for (; begin < end; ++begin)
+		{
+			if (*begin == first || *begin == second)
+			{
+				return begin;
+			}
+		}
+		return end;
+	}
+
+	ByteScanner::JsonBlock classifyJsonScalar(const char *block)
+	{
+		ByteScanner::JsonBlock masks = {0, 0, 0};
+
+		for (int i = 0; i < ByteScanner::d_block_size; ++i)
+		{
+			const uint64_t bit = uint64_t(1) << i;
+			switch (block[i])
+			{
+				case '"':
+					masks.quotes |= bit;
+					break;
+				case '\\':
+					masks.backslashes |= bit;
+					break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',':
+					masks.structurals |= bit;
+					break;
+				default:
+					break;
+			}
+		}
+		return masks;
+	}
+
+#ifdef BYTE_SCANNER_X86
+	__attribute__((target("sse2"))) const char *findEitherSse2(const char *begin, const char *end, char first,
+															   char second)
+	{
+		const __m128i first_mask  = _mm_set1_epi8(first);
+		const __m128i second_mask = _mm_set1_epi8(second);
+
+		for (; end - begin >= 16; begin += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+			const int	  mask	= _mm_movemask_epi8(
+				  _mm_or_si128(_mm_cmpeq_epi8(chunk, first_mask), _mm_cmpeq_epi8(chunk, second_mask)));
+			if (mask != 0)
+			{
+				return begin + __builtin_ctz(static_cast<unsigned>(mask));
+			}
+		}
+
+		return findEitherScalar(begin, end, first, second);
+	}
+
+	__attribute__((target("sse2"))) ByteScanner::JsonBlock classifyJsonSse2(const char *block)
+	{
+		const __m128i quote		= _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i colon		= _mm_set1_epi8(':');
+		const __m128i comma		= _mm_set1_epi8(',');
+		const __m128i lowercase = _mm_set1_epi8(0x20);
+		const __m128i brace		= _mm_set1_epi8('{'); // '[' | 0x20 == '{'
+		const __m128i close		= _mm_set1_epi8('}'); // ']' | 0x20 == '}'
+
+		ByteScanner::JsonBlock masks = {0, 0, 0};
+
+		for (int i = 0; i < ByteScanner::d_block_size; i += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+			const __m128i folded = _mm_or_si128(chunk, lowercase);
+			const __m128i structural =
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, brace), _mm_cmpeq_epi8(folded, close)),
+							 _mm_or_si128(_mm_cmpeq_epi8(chunk, colon), _mm_cmpeq_epi8(chunk, comma)));
+
+			masks.quotes	  |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << i;
+			masks.backslashes |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << i;
+			masks.structurals |= uint64_t(uint16_t(_mm_movemask_epi8(structural))) << i;
+		}
+		return masks;
+	}
+
+	__attribute__((target("avx2"))) const char *findEitherAvx2(const char *begin, const char *end, char first,
+																char second)
+	{
+		const __m256i first_mask  = _mm256_set1_epi8(first);
+		const __m256i second_mask = _mm256_set1_epi8(second);
+
+		for (; end - begin >= 32; begin += 32)
+		{
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+			const int	  mask	= _mm256_movemask_epi8(
+				  _mm256_or_si256(_mm256_cmpeq_epi8(chunk, first_mask), _mm256_cmpeq_epi8(chunk, second_mask)));
+			if (mask != 0)
+			{
+				return begin + __builtin_ctz(static_cast<unsigned>(mask));
+			}
+		}
+
+		// The tail stays in VEX encoded code, dropping into the legacy SSE version
+		// with dirty upper registers costs a state transition on every call
+		for (; begin < end; ++begin)
+		{
+			if (*begin == first || *begin == second)
+			{
+				return begin;
+			}
+		}
+		return end;
+	}
+
+	__attribute__((target("avx2"))) ByteScanner::JsonBlock classifyJsonAvx2(const char *block)
+	{
+		const __m256i quote		= _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i colon		= _mm256_set1_epi8(':');
+		const __m256i comma		= _mm256_set1_epi8(',');
+		const __m256i lowercase = _mm256_set1_epi8(0x20);
+		const __m256i brace		= _mm256_set1_epi8('{');
+		const __m256i close		= _mm256_set1_epi8('}');
+
+		ByteScanner::JsonBlock masks = {0, 0, 0};
+
+		for (int i = 0; i < ByteScanner::d_block_size; i += 32)
+		{
+			const __m256i chunk	 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+			const __m256i folded = _mm256_or_si256(chunk, lowercase);
+			const __m256i structural =
+				_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, brace), _mm256_cmpeq_epi8(folded, close)),
+								_mm256_or_si256(_mm256_cmpeq_epi8(chunk, colon), _mm256_cmpeq_epi8(chunk, comma)));
+
+			masks.quotes	  |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, quote)))) << i;
+			masks.backslashes |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash)))) << i;
+			masks.structurals |= uint64_t(uint32_t(_mm256_movemask_epi8(structural))) << i;
+		}
+		return masks;
+	}
+#endif
+
+	struct Implementation
+	{
+		FindEither	 find_either;
+		ClassifyJson classify_json;
+		const char	*name;
+	};
+
+	Implementation resolveImplementation()
+	{
+#ifdef BYTE_SCANNER_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return {findEitherAvx2, classifyJsonAvx2, "avx2"};
+		}
+		if (__builtin_cpu_supports("sse2"))
+		{
+			return {findEitherSse2, classifyJsonSse2, "sse2"};
+		}
+#endif
+		return {findEitherScalar, classifyJsonScalar, "scalar"};
+	}
+
+	// Function local so that callers running during static initialization see a resolved table
+	const Implementation &implementation()
+	{
+		static const Implementation resolved = resolveImplementation();
+		return resolved;
+	}
+} // namespace
+
+const char *ByteScanner::findByte(const char *begin, const char *end, char byte)
+{
+	return implementation().find_either(begin, end, byte, byte);
+}
+
+const char *ByteScanner::findEither(const char *begin, const char *end, char first, char second)
+{
+	return implementation().find_either(begin, end, first, second);
+}
+
+ByteScanner::JsonBlock ByteScanner::classifyJson(const char *block)
+{
+	return implementation().classify_json(block);
+}
+
+const char *ByteScanner::instructionSet()
+{
+	return implementation().name;
+}
+} // namespace UTILS
@@ -0,0 +1,40 @@
+#ifndef BYTE_SCANNER_HPP
+#define BYTE_SCANNER_HPP
+
+#include <cstdint>
+
+namespace UTILS
+{
+/**
+ * @brief Vectorized search for structural bytes in text buffers.
+ *
+ * The widest implementation the CPU supports (AVX2, SSE2 or scalar) is picked
+ * once at startup. Search functions return `end` when nothing is found.
+ */
+class ByteScanner
+{
+public:
+	/**
+	 * Bit i of each mask is set when byte i of a 64 byte block is a double
+	 * quote, a backslash, or one of `{}[]:,` respectively.
+	 */
+	struct JsonBlock
+	{
+		uint64_t quotes;
+		uint64_t backslashes;
+		uint64_t structurals;
+	};
+
+	static constexpr int d_block_size = 64;
+
+public:
+	static const char *findByte(const char *begin, const char *end, char byte);
+	static const char *findEither(const char *begin, const char *end, char first, char second);
+
+	static JsonBlock classifyJson(const char *block);
+
+	static const char *instructionSet();
+};
+} // namespace UTILS
+
+#endif // BYTE_SCANNER_HPP
@@ -0,0 +1,226 @@
+#include "content_hash.hpp"
+
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <sys/mman.h>
+#include <thread>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint64_t k_prime_1 = 11400714785074694791ULL;
+	constexpr uint64_t k_prime_2 = 14029467366897019727ULL;
+	constexpr uint64_t k_prime_3 = 1609587929392839161ULL;
+	constexpr uint64_t k_prime_4 = 9650029242287828579ULL;
+	constexpr uint64_t k_prime_5 = 2870177450012600261ULL;
+
+	constexpr std::size_t k_stripe_size = 32;
+
+	inline uint64_t rotateLeft(uint64_t value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	// Little endian loads, memcpy keeps unaligned reads well defined
+	inline uint64_t read64(const uint8_t *data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t read32(const uint8_t *data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t round(uint64_t accumulator, uint64_t input)
+	{
+		accumulator += input * k_prime_2;
+		accumulator	 = rotateLeft(accumulator, 31);
+		return accumulator * k_prime_1;
+	}
+
+	inline uint64_t mergeRound(uint64_t accumulator, uint64_t lane)
+	{
+		accumulator ^= round(0, lane);
+		return accumulator * k_prime_1 + k_prime_4;
+	}
+
+	inline const uint8_t *consumeStripes(uint64_t (&lanes)[4], const uint8_t *data, const uint8_t *end)
+	{
+		while (end - data >= static_cast<std::ptrdiff_t>(k_stripe_size))
+		{
+			lanes[0]  = round(lanes[0], read64(data));
+			lanes[1]  = round(lanes[1], read64(data + 8));
+			lanes[2]  = round(lanes[2], read64(data + 16));
+			lanes[3]  = round(lanes[3], read64(data + 24));
+			data	 += k_stripe_size;
+		}
+		return data;
+	}
+} // namespace
+
+Xxh64::Xxh64(uint64_t seed) :
+	m_seed(seed),
+	m_lanes{seed + k_prime_1 + k_prime_2, seed + k_prime_2, seed, seed - k_prime_1},
+	m_total(0),
+	m_buffer{},
+	m_buffered(0)
+{}
+
+void Xxh64::update(const void *data, std::size_t length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+
+	const uint8_t *input = static_cast<const uint8_t *>(data);
+	const uint8_t *end	 = input + length;
+	m_total				+= length;
+
+	if (m_buffered + length < k_stripe_size)
+	{
+		std::memcpy(m_buffer + m_buffered, input, length);
+		m_buffered += length;
+		return;
+	}
+
+	if (m_buffered > 0)
+	{
+		const std::size_t fill = k_stripe_size - m_buffered;
+		std::memcpy(m_buffer + m_buffered, input, fill);
+		consumeStripes(m_lanes, m_buffer, m_buffer + k_stripe_size);
+		input	   += fill;
+		m_buffered	= 0;
+	}
+
+	input = consumeStripes(m_lanes, input, end);
+
+	m_buffered = static_cast<std::size_t>(end - input);
+	std::memcpy(m_buffer, input, m_buffered);
+}
+
+void Xxh64::update(std::string_view text)
+{
+	update(text.data(), text.size());
+}
+
+uint64_t Xxh64::digest() const
+{
+	uint64_t hash;
+	if (m_total >= k_stripe_size)
+	{
+		hash = rotateLeft(m_lanes[0], 1) + rotateLeft(m_lanes[1], 7) + rotateLeft(m_lanes[2], 12) +
+			   rotateLeft(m_lanes[3], 18);
+		for (uint64_t lane : m_lanes)
+		{
+			hash = mergeRound(hash, lane);
+		}
+	}
+	else
+	{
+		hash = m_seed + k_prime_5;
+	}
+	hash += m_total;
+
+	const uint8_t *data = m_buffer;
+	const uint8_t *end	= m_buffer + m_buffered;
+
+	for (; end - data >= 8; data += 8)
+	{
+		hash ^= round(0, read64(data));
+		hash  = rotateLeft(hash, 27) * k_prime_1 + k_prime_4;
+	}
+	if (end - data >= 4)
+	{
+		hash ^= static_cast<uint64_t>(read32(data)) * k_prime_1;
+		hash  = rotateLeft(hash, 23) * k_prime_2 + k_prime_3;
+		data += 4;
+	}
+	for (; data < end; ++data)
+	{
+		hash ^= *data * k_prime_5;
+		hash  = rotateLeft(hash, 11) * k_prime_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= k_prime_2;
+	hash ^= hash >> 29;
+	hash *= k_prime_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+uint64_t Xxh64::hash(const void *data, std::size_t length, uint64_t seed)
+{
+	Xxh64 state(seed);
+	state.update(data, length);
+	return state.digest();
+}
+
+bool ContentHash::hashFile(const std::string &path, FileHash &file_hash)
+{
+	file_hash	   = FileHash();
+	file_hash.path = path;
+
+	MappedFile file;
+	if (!file.open(path))
+	{
+		return false;
+	}
+
+	// Read once front to back, let the kernel prefetch ahead
+	file.advise(MADV_SEQUENTIAL);
+
+	file_hash.size = file.size();
+	file_hash.hash = Xxh64::hash(file.data(), file.size());
+	file_hash.ok   = true;
+	return true;
+}
+
+std::vector<ContentHash::FileHash> ContentHash::hashFiles(const std::vector<std::string> &paths, unsigned threads)
+{
+	std::vector<FileHash> hashes(paths.size());
+	if (paths.empty())
+	{
+		return hashes;
+	}
+
+	if (threads == 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = std::min<unsigned>(threads, static_cast<unsigned>(paths.size()));
+
+	std::atomic<std::size_t> next{0};
+
+	const auto worker = [&]() {
+		for (std::size_t index = next++; index < paths.size(); index = next++)
+		{
+			hashFile(paths[index], hashes[index]);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (unsigned i = 1; i < threads; ++i)
+	{
+		pool.emplace_back(worker);
+	}
+	worker();
+
+	for (std::thread &thread : pool)
+	{
+		thread.join();
+	}
+	return hashes;
+}
+} // namespace UTILS
@@ -0,0 +1,58 @@
+#ifndef CONTENT_HASH_HPP
+#define CONTENT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Streaming XXH64, output identical to the reference implementation.
+ */
+class Xxh64
+{
+public:
+	explicit Xxh64(uint64_t seed = 0);
+
+	void	 update(const void *data, std::size_t length);
+	void	 update(std::string_view text);
+	uint64_t digest() const;
+
+	static uint64_t hash(const void *data, std::size_t length, uint64_t seed = 0);
+
+private:
+	uint64_t	m_seed;
+	uint64_t	m_lanes[4];
+	uint64_t	m_total;
+	uint8_t		m_buffer[32];
+	std::size_t m_buffered;
+};
+
+/**
+ * @brief Content hashes of files, several files at a time.
+ */
+class ContentHash
+{
+public:
+	struct FileHash
+	{
+		std::string path;
+		uint64_t	hash = 0;
+		uint64_t	size = 0;
+		bool		ok	 = false; // false when the file could not be read
+	};
+
+public:
+	static bool hashFile(const std::string &path, FileHash &file_hash);
+
+	/**
+	 * Results keep the order of paths. threads == 0 uses one per core.
+	 */
+	static std::vector<FileHash> hashFiles(const std::vector<std::string> &paths, unsigned threads = 0);
+};
+} // namespace UTILS
+
+#endif // CONTENT_HASH_HPP
@@ -0,0 +1,629 @@
+#include "content_matcher.hpp"
+
+#include "rule_parser.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CONTENT_MATCHER_X86
+#include <immintrin.h>
+#endif
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint32_t k_none			 = 0xffffffff;
+	constexpr uint32_t k_output_flag	 = 0x80000000;
+	constexpr uint32_t k_recursion_limit = 3000; // Suricata's default inspection recursion limit
+
+	using SkipToStart = const uint8_t *(*)(const uint8_t *, const uint8_t *, const uint8_t *, const uint8_t *);
+
+	inline uint8_t fold(uint8_t byte)
+	{
+		return byte >= 'A' && byte <= 'Z' ? byte | 0x20 : byte;
+	}
+
+	/**
+	 * A byte may start a pattern when the low nibble table entry and the
+	 * high nibble table entry share a bucket bit.
+	 */
+	const uint8_t *skipScalar(const uint8_t *begin, const uint8_t *end, const uint8_t *low, const uint8_t *high)
+	{
+		for (; begin < end; ++begin)
+		{
+			if (low[*begin & 0x0f] & high[*begin >> 4])
+			{
+				return begin;
+			}
+		}
+		return end;
+	}
+
+#ifdef CONTENT_MATCHER_X86
+	__attribute__((target("ssse3"))) const uint8_t *skipSsse3(const uint8_t *begin, const uint8_t *end, const uint8_t *low,
+															  const uint8_t *high)
+	{
+		const __m128i low_table	 = _mm_load_si128(reinterpret_cast<const __m128i *>(low));
+		const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i *>(high));
+		const __m128i nibble	 = _mm_set1_epi8(0x0f);
+		const __m128i zero		 = _mm_setzero_si128();
+
+		for (; end - begin >= 16; begin += 16)
+		{
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+			const __m128i lows	= _mm_shuffle_epi8(low_table, _mm_and_si128(chunk, nibble));
+			const __m128i highs = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(chunk, 4), nibble));
+			const int	  mask	= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lows, highs), zero)) ^ 0xffff;
+			if (mask != 0)
+			{
+				return begin + __builtin_ctz(static_cast<unsigned>(mask));
+			}
+		}
+
+		return skipScalar(begin, end, low, high);
+	}
+
+	__attribute__((target("avx2"))) const uint8_t *skipAvx2(const uint8_t *begin, const uint8_t *end, const uint8_t *low,
+															const uint8_t *high)
+	{
+		const __m256i low_table	 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(low)));
+		const __m256i high_table = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(high)));
+		const __m256i nibble	 = _mm256_set1_epi8(0x0f);
+		const __m256i zero		 = _mm256_setzero_si256();
+
+		for (; end - begin >= 32; begin += 32)
+		{
+			const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+			const __m256i lows	= _mm256_shuffle_epi8(low_table, _mm256_and_si256(chunk, nibble));
+			const __m256i highs = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble));
+			const unsigned mask =
+				~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lows, highs), zero)));
+			if (mask != 0)
+			{
+				return begin + __builtin_ctz(mask);
+			}
+		}
+
+		// Scalar tail in VEX code, see ByteScanner
+		for (; begin < end; ++begin)
+		{
+			if (low[*begin & 0x0f] & high[*begin >> 4])
+			{
+				return begin;
+			}
+		}
+		return end;
+	}
+#endif
+
+	struct Implementation
+	{
+		SkipToStart skip_to_start;
+		const char *name;
+	};
+
+	Implementation resolveImplementation()
+	{
+#ifdef CONTENT_MATCHER_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return {skipAvx2, "avx2"};
+		}
+		if (__builtin_cpu_supports("ssse3"))
+		{
+			return {skipSsse3, "ssse3"};
+		}
+#endif
+		return {skipScalar, "scalar"};
+	}
+
+	const Implementation &implementation()
+	{
+		static const Implementation resolved = resolveImplementation();
+		return resolved;
+	}
+} // namespace
+
+ContentMatcher::ContentMatcher() :
+	m_byte_class{},
+	m_classes(1),
+	m_start_low{},
+	m_start_high{},
+	m_compiled(false)
+{}
+
+uint32_t ContentMatcher::internPattern(std::string folded)
+{
+	const auto [it, inserted] = m_pattern_ids.try_emplace(folded, static_cast<uint32_t>(m_patterns.size()));
+	if (inserted)
+	{
+		m_patterns.push_back(std::move(folded));
+	}
+	return it->second;
+}
+
+uint32_t ContentMatcher::add(const Rule &rule)
+{
+	RuleEntry entry;
+	entry.sid			= rule.sid;
+	entry.first_content = static_cast<uint32_t>(m_contents.size());
+
+	// Modifiers name their content by option index
+	std::vector<uint32_t> content_of_option(rule.options.size(), k_none);
+	std::string			  bytes;
+
+	for (std::size_t index = 0; index < rule.options.size(); ++index)
+	{
+		const RuleOption &option = rule.options[index];
+		if (option.kind == RuleOption::Kind::Content)
+		{
+			RuleParser::decodeContent(rule.slice(option.value), bytes);
+
+			Content content;
+			content.bytes	= static_cast<uint32_t>(m_bytes.size());
+			content.length	= static_cast<uint32_t>(bytes.size());
+			content.negated = option.negated;
+			m_bytes.append(bytes);
+
+			content_of_option[index] = static_cast<uint32_t>(m_contents.size());
+			m_contents.push_back(content);
+			continue;
+		}
+
+		if (option.kind == RuleOption::Kind::Other || option.kind == RuleOption::Kind::FastPattern ||
+			option.content >= content_of_option.size() || content_of_option[option.content] == k_none)
+		{
+			continue;
+		}
+
+		// byte_extract variables parse as 0, which leaves the window unrestricted
+		Content &content = m_contents[content_of_option[option.content]];
+		switch (option.kind)
+		{
+			case RuleOption::Kind::Nocase:
+				content.nocase = true;
+				break;
+			case RuleOption::Kind::Offset:
+				content.offset = option.number;
+				break;
+			case RuleOption::Kind::Depth:
+				content.depth = option.number;
+				break;
+			case RuleOption::Kind::Distance:
+				content.distance = option.number;
+				content.relative = true;
+				break;
+			case RuleOption::Kind::Within:
+				content.within	 = option.number;
+				content.relative = true;
+				break;
+			default:
+				break;
+		}
+	}
+
+	entry.content_count = static_cast<uint32_t>(m_contents.size()) - entry.first_content;
+	for (uint32_t index = entry.first_content; index < m_contents.size(); ++index)
+	{
+		Content &content = m_contents[index];
+		if (content.negated)
+		{
+			continue;
+		}
+
+		std::string folded = m_bytes.substr(content.bytes, content.length);
+		std::transform(folded.begin(), folded.end(), folded.begin(), [](char byte) {
+			return static_cast<char>(fold(static_cast<uint8_t>(byte)));
+		});
+		content.pattern = internPattern(std::move(folded));
+	}
+
+	m_rules.push_back(entry);
+	return static_cast<uint32_t>(m_rules.size() - 1);
+}
+
+void ContentMatcher::compile()
+{
+	const auto started = std::chrono::steady_clock::now();
+
+	m_always.clear();
+
+	// Input classes, one per folded byte some pattern uses and class 0 for all others
+	uint16_t folded_class[256] = {};
+	for (const std::string &pattern : m_patterns)
+	{
+		for (char byte : pattern)
+		{
+			folded_class[static_cast<uint8_t>(byte)] = 1;
+		}
+	}
+	m_classes = 1;
+	for (uint16_t &klass : folded_class)
+	{
+		klass = klass ? static_cast<uint16_t>(m_classes++) : 0;
+	}
+	for (int byte = 0; byte < 256; ++byte)
+	{
+		m_byte_class[byte] = folded_class[fold(static_cast<uint8_t>(byte))];
+	}
+
+	// Trie over state indices, k_none marks a missing edge until failures are resolved
+	m_table.assign(m_classes, k_none);
+	m_state_pattern.assign(1, k_none);
+
+	for (uint32_t pattern = 0; pattern < m_patterns.size(); ++pattern)
+	{
+		uint32_t state = 0;
+		for (char byte : m_patterns[pattern])
+		{
+			uint32_t &next = m_table[state * m_classes + m_byte_class[static_cast<uint8_t>(byte)]];
+			if (next == k_none)
+			{
+				next = static_cast<uint32_t>(m_state_pattern.size());
+				m_state_pattern.push_back(k_none);
+				m_table.resize(m_table.size() + m_classes, k_none);
+			}
+			state = m_table[state * m_classes + m_byte_class[static_cast<uint8_t>(byte)]];
+		}
+		m_state_pattern[state] = pattern;
+	}
+
+	// Breadth first, a state's failure is always shallower and thus already complete
+	const uint32_t		  states = static_cast<uint32_t>(m_state_pattern.size());
+	std::vector<uint32_t> failure(states, 0);
+	std::vector<uint32_t> queue;
+	queue.reserve(states);
+	m_output_link.assign(states, k_none);
+
+	for (uint32_t klass = 0; klass < m_classes; ++klass)
+	{
+		uint32_t &next = m_table[klass];
+		if (next == k_none)
+		{
+			next = 0;
+		}
+		else
+		{
+			queue.push_back(next);
+		}
+	}
+
+	for (std::size_t head = 0; head < queue.size(); ++head)
+	{
+		const uint32_t state = queue[head];
+		for (uint32_t klass = 0; klass < m_classes; ++klass)
+		{
+			uint32_t	  &next		= m_table[state * m_classes + klass];
+			const uint32_t fallback = m_table[failure[state] * m_classes + klass];
+			if (next == k_none)
+			{
+				next = fallback;
+				continue;
+			}
+
+			failure[next]		= fallback;
+			m_output_link[next] = m_state_pattern[fallback] != k_none ? fallback : m_output_link[fallback];
+			queue.push_back(next);
+		}
+	}
+
+	// Renumber in breadth first order. Scans spend nearly all their time in the
+	// shallow states, their rows end up next to each other in a few kilobytes
+	// at the front of the table instead of scattered between the deep ones.
+	std::vector<uint32_t> renumbered(states);
+	renumbered[0] = 0;
+	for (std::size_t index = 0; index < queue.size(); ++index)
+	{
+		renumbered[queue[index]] = static_cast<uint32_t>(index + 1);
+	}
+
+	std::vector<uint32_t> table(m_table.size());
+	std::vector<uint32_t> state_pattern(states);
+	std::vector<uint32_t> output_link(states);
+	for (uint32_t state = 0; state < states; ++state)
+	{
+		const uint32_t target = renumbered[state];
+		for (uint32_t klass = 0; klass < m_classes; ++klass)
+		{
+			// Row offsets instead of indices, flagged when the target reports a pattern
+			const uint32_t next	   = m_table[state * m_classes + klass];
+			const bool	   reports = m_state_pattern[next] != k_none || m_output_link[next] != k_none;
+
+			table[target * m_classes + klass] = renumbered[next] * m_classes | (reports ? k_output_flag : 0);
+		}
+		state_pattern[target] = m_state_pattern[state];
+		output_link[target]	  = m_output_link[state] == k_none ? k_none : renumbered[m_output_link[state]];
+	}
+	m_table.swap(table);
+	m_state_pattern.swap(state_pattern);
+	m_output_link.swap(output_link);
+
+	// Nibble tables for the root skip, start bytes are bucketed by high nibble.
+	// With more than eight distinct high nibbles buckets are shared and the
+	// skip may stop early on a byte that starts nothing, which is harmless.
+	std::fill(std::begin(m_start_low), std::end(m_start_low), 0);
+	std::fill(std::begin(m_start_high), std::end(m_start_high), 0);
+	int high_bucket[16];
+	std::fill(std::begin(high_bucket), std::end(high_bucket), -1);
+	int buckets = 0;
+
+	for (int byte = 0; byte < 256; ++byte)
+	{
+		if ((m_table[m_byte_class[byte]] & ~k_output_flag) == 0)
+		{
+			continue;
+		}
+		const int high = byte >> 4;
+		if (high_bucket[high] < 0)
+		{
+			high_bucket[high] = buckets++ % 8;
+		}
+		m_start_low[byte & 0x0f] |= static_cast<uint8_t>(1 << high_bucket[high]);
+		m_start_high[high]		 |= static_cast<uint8_t>(1 << high_bucket[high]);
+	}
+
+	// Pattern to rule rows, each rule listed once per distinct pattern
+	std::vector<std::pair<uint32_t, uint32_t>> pairs;
+	for (uint32_t rule = 0; rule < m_rules.size(); ++rule)
+	{
+		RuleEntry		 &entry = m_rules[rule];
+		const std::size_t first = pairs.size();
+		for (uint32_t index = 0; index < entry.content_count; ++index)
+		{
+			const Content &content = m_contents[entry.first_content + index];
+			if (!content.negated)
+			{
+				pairs.emplace_back(content.pattern, rule);
+			}
+		}
+		std::sort(pairs.begin() + first, pairs.end());
+		pairs.erase(std::unique(pairs.begin() + first, pairs.end()), pairs.end());
+
+		entry.pattern_count = static_cast<uint32_t>(pairs.size() - first);
+		if (entry.pattern_count == 0)
+		{
+			m_always.push_back(rule);
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+
+	m_pattern_rule_offsets.assign(m_patterns.size() + 1, 0);
+	m_pattern_rules.clear();
+	m_pattern_rules.reserve(pairs.size());
+	for (const auto &[pattern, rule] : pairs)
+	{
+		++m_pattern_rule_offsets[pattern + 1];
+		m_pattern_rules.push_back(rule);
+	}
+	for (std::size_t pattern = 0; pattern < m_patterns.size(); ++pattern)
+	{
+		m_pattern_rule_offsets[pattern + 1] += m_pattern_rule_offsets[pattern];
+	}
+
+	m_pattern_ids.clear();
+	m_compiled = true;
+
+	m_statistics.rules		  = m_rules.size();
+	m_statistics.contents	  = m_contents.size();
+	m_statistics.patterns	  = m_patterns.size();
+	m_statistics.states		  = states;
+	m_statistics.byte_classes = m_classes;
+	m_statistics.table_bytes  = m_table.size() * sizeof(uint32_t);
+	m_statistics.build		  =
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+}
+
+void ContentMatcher::scan(std::string_view payload, Scratch &scratch) const
+{
+	const uint8_t *const data  = reinterpret_cast<const uint8_t *>(payload.data());
+	const uint8_t *const end   = data + payload.size();
+	const SkipToStart	 skip  = implementation().skip_to_start;
+	const uint32_t		*table = m_table.data();
+	uint32_t			 row   = 0;
+
+	for (const uint8_t *position = data; position < end;)
+	{
+		if (row == 0)
+		{
+			position = skip(position, end, m_start_low, m_start_high);
+			if (position == end)
+			{
+				break;
+			}
+		}
+
+		const uint32_t entry = table[row + m_byte_class[*position++]];
+		row					 = entry & ~k_output_flag;
+		if (!(entry & k_output_flag))
+		{
+			continue;
+		}
+
+		const uint32_t hit_end = static_cast<uint32_t>(position - data);
+		uint32_t	   state   = row / m_classes;
+		if (m_state_pattern[state] == k_none)
+		{
+			state = m_output_link[state];
+		}
+		for (; state != k_none; state = m_output_link[state])
+		{
+			scratch.m_hits.push_back({m_state_pattern[state], hit_end});
+		}
+	}
+}
+
+bool ContentMatcher::contains(const Content &content, std::string_view payload, int64_t begin, int64_t end) const
+{
+	if (end - begin < content.length)
+	{
+		return false;
+	}
+
+	const char *const first	  = payload.data() + begin;
+	const char *const last	  = payload.data() + end;
+	const char *const pattern = m_bytes.data() + content.bytes;
+
+	if (!content.nocase)
+	{
+		return std::search(first, last, pattern, pattern + content.length) != last;
+	}
+	return std::search(first, last, pattern, pattern + content.length, [](char left, char right) {
+			   return fold(static_cast<uint8_t>(left)) == fold(static_cast<uint8_t>(right));
+		   }) != last;
+}
+
+bool ContentMatcher::verify(const RuleEntry &rule, uint32_t index, int64_t previous_end, std::string_view payload,
+							const std::vector<Scratch::Hit> &hits, Scratch &scratch) const
+{
+	if (index == rule.content_count)
+	{
+		return true;
+	}
+	if (scratch.m_budget == 0)
+	{
+		return false;
+	}
+	--scratch.m_budget;
+
+	const Content &content = m_contents[rule.first_content + index];
+
+	// Suricata's windows: within counts from the start of the distance window, depth from offset
+	const int64_t size	= static_cast<int64_t>(payload.size());
+	int64_t		  begin = 0;
+	int64_t		  end	= size;
+	if (content.relative)
+	{
+		begin = previous_end + content.distance;
+		if (content.within > 0)
+		{
+			end = std::min(end, begin + content.within);
+		}
+		begin = std::max<int64_t>(begin, 0);
+	}
+	else
+	{
+		begin = content.offset;
+		if (content.depth > 0)
+		{
+			end = std::min(end, begin + content.depth);
+		}
+	}
+
+	if (content.negated)
+	{
+		return !contains(content, payload, begin, end) && verify(rule, index + 1, previous_end, payload, hits, scratch);
+	}
+
+	// Hits are sorted by pattern and end offset
+	auto it = std::lower_bound(hits.begin(), hits.end(), content.pattern, [](const Scratch::Hit &hit, uint32_t pattern) {
+		return hit.pattern < pattern;
+	});
+	for (; it != hits.end() && it->pattern == content.pattern; ++it)
+	{
+		const int64_t hit_end	= it->end;
+		const int64_t hit_begin = hit_end - content.length;
+		if (hit_end > end)
+		{
+			break;
+		}
+		if (hit_begin < begin)
+		{
+			continue;
+		}
+		if (!content.nocase && std::memcmp(payload.data() + hit_begin, m_bytes.data() + content.bytes, content.length) != 0)
+		{
+			continue;
+		}
+		if (verify(rule, index + 1, hit_end, payload, hits, scratch))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ContentMatcher::match(std::string_view payload, Scratch &scratch, std::vector<uint32_t> &rules) const
+{
+	if (!m_compiled)
+	{
+		return;
+	}
+
+	scratch.m_hits.clear();
+	scratch.m_candidates.clear();
+	scratch.m_seen.resize(m_rules.size(), 0);
+
+	if (!m_patterns.empty())
+	{
+		scan(payload, scratch);
+	}
+
+	std::vector<Scratch::Hit> &hits = scratch.m_hits;
+	std::sort(hits.begin(), hits.end(), [](const Scratch::Hit &left, const Scratch::Hit &right) {
+		return left.pattern != right.pattern ? left.pattern < right.pattern : left.end < right.end;
+	});
+
+	// Count distinct patterns per rule, rules that saw all of theirs are candidates
+	for (std::size_t index = 0; index < hits.size(); ++index)
+	{
+		const uint32_t pattern = hits[index].pattern;
+		if (index > 0 && hits[index - 1].pattern == pattern)
+		{
+			continue;
+		}
+		for (uint32_t row = m_pattern_rule_offsets[pattern]; row < m_pattern_rule_offsets[pattern + 1]; ++row)
+		{
+			const uint32_t rule = m_pattern_rules[row];
+			if (scratch.m_seen[rule]++ == 0)
+			{
+				scratch.m_touched.push_back(rule);
+			}
+		}
+	}
+
+	for (uint32_t rule : scratch.m_touched)
+	{
+		if (scratch.m_seen[rule] == m_rules[rule].pattern_count)
+		{
+			scratch.m_candidates.push_back(rule);
+		}
+		scratch.m_seen[rule] = 0;
+	}
+	scratch.m_touched.clear();
+
+	scratch.m_candidates.insert(scratch.m_candidates.end(), m_always.begin(), m_always.end());
+	std::sort(scratch.m_candidates.begin(), scratch.m_candidates.end());
+
+	for (uint32_t rule : scratch.m_candidates)
+	{
+		scratch.m_budget = k_recursion_limit;
+		if (verify(m_rules[rule], 0, 0, payload, hits, scratch))
+		{
+			rules.push_back(rule);
+		}
+	}
+}
+
+uint32_t ContentMatcher::sid(uint32_t rule) const
+{
+	return m_rules[rule].sid;
+}
+
+std::size_t ContentMatcher::size() const
+{
+	return m_rules.size();
+}
+
+const ContentMatcher::Statistics &ContentMatcher::statistics() const
+{
+	return m_statistics;
+}
+
+const char *ContentMatcher::instructionSet()
+{
+	return implementation().name;
+}
+} // namespace UTILS
@@ -0,0 +1,144 @@
+#ifndef CONTENT_MATCHER_HPP
+#define CONTENT_MATCHER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UTILS
+{
+struct Rule;
+
+/**
+ * @brief content: evaluation of a whole rule set over packet payloads.
+ *
+ * Every positive content of every rule is compiled into one Aho-Corasick
+ * automaton. Patterns are case folded, bytes no pattern uses share one
+ * input class and failure transitions are resolved at build time, so the
+ * scan is a single lookup per byte in a dense row-major table. While the
+ * automaton sits in its root state the payload is skipped up to the next
+ * byte that can start a pattern, with a nibble table shuffle (AVX2 or
+ * SSSE3, picked at startup) that tests 32 or 16 bytes at once.
+ *
+ * A rule is a candidate once all its distinct positive patterns were seen,
+ * candidates are then verified in content order against the hit
+ * positions: case for patterns without nocase, offset and depth for
+ * absolute contents, distance and within relative to the previous match
+ * with backtracking, and absence for negated contents.
+ */
+class ContentMatcher
+{
+public:
+	struct Statistics
+	{
+		std::size_t				  rules		   = 0;
+		std::size_t				  contents	   = 0;
+		std::size_t				  patterns	   = 0; // distinct after case folding
+		std::size_t				  states	   = 0;
+		std::size_t				  byte_classes = 0;
+		std::size_t				  table_bytes  = 0;
+		std::chrono::microseconds build{0};
+	};
+
+	/**
+	 * Per thread match state, reused between payloads.
+	 */
+	class Scratch
+	{
+	private:
+		friend class ContentMatcher;
+
+		struct Hit
+		{
+			uint32_t pattern;
+			uint32_t end; // offset just past the match
+		};
+
+		std::vector<Hit>	  m_hits;
+		std::vector<uint32_t> m_seen;		// per rule, distinct patterns hit so far
+		std::vector<uint32_t> m_touched;	// rules with a non-zero m_seen
+		std::vector<uint32_t> m_candidates; // rules left to verify
+		uint32_t			  m_budget = 0;
+	};
+
+public:
+	ContentMatcher();
+
+	/**
+	 * Takes the contents and their modifiers from a parsed rule, returns its
+	 * index. Rules without positive contents match every payload. Has to be
+	 * called before compile().
+	 */
+	uint32_t add(const Rule &rule);
+	void	 compile();
+
+	/**
+	 * Appends the indices of the matching rules in ascending order.
+	 */
+	void match(std::string_view payload, Scratch &scratch, std::vector<uint32_t> &rules) const;
+
+	uint32_t		  sid(uint32_t rule) const;
+	std::size_t		  size() const;
+	const Statistics &statistics() const;
+
+	static const char *instructionSet();
+
+private:
+	struct Content
+	{
+		uint32_t pattern  = 0;	   // automaton pattern, unused for negated contents
+		uint32_t bytes	  = 0;	   // offset of the exact bytes in m_bytes
+		uint32_t length	  = 0;
+		bool	 nocase	  = false;
+		bool	 negated  = false;
+		bool	 relative = false; // distance or within given
+		int32_t	 offset	  = 0;
+		int32_t	 depth	  = 0;	   // 0 without one
+		int32_t	 distance = 0;
+		int32_t	 within	  = 0;	   // 0 without one
+	};
+
+	struct RuleEntry
+	{
+		uint32_t sid		   = 0;
+		uint32_t first_content = 0;
+		uint32_t content_count = 0;
+		uint32_t pattern_count = 0;	// distinct positive patterns
+	};
+
+	uint32_t internPattern(std::string folded);
+	void	 scan(std::string_view payload, Scratch &scratch) const;
+	bool	 verify(const RuleEntry &rule, uint32_t index, int64_t previous_end, std::string_view payload,
+					const std::vector<Scratch::Hit> &hits, Scratch &scratch) const;
+	bool	 contains(const Content &content, std::string_view payload, int64_t begin, int64_t end) const;
+
+private:
+	std::vector<RuleEntry>					  m_rules;
+	std::vector<Content>					  m_contents;
+	std::string								  m_bytes;	  // exact content bytes
+	std::vector<uint32_t>					  m_always;	  // rules without positive contents
+	std::vector<std::string>				  m_patterns; // folded, indexed by pattern id
+	std::unordered_map<std::string, uint32_t> m_pattern_ids;
+
+	// Pattern to rules, compressed rows
+	std::vector<uint32_t> m_pattern_rule_offsets;
+	std::vector<uint32_t> m_pattern_rules;
+
+	// Automaton, entries are target row offsets with k_output_flag for states that report
+	uint16_t			  m_byte_class[256];
+	uint32_t			  m_classes;
+	std::vector<uint32_t> m_table;
+	std::vector<uint32_t> m_state_pattern; // pattern ending in the state or k_none
+	std::vector<uint32_t> m_output_link;   // nearest proper suffix state with a pattern or k_none
+	alignas(16) uint8_t	  m_start_low[16];
+	alignas(16) uint8_t	  m_start_high[16];
+	bool				  m_compiled;
+
+	Statistics m_statistics;
+};
+} // namespace UTILS
+
+#endif // CONTENT_MATCHER_HPP
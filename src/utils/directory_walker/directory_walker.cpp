@@ -0,0 +1,472 @@
+#include "directory_walker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <memory>
+#include <mutex>
+#include <strings.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <thread>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_dirent_buffer_size = 64 * 1024;
+	constexpr int		  k_idle_spin_count	   = 64;
+
+	// Directories modified this close to the walk may still change within the
+	// same timestamp tick, their listings are not handed to the cache.
+	constexpr std::int64_t k_racy_window_ns = 2'000'000'000;
+
+	/**
+	 * Layout of the records returned by getdents64, the name follows d_type
+	 * directly and is NUL terminated.
+	 */
+	struct LinuxDirent64
+	{
+		std::uint64_t  d_ino;
+		std::int64_t   d_off;
+		unsigned short d_reclen;
+		unsigned char  d_type;
+	};
+
+	constexpr std::size_t k_dirent_name_offset = offsetof(LinuxDirent64, d_type) + 1;
+
+	bool isDotEntry(const char *name)
+	{
+		return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+	}
+
+	std::string joinPath(const std::string &directory, const char *name, std::size_t length)
+	{
+		std::string path;
+		path.reserve(directory.size() + length + 1);
+		path.append(directory);
+		if (path.empty() || path.back() != '/')
+		{
+			path.push_back('/');
+		}
+		path.append(name, length);
+		return path;
+	}
+
+	std::string normalizeRoot(std::string root)
+	{
+		while (root.size() > 1 && root.back() == '/')
+		{
+			root.pop_back();
+		}
+		return root;
+	}
+
+	unsigned char resolveType(int directory_fd, const char *name)
+	{
+		struct statx stx;
+		if (statx(directory_fd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC, STATX_TYPE, &stx) != 0)
+		{
+			return DT_UNKNOWN;
+		}
+
+		if (S_ISDIR(stx.stx_mode))
+		{
+			return DT_DIR;
+		}
+		if (S_ISREG(stx.stx_mode))
+		{
+			return DT_REG;
+		}
+		return DT_UNKNOWN;
+	}
+
+	bool readStamp(const std::string &path, DirectoryWalker::DirectoryStamp &stamp)
+	{
+		struct statx stx;
+		if (statx(AT_FDCWD, path.c_str(), AT_NO_AUTOMOUNT, STATX_INO | STATX_MTIME, &stx) != 0)
+		{
+			return false;
+		}
+
+		stamp.device   = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+		stamp.inode	   = stx.stx_ino;
+		stamp.mtime_ns = static_cast<std::int64_t>(stx.stx_mtime.tv_sec) * 1'000'000'000 + stx.stx_mtime.tv_nsec;
+		return true;
+	}
+} // namespace
+
+class DirectoryWalker::Worker
+{
+public:
+	Worker(const DirectoryWalker				&walker,
+		   std::vector<std::unique_ptr<Worker>> &workers,
+		   std::atomic<std::uint64_t>			&pending,
+		   const MatchCallback					&on_match,
+		   std::size_t							 index) :
+		m_walker(walker),
+		m_workers(workers),
+		m_pending(pending),
+		m_on_match(on_match),
+		m_index(index),
+		m_buffer(k_dirent_buffer_size)
+	{}
+
+	void push(Task task)
+	{
+		m_pending.fetch_add(1, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(std::move(task));
+	}
+
+	void run()
+	{
+		Task task;
+		int	 idle_rounds = 0;
+
+		while (true)
+		{
+			if (popLocal(task) || stealFromOthers(task))
+			{
+				idle_rounds = 0;
+				scan(task);
+				m_pending.fetch_sub(1, std::memory_order_acq_rel);
+				continue;
+			}
+
+			if (m_pending.load(std::memory_order_acquire) == 0)
+			{
+				return;
+			}
+
+			if (++idle_rounds < k_idle_spin_count)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			}
+		}
+	}
+
+	const Statistics &statistics() const
+	{
+		return m_statistics;
+	}
+
+private:
+	bool popLocal(Task &task)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queue.empty())
+		{
+			return false;
+		}
+		task = std::move(m_queue.back());
+		m_queue.pop_back();
+		return true;
+	}
+
+	bool steal(Task &task)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queue.empty())
+		{
+			return false;
+		}
+		task = std::move(m_queue.front());
+		m_queue.pop_front();
+		return true;
+	}
+
+	bool stealFromOthers(Task &task)
+	{
+		const std::size_t count = m_workers.size();
+		for (std::size_t offset = 1; offset < count; ++offset)
+		{
+			if (m_workers[(m_index + offset) % count]->steal(task))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void scan(const Task &task)
+	{
+		const Options &options	   = m_walker.m_options;
+		const bool	   can_descend = options.max_depth < 0 || task.depth < options.max_depth;
+
+		DirectoryStamp	 stamp;
+		DirectoryListing listing;
+
+		if (options.cache != nullptr)
+		{
+			if (!readStamp(task.path, stamp))
+			{
+				++m_statistics.errors;
+				return;
+			}
+
+			if (options.cache->lookup(task.path, stamp, listing))
+			{
+				++m_statistics.directories_cached;
+				replay(task, listing);
+				options.cache->store(task.path, stamp, listing);
+				return;
+			}
+		}
+
+		int fd = open(task.path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			++m_statistics.errors;
+			return;
+		}
+
+		++m_statistics.directories_scanned;
+
+		bool complete = true;
+
+		while (true)
+		{
+			long bytes = syscall(SYS_getdents64, fd, m_buffer.data(), m_buffer.size());
+			if (bytes < 0)
+			{
+				++m_statistics.errors;
+				complete = false;
+				break;
+			}
+			if (bytes == 0)
+			{
+				break;
+			}
+
+			for (long position = 0; position < bytes;)
+			{
+				const char			*record = m_buffer.data() + position;
+				const LinuxDirent64 *entry	= reinterpret_cast<const LinuxDirent64 *>(record);
+				const char			*name	= record + k_dirent_name_offset;
+				position += entry->d_reclen;
+
+				if (isDotEntry(name))
+				{
+					continue;
+				}
+
+				++m_statistics.entries_seen;
+
+				unsigned char type = entry->d_type;
+				if (type == DT_UNKNOWN)
+				{
+					type = resolveType(fd, name);
+				}
+
+				if (type == DT_REG)
+				{
+					const std::size_t length = std::strlen(name);
+					if (!m_walker.matchesName(name, length))
+					{
+						continue;
+					}
+
+					if (options.cache != nullptr)
+					{
+						listing.matched_files.emplace_back(name, length);
+					}
+
+					if (faccessat(fd, name, R_OK, 0) == 0)
+					{
+						++m_statistics.files_matched;
+						m_on_match(joinPath(task.path, name, length));
+					}
+				}
+				else if (type == DT_DIR && can_descend)
+				{
+					const std::size_t length = std::strlen(name);
+					if (m_walker.isPruned(name, length))
+					{
+						continue;
+					}
+
+					if (options.cache != nullptr)
+					{
+						listing.subdirectories.emplace_back(name, length);
+					}
+
+					push(Task{joinPath(task.path, name, length), task.depth + 1});
+				}
+			}
+		}
+
+		close(fd);
+
+		if (options.cache != nullptr && complete && stamp.mtime_ns < m_walker.m_racy_threshold_ns)
+		{
+			options.cache->store(task.path, stamp, listing);
+		}
+	}
+
+	void replay(const Task &task, const DirectoryListing &listing)
+	{
+		for (const std::string &name : listing.matched_files)
+		{
+			std::string path = joinPath(task.path, name.data(), name.size());
+			if (access(path.c_str(), R_OK) == 0)
+			{
+				++m_statistics.files_matched;
+				m_on_match(path);
+			}
+		}
+
+		for (const std::string &name : listing.subdirectories)
+		{
+			push(Task{joinPath(task.path, name.data(), name.size()), task.depth + 1});
+		}
+	}
+
+private:
+	const DirectoryWalker				 &m_walker;
+	std::vector<std::unique_ptr<Worker>> &m_workers;
+	std::atomic<std::uint64_t>			 &m_pending;
+	const MatchCallback					 &m_on_match;
+	std::size_t							  m_index;
+
+	std::mutex		  m_mutex;
+	std::deque<Task>  m_queue;
+	std::vector<char> m_buffer;
+	Statistics		  m_statistics;
+};
+
+DirectoryWalker::DirectoryWalker(Options options) : m_options(std::move(options))
+{
+	for (const std::string &pattern : m_options.name_patterns)
+	{
+		const bool is_literal = pattern.find_first_of("*?[") == std::string::npos;
+		m_patterns.push_back({pattern, is_literal});
+	}
+}
+
+DirectoryWalker::~DirectoryWalker()
+{}
+
+DirectoryWalker::Statistics DirectoryWalker::walk(const MatchCallback &on_match)
+{
+	const auto started_at = std::chrono::steady_clock::now();
+
+	m_racy_threshold_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+							  std::chrono::system_clock::now().time_since_epoch())
+							  .count() -
+						  k_racy_window_ns;
+
+	unsigned thread_count = m_options.thread_count;
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	std::atomic<std::uint64_t>			 pending{0};
+	std::vector<std::unique_ptr<Worker>> workers;
+	workers.reserve(thread_count);
+
+	for (unsigned i = 0; i < thread_count; ++i)
+	{
+		workers.push_back(std::make_unique<Worker>(*this, workers, pending, on_match, i));
+	}
+
+	std::size_t next_worker = 0;
+	for (const std::string &root : m_options.roots)
+	{
+		workers[next_worker++ % thread_count]->push(Task{normalizeRoot(root), 0});
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	for (unsigned i = 1; i < thread_count; ++i)
+	{
+		threads.emplace_back(&Worker::run, workers[i].get());
+	}
+
+	workers[0]->run();
+
+	for (std::thread &thread : threads)
+	{
+		thread.join();
+	}
+
+	Statistics statistics;
+	for (const auto &worker : workers)
+	{
+		statistics.directories_scanned += worker->statistics().directories_scanned;
+		statistics.directories_cached += worker->statistics().directories_cached;
+		statistics.entries_seen += worker->statistics().entries_seen;
+		statistics.files_matched += worker->statistics().files_matched;
+		statistics.errors += worker->statistics().errors;
+	}
+	statistics.elapsed = std::chrono::steady_clock::now() - started_at;
+
+	return statistics;
+}
+
+const DirectoryWalker::Options &DirectoryWalker::options() const
+{
+	return m_options;
+}
+
+std::string DirectoryWalker::listingSignature() const
+{
+	constexpr char separator = '\x1f';
+
+	std::string signature = std::to_string(m_options.max_depth);
+	for (const auto *list : {&m_options.roots, &m_options.name_patterns, &m_options.prune_names})
+	{
+		signature.push_back(separator);
+		for (const std::string &item : *list)
+		{
+			signature.append(item);
+			signature.push_back(separator);
+		}
+	}
+	return signature;
+}
+
+bool DirectoryWalker::matchesName(const char *name, std::size_t length) const
+{
+	for (const Pattern &pattern : m_patterns)
+	{
+		if (pattern.is_literal)
+		{
+			if (pattern.text.size() == length && strncasecmp(pattern.text.data(), name, length) == 0)
+			{
+				return true;
+			}
+		}
+		else if (fnmatch(pattern.text.c_str(), name, FNM_CASEFOLD) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool DirectoryWalker::isPruned(const char *name, std::size_t length) const
+{
+	for (const std::string &prune : m_options.prune_names)
+	{
+		if (prune.size() == length && std::memcmp(prune.data(), name, length) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+} // namespace UTILS
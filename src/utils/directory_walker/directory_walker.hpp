@@ -0,0 +1,123 @@
+#ifndef DIRECTORY_WALKER_HPP
+#define DIRECTORY_WALKER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Parallel recursive file finder.
+ *
+ * Directories are distributed between worker threads through per-worker deques:
+ * the owner pushes and pops at the back (depth first, warm dentry cache), idle
+ * workers steal from the front of other deques. Entries are read with raw
+ * getdents64, so the file type normally comes from d_type and statx is only
+ * issued for filesystems that report DT_UNKNOWN.
+ *
+ * Symlinks are never followed, which mirrors QDir::NoSymLinks. Name patterns
+ * ignore case like QDir::match, so "Suricata.YAML" is found by "*.yaml".
+ */
+class DirectoryWalker
+{
+public:
+	struct DirectoryStamp
+	{
+		std::uint64_t device   = 0;
+		std::uint64_t inode	   = 0;
+		std::int64_t  mtime_ns = 0;
+
+		bool operator==(const DirectoryStamp &other) const = default;
+	};
+
+	/**
+	 * Names relative to the listed directory: files that matched the patterns
+	 * and subdirectories that were not pruned.
+	 */
+	struct DirectoryListing
+	{
+		std::vector<std::string> matched_files;
+		std::vector<std::string> subdirectories;
+	};
+
+	/**
+	 * Optional listing cache consulted before a directory is read. Both methods
+	 * are called concurrently from worker threads.
+	 */
+	class ListingCache
+	{
+	public:
+		virtual ~ListingCache() = default;
+
+		virtual bool lookup(const std::string &path, const DirectoryStamp &stamp, DirectoryListing &listing) = 0;
+		virtual void store(const std::string &path, const DirectoryStamp &stamp, const DirectoryListing &listing) = 0;
+	};
+
+	struct Options
+	{
+		std::vector<std::string> roots;
+		std::vector<std::string> name_patterns;
+		std::vector<std::string> prune_names  = {".cache", "node_modules", ".git"};
+		int						 max_depth	  = -1; // -1 means unlimited, roots are depth 0
+		unsigned				 thread_count = 0;	// 0 means std::thread::hardware_concurrency()
+		ListingCache			*cache		  = nullptr;
+	};
+
+	struct Statistics
+	{
+		std::uint64_t			 directories_scanned = 0;
+		std::uint64_t			 directories_cached	 = 0;
+		std::uint64_t			 entries_seen		 = 0;
+		std::uint64_t			 files_matched		 = 0;
+		std::uint64_t			 errors				 = 0;
+		std::chrono::nanoseconds elapsed{0};
+	};
+
+	/**
+	 * Called from worker threads for every matching file, must be thread safe.
+	 */
+	using MatchCallback = std::function<void(const std::string &path)>;
+
+public:
+	explicit DirectoryWalker(Options options);
+	~DirectoryWalker();
+
+	Statistics walk(const MatchCallback &on_match);
+
+	const Options &options() const;
+
+	/**
+	 * Signature of everything that influences a listing, caches must drop
+	 * their content when it changes.
+	 */
+	std::string listingSignature() const;
+
+private:
+	struct Pattern
+	{
+		std::string text;
+		bool		is_literal;
+	};
+
+	struct Task
+	{
+		std::string path;
+		int			depth;
+	};
+
+	class Worker;
+
+	bool matchesName(const char *name, std::size_t length) const;
+	bool isPruned(const char *name, std::size_t length) const;
+
+private:
+	Options				 m_options;
+	std::vector<Pattern> m_patterns;
+	std::int64_t		 m_racy_threshold_ns = 0;
+};
+} // namespace UTILS
+
+#endif // DIRECTORY_WALKER_HPP
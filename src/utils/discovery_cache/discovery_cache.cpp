@@ -0,0 +1,219 @@
+#include "discovery_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::uint32_t k_cache_magic	= 0x31434453; // "SDC1"
+	constexpr std::uint32_t k_cache_version = 1;
+
+	class Reader
+	{
+	public:
+		explicit Reader(const std::vector<char> &data) : m_data(data), m_position(0), m_ok(true)
+		{}
+
+		template<typename T>
+		T read()
+		{
+			T value{};
+			if (!m_ok || m_data.size() - m_position < sizeof(T))
+			{
+				m_ok = false;
+				return value;
+			}
+			std::memcpy(&value, m_data.data() + m_position, sizeof(T));
+			m_position += sizeof(T);
+			return value;
+		}
+
+		std::string readString()
+		{
+			const auto length = read<std::uint32_t>();
+			if (!m_ok || m_data.size() - m_position < length)
+			{
+				m_ok = false;
+				return {};
+			}
+			std::string value(m_data.data() + m_position, length);
+			m_position += length;
+			return value;
+		}
+
+		void readStrings(std::vector<std::string> &values)
+		{
+			const auto count = read<std::uint32_t>();
+			for (std::uint32_t i = 0; m_ok && i < count; ++i)
+			{
+				values.push_back(readString());
+			}
+		}
+
+		bool ok() const
+		{
+			return m_ok;
+		}
+
+	private:
+		const std::vector<char> &m_data;
+		std::size_t				 m_position;
+		bool					 m_ok;
+	};
+
+	class Writer
+	{
+	public:
+		template<typename T>
+		void write(T value)
+		{
+			const char *bytes = reinterpret_cast<const char *>(&value);
+			m_data.insert(m_data.end(), bytes, bytes + sizeof(T));
+		}
+
+		void writeString(const std::string &value)
+		{
+			write<std::uint32_t>(static_cast<std::uint32_t>(value.size()));
+			m_data.insert(m_data.end(), value.begin(), value.end());
+		}
+
+		void writeStrings(const std::vector<std::string> &values)
+		{
+			write<std::uint32_t>(static_cast<std::uint32_t>(values.size()));
+			for (const std::string &value : values)
+			{
+				writeString(value);
+			}
+		}
+
+		const std::vector<char> &data() const
+		{
+			return m_data;
+		}
+
+	private:
+		std::vector<char> m_data;
+	};
+} // namespace
+
+DiscoveryCache::DiscoveryCache(std::string file_path) : m_file_path(std::move(file_path))
+{}
+
+DiscoveryCache::~DiscoveryCache()
+{}
+
+bool DiscoveryCache::load(const std::string &signature)
+{
+	m_signature = signature;
+	m_loaded.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(m_visited_mutex);
+		m_visited.clear();
+	}
+
+	std::ifstream file(m_file_path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	Reader					reader(data);
+
+	if (reader.read<std::uint32_t>() != k_cache_magic || reader.read<std::uint32_t>() != k_cache_version ||
+		reader.readString() != m_signature)
+	{
+		return false;
+	}
+
+	const auto count = reader.read<std::uint64_t>();
+	for (std::uint64_t i = 0; reader.ok() && i < count; ++i)
+	{
+		std::string path = reader.readString();
+		Record		record;
+		record.stamp.device	  = reader.read<std::uint64_t>();
+		record.stamp.inode	  = reader.read<std::uint64_t>();
+		record.stamp.mtime_ns = reader.read<std::int64_t>();
+		reader.readStrings(record.listing.matched_files);
+		reader.readStrings(record.listing.subdirectories);
+
+		m_loaded.emplace(std::move(path), std::move(record));
+	}
+
+	if (!reader.ok())
+	{
+		m_loaded.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool DiscoveryCache::save() const
+{
+	Writer writer;
+	writer.write<std::uint32_t>(k_cache_magic);
+	writer.write<std::uint32_t>(k_cache_version);
+	writer.writeString(m_signature);
+
+	{
+		std::lock_guard<std::mutex> lock(m_visited_mutex);
+
+		writer.write<std::uint64_t>(m_visited.size());
+		for (const auto &[path, record] : m_visited)
+		{
+			writer.writeString(path);
+			writer.write<std::uint64_t>(record.stamp.device);
+			writer.write<std::uint64_t>(record.stamp.inode);
+			writer.write<std::int64_t>(record.stamp.mtime_ns);
+			writer.writeStrings(record.listing.matched_files);
+			writer.writeStrings(record.listing.subdirectories);
+		}
+	}
+
+	const std::string temporary_path = m_file_path + ".tmp";
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		if (!file.write(writer.data().data(), static_cast<std::streamsize>(writer.data().size())))
+		{
+			return false;
+		}
+	}
+
+	return std::rename(temporary_path.c_str(), m_file_path.c_str()) == 0;
+}
+
+bool DiscoveryCache::lookup(const std::string					  &path,
+							const DirectoryWalker::DirectoryStamp &stamp,
+							DirectoryWalker::DirectoryListing	  &listing)
+{
+	// m_loaded is not modified while a walk is running, concurrent reads are safe
+	const auto it = m_loaded.find(path);
+	if (it == m_loaded.end() || !(it->second.stamp == stamp))
+	{
+		return false;
+	}
+
+	listing = it->second.listing;
+	return true;
+}
+
+void DiscoveryCache::store(const std::string					 &path,
+						   const DirectoryWalker::DirectoryStamp &stamp,
+						   const DirectoryWalker::DirectoryListing &listing)
+{
+	std::lock_guard<std::mutex> lock(m_visited_mutex);
+	m_visited.insert_or_assign(path, Record{stamp, listing});
+}
+
+std::size_t DiscoveryCache::loadedCount() const
+{
+	return m_loaded.size();
+}
+} // namespace UTILS
@@ -0,0 +1,60 @@
+#ifndef DISCOVERY_CACHE_HPP
+#define DISCOVERY_CACHE_HPP
+
+#include "directory_walker.hpp"
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace UTILS
+{
+/**
+ * @brief Persistent listing cache for DirectoryWalker.
+ *
+ * Remembers device/inode/mtime of every scanned directory together with the
+ * matching files and subdirectories found there. A directory's mtime changes
+ * whenever an entry is added, removed or renamed in it, so on the next walk an
+ * unchanged stamp lets the walker skip reading the directory and costs a single
+ * statx instead.
+ *
+ * Only directories visited during the last walk are written back, deleted
+ * directories therefore drop out on their own.
+ */
+class DiscoveryCache : public DirectoryWalker::ListingCache
+{
+public:
+	explicit DiscoveryCache(std::string file_path);
+	~DiscoveryCache() override;
+
+	bool load(const std::string &signature);
+	bool save() const;
+
+	bool lookup(const std::string					  &path,
+				const DirectoryWalker::DirectoryStamp &stamp,
+				DirectoryWalker::DirectoryListing	  &listing) override;
+	void store(const std::string					 &path,
+			   const DirectoryWalker::DirectoryStamp &stamp,
+			   const DirectoryWalker::DirectoryListing &listing) override;
+
+	std::size_t loadedCount() const;
+
+private:
+	struct Record
+	{
+		DirectoryWalker::DirectoryStamp	  stamp;
+		DirectoryWalker::DirectoryListing listing;
+	};
+
+private:
+	std::string m_file_path;
+	std::string m_signature;
+
+	std::unordered_map<std::string, Record> m_loaded;
+
+	mutable std::mutex						m_visited_mutex;
+	std::unordered_map<std::string, Record> m_visited;
+};
+} // namespace UTILS
+
+#endif // DISCOVERY_CACHE_HPP
@@ -0,0 +1,497 @@
+#include "eve_parser.hpp"
+
+#include "byte_scanner.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr unsigned k_field_event_type	  = 1 << 0;
+	constexpr unsigned k_field_source_ip	  = 1 << 1;
+	constexpr unsigned k_field_destination_ip = 1 << 2;
+	constexpr unsigned k_field_protocol		  = 1 << 3;
+	constexpr unsigned k_field_flow_id		  = 1 << 4;
+	constexpr unsigned k_field_alert		  = 1 << 5;
+	constexpr unsigned k_fields_common =
+		k_field_event_type | k_field_source_ip | k_field_destination_ip | k_field_protocol | k_field_flow_id;
+	constexpr unsigned k_fields_alert = k_fields_common | k_field_alert;
+
+	constexpr uint64_t k_even_bits = 0x5555555555555555ull;
+	constexpr uint64_t k_odd_bits  = ~k_even_bits;
+
+	bool isWhitespace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	const char *skipWhitespace(const char *position, const char *end)
+	{
+		while (position < end && isWhitespace(*position))
+		{
+			++position;
+		}
+		return position;
+	}
+
+	/**
+	 * Walks the structural characters of a JSON text: unescaped quotes and
+	 * `{}[]:,` outside of strings. Blocks of 64 bytes are classified with
+	 * ByteScanner on demand, so text after an early exit is never touched.
+	 */
+	class StructuralIterator
+	{
+	public:
+		StructuralIterator(const char *begin, const char *end) :
+			m_next_block(begin),
+			m_end(end),
+			m_odd_backslash_carry(0),
+			m_in_string_carry(0),
+			m_count(0),
+			m_index(0)
+		{}
+
+		const char *end() const
+		{
+			return m_end;
+		}
+
+		/**
+		 * Position of the next structural character, nullptr when exhausted.
+		 */
+		const char *next()
+		{
+			if (m_index == m_count && !loadBlock())
+			{
+				return nullptr;
+			}
+			return m_tokens[m_index++];
+		}
+
+		const char *peek()
+		{
+			if (m_index == m_count && !loadBlock())
+			{
+				return nullptr;
+			}
+			return m_tokens[m_index];
+		}
+
+	private:
+		bool loadBlock()
+		{
+			m_index = 0;
+			m_count = 0;
+			while (m_count == 0)
+			{
+				if (m_next_block >= m_end)
+				{
+					return false;
+				}
+				flattenBlock();
+			}
+			return true;
+		}
+
+		void flattenBlock()
+		{
+			const char *block = m_next_block;
+
+			ByteScanner::JsonBlock masks;
+			if (m_end - block >= ByteScanner::d_block_size)
+			{
+				masks = ByteScanner::classifyJson(block);
+			}
+			else
+			{
+				char padded[ByteScanner::d_block_size];
+				std::memset(padded, ' ', sizeof(padded));
+				std::memcpy(padded, block, static_cast<std::size_t>(m_end - block));
+				masks = ByteScanner::classifyJson(padded);
+			}
+			m_next_block = block + ByteScanner::d_block_size;
+
+			const uint64_t quotes	 = masks.quotes & ~escapedCharacters(masks.backslashes);
+			const uint64_t in_string = prefixXor(quotes) ^ m_in_string_carry;
+			m_in_string_carry		 = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+			// Positions are written eight at a time without branching on each bit, the slots past the
+			// population count hold garbage and are never read
+			uint64_t  bits	= quotes | (masks.structurals & ~in_string);
+			const int count = __builtin_popcountll(bits);
+			for (int i = 0; i < count; i += 8)
+			{
+				for (int j = 0; j < 8; ++j)
+				{
+					m_tokens[i + j]	 = block + __builtin_ctzll(bits | (uint64_t(1) << 63));
+					bits			&= bits - 1;
+				}
+			}
+			m_count = count;
+		}
+
+		/**
+		 * Characters preceded by an odd run of backslashes, the run may start
+		 * in the previous block.
+		 */
+		uint64_t escapedCharacters(uint64_t backslashes)
+		{
+			const uint64_t start_edges	   = backslashes & ~(backslashes << 1);
+			const uint64_t even_start_mask = k_even_bits ^ m_odd_backslash_carry;
+			const uint64_t even_starts	   = start_edges & even_start_mask;
+			const uint64_t odd_starts	   = start_edges & ~even_start_mask;
+			const uint64_t even_carries	   = backslashes + even_starts;
+
+			uint64_t   odd_carries;
+			const bool overflow	   = __builtin_add_overflow(backslashes, odd_starts, &odd_carries);
+			odd_carries			  |= m_odd_backslash_carry;
+			m_odd_backslash_carry  = overflow ? 1 : 0;
+
+			const uint64_t even_carry_ends = even_carries & ~backslashes;
+			const uint64_t odd_carry_ends  = odd_carries & ~backslashes;
+			return (even_carry_ends & k_odd_bits) | (odd_carry_ends & k_even_bits);
+		}
+
+		static uint64_t prefixXor(uint64_t bits)
+		{
+			bits ^= bits << 1;
+			bits ^= bits << 2;
+			bits ^= bits << 4;
+			bits ^= bits << 8;
+			bits ^= bits << 16;
+			bits ^= bits << 32;
+			return bits;
+		}
+
+	private:
+		const char *m_next_block;
+		const char *m_end;
+		uint64_t	m_odd_backslash_carry;
+		uint64_t	m_in_string_carry;
+		const char *m_tokens[ByteScanner::d_block_size];
+		int			m_count;
+		int			m_index;
+	};
+
+	/**
+	 * Reads the string whose opening quote was just returned by the iterator.
+	 */
+	bool readString(StructuralIterator &it, const char *open, std::string_view &value)
+	{
+		const char *close = it.next();
+		if (close == nullptr || *close != '"')
+		{
+			return false;
+		}
+		value = std::string_view(open + 1, static_cast<std::size_t>(close - open - 1));
+		return true;
+	}
+
+	/**
+	 * Skips a container whose opening bracket was just returned by the iterator.
+	 */
+	bool skipContainer(StructuralIterator &it)
+	{
+		int depth = 1;
+		while (depth > 0)
+		{
+			const char *position = it.next();
+			if (position == nullptr)
+			{
+				return false;
+			}
+			switch (*position)
+			{
+				case '{':
+				case '[':
+					depth++;
+					break;
+				case '}':
+				case ']':
+					depth--;
+					break;
+				default:
+					break;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * A member value starting right after the colon at `colon`.
+	 */
+	struct Value
+	{
+		char			 kind = 0; // '"', '{', '[' or 0 for scalars
+		const char		*open = nullptr;
+		std::string_view scalar;
+	};
+
+	bool beginValue(StructuralIterator &it, const char *colon, Value &value)
+	{
+		const char *start = skipWhitespace(colon + 1, it.end());
+		if (start == it.end())
+		{
+			return false;
+		}
+
+		if (*start == '"' || *start == '{' || *start == '[')
+		{
+			value.kind = *start;
+			value.open = it.next();
+			return value.open == start;
+		}
+
+		const char *stop = it.peek();
+		if (stop == nullptr)
+		{
+			stop = it.end();
+		}
+		while (stop > start && isWhitespace(stop[-1]))
+		{
+			--stop;
+		}
+		value.scalar = std::string_view(start, static_cast<std::size_t>(stop - start));
+		return !value.scalar.empty();
+	}
+
+	bool skipValue(StructuralIterator &it, const Value &value)
+	{
+		std::string_view ignored;
+		switch (value.kind)
+		{
+			case '"':
+				return readString(it, value.open, ignored);
+			case '{':
+			case '[':
+				return skipContainer(it);
+			default:
+				return true;
+		}
+	}
+
+	template<typename T>
+	bool readNumber(const Value &value, T &number)
+	{
+		if (value.kind != 0)
+		{
+			return false;
+		}
+		const char *end	   = value.scalar.data() + value.scalar.size();
+		const auto	result = std::from_chars(value.scalar.data(), end, number);
+		return result.ec == std::errc() && result.ptr == end;
+	}
+
+	bool readStringValue(StructuralIterator &it, const Value &value, std::string_view &string)
+	{
+		return value.kind == '"' ? readString(it, value.open, string) : skipValue(it, value);
+	}
+
+	/**
+	 * Reads `"key":` and positions the iterator at the value. Returns false
+	 * on malformed input, sets `closed` when the object ends instead.
+	 */
+	bool beginMember(StructuralIterator &it, std::string_view &key, Value &value, bool &closed)
+	{
+		const char *open = it.next();
+		if (open == nullptr)
+		{
+			return false;
+		}
+		if (*open == '}')
+		{
+			closed = true;
+			return true;
+		}
+
+		const char *colon;
+		if (*open != '"' || !readString(it, open, key) || (colon = it.next()) == nullptr || *colon != ':')
+		{
+			return false;
+		}
+		return beginValue(it, colon, value);
+	}
+
+	/**
+	 * Consumes the separator after a member, sets `closed` on `}`.
+	 */
+	bool endMember(StructuralIterator &it, bool &closed)
+	{
+		const char *separator = it.next();
+		if (separator == nullptr)
+		{
+			return false;
+		}
+		closed = *separator == '}';
+		return closed || *separator == ',';
+	}
+
+	bool parseAlert(StructuralIterator &it, EveEvent &event)
+	{
+		bool closed = false;
+		while (!closed)
+		{
+			std::string_view key;
+			Value			 value;
+			if (!beginMember(it, key, value, closed))
+			{
+				return false;
+			}
+			if (closed)
+			{
+				break;
+			}
+
+			bool parsed;
+			if (key == "signature_id")
+			{
+				parsed = readNumber(value, event.signature_id) || skipValue(it, value);
+			}
+			else if (key == "gid")
+			{
+				parsed = readNumber(value, event.gid) || skipValue(it, value);
+			}
+			else if (key == "rev")
+			{
+				parsed = readNumber(value, event.rev) || skipValue(it, value);
+			}
+			else if (key == "signature")
+			{
+				parsed = readStringValue(it, value, event.signature);
+			}
+			else
+			{
+				parsed = skipValue(it, value);
+			}
+
+			if (!parsed || !endMember(it, closed))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+bool EveEvent::isAlert() const
+{
+	return has_alert && event_type == "alert";
+}
+
+bool EveParser::parse(std::string_view line, EveEvent &event)
+{
+	event = EveEvent();
+
+	StructuralIterator it(line.data(), line.data() + line.size());
+
+	const char *open = it.next();
+	if (open == nullptr || *open != '{' || skipWhitespace(line.data(), open) != open)
+	{
+		return false;
+	}
+
+	unsigned found	= 0;
+	bool	 closed = false;
+
+	while (!closed)
+	{
+		std::string_view key;
+		Value			 value;
+		if (!beginMember(it, key, value, closed))
+		{
+			return false;
+		}
+		if (closed)
+		{
+			break;
+		}
+
+		// Dispatch on length first, most keys are rejected without comparing bytes
+		bool parsed = false;
+		bool wanted = true;
+		switch (key.size())
+		{
+			case 5:
+				if (key == "proto")
+				{
+					parsed	= readStringValue(it, value, event.protocol);
+					found  |= k_field_protocol;
+				}
+				else if (key == "alert" && value.kind == '{')
+				{
+					parsed			= parseAlert(it, event);
+					event.has_alert = parsed;
+					found		   |= k_field_alert;
+				}
+				else
+				{
+					wanted = false;
+				}
+				break;
+			case 6:
+				wanted = key == "src_ip";
+				if (wanted)
+				{
+					parsed	= readStringValue(it, value, event.source_ip);
+					found  |= k_field_source_ip;
+				}
+				break;
+			case 7:
+				if (key == "dest_ip")
+				{
+					parsed	= readStringValue(it, value, event.destination_ip);
+					found  |= k_field_destination_ip;
+				}
+				else if (key == "flow_id")
+				{
+					event.has_flow_id  = readNumber(value, event.flow_id);
+					parsed			   = event.has_flow_id || skipValue(it, value);
+					found			  |= k_field_flow_id;
+				}
+				else
+				{
+					wanted = false;
+				}
+				break;
+			case 10:
+				wanted = key == "event_type";
+				if (wanted)
+				{
+					parsed	= readStringValue(it, value, event.event_type);
+					found  |= k_field_event_type;
+				}
+				break;
+			default:
+				wanted = false;
+				break;
+		}
+
+		if (!wanted)
+		{
+			parsed = skipValue(it, value);
+		}
+
+		if (!parsed)
+		{
+			return false;
+		}
+
+		// Everything after the last wanted field (payload, flow, metadata...) is not even classified
+		const unsigned required = event.event_type == "alert" ? k_fields_alert : k_fields_common;
+		if ((found & required) == required)
+		{
+			return true;
+		}
+
+		if (!endMember(it, closed))
+		{
+			return false;
+		}
+	}
+
+	const char *trailing = it.next();
+	return trailing == nullptr;
+}
+} // namespace UTILS
@@ -0,0 +1,46 @@
+#ifndef EVE_PARSER_HPP
+#define EVE_PARSER_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace UTILS
+{
+/**
+ * @brief Fields of one eve.json record the application cares about.
+ *
+ * String fields are views into the line, escapes are left as is.
+ */
+struct EveEvent
+{
+	std::string_view event_type;
+	std::string_view source_ip;
+	std::string_view destination_ip;
+	std::string_view protocol;
+	uint64_t		 flow_id	  = 0;
+	bool			 has_flow_id  = false;
+	bool			 has_alert	  = false;
+	uint32_t		 gid		  = 0;
+	uint32_t		 signature_id = 0;
+	uint32_t		 rev		  = 0;
+	std::string_view signature;
+
+	bool isAlert() const;
+};
+
+/**
+ * @brief Extracts EveEvent fields from a single NDJSON line without building
+ *        a document.
+ *
+ * The line is walked over its structural characters only, found 64 bytes at
+ * a time by ByteScanner, so unrelated values are skipped without looking at
+ * their bytes. Parsing stops as soon as every wanted field has been seen.
+ */
+class EveParser
+{
+public:
+	static bool parse(std::string_view line, EveEvent &event);
+};
+} // namespace UTILS
+
+#endif // EVE_PARSER_HPP
@@ -0,0 +1,137 @@
+#include "fast_log_parser.hpp"
+
+#include <charconv>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::string_view k_marker			= "[**]";
+	constexpr std::string_view k_classification = "[Classification: ";
+	constexpr std::string_view k_priority		= "[Priority: ";
+	constexpr std::string_view k_arrow			= " -> ";
+
+	std::string_view trim(std::string_view text)
+	{
+		while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+		{
+			text.remove_prefix(1);
+		}
+		while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r'))
+		{
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	template<typename T>
+	bool parseNumber(std::string_view text, T &value)
+	{
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+
+	/**
+	 * The port follows the last colon, which also works for IPv6 addresses.
+	 */
+	bool parseEndpoint(std::string_view text, std::string_view &address, uint16_t &port)
+	{
+		const std::size_t colon = text.rfind(':');
+		if (colon == std::string_view::npos || !parseNumber(text.substr(colon + 1), port))
+		{
+			address = text;
+			return false;
+		}
+		address = text.substr(0, colon);
+		return true;
+	}
+} // namespace
+
+bool FastLogAlert::parse(std::string_view line, FastLogAlert &alert)
+{
+	alert = FastLogAlert();
+
+	const std::size_t first_marker = line.find(k_marker);
+	if (first_marker == std::string_view::npos)
+	{
+		return false;
+	}
+
+	alert.timestamp		  = trim(line.substr(0, first_marker));
+	std::string_view rest = trim(line.substr(first_marker + k_marker.size()));
+
+	// [gid:sid:rev]
+	const std::size_t id_end = rest.find(']');
+	if (rest.empty() || rest.front() != '[' || id_end == std::string_view::npos)
+	{
+		return false;
+	}
+
+	const std::string_view identifier = rest.substr(1, id_end - 1);
+	const std::size_t	   first	  = identifier.find(':');
+	const std::size_t	   second	  = identifier.find(':', first + 1);
+	if (first == std::string_view::npos || second == std::string_view::npos ||
+		!parseNumber(identifier.substr(0, first), alert.gid) ||
+		!parseNumber(identifier.substr(first + 1, second - first - 1), alert.sid) ||
+		!parseNumber(identifier.substr(second + 1), alert.rev))
+	{
+		return false;
+	}
+	rest.remove_prefix(id_end + 1);
+
+	const std::size_t second_marker = rest.find(k_marker);
+	if (second_marker == std::string_view::npos)
+	{
+		return false;
+	}
+	alert.message = trim(rest.substr(0, second_marker));
+	rest		  = trim(rest.substr(second_marker + k_marker.size()));
+
+	if (rest.substr(0, k_classification.size()) == k_classification)
+	{
+		const std::size_t end = rest.find(']');
+		if (end == std::string_view::npos)
+		{
+			return false;
+		}
+		alert.classification = rest.substr(k_classification.size(), end - k_classification.size());
+		rest				 = trim(rest.substr(end + 1));
+	}
+
+	if (rest.substr(0, k_priority.size()) == k_priority)
+	{
+		const std::size_t end = rest.find(']');
+		if (end == std::string_view::npos ||
+			!parseNumber(rest.substr(k_priority.size(), end - k_priority.size()), alert.priority))
+		{
+			return false;
+		}
+		rest = trim(rest.substr(end + 1));
+	}
+
+	if (rest.empty() || rest.front() != '{')
+	{
+		return false;
+	}
+
+	const std::size_t protocol_end = rest.find('}');
+	if (protocol_end == std::string_view::npos)
+	{
+		return false;
+	}
+	alert.protocol = rest.substr(1, protocol_end - 1);
+	rest		   = trim(rest.substr(protocol_end + 1));
+
+	const std::size_t arrow = rest.find(k_arrow);
+	if (arrow == std::string_view::npos)
+	{
+		return false;
+	}
+
+	const bool source_port		= parseEndpoint(rest.substr(0, arrow), alert.source_ip, alert.source_port);
+	const bool destination_port =
+		parseEndpoint(rest.substr(arrow + k_arrow.size()), alert.destination_ip, alert.destination_port);
+	alert.has_ports				= source_port && destination_port;
+	return true;
+}
+} // namespace UTILS
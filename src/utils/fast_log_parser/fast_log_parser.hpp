@@ -0,0 +1,37 @@
+#ifndef FAST_LOG_PARSER_HPP
+#define FAST_LOG_PARSER_HPP
+
+#include <cstdint>
+#include <string_view>
+
+namespace UTILS
+{
+/**
+ * @brief One fast.log line. All views point into the parsed line and are
+ *        only valid as long as it is.
+ */
+struct FastLogAlert
+{
+	std::string_view timestamp;
+	uint32_t		 gid	  = 0;
+	uint32_t		 sid	  = 0;
+	uint32_t		 rev	  = 0;
+	int				 priority = 0;
+	std::string_view message;
+	std::string_view classification;
+	std::string_view protocol;
+	std::string_view source_ip;
+	std::string_view destination_ip;
+	uint16_t		 source_port	  = 0;
+	uint16_t		 destination_port = 0;
+	bool			 has_ports		  = false;
+
+	/**
+	 * Parses a line of the form
+	 * `ts  [**] [gid:sid:rev] msg [**] [Classification: c] [Priority: p] {PROTO} src:port -> dst:port`
+	 */
+	static bool parse(std::string_view line, FastLogAlert &alert);
+};
+} // namespace UTILS
+
+#endif // FAST_LOG_PARSER_HPP
@@ -0,0 +1,120 @@
+#include "file_change_waiter.hpp"
+
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint32_t k_watch_mask		   = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR;
+	constexpr size_t   k_event_buffer_size = 4096;
+} // namespace
+
+FileChangeWaiter::FileChangeWaiter(const std::string &path) :
+	m_inotify_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+	m_error(0)
+{
+	if (m_inotify_fd < 0)
+	{
+		m_error = errno;
+		return;
+	}
+
+	const std::size_t slash		= path.rfind('/');
+	const std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+	m_file_name					= slash == std::string::npos ? path : path.substr(slash + 1);
+
+	if (inotify_add_watch(m_inotify_fd, directory.c_str(), k_watch_mask) < 0)
+	{
+		m_error = errno;
+		close(m_inotify_fd);
+		m_inotify_fd = -1;
+	}
+}
+
+FileChangeWaiter::~FileChangeWaiter()
+{
+	if (m_inotify_fd >= 0)
+	{
+		close(m_inotify_fd);
+	}
+}
+
+bool FileChangeWaiter::isArmed() const
+{
+	return m_inotify_fd >= 0;
+}
+
+int FileChangeWaiter::error() const
+{
+	return m_error;
+}
+
+FileChangeWaiter::Result FileChangeWaiter::wait(std::chrono::milliseconds timeout)
+{
+	if (!isArmed())
+	{
+		return Result::Error;
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	while (true)
+	{
+		const auto remaining =
+			std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+		if (remaining.count() <= 0)
+		{
+			return Result::Timeout;
+		}
+
+		pollfd descriptor = {m_inotify_fd, POLLIN, 0};
+		const int ready	  = poll(&descriptor, 1, static_cast<int>(remaining.count()));
+
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			m_error = errno;
+			return Result::Error;
+		}
+
+		if (ready > 0 && readEvents())
+		{
+			return Result::Changed;
+		}
+	}
+}
+
+bool FileChangeWaiter::readEvents()
+{
+	alignas(inotify_event) char buffer[k_event_buffer_size];
+	bool						changed = false;
+
+	while (true)
+	{
+		const ssize_t length = read(m_inotify_fd, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			break;
+		}
+
+		for (char *cursor = buffer; cursor < buffer + length;)
+		{
+			const auto *event = reinterpret_cast<const inotify_event *>(cursor);
+			if (event->len > 0 && m_file_name == event->name)
+			{
+				changed = true;
+			}
+			cursor += sizeof(inotify_event) + event->len;
+		}
+	}
+
+	return changed;
+}
+} // namespace UTILS
@@ -0,0 +1,49 @@
+#ifndef FILE_CHANGE_WAITER_HPP
+#define FILE_CHANGE_WAITER_HPP
+
+#include <chrono>
+#include <string>
+
+namespace UTILS
+{
+/**
+ * @brief Blocks until a single file is written to, or a deadline passes.
+ *
+ * The parent directory is watched with inotify as soon as the waiter is
+ * constructed, so arm it before triggering the write to avoid missing the
+ * event. The file does not need to exist yet. Meant for worker threads; the
+ * Qt event driven counterpart is FileWatcher.
+ */
+class FileChangeWaiter
+{
+public:
+	enum class Result
+	{
+		Changed,
+		Timeout,
+		Error
+	};
+
+public:
+	explicit FileChangeWaiter(const std::string &path);
+	~FileChangeWaiter();
+
+	FileChangeWaiter(const FileChangeWaiter &)			  = delete;
+	FileChangeWaiter &operator=(const FileChangeWaiter &) = delete;
+
+	bool isArmed() const;
+	int	 error() const;
+
+	Result wait(std::chrono::milliseconds timeout);
+
+private:
+	bool readEvents();
+
+private:
+	std::string m_file_name;
+	int			m_inotify_fd;
+	int			m_error;
+};
+} // namespace UTILS
+
+#endif // FILE_CHANGE_WAITER_HPP
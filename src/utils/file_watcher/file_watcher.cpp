@@ -0,0 +1,206 @@
+#include "file_watcher.hpp"
+
+#include "settings_defaults.hpp"
+#include "spdlog_wrapper.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <cerrno>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr int		  k_default_coalesce_interval = 300;
+	constexpr std::size_t k_event_buffer_size		  = 16 * 1024;
+} // namespace
+
+FileWatcher::FileWatcher(QObject *parent) :
+	QObject(parent),
+	m_inotify_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+	m_notifier(nullptr),
+	m_coalesce_timer(new QTimer(this))
+{
+	m_coalesce_timer->setSingleShot(true);
+	m_coalesce_timer->setInterval(k_default_coalesce_interval);
+	connect(m_coalesce_timer, &QTimer::timeout, this, &FileWatcher::onCoalesceTimeout);
+
+	if (m_inotify_fd < 0)
+	{
+		SPD_ERROR_CLASS(DEFAULTS::d_logger_file_watcher, QString("Unable to initialize inotify: %1").arg(errno));
+		return;
+	}
+
+	m_notifier = new QSocketNotifier(m_inotify_fd, QSocketNotifier::Read, this);
+	connect(m_notifier, &QSocketNotifier::activated, this, &FileWatcher::onInotifyReadable);
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (m_inotify_fd >= 0)
+	{
+		close(m_inotify_fd);
+	}
+}
+
+bool FileWatcher::isValid() const
+{
+	return m_inotify_fd >= 0;
+}
+
+bool FileWatcher::watchDirectory(const QString &path, quint32 mask)
+{
+	if (!isValid())
+	{
+		return false;
+	}
+
+	const QString clean_path = QDir::cleanPath(path);
+	const int	  wd =
+		inotify_add_watch(m_inotify_fd, QFile::encodeName(clean_path).constData(), mask | IN_ONLYDIR | IN_MASK_ADD);
+	if (wd < 0)
+	{
+		SPD_WARN_CLASS(DEFAULTS::d_logger_file_watcher, QString("Unable to watch %1: %2").arg(clean_path).arg(errno));
+		return false;
+	}
+
+	m_watch_paths.insert(wd, clean_path);
+	m_path_watches.insert(clean_path, wd);
+
+	if (mask & (IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO))
+	{
+		m_watch_whole_directory.insert(wd);
+	}
+
+	return true;
+}
+
+bool FileWatcher::watchFile(const QString &path)
+{
+	const QFileInfo info(QDir::cleanPath(path));
+
+	if (!isValid())
+	{
+		return false;
+	}
+
+	const QString directory = info.absolutePath();
+	const int	  wd =
+		inotify_add_watch(m_inotify_fd, QFile::encodeName(directory).constData(), d_directory_mask | IN_ONLYDIR | IN_MASK_ADD);
+	if (wd < 0)
+	{
+		SPD_WARN_CLASS(DEFAULTS::d_logger_file_watcher, QString("Unable to watch %1: %2").arg(info.filePath()).arg(errno));
+		return false;
+	}
+
+	m_watch_paths.insert(wd, directory);
+	m_path_watches.insert(directory, wd);
+	m_watch_file_filters[wd].insert(info.fileName());
+
+	return true;
+}
+
+void FileWatcher::clear()
+{
+	for (auto it = m_watch_paths.constBegin(); it != m_watch_paths.constEnd(); ++it)
+	{
+		inotify_rm_watch(m_inotify_fd, it.key());
+	}
+
+	m_watch_paths.clear();
+	m_path_watches.clear();
+	m_watch_file_filters.clear();
+	m_watch_whole_directory.clear();
+	m_pending_paths.clear();
+	m_coalesce_timer->stop();
+}
+
+void FileWatcher::setCoalesceInterval(int msec)
+{
+	m_coalesce_timer->setInterval(msec);
+}
+
+void FileWatcher::onInotifyReadable()
+{
+	alignas(struct inotify_event) char buffer[k_event_buffer_size];
+
+	while (true)
+	{
+		const ssize_t length = read(m_inotify_fd, buffer, sizeof(buffer));
+		if (length <= 0)
+		{
+			break;
+		}
+
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const auto *event = reinterpret_cast<const struct inotify_event *>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(struct inotify_event) + event->len);
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				// Events were dropped, everything has to be assumed changed
+				for (auto it = m_watch_paths.constBegin(); it != m_watch_paths.constEnd(); ++it)
+				{
+					m_pending_paths.insert(it.value());
+					for (const QString &file_name : m_watch_file_filters.value(it.key()))
+					{
+						m_pending_paths.insert(it.value() + "/" + file_name);
+					}
+				}
+				continue;
+			}
+
+			const QString directory = m_watch_paths.value(event->wd);
+			if (directory.isEmpty())
+			{
+				continue;
+			}
+
+			if (event->len > 0)
+			{
+				const QString name = QFile::decodeName(event->name);
+				if (m_watch_whole_directory.contains(event->wd) || m_watch_file_filters.value(event->wd).contains(name))
+				{
+					m_pending_paths.insert(directory + "/" + name);
+				}
+			}
+			else
+			{
+				m_pending_paths.insert(directory);
+				for (const QString &file_name : m_watch_file_filters.value(event->wd))
+				{
+					m_pending_paths.insert(directory + "/" + file_name);
+				}
+			}
+
+			if (event->mask & IN_IGNORED)
+			{
+				m_path_watches.remove(directory);
+				m_watch_paths.remove(event->wd);
+				m_watch_file_filters.remove(event->wd);
+				m_watch_whole_directory.remove(event->wd);
+			}
+		}
+	}
+
+	if (!m_pending_paths.isEmpty())
+	{
+		m_coalesce_timer->start();
+	}
+}
+
+void FileWatcher::onCoalesceTimeout()
+{
+	const QStringList paths = m_pending_paths.values();
+	m_pending_paths.clear();
+
+	SPD_INFO_CLASS(DEFAULTS::d_logger_file_watcher, QString("Detected changes in %1 path(s)").arg(paths.size()));
+
+	emit pathsChanged(paths);
+}
+} // namespace UTILS
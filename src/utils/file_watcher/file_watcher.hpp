@@ -0,0 +1,67 @@
+#ifndef FILE_WATCHER_HPP
+#define FILE_WATCHER_HPP
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <sys/inotify.h>
+
+class QSocketNotifier;
+class QTimer;
+
+namespace UTILS
+{
+/**
+ * @brief inotify backed watcher with burst coalescing.
+ *
+ * Files are watched through their parent directory, editors that save by
+ * writing a temporary file and renaming it over the original would otherwise
+ * silently drop the watch. Events are collected until the watcher has been
+ * quiet for the coalesce interval and then reported once as a set of paths.
+ */
+class FileWatcher : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY_MOVE(FileWatcher)
+
+signals:
+	void pathsChanged(const QStringList &paths);
+
+public:
+	static constexpr quint32 d_directory_mask = IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_CREATE |
+												IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF;
+	static constexpr quint32 d_self_mask	  = IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF;
+
+public:
+	explicit FileWatcher(QObject *parent = nullptr);
+	~FileWatcher() override;
+
+	bool isValid() const;
+
+	bool watchDirectory(const QString &path, quint32 mask = d_directory_mask);
+	bool watchFile(const QString &path);
+	void clear();
+
+	void setCoalesceInterval(int msec);
+
+private slots:
+	void onInotifyReadable();
+	void onCoalesceTimeout();
+
+private:
+	int				 m_inotify_fd;
+	QSocketNotifier *m_notifier;
+	QTimer			*m_coalesce_timer;
+
+	QHash<int, QString>		  m_watch_paths;
+	QHash<QString, int>		  m_path_watches;
+	QHash<int, QSet<QString>> m_watch_file_filters;
+	QSet<int>				  m_watch_whole_directory;
+
+	QSet<QString> m_pending_paths;
+};
+} // namespace UTILS
+
+#endif // FILE_WATCHER_HPP
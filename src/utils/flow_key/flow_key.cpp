@@ -0,0 +1,37 @@
+#include "flow_key.hpp"
+
+#include <cstring>
+#include <utility>
+
+namespace UTILS
+{
+FlowKey FlowKey::ipv4(uint32_t source, uint32_t destination, uint16_t source_port, uint16_t destination_port,
+					  uint8_t protocol)
+{
+	FlowKey key;
+	key.source[10] = key.source[11] = key.destination[10] = key.destination[11] = 0xff;
+	for (int i = 0; i < 4; ++i)
+	{
+		key.source[12 + i]		= static_cast<uint8_t>(source >> (24 - 8 * i));
+		key.destination[12 + i] = static_cast<uint8_t>(destination >> (24 - 8 * i));
+	}
+	key.source_port		 = source_port;
+	key.destination_port = destination_port;
+	key.protocol		 = protocol;
+	return key;
+}
+
+FlowKey FlowKey::reversed() const
+{
+	FlowKey key = *this;
+	std::memcpy(key.source, destination, sizeof(key.source));
+	std::memcpy(key.destination, source, sizeof(key.destination));
+	std::swap(key.source_port, key.destination_port);
+	return key;
+}
+
+bool FlowKey::operator==(const FlowKey &other) const
+{
+	return std::memcmp(this, &other, sizeof(FlowKey)) == 0;
+}
+} // namespace UTILS
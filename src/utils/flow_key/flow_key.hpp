@@ -0,0 +1,40 @@
+#ifndef FLOW_KEY_HPP
+#define FLOW_KEY_HPP
+
+#include <cstdint>
+
+namespace UTILS
+{
+/**
+ * @brief 5-tuple of a packet as seen on the wire.
+ *
+ * IPv4 addresses are stored IPv4-mapped (::ffff:a.b.c.d) so both families
+ * share one layout. Padding is zeroed, keys compare with memcmp.
+ */
+struct FlowKey
+{
+	uint8_t	 source[16]		  = {};
+	uint8_t	 destination[16]  = {};
+	uint16_t source_port	  = 0;
+	uint16_t destination_port = 0;
+	uint8_t	 protocol		  = 0;
+	uint8_t	 padding[3]		  = {};
+
+	/**
+	 * Addresses in host byte order.
+	 */
+	static FlowKey ipv4(uint32_t source, uint32_t destination, uint16_t source_port, uint16_t destination_port,
+						uint8_t protocol);
+
+	FlowKey reversed() const;
+	bool	operator==(const FlowKey &other) const;
+};
+
+enum class FlowDirection : uint8_t
+{
+	ToServer = 0, // from the endpoint that opened the flow
+	ToClient = 1
+};
+} // namespace UTILS
+
+#endif // FLOW_KEY_HPP
@@ -0,0 +1,366 @@
+#include "flow_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint8_t	  k_protocol_tcp = 6;
+	constexpr std::size_t k_sweep_slots	 = 4; // slots checked for idle flows on every update
+	constexpr std::size_t k_min_capacity = 16;
+	constexpr uint64_t	  k_microseconds = 1000000;
+
+	inline uint64_t load64(const uint8_t *data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	inline uint64_t mix(uint64_t hash, uint64_t value)
+	{
+		hash ^= value;
+		hash *= 0x9e3779b97f4a7c15ULL;
+		return hash ^ (hash >> 29);
+	}
+
+	/**
+	 * Endpoints are ordered before hashing so both directions of a flow get
+	 * the same tag. 0 marks empty slots and is never returned.
+	 */
+	uint32_t hashKey(const FlowKey &key)
+	{
+		const int  order = std::memcmp(key.source, key.destination, sizeof(key.source));
+		const bool swap	 = order > 0 || (order == 0 && key.source_port > key.destination_port);
+
+		const uint8_t *low		 = swap ? key.destination : key.source;
+		const uint8_t *high		 = swap ? key.source : key.destination;
+		const uint64_t low_port	 = swap ? key.destination_port : key.source_port;
+		const uint64_t high_port = swap ? key.source_port : key.destination_port;
+
+		uint64_t hash = 0x243f6a8885a308d3ULL;
+		hash		  = mix(hash, load64(low));
+		hash		  = mix(hash, load64(low + 8));
+		hash		  = mix(hash, load64(high));
+		hash		  = mix(hash, load64(high + 8));
+		hash		  = mix(hash, low_port << 32 | high_port << 16 | key.protocol);
+
+		const uint32_t tag = static_cast<uint32_t>(hash ^ (hash >> 32));
+		return tag != 0 ? tag : 1;
+	}
+
+	inline bool isReverse(const FlowKey &key, const FlowKey &other)
+	{
+		return key.source_port == other.destination_port && key.destination_port == other.source_port
+			   && key.protocol == other.protocol
+			   && std::memcmp(key.source, other.destination, sizeof(key.source)) == 0
+			   && std::memcmp(key.destination, other.source, sizeof(key.destination)) == 0;
+	}
+} // namespace
+
+bool Flow::established() const
+{
+	if (key.protocol != k_protocol_tcp)
+	{
+		return packets[0] != 0 && packets[1] != 0;
+	}
+
+	return tcp_state == TcpState::Established || tcp_state == TcpState::FinWait || tcp_state == TcpState::Closing;
+}
+
+FlowTable::FlowTable(std::size_t max_flows) :
+	m_mask(0),
+	m_max_flows(std::max<std::size_t>(max_flows, 1)),
+	m_sweep_cursor(0),
+	m_emergency_us(0),
+	m_midstream(false)
+{
+	// Load factor stays at or below 3/4 so probe sequences remain short
+	const std::size_t capacity = std::bit_ceil(std::max(k_min_capacity, m_max_flows + m_max_flows / 3 + 1));
+
+	m_tags.assign(capacity, 0);
+	m_flows.resize(capacity);
+	m_mask = capacity - 1;
+}
+
+std::size_t FlowTable::probe(const FlowKey &key, uint32_t tag, FlowDirection &direction) const
+{
+	std::size_t slot = tag & m_mask;
+	while (m_tags[slot] != 0)
+	{
+		if (m_tags[slot] == tag)
+		{
+			const Flow &flow = m_flows[slot];
+			if (flow.key == key)
+			{
+				direction = FlowDirection::ToServer;
+				return slot;
+			}
+			if (isReverse(flow.key, key))
+			{
+				direction = FlowDirection::ToClient;
+				return slot;
+			}
+		}
+		slot = (slot + 1) & m_mask;
+	}
+	return slot;
+}
+
+bool FlowTable::idle(const Flow &flow, uint64_t timestamp_us, bool emergency) const
+{
+	if (timestamp_us <= flow.last_seen_us)
+	{
+		return false;
+	}
+
+	uint32_t timeout;
+	if (flow.key.protocol == k_protocol_tcp)
+	{
+		switch (flow.tcp_state)
+		{
+			case Flow::TcpState::Established:
+			case Flow::TcpState::FinWait:
+				timeout = emergency ? m_timeouts.emergency_established : m_timeouts.tcp_established;
+				break;
+			case Flow::TcpState::Closing:
+			case Flow::TcpState::Closed:
+				timeout = emergency ? m_timeouts.emergency_closed : m_timeouts.tcp_closed;
+				break;
+			default:
+				timeout = emergency ? m_timeouts.emergency_new : m_timeouts.tcp_new;
+				break;
+		}
+	}
+	else if (flow.established())
+	{
+		timeout = emergency ? m_timeouts.emergency_established : m_timeouts.other_established;
+	}
+	else
+	{
+		timeout = emergency ? m_timeouts.emergency_new : m_timeouts.other_new;
+	}
+
+	return timestamp_us - flow.last_seen_us > timeout * k_microseconds;
+}
+
+void FlowTable::sweep(std::size_t slots, uint64_t timestamp_us, bool emergency)
+{
+	std::size_t checked = 0;
+	while (checked < slots && m_statistics.active > 0)
+	{
+		const std::size_t slot = m_sweep_cursor;
+		if (m_tags[slot] != 0 && idle(m_flows[slot], timestamp_us, emergency))
+		{
+			if (m_eviction_handler)
+			{
+				m_eviction_handler(m_flows[slot]);
+			}
+			++m_statistics.evicted;
+
+			// Backward shifting may have moved another flow into the slot, check it again
+			erase(slot);
+			continue;
+		}
+
+		m_sweep_cursor = (slot + 1) & m_mask;
+		++checked;
+	}
+}
+
+void FlowTable::erase(std::size_t slot)
+{
+	std::size_t hole = slot;
+	std::size_t next = (hole + 1) & m_mask;
+	while (m_tags[next] != 0)
+	{
+		// A flow can fill the hole unless its home slot lies between the hole and itself
+		const std::size_t home = m_tags[next] & m_mask;
+		if (((next - home) & m_mask) >= ((next - hole) & m_mask))
+		{
+			m_tags[hole]  = m_tags[next];
+			m_flows[hole] = m_flows[next];
+			hole		  = next;
+		}
+		next = (next + 1) & m_mask;
+	}
+
+	m_tags[hole] = 0;
+	--m_statistics.active;
+}
+
+void FlowTable::track(Flow &flow, FlowDirection direction, uint8_t tcp_flags) const
+{
+	if (flow.key.protocol != k_protocol_tcp)
+	{
+		return;
+	}
+
+	if (tcp_flags & TcpRst)
+	{
+		flow.tcp_state = Flow::TcpState::Closed;
+		return;
+	}
+
+	const bool syn		 = tcp_flags & TcpSyn;
+	const bool ack		 = tcp_flags & TcpAck;
+	const bool fin		 = tcp_flags & TcpFin;
+	const bool to_server = direction == FlowDirection::ToServer;
+
+	switch (flow.tcp_state)
+	{
+		case Flow::TcpState::None:
+			if (syn && !ack && to_server)
+			{
+				flow.tcp_state = Flow::TcpState::SynSent;
+			}
+			else if (m_midstream && syn && ack)
+			{
+				flow.tcp_state = Flow::TcpState::SynReceived;
+			}
+			else if (m_midstream && ack && !syn)
+			{
+				flow.tcp_state = Flow::TcpState::Established;
+			}
+			return;
+		case Flow::TcpState::SynSent:
+			if (syn && ack && !to_server)
+			{
+				flow.tcp_state = Flow::TcpState::SynReceived;
+			}
+			return;
+		case Flow::TcpState::SynReceived:
+			if (ack && !syn && to_server)
+			{
+				flow.tcp_state = Flow::TcpState::Established;
+			}
+			return;
+		case Flow::TcpState::Closing:
+			if (ack && !fin)
+			{
+				flow.tcp_state = Flow::TcpState::Closed;
+			}
+			return;
+		case Flow::TcpState::Established:
+		case Flow::TcpState::FinWait:
+			if (fin)
+			{
+				flow.fin_seen |= 1 << static_cast<uint8_t>(direction);
+				flow.tcp_state = flow.fin_seen == 3 ? Flow::TcpState::Closing : Flow::TcpState::FinWait;
+			}
+			return;
+		case Flow::TcpState::Closed:
+			return;
+	}
+}
+
+Flow *FlowTable::update(const FlowKey &key, uint8_t tcp_flags, uint32_t payload_length, uint64_t timestamp_us,
+						FlowDirection &direction)
+{
+	// Before the lookup, erasing shifts flows around
+	sweep(k_sweep_slots, timestamp_us, false);
+
+	const uint32_t tag	 = hashKey(key);
+	std::size_t	   slot	 = probe(key, tag, direction);
+	bool		   fresh = true;
+
+	if (m_tags[slot] != 0 && idle(m_flows[slot], timestamp_us, false))
+	{
+		// A late packet of a timed out flow starts a new one in the same slot
+		if (m_eviction_handler)
+		{
+			m_eviction_handler(m_flows[slot]);
+		}
+		++m_statistics.evicted;
+		++m_statistics.created;
+		m_flows[slot] = Flow{};
+	}
+	else if (m_tags[slot] != 0)
+	{
+		fresh = false;
+	}
+	else
+	{
+		const bool full = m_statistics.active >= m_max_flows;
+		if (full && (m_statistics.emergency_sweeps == 0 || timestamp_us >= m_emergency_us + k_microseconds))
+		{
+			++m_statistics.emergency_sweeps;
+			m_emergency_us = timestamp_us;
+			sweep(m_tags.size(), timestamp_us, true);
+			slot = probe(key, tag, direction);
+		}
+		if (m_statistics.active >= m_max_flows)
+		{
+			++m_statistics.dropped;
+			return nullptr;
+		}
+
+		m_tags[slot]  = tag;
+		m_flows[slot] = Flow{};
+		++m_statistics.active;
+		++m_statistics.created;
+	}
+
+	Flow &flow = m_flows[slot];
+	if (fresh)
+	{
+		// A SYN-ACK seen first comes from the server
+		const bool from_server = (tcp_flags & (TcpSyn | TcpAck)) == (TcpSyn | TcpAck) && key.protocol == k_protocol_tcp;
+		flow.key			   = from_server ? key.reversed() : key;
+		flow.first_seen_us	   = timestamp_us;
+		direction			   = from_server ? FlowDirection::ToClient : FlowDirection::ToServer;
+	}
+
+	const auto index = static_cast<uint8_t>(direction);
+	++flow.packets[index];
+	flow.bytes[index] += payload_length;
+	flow.last_seen_us  = std::max(flow.last_seen_us, timestamp_us);
+	track(flow, direction, tcp_flags);
+	return &flow;
+}
+
+void FlowTable::expire(uint64_t timestamp_us)
+{
+	sweep(m_tags.size(), timestamp_us, false);
+}
+
+void FlowTable::clear()
+{
+	std::fill(m_tags.begin(), m_tags.end(), 0);
+	m_statistics.active = 0;
+	m_sweep_cursor		= 0;
+}
+
+void FlowTable::setTimeouts(const Timeouts &timeouts)
+{
+	m_timeouts = timeouts;
+}
+
+void FlowTable::setMidstream(bool enabled)
+{
+	m_midstream = enabled;
+}
+
+void FlowTable::setEvictionHandler(EvictionHandler handler)
+{
+	m_eviction_handler = std::move(handler);
+}
+
+std::size_t FlowTable::size() const
+{
+	return m_statistics.active;
+}
+
+std::size_t FlowTable::capacity() const
+{
+	return m_max_flows;
+}
+
+const FlowTable::Statistics &FlowTable::statistics() const
+{
+	return m_statistics;
+}
+} // namespace UTILS
@@ -0,0 +1,142 @@
+#ifndef FLOW_TABLE_HPP
+#define FLOW_TABLE_HPP
+
+#include "flow_key.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Connection tracking record, stored inline in the table.
+ */
+struct Flow
+{
+	enum class TcpState : uint8_t
+	{
+		None, // not TCP, or picked up without a handshake and midstream is off
+		SynSent,
+		SynReceived,
+		Established,
+		FinWait, // one side sent FIN
+		Closing, // both sides sent FIN
+		Closed	 // final ACK or RST
+	};
+
+	FlowKey	 key;				 // oriented client to server
+	uint64_t first_seen_us = 0;
+	uint64_t last_seen_us  = 0;
+	uint64_t packets[2]	   = {}; // indexed by FlowDirection
+	uint64_t bytes[2]	   = {}; // payload bytes
+	uint64_t flowbits	   = 0;	 // owned by the rule evaluator
+	TcpState tcp_state	   = TcpState::None;
+	uint8_t	 fin_seen	   = 0;	 // bit per FlowDirection
+
+	/**
+	 * TCP: the handshake completed and the flow is not closed yet. Other
+	 * protocols: packets were seen in both directions. This is what the
+	 * flow:established keyword tests.
+	 */
+	bool established() const;
+};
+
+/**
+ * @brief Open addressing flow table with idle eviction.
+ *
+ * Sits between the packet decoder and the rule evaluator. Both directions
+ * of a connection hash to the same slot, lookups probe linearly through a
+ * dense array of 32 bit hash tags and only touch a flow record on a tag
+ * match. Records live inline in one preallocated array, nothing is
+ * allocated per flow. Every update also sweeps a few slots for flows past
+ * their idle timeout, erasing with backward shifting so the table never
+ * fills up with tombstones. When the table is full a sweep over all slots
+ * with the shorter emergency timeouts runs before new flows are dropped,
+ * at most once per second of capture time.
+ */
+class FlowTable
+{
+public:
+	/**
+	 * Idle timeouts in seconds, Suricata's defaults.
+	 */
+	struct Timeouts
+	{
+		uint32_t tcp_new			   = 60;
+		uint32_t tcp_established	   = 600;
+		uint32_t tcp_closed			   = 60;
+		uint32_t other_new			   = 30;
+		uint32_t other_established	   = 300;
+		uint32_t emergency_new		   = 10;
+		uint32_t emergency_established = 100;
+		uint32_t emergency_closed	   = 5;
+	};
+
+	struct Statistics
+	{
+		std::size_t	active			 = 0;
+		uint64_t	created			 = 0;
+		uint64_t	evicted			 = 0; // idle timeout, including flows reused on a late packet
+		uint64_t	dropped			 = 0; // table full
+		uint64_t	emergency_sweeps = 0;
+	};
+
+	using EvictionHandler = std::function<void(const Flow &flow)>;
+
+	enum TcpFlag : uint8_t
+	{
+		TcpFin = 0x01,
+		TcpSyn = 0x02,
+		TcpRst = 0x04,
+		TcpAck = 0x10
+	};
+
+public:
+	explicit FlowTable(std::size_t max_flows);
+
+	/**
+	 * Accounts a packet to its flow, creating the flow on first sight.
+	 * tcp_flags is the raw flags byte, 0 for other protocols. Returns null
+	 * when the table is full. The pointer stays valid until the next call.
+	 */
+	Flow *update(const FlowKey &key, uint8_t tcp_flags, uint32_t payload_length, uint64_t timestamp_us,
+				 FlowDirection &direction);
+
+	/**
+	 * Evicts every flow idle at timestamp_us.
+	 */
+	void expire(uint64_t timestamp_us);
+	void clear();
+
+	void setTimeouts(const Timeouts &timeouts);
+	void setMidstream(bool enabled);
+	void setEvictionHandler(EvictionHandler handler);
+
+	std::size_t		  size() const;
+	std::size_t		  capacity() const;
+	const Statistics &statistics() const;
+
+private:
+	std::size_t probe(const FlowKey &key, uint32_t tag, FlowDirection &direction) const;
+	bool		idle(const Flow &flow, uint64_t timestamp_us, bool emergency) const;
+	void		sweep(std::size_t slots, uint64_t timestamp_us, bool emergency);
+	void		erase(std::size_t slot);
+	void		track(Flow &flow, FlowDirection direction, uint8_t tcp_flags) const;
+
+private:
+	std::vector<uint32_t> m_tags; // 0 for an empty slot, else the key hash with 0 mapped to 1
+	std::vector<Flow>	  m_flows;
+	std::size_t			  m_mask;
+	std::size_t			  m_max_flows;
+	std::size_t			  m_sweep_cursor;
+	uint64_t			  m_emergency_us; // last emergency sweep, at most one per second of capture time
+	bool				  m_midstream;
+	Timeouts			  m_timeouts;
+	EvictionHandler		  m_eviction_handler;
+	Statistics			  m_statistics;
+};
+} // namespace UTILS
+
+#endif // FLOW_TABLE_HPP
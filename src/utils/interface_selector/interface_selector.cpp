@@ -0,0 +1,344 @@
+#include "interface_selector.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <dirent.h>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+
+namespace UTILS
+{
+namespace
+{
+	const std::string k_sys_class_net = "/sys/class/net/";
+
+	constexpr unsigned k_route_flag_up		= 0x0001; // RTF_UP
+	constexpr int	   k_arp_type_loopback	= 772;	  // ARPHRD_LOOPBACK
+	constexpr int	   k_arp_type_none		= 65534;  // ARPHRD_NONE, tun and most VPN devices
+	constexpr int	   k_first_cluster_id	= 99;
+	constexpr int	   k_score_route		= 1000;
+	constexpr int	   k_score_physical		= 300;
+	constexpr int	   k_score_wireless		= 200;
+	constexpr int	   k_score_per_traffic	= 20;  // per doubling of packets seen while sampling
+	constexpr int	   k_score_speed_limit	= 100; // one point per 100 Mbit/s
+
+	const char *const k_bridge_prefixes[] = {"docker", "br-", "virbr", "lxcbr", "cni", "podman"};
+	const char *const k_tunnel_prefixes[] = {"tun", "tap", "wg", "tailscale", "zt", "ppp", "vpn", "ipsec"};
+
+	bool readLine(const std::string &path, std::string &line)
+	{
+		std::ifstream file(path);
+		return static_cast<bool>(std::getline(file, line));
+	}
+
+	template<typename T>
+	bool readNumber(const std::string &path, T &value)
+	{
+		std::string line;
+		if (!readLine(path, line))
+		{
+			return false;
+		}
+		const auto result = std::from_chars(line.data(), line.data() + line.size(), value);
+		return result.ec == std::errc();
+	}
+
+	bool exists(const std::string &path)
+	{
+		struct stat path_stat;
+		return stat(path.c_str(), &path_stat) == 0;
+	}
+
+	template<std::size_t N>
+	bool startsWithAny(const std::string &name, const char *const (&prefixes)[N])
+	{
+		return std::any_of(std::begin(prefixes), std::end(prefixes),
+						   [&](const char *prefix) { return name.rfind(prefix, 0) == 0; });
+	}
+
+	CaptureInterface::Kind detectKind(const std::string &name)
+	{
+		const std::string base = k_sys_class_net + name + "/";
+
+		int type = 0;
+		readNumber(base + "type", type);
+
+		if (type == k_arp_type_loopback)
+		{
+			return CaptureInterface::Kind::Loopback;
+		}
+		if (exists(base + "bridge") || startsWithAny(name, k_bridge_prefixes))
+		{
+			return CaptureInterface::Kind::Bridge;
+		}
+		if (type == k_arp_type_none || exists(base + "tun_flags") || startsWithAny(name, k_tunnel_prefixes))
+		{
+			return CaptureInterface::Kind::Tunnel;
+		}
+		if (exists(base + "wireless") || exists(base + "phy80211"))
+		{
+			return CaptureInterface::Kind::Wireless;
+		}
+		// Only devices backed by hardware (or a paravirtual NIC) have a device link
+		if (exists(base + "device"))
+		{
+			return CaptureInterface::Kind::Physical;
+		}
+		return CaptureInterface::Kind::Virtual;
+	}
+
+	/**
+	 * Interfaces with a default route, and the lowest metric seen for each.
+	 */
+	void readDefaultRoutes(std::vector<CaptureInterface> &interfaces)
+	{
+		const auto mark = [&](const std::string &name, uint32_t metric) {
+			for (CaptureInterface &interface : interfaces)
+			{
+				if (interface.name == name && (!interface.default_route || metric < interface.route_metric))
+				{
+					interface.default_route = true;
+					interface.route_metric	= metric;
+				}
+			}
+		};
+
+		std::ifstream ipv4("/proc/net/route");
+		std::string	  line;
+		std::getline(ipv4, line); // header
+		while (std::getline(ipv4, line))
+		{
+			std::istringstream fields(line);
+			std::string		   name, destination, gateway, mask;
+			unsigned		   flags = 0, reference = 0, use = 0;
+			uint32_t		   metric = 0;
+			fields >> name >> destination >> gateway >> std::hex >> flags >> std::dec >> reference >> use >> metric >> mask;
+			if (fields && destination == "00000000" && mask == "00000000" && (flags & k_route_flag_up) != 0)
+			{
+				mark(name, metric);
+			}
+		}
+
+		std::ifstream ipv6("/proc/net/ipv6_route");
+		while (std::getline(ipv6, line))
+		{
+			std::istringstream fields(line);
+			std::string		   destination, destination_prefix, source, source_prefix, next_hop, name;
+			uint32_t		   metric = 0;
+			unsigned		   reference = 0, use = 0, flags = 0;
+			fields >> destination >> destination_prefix >> source >> source_prefix >> next_hop >> std::hex >> metric >>
+				reference >> use >> flags >> name;
+			if (fields && destination_prefix == "00" && destination.find_first_not_of('0') == std::string::npos &&
+				(flags & k_route_flag_up) != 0 && name != "lo")
+			{
+				mark(name, metric);
+			}
+		}
+	}
+
+	int trafficScore(uint64_t packets)
+	{
+		return packets == 0 ? 0 : k_score_per_traffic * static_cast<int>(std::log2(static_cast<double>(packets)) + 1);
+	}
+} // namespace
+
+bool CaptureInterface::isUsable() const
+{
+	// Virtual devices often report "unknown" instead of "up"
+	return kind != Kind::Loopback && carrier && operstate != "down" && operstate != "notpresent" &&
+		   operstate != "lowerlayerdown";
+}
+
+std::vector<CaptureInterface> InterfaceSelector::enumerate()
+{
+	std::vector<CaptureInterface> interfaces;
+
+	DIR *directory = opendir(k_sys_class_net.c_str());
+	if (directory == nullptr)
+	{
+		return interfaces;
+	}
+
+	while (const dirent *entry = readdir(directory))
+	{
+		const std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+
+		const std::string base = k_sys_class_net + name + "/";
+
+		CaptureInterface interface;
+		interface.name = name;
+		interface.kind = detectKind(name);
+		readLine(base + "operstate", interface.operstate);
+
+		// Reading carrier of a down interface fails with EINVAL
+		int carrier = 0;
+		interface.carrier = readNumber(base + "carrier", carrier) && carrier == 1;
+
+		int speed = -1;
+		if (readNumber(base + "speed", speed) && speed > 0)
+		{
+			interface.speed_mbps = speed;
+		}
+
+		readNumber(base + "statistics/rx_packets", interface.rx_packets);
+		interfaces.push_back(std::move(interface));
+	}
+	closedir(directory);
+
+	readDefaultRoutes(interfaces);
+	return interfaces;
+}
+
+void InterfaceSelector::sample(std::vector<CaptureInterface> &interfaces, std::chrono::milliseconds window)
+{
+	for (CaptureInterface &interface : interfaces)
+	{
+		readNumber(k_sys_class_net + interface.name + "/statistics/rx_packets", interface.rx_packets);
+	}
+
+	std::this_thread::sleep_for(window);
+
+	for (CaptureInterface &interface : interfaces)
+	{
+		uint64_t packets = interface.rx_packets;
+		readNumber(k_sys_class_net + interface.name + "/statistics/rx_packets", packets);
+		interface.rx_delta	 = packets >= interface.rx_packets ? packets - interface.rx_packets : 0;
+		interface.rx_packets = packets;
+	}
+}
+
+void InterfaceSelector::rank(std::vector<CaptureInterface> &interfaces)
+{
+	for (CaptureInterface &interface : interfaces)
+	{
+		int score = 0;
+		if (interface.default_route)
+		{
+			score += k_score_route;
+		}
+		if (interface.kind == CaptureInterface::Kind::Physical)
+		{
+			score += k_score_physical;
+		}
+		else if (interface.kind == CaptureInterface::Kind::Wireless)
+		{
+			score += k_score_wireless;
+		}
+		score += trafficScore(interface.rx_delta);
+		if (interface.speed_mbps > 0)
+		{
+			score += std::min(interface.speed_mbps / 100, k_score_speed_limit);
+		}
+
+		interface.score = interface.isUsable() ? score : -1;
+	}
+
+	std::stable_sort(interfaces.begin(), interfaces.end(), [](const CaptureInterface &left, const CaptureInterface &right) {
+		if (left.score != right.score)
+		{
+			return left.score > right.score;
+		}
+		if (left.default_route && right.default_route && left.route_metric != right.route_metric)
+		{
+			return left.route_metric < right.route_metric;
+		}
+		return left.name < right.name;
+	});
+}
+
+std::vector<CaptureInterface> InterfaceSelector::rankedInterfaces(std::chrono::milliseconds window)
+{
+	std::vector<CaptureInterface> interfaces = enumerate();
+	if (window.count() > 0)
+	{
+		sample(interfaces, window);
+	}
+	rank(interfaces);
+	return interfaces;
+}
+
+std::string InterfaceSelector::afPacketOverlay(const std::vector<std::string>					   &names,
+											   const std::vector<SuricataConfig::AfPacketInterface> &configured)
+{
+	const SuricataConfig::AfPacketInterface *fallback = nullptr;
+	std::set<int>							 used_cluster_ids;
+	for (const SuricataConfig::AfPacketInterface &entry : configured)
+	{
+		if (entry.interface == "default")
+		{
+			fallback = &entry;
+		}
+		int cluster_id = 0;
+		if (std::from_chars(entry.cluster_id.data(), entry.cluster_id.data() + entry.cluster_id.size(), cluster_id).ec ==
+			std::errc())
+		{
+			used_cluster_ids.insert(cluster_id);
+		}
+	}
+
+	std::ostringstream overlay;
+	overlay << "%YAML 1.1\n---\n";
+	overlay << "af-packet:\n";
+
+	int next_cluster_id = k_first_cluster_id;
+	for (const std::string &name : names)
+	{
+		const auto match = std::find_if(configured.begin(), configured.end(), [&](const auto &entry) {
+			return entry.interface == name;
+		});
+		const SuricataConfig::AfPacketInterface *source = match != configured.end() ? &*match : fallback;
+
+		// Every interface needs its own fanout group, sharing one would merge their traffic
+		std::string cluster_id = match != configured.end() ? match->cluster_id : std::string();
+		if (cluster_id.empty())
+		{
+			while (used_cluster_ids.count(next_cluster_id) != 0)
+			{
+				--next_cluster_id;
+			}
+			used_cluster_ids.insert(next_cluster_id);
+			cluster_id = std::to_string(next_cluster_id);
+		}
+
+		overlay << "  - interface: " << name << "\n";
+		overlay << "    cluster-id: " << cluster_id << "\n";
+		overlay << "    cluster-type: "
+				<< (source != nullptr && !source->cluster_type.empty() ? source->cluster_type : "cluster_flow") << "\n";
+		if (source != nullptr && !source->threads.empty())
+		{
+			overlay << "    threads: " << source->threads << "\n";
+		}
+		overlay << "    defrag: yes\n";
+	}
+
+	return overlay.str();
+}
+
+const char *InterfaceSelector::kindName(CaptureInterface::Kind kind)
+{
+	switch (kind)
+	{
+		case CaptureInterface::Kind::Physical:
+			return "physical";
+		case CaptureInterface::Kind::Wireless:
+			return "wireless";
+		case CaptureInterface::Kind::Bridge:
+			return "bridge";
+		case CaptureInterface::Kind::Tunnel:
+			return "tunnel";
+		case CaptureInterface::Kind::Virtual:
+			return "virtual";
+		case CaptureInterface::Kind::Loopback:
+			return "loopback";
+	}
+	return "unknown";
+}
+} // namespace UTILS
@@ -0,0 +1,74 @@
+#ifndef INTERFACE_SELECTOR_HPP
+#define INTERFACE_SELECTOR_HPP
+
+#include "suricata_config.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief State of one network interface as seen in /sys/class/net.
+ */
+struct CaptureInterface
+{
+	enum class Kind
+	{
+		Physical,
+		Wireless,
+		Bridge,	 // docker0, br-*, virbr*
+		Tunnel,	 // tun/tap, wireguard, VPN clients
+		Virtual, // veth, dummy, ifb and other software devices
+		Loopback
+	};
+
+	std::string name;
+	Kind		kind		  = Kind::Virtual;
+	std::string operstate;
+	bool		carrier		  = false;
+	int			speed_mbps	  = -1; // -1 when the driver does not report it
+	bool		default_route = false;
+	uint32_t	route_metric  = 0;
+	uint64_t	rx_packets	  = 0;
+	uint64_t	rx_delta	  = 0; // packets received during the sampling window
+	int			score		  = 0;
+
+	bool isUsable() const;
+};
+
+/**
+ * @brief Picks the interfaces worth capturing on.
+ *
+ * Candidates are ranked by, in order of weight: carrying the default route
+ * (IPv4 or IPv6), being backed by a real device rather than a bridge or
+ * tunnel, traffic seen during a short rx_packets sampling window, and link
+ * speed. Down, carrier-less and loopback interfaces are never usable.
+ */
+class InterfaceSelector
+{
+public:
+	static std::vector<CaptureInterface> enumerate();
+	static void							 sample(std::vector<CaptureInterface> &interfaces, std::chrono::milliseconds window);
+	static void							 rank(std::vector<CaptureInterface> &interfaces);
+
+	/**
+	 * enumerate() + sample() + rank(), best candidate first.
+	 */
+	static std::vector<CaptureInterface> rankedInterfaces(std::chrono::milliseconds window);
+
+	/**
+	 * Suricata config overlay with one af-packet entry per interface, for
+	 * `--include`. Settings of matching (or the `default`) entries of the
+	 * original config are carried over, cluster ids are kept unique.
+	 */
+	static std::string afPacketOverlay(const std::vector<std::string>					   &names,
+									   const std::vector<SuricataConfig::AfPacketInterface> &configured);
+
+	static const char *kindName(CaptureInterface::Kind kind);
+};
+} // namespace UTILS
+
+#endif // INTERFACE_SELECTOR_HPP
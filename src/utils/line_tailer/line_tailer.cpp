@@ -0,0 +1,220 @@
+#include "line_tailer.hpp"
+
+#include "byte_scanner.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_initial_buffer_size = 256 * 1024;
+
+	bool isBlank(std::string_view line)
+	{
+		for (const char c : line)
+		{
+			if (c != ' ' && c != '\t' && c != '\r')
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+LineTailer::LineTailer(std::string path) :
+	m_path(std::move(path)),
+	m_fd(-1),
+	m_device(0),
+	m_inode(0),
+	m_offset(0),
+	m_buffer(k_initial_buffer_size),
+	m_pending(0)
+{}
+
+LineTailer::~LineTailer()
+{
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+	}
+}
+
+std::size_t LineTailer::poll(const LineCallback &callback)
+{
+	if (m_fd < 0 && !reopen())
+	{
+		return 0;
+	}
+
+	std::size_t lines = 0;
+
+	struct stat path_stat;
+	if (stat(m_path.c_str(), &path_stat) != 0)
+	{
+		// Rotated away and not recreated yet, whatever is left in the old file still counts
+		return drain(callback);
+	}
+
+	if (path_stat.st_ino != m_inode || path_stat.st_dev != m_device)
+	{
+		lines += drain(callback);
+		m_statistics.rotations++;
+		if (!reopen())
+		{
+			return lines;
+		}
+	}
+	else
+	{
+		struct stat fd_stat;
+		if (fstat(m_fd, &fd_stat) == 0 && static_cast<uint64_t>(fd_stat.st_size) < m_offset)
+		{
+			m_statistics.truncations++;
+			m_offset  = 0;
+			m_pending = 0;
+		}
+	}
+
+	return lines + drain(callback);
+}
+
+void LineTailer::seekToEnd()
+{
+	if (m_fd < 0 && !reopen())
+	{
+		return;
+	}
+
+	struct stat fd_stat;
+	if (fstat(m_fd, &fd_stat) == 0)
+	{
+		m_offset = static_cast<uint64_t>(fd_stat.st_size);
+	}
+	m_pending = 0;
+}
+
+void LineTailer::reset()
+{
+	m_offset  = 0;
+	m_pending = 0;
+}
+
+const std::string &LineTailer::path() const
+{
+	return m_path;
+}
+
+uint64_t LineTailer::offset() const
+{
+	return m_offset;
+}
+
+const LineTailer::Statistics &LineTailer::statistics() const
+{
+	return m_statistics;
+}
+
+bool LineTailer::reopen()
+{
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+
+	m_offset  = 0;
+	m_pending = 0;
+
+	const int fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat fd_stat;
+	if (fstat(fd, &fd_stat) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	m_fd	 = fd;
+	m_device = fd_stat.st_dev;
+	m_inode	 = fd_stat.st_ino;
+	return true;
+}
+
+std::size_t LineTailer::drain(const LineCallback &callback)
+{
+	std::size_t lines = 0;
+
+	while (true)
+	{
+		// A single line longer than the buffer grows it, otherwise it is reused as is
+		if (m_pending == m_buffer.size())
+		{
+			m_buffer.resize(m_buffer.size() * 2);
+		}
+
+		const ssize_t length = pread(m_fd, m_buffer.data() + m_pending, m_buffer.size() - m_pending,
+									 static_cast<off_t>(m_offset));
+		if (length <= 0)
+		{
+			break;
+		}
+
+		m_offset			+= static_cast<uint64_t>(length);
+		m_pending			+= static_cast<std::size_t>(length);
+		m_statistics.bytes	+= static_cast<uint64_t>(length);
+
+		lines += consumeLines(callback);
+	}
+
+	return lines;
+}
+
+std::size_t LineTailer::consumeLines(const LineCallback &callback)
+{
+	std::size_t lines  = 0;
+	const char *begin  = m_buffer.data();
+	const char *end	   = begin + m_pending;
+	const char *cursor = begin;
+
+	while (cursor < end)
+	{
+		const char *newline = ByteScanner::findByte(cursor, end, '\n');
+		if (newline == end)
+		{
+			break;
+		}
+
+		const std::string_view line(cursor, static_cast<std::size_t>(newline - cursor));
+		cursor = newline + 1;
+
+		if (isBlank(line))
+		{
+			continue;
+		}
+
+		m_statistics.lines++;
+		lines++;
+		if (callback)
+		{
+			callback(line);
+		}
+	}
+
+	m_pending = static_cast<std::size_t>(end - cursor);
+	if (m_pending > 0 && cursor != begin)
+	{
+		std::memmove(m_buffer.data(), cursor, m_pending);
+	}
+
+	return lines;
+}
+} // namespace UTILS
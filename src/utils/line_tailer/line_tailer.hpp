@@ -0,0 +1,68 @@
+#ifndef LINE_TAILER_HPP
+#define LINE_TAILER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Incremental line reader of a growing log file.
+ *
+ * Each poll() preads everything appended since the saved offset and hands
+ * complete lines to the callback as views into the read buffer, valid only
+ * inside the callback. An incomplete last line is kept for the next poll.
+ * Truncation restarts from the beginning, while rotation (a new inode behind
+ * the path) first drains the old file.
+ */
+class LineTailer
+{
+public:
+	using LineCallback = std::function<void(std::string_view line)>;
+
+	struct Statistics
+	{
+		uint64_t bytes		 = 0;
+		uint64_t lines		 = 0;
+		uint64_t truncations = 0;
+		uint64_t rotations	 = 0;
+	};
+
+public:
+	explicit LineTailer(std::string path);
+	~LineTailer();
+
+	LineTailer(const LineTailer &)			  = delete;
+	LineTailer &operator=(const LineTailer &) = delete;
+
+	std::size_t poll(const LineCallback &callback);
+
+	void seekToEnd();
+	void reset();
+
+	const std::string &path() const;
+	uint64_t		   offset() const;
+	const Statistics  &statistics() const;
+
+private:
+	bool		reopen();
+	std::size_t drain(const LineCallback &callback);
+	std::size_t consumeLines(const LineCallback &callback);
+
+private:
+	std::string		  m_path;
+	int				  m_fd;
+	dev_t			  m_device;
+	ino_t			  m_inode;
+	uint64_t		  m_offset;
+	std::vector<char> m_buffer;
+	std::size_t		  m_pending;
+	Statistics		  m_statistics;
+};
+} // namespace UTILS
+
+#endif // LINE_TAILER_HPP
@@ -0,0 +1,142 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace UTILS
+{
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_open(false), m_error(0)
+{}
+
+MappedFile::MappedFile(const std::string &path) : MappedFile()
+{
+	open(path);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+	m_data(std::exchange(other.m_data, nullptr)),
+	m_size(std::exchange(other.m_size, 0)),
+	m_open(std::exchange(other.m_open, false)),
+	m_error(std::exchange(other.m_error, 0))
+{}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this != &other)
+	{
+		close();
+		m_data	= std::exchange(other.m_data, nullptr);
+		m_size	= std::exchange(other.m_size, 0);
+		m_open	= std::exchange(other.m_open, false);
+		m_error = std::exchange(other.m_error, 0);
+	}
+	return *this;
+}
+
+bool MappedFile::open(const std::string &path)
+{
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		m_error = errno;
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode))
+	{
+		m_error = errno != 0 ? errno : EINVAL;
+		::close(fd);
+		return false;
+	}
+
+	if (file_stat.st_size > 0)
+	{
+		void *data = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			m_error = errno;
+			::close(fd);
+			return false;
+		}
+
+		m_data = data;
+		m_size = static_cast<std::size_t>(file_stat.st_size);
+	}
+
+	::close(fd);
+
+	m_open	= true;
+	m_error = 0;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data != nullptr)
+	{
+		munmap(m_data, m_size);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
+
+bool MappedFile::isOpen() const
+{
+	return m_open;
+}
+
+int MappedFile::error() const
+{
+	return m_error;
+}
+
+const char *MappedFile::data() const
+{
+	return static_cast<const char *>(m_data);
+}
+
+std::size_t MappedFile::size() const
+{
+	return m_size;
+}
+
+std::string_view MappedFile::view() const
+{
+	return std::string_view(data(), m_size);
+}
+
+bool MappedFile::advise(int advice) const
+{
+	return m_data == nullptr || madvise(m_data, m_size, advice) == 0;
+}
+
+bool MappedFile::advise(int advice, std::size_t offset, std::size_t length) const
+{
+	if (m_data == nullptr || offset >= m_size)
+	{
+		return true;
+	}
+
+	// madvise wants a page aligned start address
+	const std::size_t page_size	  = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t aligned	  = offset - offset % page_size;
+	const std::size_t clamped_end = std::min(m_size, offset + length);
+
+	return madvise(static_cast<char *>(m_data) + aligned, clamped_end - aligned, advice) == 0;
+}
+} // namespace UTILS
@@ -0,0 +1,52 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace UTILS
+{
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Empty files are valid and yield an empty view without a mapping.
+ */
+class MappedFile
+{
+public:
+	MappedFile();
+	explicit MappedFile(const std::string &path);
+	~MappedFile();
+
+	MappedFile(MappedFile &&other) noexcept;
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	MappedFile(const MappedFile &)			  = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	bool open(const std::string &path);
+	void close();
+
+	bool		isOpen() const;
+	int			error() const;
+	const char *data() const;
+	std::size_t size() const;
+
+	std::string_view view() const;
+
+	/**
+	 * madvise() over the whole mapping, or over [offset, offset + length).
+	 */
+	bool advise(int advice) const;
+	bool advise(int advice, std::size_t offset, std::size_t length) const;
+
+private:
+	void		*m_data;
+	std::size_t m_size;
+	bool		m_open;
+	int			m_error;
+};
+} // namespace UTILS
+
+#endif // MAPPED_FILE_HPP
@@ -0,0 +1,212 @@
+#include "net_checksum.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NET_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_vector_threshold = 64;	  // shorter blocks, such as headers, stay on the scalar loop
+	constexpr std::size_t k_vector_steps	 = 16384; // 32 bit lanes gain at most 2 * 0xffff per step
+
+	/**
+	 * Sums the block up to a multiple of the vector width into sum, returns
+	 * the first byte left over.
+	 */
+	using SumWords = const uint8_t *(*)(const uint8_t *, const uint8_t *, uint64_t &);
+
+	const uint8_t *sumWordsScalar(const uint8_t *begin, const uint8_t *end, uint64_t &sum)
+	{
+		for (; end - begin >= 8; begin += 8)
+		{
+			uint64_t chunk;
+			std::memcpy(&chunk, begin, sizeof(chunk));
+			sum += (chunk & 0xffffffffu) + (chunk >> 32);
+		}
+		return begin;
+	}
+
+#ifdef NET_CHECKSUM_X86
+	__attribute__((target("sse2"))) const uint8_t *sumWordsSse2(const uint8_t *begin, const uint8_t *end, uint64_t &sum)
+	{
+		const __m128i zero		= _mm_setzero_si128();
+		const __m128i low_words	= _mm_set1_epi32(0xffff);
+		__m128i		  total		= _mm_setzero_si128();
+
+		while (end - begin >= 16)
+		{
+			const uint8_t *stop	   = begin + std::min<std::size_t>((end - begin) / 16, k_vector_steps) * 16;
+			__m128i		   partial = _mm_setzero_si128();
+			for (; begin < stop; begin += 16)
+			{
+				const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+				partial = _mm_add_epi32(partial, _mm_add_epi32(_mm_and_si128(chunk, low_words), _mm_srli_epi32(chunk, 16)));
+			}
+			total = _mm_add_epi64(total, _mm_add_epi64(_mm_unpacklo_epi32(partial, zero), _mm_unpackhi_epi32(partial, zero)));
+		}
+
+		uint64_t lanes[2];
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), total);
+		sum += lanes[0] + lanes[1];
+		return begin;
+	}
+
+	__attribute__((target("avx2"))) const uint8_t *sumWordsAvx2(const uint8_t *begin, const uint8_t *end, uint64_t &sum)
+	{
+		const __m256i zero		= _mm256_setzero_si256();
+		const __m256i low_words	= _mm256_set1_epi32(0xffff);
+		__m256i		  total		= _mm256_setzero_si256();
+
+		while (end - begin >= 32)
+		{
+			const uint8_t *stop	   = begin + std::min<std::size_t>((end - begin) / 32, k_vector_steps) * 32;
+			__m256i		   partial = _mm256_setzero_si256();
+			for (; begin < stop; begin += 32)
+			{
+				const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+				partial				= _mm256_add_epi32(
+					partial, _mm256_add_epi32(_mm256_and_si256(chunk, low_words), _mm256_srli_epi32(chunk, 16)));
+			}
+			total = _mm256_add_epi64(
+				total, _mm256_add_epi64(_mm256_unpacklo_epi32(partial, zero), _mm256_unpackhi_epi32(partial, zero)));
+		}
+
+		uint64_t lanes[4];
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(lanes), total);
+		sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+		// The tail stays in VEX encoded code, see ByteScanner
+		for (; end - begin >= 8; begin += 8)
+		{
+			uint64_t chunk;
+			std::memcpy(&chunk, begin, sizeof(chunk));
+			sum += (chunk & 0xffffffffu) + (chunk >> 32);
+		}
+		return begin;
+	}
+#endif
+
+	struct Implementation
+	{
+		SumWords	sum_words;
+		const char *name;
+	};
+
+	Implementation resolveImplementation()
+	{
+#ifdef NET_CHECKSUM_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return {sumWordsAvx2, "avx2"};
+		}
+		if (__builtin_cpu_supports("sse2"))
+		{
+			return {sumWordsSse2, "sse2"};
+		}
+#endif
+		return {sumWordsScalar, "scalar"};
+	}
+
+	const Implementation &implementation()
+	{
+		static const Implementation resolved = resolveImplementation();
+		return resolved;
+	}
+} // namespace
+
+InternetChecksum::InternetChecksum() :
+	m_sum(0)
+{}
+
+void InternetChecksum::add(const void *data, std::size_t length)
+{
+	const auto *bytes = static_cast<const uint8_t *>(data);
+
+	if (length >= k_vector_threshold)
+	{
+		const uint8_t *rest	 = implementation().sum_words(bytes, bytes + length, m_sum);
+		length				-= static_cast<std::size_t>(rest - bytes);
+		bytes				 = rest;
+	}
+
+	// Eight bytes per step, folded into 32 bit halves so the 64 bit sum cannot overflow
+	while (length >= 8)
+	{
+		uint64_t chunk;
+		std::memcpy(&chunk, bytes, sizeof(chunk));
+		m_sum  += (chunk & 0xffffffffu) + (chunk >> 32);
+		bytes  += 8;
+		length -= 8;
+	}
+
+	while (length >= 2)
+	{
+		uint16_t word;
+		std::memcpy(&word, bytes, sizeof(word));
+		m_sum  += word;
+		bytes  += 2;
+		length -= 2;
+	}
+
+	if (length == 1)
+	{
+		const uint8_t tail[2] = {bytes[0], 0};
+		uint16_t	  word;
+		std::memcpy(&word, tail, sizeof(word));
+		m_sum += word;
+	}
+}
+
+void InternetChecksum::addBigEndian16(uint16_t value)
+{
+	const uint8_t bytes[2] = {static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+	add(bytes, sizeof(bytes));
+}
+
+void InternetChecksum::addBigEndian32(uint32_t value)
+{
+	const uint8_t bytes[4] = {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+							  static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+	add(bytes, sizeof(bytes));
+}
+
+uint16_t InternetChecksum::finish() const
+{
+	uint64_t sum = m_sum;
+	while (sum >> 16)
+	{
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+	return static_cast<uint16_t>(~sum);
+}
+
+uint16_t InternetChecksum::compute(const void *data, std::size_t length)
+{
+	InternetChecksum checksum;
+	checksum.add(data, length);
+	return checksum.finish();
+}
+
+uint16_t InternetChecksum::ipv4Transport(uint32_t source, uint32_t destination, uint8_t protocol, const void *segment,
+										 std::size_t length)
+{
+	InternetChecksum checksum;
+	checksum.addBigEndian32(source);
+	checksum.addBigEndian32(destination);
+	checksum.addBigEndian16(protocol);
+	checksum.addBigEndian16(static_cast<uint16_t>(length));
+	checksum.add(segment, length);
+	return checksum.finish();
+}
+const char *InternetChecksum::instructionSet()
+{
+	return implementation().name;
+}
+} // namespace UTILS
@@ -0,0 +1,45 @@
+#ifndef NET_CHECKSUM_HPP
+#define NET_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace UTILS
+{
+/**
+ * @brief RFC 1071 internet checksum.
+ *
+ * Words are summed in host byte order, which the ones' complement sum allows,
+ * so the result is already in the byte order of the packet: store it with
+ * memcpy, not htons. Only the last block added may have an odd length.
+ * Blocks of 64 bytes and more are summed with AVX2 or SSE2 when the CPU
+ * has them.
+ */
+class InternetChecksum
+{
+public:
+	InternetChecksum();
+
+	void add(const void *data, std::size_t length);
+	void addBigEndian16(uint16_t value);
+	void addBigEndian32(uint32_t value);
+
+	uint16_t finish() const;
+
+	static uint16_t compute(const void *data, std::size_t length);
+
+	/**
+	 * TCP/UDP checksum over the IPv4 pseudo header and the segment, whose
+	 * checksum field must be zero. Addresses are in host byte order.
+	 */
+	static uint16_t ipv4Transport(uint32_t source, uint32_t destination, uint8_t protocol, const void *segment,
+								  std::size_t length);
+
+	static const char *instructionSet();
+
+private:
+	uint64_t m_sum;
+};
+} // namespace UTILS
+
+#endif // NET_CHECKSUM_HPP
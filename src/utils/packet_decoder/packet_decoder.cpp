@@ -0,0 +1,479 @@
+#include "packet_decoder.hpp"
+
+#include <cstring>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint16_t k_ether_ipv4		= 0x0800;
+	constexpr uint16_t k_ether_ipv6		= 0x86dd;
+	constexpr uint16_t k_ether_vlan		= 0x8100;
+	constexpr uint16_t k_ether_qinq		= 0x88a8;
+	constexpr uint16_t k_ether_qinq_old	= 0x9100;
+
+	constexpr uint8_t k_protocol_icmp	   = 1;
+	constexpr uint8_t k_protocol_tcp	   = 6;
+	constexpr uint8_t k_protocol_udp	   = 17;
+	constexpr uint8_t k_protocol_icmpv6	   = 58;
+	constexpr uint8_t k_ipv6_hop_by_hop	   = 0;
+	constexpr uint8_t k_ipv6_routing	   = 43;
+	constexpr uint8_t k_ipv6_fragment	   = 44;
+	constexpr uint8_t k_ipv6_auth		   = 51;
+	constexpr uint8_t k_ipv6_no_next	   = 59;
+	constexpr uint8_t k_ipv6_destination   = 60;
+	constexpr uint8_t k_ipv6_mobility	   = 135;
+	constexpr uint8_t k_ipv6_host_identity = 139;
+	constexpr uint8_t k_ipv6_shim6		   = 140;
+
+	constexpr std::size_t k_max_vlan_tags		= 8;
+	constexpr std::size_t k_max_ipv6_extensions	= 8;
+	constexpr std::size_t k_ethernet_header		= 14;
+	constexpr std::size_t k_vlan_tag			= 4;
+	constexpr std::size_t k_null_header			= 4;
+	constexpr std::size_t k_sll_header			= 16;
+	constexpr std::size_t k_sll2_header			= 20;
+	constexpr std::size_t k_ipv4_header			= 20;
+	constexpr std::size_t k_ipv6_header			= 40;
+	constexpr std::size_t k_tcp_header			= 20;
+	constexpr std::size_t k_udp_header			= 8;
+	constexpr std::size_t k_icmp_header			= 8;
+
+	inline uint16_t be16(const uint8_t *data)
+	{
+		return static_cast<uint16_t>(data[0] << 8 | data[1]);
+	}
+
+	inline uint32_t be32(const uint8_t *data)
+	{
+		return uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 | uint32_t(data[2]) << 8 | data[3];
+	}
+
+	inline bool isEcho(uint8_t protocol, uint8_t type)
+	{
+		return protocol == k_protocol_icmp ? type == 0 || type == 8 : type == 128 || type == 129;
+	}
+
+	inline bool isVlan(uint16_t ether_type)
+	{
+		return ether_type == k_ether_vlan || ether_type == k_ether_qinq || ether_type == k_ether_qinq_old;
+	}
+} // namespace
+
+PacketDecoder::PacketDecoder() :
+	m_verify_checksums(true)
+{}
+
+DecodedPacket::Status PacketDecoder::decode(const uint8_t *data, std::size_t length, uint32_t link_type,
+											DecodedPacket &packet)
+{
+	packet = DecodedPacket{};
+
+	const DecodedPacket::Status status = decodeLink(data, length, link_type, packet);
+	packet.status					   = status;
+
+	++m_statistics.packets;
+	m_statistics.bytes += length;
+	switch (status)
+	{
+		case DecodedPacket::Status::Ok:
+			++m_statistics.ok;
+			break;
+		case DecodedPacket::Status::Truncated:
+			++m_statistics.truncated;
+			break;
+		case DecodedPacket::Status::Unsupported:
+			++m_statistics.unsupported;
+			break;
+		case DecodedPacket::Status::Malformed:
+			++m_statistics.malformed;
+			break;
+	}
+	if (packet.flags & (DecodedPacket::BadIpChecksum | DecodedPacket::BadL4Checksum))
+	{
+		++m_statistics.bad_checksums;
+	}
+	return status;
+}
+
+DecodedPacket::Status PacketDecoder::decodeLink(const uint8_t *data, std::size_t length, uint32_t link_type,
+												DecodedPacket &packet) const
+{
+	std::size_t offset;
+	uint16_t	ether_type;
+
+	switch (link_type)
+	{
+		case d_link_type_ethernet:
+			if (length < k_ethernet_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+
+			offset	   = k_ethernet_header;
+			ether_type = be16(data + 12);
+			while (isVlan(ether_type))
+			{
+				if (packet.vlan_count == k_max_vlan_tags)
+				{
+					packet.flags |= DecodedPacket::VlanStackTooDeep;
+					return DecodedPacket::Status::Unsupported;
+				}
+				if (length - offset < k_vlan_tag)
+				{
+					return DecodedPacket::Status::Truncated;
+				}
+
+				packet.vlan	= be16(data + offset) & 0x0fff;
+				ether_type	= be16(data + offset + 2);
+				offset	   += k_vlan_tag;
+				++packet.vlan_count;
+			}
+			break;
+		case d_link_type_linux_sll:
+			if (length < k_sll_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+			offset	   = k_sll_header;
+			ether_type = be16(data + 14);
+			break;
+		case d_link_type_linux_sll2:
+			if (length < k_sll2_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+			offset	   = k_sll2_header;
+			ether_type = be16(data);
+			break;
+		case d_link_type_null:
+		{
+			if (length < k_null_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+
+			// Address family in the byte order of the capturing host, AF_INET is 2 everywhere,
+			// AF_INET6 is 24, 28 or 30 depending on the BSD
+			const uint8_t family = data[0] != 0 ? data[0] : data[3];
+			offset				 = k_null_header;
+			ether_type			 = family == 2 ? k_ether_ipv4 : k_ether_ipv6;
+			if (family != 2 && family != 24 && family != 28 && family != 30)
+			{
+				return DecodedPacket::Status::Unsupported;
+			}
+			break;
+		}
+		case d_link_type_raw:
+		case 12: // DLT_RAW on most BSDs
+		case 14: // DLT_RAW on OpenBSD
+			if (length == 0)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+			offset	   = 0;
+			ether_type = (data[0] >> 4) == 6 ? k_ether_ipv6 : k_ether_ipv4;
+			break;
+		default:
+			return DecodedPacket::Status::Unsupported;
+	}
+
+	if (ether_type == k_ether_ipv4)
+	{
+		return decodeIpv4(data, length, offset, packet);
+	}
+	if (ether_type == k_ether_ipv6)
+	{
+		return decodeIpv6(data, length, offset, packet);
+	}
+	return DecodedPacket::Status::Unsupported;
+}
+
+DecodedPacket::Status PacketDecoder::decodeIpv4(const uint8_t *data, std::size_t length, std::size_t offset,
+												DecodedPacket &packet) const
+{
+	if (length - offset < k_ipv4_header)
+	{
+		return DecodedPacket::Status::Truncated;
+	}
+
+	const uint8_t	 *ip			= data + offset;
+	const std::size_t header_length = std::size_t(ip[0] & 0x0f) * 4;
+	const std::size_t total_length	= be16(ip + 2);
+	if ((ip[0] >> 4) != 4 || header_length < k_ipv4_header || total_length < header_length)
+	{
+		return DecodedPacket::Status::Malformed;
+	}
+	if (header_length > length - offset)
+	{
+		return DecodedPacket::Status::Truncated;
+	}
+
+	packet.ip_version		   = 4;
+	packet.ttl				   = ip[8];
+	packet.l3_offset		   = static_cast<uint16_t>(offset);
+	packet.key.protocol		   = ip[9];
+	packet.key.source[10]	   = packet.key.source[11] = 0xff;
+	packet.key.destination[10] = packet.key.destination[11] = 0xff;
+	std::memcpy(packet.key.source + 12, ip + 12, 4);
+	std::memcpy(packet.key.destination + 12, ip + 16, 4);
+
+	if (m_verify_checksums && InternetChecksum::compute(ip, header_length) != 0)
+	{
+		packet.flags |= DecodedPacket::BadIpChecksum;
+	}
+
+	const uint16_t fragment = be16(ip + 6);
+	if (fragment & 0x3fff)
+	{
+		packet.flags |= DecodedPacket::Fragment;
+	}
+
+	// Ethernet pads short frames, the IP length decides where the segment ends
+	const std::size_t end		   = offset + total_length;
+	std::size_t		  captured_end = end;
+	if (end > length)
+	{
+		packet.flags |= DecodedPacket::ShortCapture;
+		captured_end  = length;
+	}
+
+	if (fragment & 0x1fff)
+	{
+		return DecodedPacket::Status::Ok;
+	}
+
+	InternetChecksum pseudo;
+	pseudo.add(ip + 12, 8);
+	pseudo.addBigEndian16(packet.key.protocol);
+	return decodeTransport(data, offset + header_length, captured_end, end, packet.key.protocol, pseudo, packet);
+}
+
+DecodedPacket::Status PacketDecoder::decodeIpv6(const uint8_t *data, std::size_t length, std::size_t offset,
+												DecodedPacket &packet) const
+{
+	if (length - offset < k_ipv6_header)
+	{
+		return DecodedPacket::Status::Truncated;
+	}
+
+	const uint8_t *ip = data + offset;
+	if ((ip[0] >> 4) != 6)
+	{
+		return DecodedPacket::Status::Malformed;
+	}
+
+	packet.ip_version = 6;
+	packet.ttl		  = ip[7];
+	packet.l3_offset  = static_cast<uint16_t>(offset);
+	std::memcpy(packet.key.source, ip + 8, 16);
+	std::memcpy(packet.key.destination, ip + 24, 16);
+
+	// A zero payload length with a hop-by-hop header is a jumbogram, its length is in an option
+	const std::size_t payload_length = be16(ip + 4);
+	std::size_t		  end			 = offset + k_ipv6_header + payload_length;
+	if (payload_length == 0 && ip[6] == k_ipv6_hop_by_hop)
+	{
+		end = length;
+	}
+
+	std::size_t captured_end = end;
+	if (end > length)
+	{
+		packet.flags |= DecodedPacket::ShortCapture;
+		captured_end  = length;
+	}
+
+	uint8_t		next	 = ip[6];
+	std::size_t position = offset + k_ipv6_header;
+	for (std::size_t extensions = 0;; ++extensions)
+	{
+		std::size_t header_length;
+		switch (next)
+		{
+			case k_ipv6_hop_by_hop:
+			case k_ipv6_routing:
+			case k_ipv6_destination:
+			case k_ipv6_mobility:
+			case k_ipv6_host_identity:
+			case k_ipv6_shim6:
+				if (position + 2 > captured_end)
+				{
+					return DecodedPacket::Status::Truncated;
+				}
+				header_length = (std::size_t(data[position + 1]) + 1) * 8;
+				break;
+			case k_ipv6_auth:
+				if (position + 2 > captured_end)
+				{
+					return DecodedPacket::Status::Truncated;
+				}
+				header_length = (std::size_t(data[position + 1]) + 2) * 4;
+				break;
+			case k_ipv6_fragment:
+				header_length = 8;
+				break;
+			default:
+				header_length = 0;
+				break;
+		}
+
+		if (header_length == 0)
+		{
+			break;
+		}
+		if (extensions == k_max_ipv6_extensions)
+		{
+			return DecodedPacket::Status::Malformed;
+		}
+		if (position + header_length > captured_end)
+		{
+			return DecodedPacket::Status::Truncated;
+		}
+
+		packet.flags |= DecodedPacket::Ipv6Extension;
+		if (next == k_ipv6_fragment)
+		{
+			const uint16_t fragment = be16(data + position + 2);
+			packet.flags		   |= DecodedPacket::Fragment;
+			if (fragment & 0xfff8)
+			{
+				packet.key.protocol = data[position];
+				return DecodedPacket::Status::Ok;
+			}
+		}
+
+		next	  = data[position];
+		position += header_length;
+	}
+
+	packet.key.protocol = next;
+	if (next == k_ipv6_no_next)
+	{
+		return DecodedPacket::Status::Ok;
+	}
+
+	InternetChecksum pseudo;
+	pseudo.add(ip + 8, 32);
+	pseudo.addBigEndian16(next);
+	return decodeTransport(data, position, captured_end, end, next, pseudo, packet);
+}
+
+DecodedPacket::Status PacketDecoder::decodeTransport(const uint8_t *data, std::size_t offset, std::size_t captured_end,
+													 std::size_t end, uint8_t protocol, InternetChecksum pseudo,
+													 DecodedPacket &packet) const
+{
+	if (offset > captured_end)
+	{
+		return offset > end ? DecodedPacket::Status::Malformed : DecodedPacket::Status::Truncated;
+	}
+
+	const uint8_t	 *segment  = data + offset;
+	const std::size_t captured = captured_end - offset;
+	std::size_t		  header_length;
+	bool			  checksum = true;
+
+	packet.l4_offset = static_cast<uint16_t>(offset);
+	switch (protocol)
+	{
+		case k_protocol_tcp:
+			if (captured < k_tcp_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+			header_length = std::size_t(segment[12] >> 4) * 4;
+			if (header_length < k_tcp_header)
+			{
+				return DecodedPacket::Status::Malformed;
+			}
+			if (header_length > captured)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+
+			packet.key.source_port		= be16(segment);
+			packet.key.destination_port = be16(segment + 2);
+			packet.tcp_sequence			= be32(segment + 4);
+			packet.tcp_ack				= be32(segment + 8);
+			packet.tcp_flags			= segment[13];
+			break;
+		case k_protocol_udp:
+			if (captured < k_udp_header)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+			if (be16(segment + 4) < k_udp_header)
+			{
+				return DecodedPacket::Status::Malformed;
+			}
+
+			header_length				= k_udp_header;
+			packet.key.source_port		= be16(segment);
+			packet.key.destination_port = be16(segment + 2);
+
+			// Optional over IPv4, zero means the sender did not compute one
+			checksum = packet.ip_version == 6 || be16(segment + 6) != 0;
+			break;
+		case k_protocol_icmp:
+		case k_protocol_icmpv6:
+			if (captured < 4)
+			{
+				return DecodedPacket::Status::Truncated;
+			}
+
+			header_length	 = captured < k_icmp_header ? captured : k_icmp_header;
+			packet.icmp_type = segment[0];
+			packet.icmp_code = segment[1];
+
+			// Echo requests and replies share a flow per identifier, like ping sessions
+			if (captured >= k_icmp_header && isEcho(protocol, segment[0]))
+			{
+				packet.key.source_port		= be16(segment + 4);
+				packet.key.destination_port = packet.key.source_port;
+			}
+			break;
+		default:
+			// GRE, ESP, SCTP and friends stay opaque, their payload starts right after IP
+			packet.payload_offset = static_cast<uint16_t>(offset);
+			packet.payload_length = static_cast<uint32_t>(captured);
+			return DecodedPacket::Status::Ok;
+	}
+
+	packet.payload_offset = static_cast<uint16_t>(offset + header_length);
+	packet.payload_length = static_cast<uint32_t>(captured - header_length);
+
+	// Fragments and short captures do not hold the whole segment the checksum covers
+	const bool complete = captured_end == end && !(packet.flags & DecodedPacket::Fragment);
+	if (m_verify_checksums && checksum && complete)
+	{
+		InternetChecksum sum = protocol == k_protocol_icmp ? InternetChecksum() : pseudo;
+		if (protocol != k_protocol_icmp)
+		{
+			sum.addBigEndian32(static_cast<uint32_t>(captured));
+		}
+		sum.add(segment, captured);
+
+		packet.flags |= DecodedPacket::ChecksumVerified;
+		if (sum.finish() != 0)
+		{
+			packet.flags |= DecodedPacket::BadL4Checksum;
+		}
+	}
+	return DecodedPacket::Status::Ok;
+}
+
+void PacketDecoder::setVerifyChecksums(bool enabled)
+{
+	m_verify_checksums = enabled;
+}
+
+const PacketDecoder::Statistics &PacketDecoder::statistics() const
+{
+	return m_statistics;
+}
+
+void PacketDecoder::resetStatistics()
+{
+	m_statistics = Statistics{};
+}
+} // namespace UTILS
@@ -0,0 +1,125 @@
+#ifndef PACKET_DECODER_HPP
+#define PACKET_DECODER_HPP
+
+#include "flow_key.hpp"
+#include "net_checksum.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace UTILS
+{
+/**
+ * @brief Header summary of one frame, offsets are relative to its start.
+ *
+ * Offsets of layers that were not reached are 0. The key is filled as far
+ * as the frame was decoded and can be handed to FlowTable::update().
+ */
+struct DecodedPacket
+{
+	enum class Status : uint8_t
+	{
+		Ok,
+		Truncated,	 // the capture ends inside a header, layers before it are valid
+		Unsupported, // not IP (ARP, LLDP, ...) or an unknown link type
+		Malformed	 // header fields contradict each other
+	};
+
+	enum Flag : uint16_t
+	{
+		Fragment		 = 1 << 0, // IP fragment, transport decoded for the first one only
+		ShortCapture	 = 1 << 1, // fewer bytes captured than the IP length announces
+		BadIpChecksum	 = 1 << 2,
+		BadL4Checksum	 = 1 << 3,
+		ChecksumVerified = 1 << 4, // the transport checksum covered the whole segment
+		VlanStackTooDeep = 1 << 5,
+		Ipv6Extension	 = 1 << 6
+	};
+
+	FlowKey	 key;
+	Status	 status			= Status::Ok;
+	uint8_t	 ip_version		= 0;
+	uint8_t	 ttl			= 0; // hop limit for IPv6
+	uint8_t	 tcp_flags		= 0;
+	uint8_t	 icmp_type		= 0;
+	uint8_t	 icmp_code		= 0;
+	uint8_t	 vlan_count		= 0;
+	uint16_t flags			= 0; // Flag bits
+	uint16_t vlan			= 0; // innermost VLAN id
+	uint16_t l3_offset		= 0;
+	uint16_t l4_offset		= 0;
+	uint16_t payload_offset	= 0;
+	uint32_t payload_length	= 0; // captured payload bytes
+	uint32_t tcp_sequence	= 0;
+	uint32_t tcp_ack		= 0;
+};
+
+/**
+ * @brief Allocation free decoder for Ethernet, VLAN, IPv4, IPv6, TCP, UDP
+ * and ICMP.
+ *
+ * Reads raw frames of the common pcap link types (Ethernet, raw IP, BSD
+ * loopback, Linux cooked v1 and v2) into a DecodedPacket. 802.1Q and
+ * 802.1ad stacks are walked up to eight tags, IPv6 extension headers up to
+ * eight headers. Every length field is checked against the captured bytes
+ * before it is used, a short or corrupt frame ends decoding at the last
+ * complete layer instead of reading past the buffer.
+ *
+ * Checksums are optional: the IPv4 header checksum is verified whenever the
+ * header is complete, transport checksums when the whole segment was
+ * captured and it is not a fragment. Both use the vectorized
+ * InternetChecksum.
+ */
+class PacketDecoder
+{
+public:
+	struct Statistics
+	{
+		uint64_t packets	   = 0;
+		uint64_t bytes		   = 0;
+		uint64_t ok			   = 0;
+		uint64_t truncated	   = 0;
+		uint64_t unsupported   = 0;
+		uint64_t malformed	   = 0;
+		uint64_t bad_checksums = 0;
+	};
+
+	static constexpr uint32_t d_link_type_null		 = 0;
+	static constexpr uint32_t d_link_type_ethernet	 = 1;
+	static constexpr uint32_t d_link_type_raw		 = 101;
+	static constexpr uint32_t d_link_type_linux_sll	 = 113;
+	static constexpr uint32_t d_link_type_linux_sll2 = 276;
+
+public:
+	PacketDecoder();
+
+	DecodedPacket::Status decode(const uint8_t *data, std::size_t length, uint32_t link_type, DecodedPacket &packet);
+
+	void setVerifyChecksums(bool enabled);
+
+	const Statistics &statistics() const;
+	void			  resetStatistics();
+
+private:
+	DecodedPacket::Status decodeLink(const uint8_t *data, std::size_t length, uint32_t link_type,
+									 DecodedPacket &packet) const;
+	DecodedPacket::Status decodeIpv4(const uint8_t *data, std::size_t length, std::size_t offset,
+									 DecodedPacket &packet) const;
+	DecodedPacket::Status decodeIpv6(const uint8_t *data, std::size_t length, std::size_t offset,
+									 DecodedPacket &packet) const;
+
+	/**
+	 * captured_end is where the frame data ends, end where the IP length
+	 * says the segment ends. pseudo holds the pseudo header minus the length.
+	 */
+	DecodedPacket::Status decodeTransport(const uint8_t *data, std::size_t offset, std::size_t captured_end,
+										  std::size_t end, uint8_t protocol, InternetChecksum pseudo,
+										  DecodedPacket &packet) const;
+
+private:
+	bool	   m_verify_checksums;
+	Statistics m_statistics;
+};
+} // namespace UTILS
+
+#endif // PACKET_DECODER_HPP
@@ -0,0 +1,514 @@
+#include "pcap_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr uint32_t	  k_pcap_magic_usec			= 0xa1b2c3d4;
+	constexpr uint32_t	  k_pcap_magic_nsec			= 0xa1b23c4d;
+	constexpr uint32_t	  k_pcap_link_type_mask		= 0x03ffffff; // upper bits carry the FCS length
+	constexpr uint32_t	  k_max_packet_length		= 0x40000;	  // libpcap's sanity limit
+	constexpr uint32_t	  k_pcapng_section_header	= 0x0a0d0d0a;
+	constexpr uint32_t	  k_pcapng_interface_desc	= 0x00000001;
+	constexpr uint32_t	  k_pcapng_obsolete_packet	= 0x00000002;
+	constexpr uint32_t	  k_pcapng_simple_packet	= 0x00000003;
+	constexpr uint32_t	  k_pcapng_enhanced_packet	= 0x00000006;
+	constexpr uint32_t	  k_pcapng_byte_order_magic	= 0x1a2b3c4d;
+	constexpr uint16_t	  k_pcapng_option_end		= 0;
+	constexpr uint16_t	  k_pcapng_option_ts_resol	= 9;
+	constexpr uint16_t	  k_pcapng_option_ts_offset	= 14;
+	constexpr uint64_t	  k_nanoseconds				= 1000000000;
+	constexpr std::size_t k_pcap_header_length		= 24;
+	constexpr std::size_t k_pcap_record_length		= 16;
+	constexpr std::size_t k_pcapng_block_min		= 12;
+	constexpr std::size_t k_release_chunk			= 16 << 20;	  // bytes read between page releases
+
+	__extension__ using Wide = unsigned __int128;
+
+	constexpr std::size_t padTo4(std::size_t length)
+	{
+		return (4 - (length & 3)) & 3;
+	}
+
+	uint32_t load32(const uint8_t *data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+} // namespace
+
+PcapReader::PcapReader() :
+	m_data(nullptr),
+	m_size(0),
+	m_offset(0),
+	m_released(0),
+	m_first_record(0),
+	m_format(Format::Pcap),
+	m_swapped(false),
+	m_truncated(false),
+	m_finished(true),
+	m_error(0),
+	m_packet_count(0)
+{}
+
+PcapReader::PcapReader(const std::string &path) : PcapReader()
+{
+	open(path);
+}
+
+bool PcapReader::open(const std::string &path)
+{
+	close();
+
+	if (!m_file.open(path))
+	{
+		m_error = m_file.error();
+		return false;
+	}
+
+	m_data = reinterpret_cast<const uint8_t *>(m_file.data());
+	m_size = m_file.size();
+	m_file.advise(MADV_SEQUENTIAL);
+
+	if (!readHeader())
+	{
+		const int error = m_error;
+		close();
+		m_error = error;
+		return false;
+	}
+
+	rewind();
+	return true;
+}
+
+void PcapReader::close()
+{
+	m_file.close();
+	m_data		   = nullptr;
+	m_size		   = 0;
+	m_offset	   = 0;
+	m_released	   = 0;
+	m_first_record = 0;
+	m_swapped	   = false;
+	m_truncated	   = false;
+	m_finished	   = true;
+	m_error		   = 0;
+	m_packet_count = 0;
+	m_interfaces.clear();
+}
+
+uint16_t PcapReader::u16(std::size_t offset) const
+{
+	uint16_t value;
+	std::memcpy(&value, m_data + offset, sizeof(value));
+	return m_swapped ? __builtin_bswap16(value) : value;
+}
+
+uint32_t PcapReader::u32(std::size_t offset) const
+{
+	const uint32_t value = load32(m_data + offset);
+	return m_swapped ? __builtin_bswap32(value) : value;
+}
+
+bool PcapReader::fail(int error)
+{
+	m_error	   = error;
+	m_finished = true;
+	return false;
+}
+
+bool PcapReader::readHeader()
+{
+	if (m_size < 4)
+	{
+		return fail(EINVAL);
+	}
+
+	const uint32_t magic = load32(m_data);
+	if (magic == k_pcapng_section_header)
+	{
+		m_format	   = Format::PcapNg;
+		m_first_record = 0;
+		return readSection() || fail(m_error != 0 ? m_error : EINVAL);
+	}
+
+	const uint32_t swapped = __builtin_bswap32(magic);
+	if (magic != k_pcap_magic_usec && magic != k_pcap_magic_nsec && swapped != k_pcap_magic_usec
+		&& swapped != k_pcap_magic_nsec)
+	{
+		return fail(EINVAL);
+	}
+	if (m_size < k_pcap_header_length)
+	{
+		return fail(EINVAL);
+	}
+
+	m_format	   = Format::Pcap;
+	m_swapped	   = magic != k_pcap_magic_usec && magic != k_pcap_magic_nsec;
+	m_first_record = k_pcap_header_length;
+
+	Interface interface;
+	interface.snap_length = u32(16);
+	interface.link_type	  = u32(20) & k_pcap_link_type_mask;
+	interface.multiplier  = (m_swapped ? swapped : magic) == k_pcap_magic_nsec ? 1 : 1000;
+	m_interfaces.assign(1, interface);
+	return true;
+}
+
+bool PcapReader::readSection()
+{
+	// The block type reads the same in both byte orders, the magic after the length decides
+	if (m_size - m_offset < 28)
+	{
+		m_truncated = true;
+		m_finished	= true;
+		return false;
+	}
+
+	const uint32_t magic = load32(m_data + m_offset + 8);
+	if (magic != k_pcapng_byte_order_magic && __builtin_bswap32(magic) != k_pcapng_byte_order_magic)
+	{
+		return fail(EINVAL);
+	}
+
+	m_swapped = magic != k_pcapng_byte_order_magic;
+	m_interfaces.clear();
+	return true;
+}
+
+bool PcapReader::readInterface(std::size_t length)
+{
+	if (length < 20)
+	{
+		return fail(EINVAL);
+	}
+
+	Interface interface;
+	interface.link_type	  = u16(m_offset + 8);
+	interface.snap_length = u32(m_offset + 12);
+
+	std::size_t		  option = m_offset + 16;
+	const std::size_t end	 = m_offset + length - 4;
+	while (option + 4 <= end)
+	{
+		const uint16_t	  code	= u16(option);
+		const uint16_t	  size	= u16(option + 2);
+		const std::size_t value = option + 4;
+		if (code == k_pcapng_option_end)
+		{
+			break;
+		}
+		if (value + size > end)
+		{
+			return fail(EINVAL);
+		}
+
+		if (code == k_pcapng_option_ts_resol && size == 1)
+		{
+			// Negative power of 10, or of 2 with the high bit set
+			const uint8_t resolution = m_data[value];
+			const uint8_t exponent	 = resolution & 0x7f;
+			if (resolution & 0x80)
+			{
+				if (exponent > 63)
+				{
+					return fail(EINVAL);
+				}
+				interface.multiplier = k_nanoseconds;
+				interface.divisor	 = uint64_t(1) << exponent;
+			}
+			else
+			{
+				if (exponent > 19)
+				{
+					return fail(EINVAL);
+				}
+				interface.multiplier = 1;
+				interface.divisor	 = 1;
+				for (uint8_t i = exponent; i < 9; ++i)
+				{
+					interface.multiplier *= 10;
+				}
+				for (uint8_t i = 9; i < exponent; ++i)
+				{
+					interface.divisor *= 10;
+				}
+			}
+		}
+		else if (code == k_pcapng_option_ts_offset && size == 8)
+		{
+			const uint64_t low	= u32(m_swapped ? value + 4 : value);
+			const uint64_t high = u32(m_swapped ? value : value + 4);
+			interface.offset_s	= static_cast<int64_t>(high << 32 | low);
+		}
+
+		option = value + size + padTo4(size);
+	}
+
+	m_interfaces.push_back(interface);
+	return true;
+}
+
+bool PcapReader::readPcap(PcapPacket &packet)
+{
+	const std::size_t remaining = m_size - m_offset;
+	if (remaining == 0)
+	{
+		m_finished = true;
+		return false;
+	}
+	if (remaining < k_pcap_record_length)
+	{
+		m_truncated = true;
+		m_finished	= true;
+		return false;
+	}
+
+	const uint32_t seconds		   = u32(m_offset);
+	const uint32_t fraction		   = u32(m_offset + 4);
+	const uint32_t captured_length = u32(m_offset + 8);
+	const uint32_t original_length = u32(m_offset + 12);
+	if (captured_length > std::max(k_max_packet_length, m_interfaces[0].snap_length))
+	{
+		return fail(EINVAL);
+	}
+	if (captured_length > remaining - k_pcap_record_length)
+	{
+		m_truncated = true;
+		m_finished	= true;
+		return false;
+	}
+
+	packet.data			   = m_data + m_offset + k_pcap_record_length;
+	packet.captured_length = captured_length;
+	packet.original_length = original_length;
+	packet.timestamp_ns	   = seconds * k_nanoseconds + fraction * m_interfaces[0].multiplier;
+	packet.link_type	   = m_interfaces[0].link_type;
+	packet.interface	   = 0;
+
+	m_offset += k_pcap_record_length + captured_length;
+	return true;
+}
+
+bool PcapReader::readPcapNg(PcapPacket &packet)
+{
+	while (true)
+	{
+		const std::size_t remaining = m_size - m_offset;
+		if (remaining == 0)
+		{
+			m_finished = true;
+			return false;
+		}
+		if (remaining < k_pcapng_block_min)
+		{
+			m_truncated = true;
+			m_finished	= true;
+			return false;
+		}
+
+		const uint32_t type = u32(m_offset);
+		if (type == k_pcapng_section_header && !readSection())
+		{
+			return false;
+		}
+
+		const uint32_t length = u32(m_offset + 4);
+		if (length < k_pcapng_block_min || length % 4 != 0)
+		{
+			return fail(EINVAL);
+		}
+		if (length > remaining)
+		{
+			m_truncated = true;
+			m_finished	= true;
+			return false;
+		}
+		if (u32(m_offset + length - 4) != length)
+		{
+			return fail(EINVAL);
+		}
+
+		bool		   produced = false;
+		const uint8_t *body		= m_data + m_offset + 8;
+		switch (type)
+		{
+			case k_pcapng_interface_desc:
+				if (!readInterface(length))
+				{
+					return false;
+				}
+				break;
+			case k_pcapng_enhanced_packet:
+			case k_pcapng_obsolete_packet:
+			{
+				if (length < 32)
+				{
+					return fail(EINVAL);
+				}
+
+				const uint32_t interface	   = type == k_pcapng_enhanced_packet ? u32(m_offset + 8) : u16(m_offset + 8);
+				const uint32_t captured_length = u32(m_offset + 20);
+				if (interface >= m_interfaces.size() || captured_length > length - 32)
+				{
+					return fail(EINVAL);
+				}
+
+				const Interface &description = m_interfaces[interface];
+				const Wide		 units		 = static_cast<Wide>(u32(m_offset + 12)) << 32 | u32(m_offset + 16);
+				const Wide		 nanoseconds = units * description.multiplier / description.divisor;
+
+				packet.data			   = body + 20;
+				packet.captured_length = captured_length;
+				packet.original_length = u32(m_offset + 24);
+				packet.timestamp_ns	   = static_cast<uint64_t>(nanoseconds) + description.offset_s * k_nanoseconds;
+				packet.link_type	   = description.link_type;
+				packet.interface	   = interface;
+				produced			   = true;
+				break;
+		}
+		case k_pcapng_simple_packet:
+		{
+			if (length < 16 || m_interfaces.empty())
+			{
+				return fail(EINVAL);
+			}
+
+			// No captured length field, the block holds min(original length, snap length) bytes
+			const Interface &description	 = m_interfaces[0];
+			const uint32_t	 original_length = u32(m_offset + 8);
+			uint32_t		 captured_length = std::min<uint32_t>(original_length, length - 16);
+			if (description.snap_length != 0)
+			{
+				captured_length = std::min(captured_length, description.snap_length);
+			}
+
+			packet.data			   = body + 4;
+			packet.captured_length = captured_length;
+			packet.original_length = original_length;
+			packet.timestamp_ns	   = 0;
+			packet.link_type	   = description.link_type;
+			packet.interface	   = 0;
+			produced			   = true;
+			break;
+		}
+		default:
+			// Statistics, name resolution and custom blocks carry no packets
+			break;
+		}
+
+		m_offset += length;
+		if (produced)
+		{
+			return true;
+		}
+	}
+}
+
+void PcapReader::release()
+{
+	if (m_offset - m_released < k_release_chunk)
+	{
+		return;
+	}
+
+	// Private read-only pages are dropped, not written back, and refault from the file if touched again
+	const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t end		= m_offset - m_offset % page_size;
+	m_file.advise(MADV_DONTNEED, m_released, end - m_released);
+	m_file.advise(MADV_WILLNEED, end, k_release_chunk);
+	m_released = end;
+}
+
+std::size_t PcapReader::read(std::span<PcapPacket> batch)
+{
+	if (m_finished)
+	{
+		return 0;
+	}
+
+	release();
+
+	std::size_t count = 0;
+	if (m_format == Format::Pcap)
+	{
+		while (count < batch.size() && readPcap(batch[count]))
+		{
+			++count;
+		}
+	}
+	else
+	{
+		while (count < batch.size() && readPcapNg(batch[count]))
+		{
+			++count;
+		}
+	}
+
+	m_packet_count += count;
+	return count;
+}
+
+void PcapReader::rewind()
+{
+	if (!m_file.isOpen())
+	{
+		return;
+	}
+
+	if (m_format == Format::PcapNg)
+	{
+		m_interfaces.clear();
+	}
+
+	m_offset	   = m_first_record;
+	m_released	   = 0;
+	m_truncated	   = false;
+	m_finished	   = false;
+	m_error		   = 0;
+	m_packet_count = 0;
+}
+
+bool PcapReader::isOpen() const
+{
+	return m_file.isOpen();
+}
+
+int PcapReader::error() const
+{
+	return m_error;
+}
+
+bool PcapReader::truncated() const
+{
+	return m_truncated;
+}
+
+PcapReader::Format PcapReader::format() const
+{
+	return m_format;
+}
+
+uint64_t PcapReader::packetCount() const
+{
+	return m_packet_count;
+}
+
+std::size_t PcapReader::offset() const
+{
+	return m_offset;
+}
+
+std::size_t PcapReader::size() const
+{
+	return m_size;
+}
+} // namespace UTILS
@@ -0,0 +1,114 @@
+#ifndef PCAP_READER_HPP
+#define PCAP_READER_HPP
+
+#include "mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief One captured packet, data points into the file mapping.
+ */
+struct PcapPacket
+{
+	const uint8_t *data			   = nullptr;
+	uint32_t	   captured_length = 0;
+	uint32_t	   original_length = 0;
+	uint64_t	   timestamp_ns	   = 0;
+	uint32_t	   link_type	   = 0;
+	uint32_t	   interface	   = 0; // pcapng interface id, 0 for pcap
+};
+
+/**
+ * @brief Zero copy reader for classic pcap and pcapng capture files.
+ *
+ * The file is mapped once and read front to back, packets are handed out
+ * in caller sized batches as pointers into the mapping. Both byte orders,
+ * microsecond and nanosecond pcap files and any pcapng timestamp
+ * resolution are supported, timestamps are converted to nanoseconds.
+ * Pages behind the read position are dropped from the mapping every few
+ * megabytes, so memory use stays flat on captures of any size. Dropped
+ * pages fault back in from the file, packet pointers never dangle while
+ * the reader is open.
+ *
+ * A record cut short at the end of the file ends the capture and sets
+ * truncated(), a malformed record stops reading with EINVAL.
+ */
+class PcapReader
+{
+public:
+	enum class Format
+	{
+		Pcap,
+		PcapNg
+	};
+
+public:
+	PcapReader();
+	explicit PcapReader(const std::string &path);
+
+	PcapReader(const PcapReader &)			  = delete;
+	PcapReader &operator=(const PcapReader &) = delete;
+
+	bool open(const std::string &path);
+	void close();
+
+	/**
+	 * Fills batch from the front and returns the number of packets, 0 at
+	 * the end of the capture or after an error.
+	 */
+	std::size_t read(std::span<PcapPacket> batch);
+	void		rewind();
+
+	bool		isOpen() const;
+	int			error() const;
+	bool		truncated() const;
+	Format		format() const;
+	uint64_t	packetCount() const;
+	std::size_t offset() const;
+	std::size_t size() const;
+
+private:
+	struct Interface
+	{
+		uint32_t link_type	 = 0;
+		uint32_t snap_length = 0;
+		uint64_t multiplier	 = 1000; // timestamp units to nanoseconds, multiplier / divisor
+		uint64_t divisor	 = 1;
+		int64_t	 offset_s	 = 0;	 // if_tsoffset
+	};
+
+	bool readHeader();
+	bool readPcap(PcapPacket &packet);
+	bool readPcapNg(PcapPacket &packet);
+	bool readSection();
+	bool readInterface(std::size_t length);
+	bool fail(int error);
+	void release();
+
+	uint16_t u16(std::size_t offset) const;
+	uint32_t u32(std::size_t offset) const;
+
+private:
+	MappedFile			   m_file;
+	const uint8_t		  *m_data;
+	std::size_t			   m_size;
+	std::size_t			   m_offset;
+	std::size_t			   m_released; // start of the pages still resident, page aligned
+	std::size_t			   m_first_record;
+	Format				   m_format;
+	bool				   m_swapped;
+	bool				   m_truncated;
+	bool				   m_finished;
+	int					   m_error;
+	uint64_t			   m_packet_count;
+	std::vector<Interface> m_interfaces; // pcap uses a single entry
+};
+} // namespace UTILS
+
+#endif // PCAP_READER_HPP
@@ -0,0 +1,223 @@
+#include "pcap_writer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_buffer_capacity = 1 << 20;
+
+	constexpr uint32_t k_pcap_magic_usec  = 0xa1b2c3d4;
+	constexpr uint16_t k_pcap_version_maj = 2;
+	constexpr uint16_t k_pcap_version_min = 4;
+
+	constexpr uint32_t k_pcapng_section_header	   = 0x0a0d0d0a;
+	constexpr uint32_t k_pcapng_interface_desc	   = 0x00000001;
+	constexpr uint32_t k_pcapng_enhanced_packet	   = 0x00000006;
+	constexpr uint32_t k_pcapng_byte_order_magic   = 0x1a2b3c4d;
+	constexpr uint16_t k_pcapng_option_end		   = 0;
+	constexpr uint16_t k_pcapng_option_ts_resol	   = 9;
+	constexpr uint8_t  k_pcapng_nanosecond_resol   = 9;
+	constexpr uint32_t k_pcapng_section_length	   = 28;
+	constexpr uint32_t k_pcapng_interface_length   = 32;
+	constexpr uint32_t k_pcapng_packet_base_length = 32;
+
+	constexpr std::size_t padTo4(std::size_t length)
+	{
+		return (4 - (length & 3)) & 3;
+	}
+} // namespace
+
+PcapWriter::PcapWriter() :
+	m_fd(-1),
+	m_error(0),
+	m_format(Format::Pcap),
+	m_snap_length(0),
+	m_packet_count(0)
+{}
+
+PcapWriter::~PcapWriter()
+{
+	close();
+}
+
+bool PcapWriter::open(const std::string &path, Format format, uint32_t link_type, uint32_t snap_length)
+{
+	close();
+
+	m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (m_fd < 0)
+	{
+		m_error = errno;
+		return false;
+	}
+
+	m_error		   = 0;
+	m_format	   = format;
+	m_snap_length  = snap_length;
+	m_packet_count = 0;
+	m_buffer.clear();
+	m_buffer.reserve(k_buffer_capacity);
+
+	// Records are written in host byte order, readers detect it from the magic numbers
+	if (format == Format::Pcap)
+	{
+		appendU32(k_pcap_magic_usec);
+		appendU16(k_pcap_version_maj);
+		appendU16(k_pcap_version_min);
+		appendU32(0); // thiszone
+		appendU32(0); // sigfigs
+		appendU32(snap_length);
+		appendU32(link_type);
+		return true;
+	}
+
+	appendU32(k_pcapng_section_header);
+	appendU32(k_pcapng_section_length);
+	appendU32(k_pcapng_byte_order_magic);
+	appendU16(1); // major version
+	appendU16(0); // minor version
+	appendU32(0xffffffff); // section length unknown, 64 bit -1
+	appendU32(0xffffffff);
+	appendU32(k_pcapng_section_length);
+
+	appendU32(k_pcapng_interface_desc);
+	appendU32(k_pcapng_interface_length);
+	appendU16(static_cast<uint16_t>(link_type));
+	appendU16(0);
+	appendU32(snap_length);
+	appendU16(k_pcapng_option_ts_resol);
+	appendU16(1);
+	append(&k_pcapng_nanosecond_resol, 1);
+	appendPadding(3);
+	appendU16(k_pcapng_option_end);
+	appendU16(0);
+	appendU32(k_pcapng_interface_length);
+	return true;
+}
+
+bool PcapWriter::write(uint64_t timestamp_ns, const uint8_t *data, std::size_t length)
+{
+	if (m_fd < 0)
+	{
+		return false;
+	}
+
+	const uint32_t captured = static_cast<uint32_t>(std::min<std::size_t>(length, m_snap_length));
+
+	if (m_buffer.size() + captured + k_pcapng_packet_base_length + 4 > k_buffer_capacity && !flush())
+	{
+		return false;
+	}
+
+	if (m_format == Format::Pcap)
+	{
+		appendU32(static_cast<uint32_t>(timestamp_ns / 1000000000));
+		appendU32(static_cast<uint32_t>(timestamp_ns % 1000000000 / 1000));
+		appendU32(captured);
+		appendU32(static_cast<uint32_t>(length));
+		append(data, captured);
+	}
+	else
+	{
+		const uint32_t padding		= static_cast<uint32_t>(padTo4(captured));
+		const uint32_t block_length = k_pcapng_packet_base_length + captured + padding;
+
+		appendU32(k_pcapng_enhanced_packet);
+		appendU32(block_length);
+		appendU32(0); // interface id
+		appendU32(static_cast<uint32_t>(timestamp_ns >> 32));
+		appendU32(static_cast<uint32_t>(timestamp_ns));
+		appendU32(captured);
+		appendU32(static_cast<uint32_t>(length));
+		append(data, captured);
+		appendPadding(padding);
+		appendU32(block_length);
+	}
+
+	m_packet_count++;
+	return true;
+}
+
+bool PcapWriter::flush()
+{
+	std::size_t offset = 0;
+
+	while (offset < m_buffer.size())
+	{
+		const ssize_t written = ::write(m_fd, m_buffer.data() + offset, m_buffer.size() - offset);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			m_error = errno;
+			return false;
+		}
+		offset += static_cast<std::size_t>(written);
+	}
+
+	m_buffer.clear();
+	return true;
+}
+
+bool PcapWriter::close()
+{
+	if (m_fd < 0)
+	{
+		return true;
+	}
+
+	const bool flushed = flush();
+	const bool closed  = ::close(m_fd) == 0;
+	if (!closed && m_error == 0)
+	{
+		m_error = errno;
+	}
+
+	m_fd = -1;
+	return flushed && closed;
+}
+
+bool PcapWriter::isOpen() const
+{
+	return m_fd >= 0;
+}
+
+int PcapWriter::error() const
+{
+	return m_error;
+}
+
+uint64_t PcapWriter::packetCount() const
+{
+	return m_packet_count;
+}
+
+void PcapWriter::append(const void *data, std::size_t length)
+{
+	const auto *bytes = static_cast<const uint8_t *>(data);
+	m_buffer.insert(m_buffer.end(), bytes, bytes + length);
+}
+
+void PcapWriter::appendU16(uint16_t value)
+{
+	append(&value, sizeof(value));
+}
+
+void PcapWriter::appendU32(uint32_t value)
+{
+	append(&value, sizeof(value));
+}
+
+void PcapWriter::appendPadding(std::size_t length)
+{
+	m_buffer.insert(m_buffer.end(), length, 0);
+}
+} // namespace UTILS
@@ -0,0 +1,62 @@
+#ifndef PCAP_WRITER_HPP
+#define PCAP_WRITER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Buffered writer for classic pcap and pcapng capture files.
+ *
+ * Records are appended to an in-memory buffer that is flushed with a single
+ * write() once full, so writing millions of small packets costs a handful of
+ * system calls per megabyte.
+ */
+class PcapWriter
+{
+public:
+	enum class Format
+	{
+		Pcap,
+		PcapNg
+	};
+
+	static constexpr uint32_t d_link_type_ethernet = 1;
+
+public:
+	PcapWriter();
+	~PcapWriter();
+
+	PcapWriter(const PcapWriter &)			  = delete;
+	PcapWriter &operator=(const PcapWriter &) = delete;
+
+	bool open(const std::string &path, Format format = Format::Pcap, uint32_t link_type = d_link_type_ethernet,
+			  uint32_t snap_length = 65535);
+	bool write(uint64_t timestamp_ns, const uint8_t *data, std::size_t length);
+	bool flush();
+	bool close();
+
+	bool	 isOpen() const;
+	int		 error() const;
+	uint64_t packetCount() const;
+
+private:
+	void append(const void *data, std::size_t length);
+	void appendU16(uint16_t value);
+	void appendU32(uint32_t value);
+	void appendPadding(std::size_t length);
+
+private:
+	int					 m_fd;
+	int					 m_error;
+	Format				 m_format;
+	uint32_t			 m_snap_length;
+	uint64_t			 m_packet_count;
+	std::vector<uint8_t> m_buffer;
+};
+} // namespace UTILS
+
+#endif // PCAP_WRITER_HPP
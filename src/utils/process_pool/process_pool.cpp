@@ -0,0 +1,349 @@
+#include "process_pool.hpp"
+
+#include <QDateTime>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <sched.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr int k_kill_timeout = 3000;
+
+	bool pinToCpu(pid_t pid, int cpu)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		return sched_setaffinity(pid, sizeof(set), &set) == 0;
+	}
+} // namespace
+
+ProcessPool::ProcessPool(int max_parallel, QObject *parent) :
+	QObject(parent),
+	m_max_parallel(max_parallel > 0 ? max_parallel : QThread::idealThreadCount()),
+	m_running(0),
+	m_remaining(0),
+	m_next(0),
+	m_loop(nullptr),
+	m_in_handler(false)
+{}
+
+ProcessPool::~ProcessPool()
+{
+	for (QProcess *process : m_processes)
+	{
+		if (process != nullptr)
+		{
+			process->kill();
+			process->waitForFinished(k_kill_timeout);
+		}
+	}
+}
+
+void ProcessPool::run(const QList<Job> &jobs, const FinishedHandler &on_finished)
+{
+	m_jobs			 = jobs;
+	m_on_finished	 = on_finished;
+	m_states		 = QVector<JobState>(jobs.size(), JobState::Pending);
+	m_processes		 = QVector<QProcess *>(jobs.size(), nullptr);
+	m_started_at	 = QVector<qint64>(jobs.size(), 0);
+	m_standard_error = QVector<QByteArray>(jobs.size());
+	m_line_start	 = QVector<int>(jobs.size(), 0);
+	m_cpu_jobs		 = QVector<int>(m_cpus.size(), 0);
+	m_job_cpu		 = QVector<int>(jobs.size(), -1);
+	m_running		 = 0;
+	m_remaining		 = jobs.size();
+	m_next			 = 0;
+	m_cancelled_pending.clear();
+
+	if (m_remaining == 0)
+	{
+		return;
+	}
+
+	QEventLoop loop;
+	m_loop = &loop;
+
+	startPending();
+
+	if (m_remaining > 0)
+	{
+		loop.exec();
+	}
+
+	m_loop = nullptr;
+}
+
+void ProcessPool::cancel(int index)
+{
+	if (index < 0 || index >= m_states.size())
+	{
+		return;
+	}
+
+	switch (m_states[index])
+	{
+		case JobState::Pending:
+			m_states[index] = JobState::Done;
+			m_cancelled_pending.append(index);
+			if (!m_in_handler)
+			{
+				flushCancelled();
+			}
+			break;
+		case JobState::Running:
+			terminate(index, JobState::Terminating);
+			break;
+		default:
+			break;
+	}
+}
+
+void ProcessPool::abort(int index)
+{
+	if (index >= 0 && index < m_states.size() && m_states[index] == JobState::Running)
+	{
+		terminate(index, JobState::Aborting);
+	}
+}
+
+void ProcessPool::setStandardErrorHandler(const LineHandler &on_line)
+{
+	m_on_line = on_line;
+}
+
+void ProcessPool::setCpuAffinity(const QVector<int> &cpus)
+{
+	m_cpus = cpus;
+}
+
+void ProcessPool::cancelAll()
+{
+	for (int i = 0; i < m_states.size(); ++i)
+	{
+		cancel(i);
+	}
+}
+
+int ProcessPool::maxParallel() const
+{
+	return m_max_parallel;
+}
+
+QVector<int> ProcessPool::availableCpus()
+{
+	QVector<int> cpus;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set) != 0)
+	{
+		return cpus;
+	}
+
+	for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+	{
+		if (CPU_ISSET(cpu, &set))
+		{
+			cpus.append(cpu);
+		}
+	}
+	return cpus;
+}
+
+void ProcessPool::startPending()
+{
+	while (m_running < m_max_parallel && m_next < m_jobs.size())
+	{
+		const int index = m_next++;
+		if (m_states[index] == JobState::Pending)
+		{
+			startJob(index);
+		}
+	}
+}
+
+void ProcessPool::startJob(int index)
+{
+	QProcess *process	 = new QProcess(this);
+	m_processes[index]	 = process;
+	m_states[index]		 = JobState::Running;
+	m_started_at[index]	 = QDateTime::currentMSecsSinceEpoch();
+	m_running			+= 1;
+
+	connect(process, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, [this, index]() {
+		finishJob(index, true);
+	});
+	const int cpu = acquireCpu(index);
+	if (cpu >= 0)
+	{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+		// Applied between fork and exec, threads spawned later inherit it
+		process->setChildProcessModifier([cpu]() {
+			pinToCpu(0, cpu);
+		});
+#else
+		// Qt 5 has no child hook, pin right after exec while the program is still initializing
+		connect(process, &QProcess::started, this, [process, cpu]() {
+			pinToCpu(static_cast<pid_t>(process->processId()), cpu);
+		});
+#endif
+	}
+
+	if (m_on_line)
+	{
+		connect(process, &QProcess::readyReadStandardError, this, [this, index]() {
+			readStandardError(index, false);
+		});
+	}
+	connect(process, &QProcess::errorOccurred, this, [this, index](QProcess::ProcessError error) {
+		if (error == QProcess::FailedToStart)
+		{
+			finishJob(index, false);
+		}
+	});
+
+	process->start(m_jobs[index].program, m_jobs[index].arguments);
+}
+
+int ProcessPool::acquireCpu(int index)
+{
+	if (m_cpus.isEmpty())
+	{
+		return -1;
+	}
+
+	int slot = 0;
+	for (int i = 1; i < m_cpu_jobs.size(); ++i)
+	{
+		if (m_cpu_jobs[i] < m_cpu_jobs[slot])
+		{
+			slot = i;
+		}
+	}
+
+	m_cpu_jobs[slot] += 1;
+	m_job_cpu[index]  = slot;
+	return m_cpus[slot];
+}
+
+void ProcessPool::releaseCpu(int index)
+{
+	const int slot = m_job_cpu[index];
+	if (slot >= 0)
+	{
+		m_cpu_jobs[slot] -= 1;
+		m_job_cpu[index]  = -1;
+	}
+}
+
+void ProcessPool::finishJob(int index, bool started)
+{
+	QProcess *process = m_processes[index];
+	if (process == nullptr)
+	{
+		return;
+	}
+
+	readStandardError(index, true);
+
+	Result result;
+	result.index		   = index;
+	result.started		   = started;
+	result.cancelled	   = m_states[index] == JobState::Terminating;
+	result.aborted		   = m_states[index] == JobState::Aborting;
+	result.exit_code	   = process->exitCode();
+	result.exit_status	   = process->exitStatus();
+	result.elapsed_ms	   = QDateTime::currentMSecsSinceEpoch() - m_started_at[index];
+	result.cpu			   = m_job_cpu[index] >= 0 ? m_cpus[m_job_cpu[index]] : -1;
+	result.standard_output = process->readAllStandardOutput();
+	result.standard_error  = m_standard_error[index];
+
+	m_standard_error[index].clear();
+	releaseCpu(index);
+
+	m_processes[index] = nullptr;
+	m_states[index]	   = JobState::Done;
+	m_running		  -= 1;
+	m_remaining		  -= 1;
+	process->deleteLater();
+
+	m_in_handler = true;
+	m_on_finished(result);
+	m_in_handler = false;
+
+	flushCancelled();
+	startPending();
+
+	if (m_remaining == 0 && m_loop != nullptr)
+	{
+		m_loop->quit();
+	}
+}
+
+void ProcessPool::readStandardError(int index, bool flush)
+{
+	QByteArray &buffer = m_standard_error[index];
+	buffer.append(m_processes[index]->readAllStandardError());
+
+	if (!m_on_line)
+	{
+		return;
+	}
+
+	// Aborted jobs still drain their pipe, but nobody is interested in the rest
+	int &start = m_line_start[index];
+	while (m_states[index] == JobState::Running)
+	{
+		const int end = buffer.indexOf('\n', start);
+		if (end < 0)
+		{
+			break;
+		}
+		const int line_start = start;
+		start				 = end + 1;
+		m_on_line(index, buffer.mid(line_start, end - line_start));
+	}
+
+	if (flush && start < buffer.size() && m_states[index] == JobState::Running)
+	{
+		const int line_start = start;
+		start				 = buffer.size();
+		m_on_line(index, buffer.mid(line_start));
+	}
+}
+
+void ProcessPool::terminate(int index, JobState state)
+{
+	m_states[index]	  = state;
+	QProcess *process = m_processes[index];
+	process->terminate();
+	QTimer::singleShot(k_kill_timeout, process, [process]() {
+		process->kill();
+	});
+}
+
+void ProcessPool::flushCancelled()
+{
+	while (!m_cancelled_pending.isEmpty())
+	{
+		Result result;
+		result.index	 = m_cancelled_pending.takeFirst();
+		result.cancelled = true;
+
+		m_remaining -= 1;
+
+		m_in_handler = true;
+		m_on_finished(result);
+		m_in_handler = false;
+	}
+
+	if (m_remaining == 0 && m_loop != nullptr)
+	{
+		m_loop->quit();
+	}
+}
+} // namespace UTILS
@@ -0,0 +1,123 @@
+#ifndef PROCESS_POOL_HPP
+#define PROCESS_POOL_HPP
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+class QEventLoop;
+
+namespace UTILS
+{
+/**
+ * @brief Runs a list of external processes with a bounded level of parallelism.
+ *
+ * run() blocks the calling thread on a local event loop, so it is meant to be
+ * used from worker threads. The finished handler is invoked once per job on
+ * the calling thread and may cancel other jobs: pending ones are dropped,
+ * running ones receive SIGTERM (and SIGKILL if they do not exit in time).
+ *
+ * With a line handler set, standard error is also handed over line by line
+ * while the job runs. The handler may abort() the job once its outcome is
+ * known, an aborted job is reported as finished rather than cancelled.
+ *
+ * With a CPU list set, every job is pinned to the least busy CPU of the list
+ * when it starts, so parallel single threaded jobs do not migrate between
+ * cores and evict each other's caches.
+ */
+class ProcessPool : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY_MOVE(ProcessPool)
+
+public:
+	struct Job
+	{
+		QString		program;
+		QStringList arguments;
+	};
+
+	struct Result
+	{
+		int					 index		= -1;
+		bool				 started	= false;
+		bool				 cancelled	= false;
+		bool				 aborted	= false;
+		int					 exit_code	= -1;
+		QProcess::ExitStatus exit_status = QProcess::NormalExit;
+		qint64				 elapsed_ms = 0;
+		int					 cpu		= -1; // CPU the job was pinned to, -1 without affinity
+		QByteArray			 standard_output;
+		QByteArray			 standard_error;
+	};
+
+	using FinishedHandler = std::function<void(const Result &result)>;
+	using LineHandler	  = std::function<void(int index, const QByteArray &line)>;
+
+public:
+	explicit ProcessPool(int max_parallel = 0, QObject *parent = nullptr);
+	~ProcessPool() override;
+
+	void setStandardErrorHandler(const LineHandler &on_line);
+	void setCpuAffinity(const QVector<int> &cpus);
+
+	void run(const QList<Job> &jobs, const FinishedHandler &on_finished);
+	void cancel(int index);
+	void cancelAll();
+	void abort(int index);
+
+	int maxParallel() const;
+
+	/**
+	 * CPUs the calling process may run on, in ascending order.
+	 */
+	static QVector<int> availableCpus();
+
+private:
+	enum class JobState
+	{
+		Pending,
+		Running,
+		Terminating,
+		Aborting,
+		Done
+	};
+
+	void startPending();
+	void startJob(int index);
+	int	 acquireCpu(int index);
+	void releaseCpu(int index);
+	void finishJob(int index, bool started);
+	void readStandardError(int index, bool flush);
+	void terminate(int index, JobState state);
+	void flushCancelled();
+
+private:
+	int m_max_parallel;
+	int m_running;
+	int m_remaining;
+	int m_next;
+
+	QList<Job>			 m_jobs;
+	QVector<JobState>	 m_states;
+	QVector<QProcess *>	 m_processes;
+	QVector<qint64>		 m_started_at;
+	QVector<int>		 m_cancelled_pending;
+	QVector<QByteArray>	 m_standard_error;
+	QVector<int>		 m_line_start; // first byte of m_standard_error not yet handed to m_on_line
+	QVector<int>		 m_cpus;
+	QVector<int>		 m_cpu_jobs; // running jobs per entry of m_cpus
+	QVector<int>		 m_job_cpu;	 // entry of m_cpus per job, -1 when not pinned
+	FinishedHandler		 m_on_finished;
+	LineHandler			 m_on_line;
+	QEventLoop			*m_loop;
+	bool				 m_in_handler;
+};
+} // namespace UTILS
+
+#endif // PROCESS_POOL_HPP
@@ -0,0 +1,342 @@
+#include "process_scanner.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_dirent_buffer_size = 32 * 1024;
+	constexpr std::size_t k_comm_length		   = 15; // TASK_COMM_LEN without the terminator
+	constexpr int		  k_parent_pid_field   = 4;	 // ppid in /proc/<pid>/stat, see proc(5)
+	constexpr int		  k_start_time_field   = 22; // starttime
+
+	struct LinuxDirent64
+	{
+		uint64_t	   d_ino;
+		int64_t		   d_off;
+		unsigned short d_reclen;
+		unsigned char  d_type;
+		char		   d_name[1];
+	};
+
+	class FileDescriptor
+	{
+	public:
+		explicit FileDescriptor(int fd) :
+			m_fd(fd)
+		{}
+
+		~FileDescriptor()
+		{
+			if (m_fd >= 0)
+			{
+				close(m_fd);
+			}
+		}
+
+		FileDescriptor(const FileDescriptor &)			  = delete;
+		FileDescriptor &operator=(const FileDescriptor &) = delete;
+
+		int get() const
+		{
+			return m_fd;
+		}
+
+	private:
+		int m_fd;
+	};
+
+	bool readFileAt(int directory_fd, const char *name, std::string &content)
+	{
+		const FileDescriptor fd(openat(directory_fd, name, O_RDONLY | O_CLOEXEC));
+		if (fd.get() < 0)
+		{
+			return false;
+		}
+
+		content.clear();
+		char buffer[4096];
+		while (true)
+		{
+			const ssize_t length = read(fd.get(), buffer, sizeof(buffer));
+			if (length < 0)
+			{
+				return false;
+			}
+			if (length == 0)
+			{
+				return true;
+			}
+			content.append(buffer, static_cast<std::size_t>(length));
+		}
+	}
+
+	std::string_view baseName(std::string_view path)
+	{
+		const std::size_t slash = path.rfind('/');
+		return slash == std::string_view::npos ? path : path.substr(slash + 1);
+	}
+
+	std::vector<std::string> splitArguments(std::string_view cmdline)
+	{
+		std::vector<std::string> arguments;
+		while (!cmdline.empty())
+		{
+			const std::size_t end = cmdline.find('\0');
+			arguments.emplace_back(cmdline.substr(0, end));
+			if (end == std::string_view::npos)
+			{
+				break;
+			}
+			cmdline.remove_prefix(end + 1);
+		}
+		return arguments;
+	}
+
+	std::string readExecutable(int pid_fd)
+	{
+		char		  buffer[4096];
+		const ssize_t length = readlinkat(pid_fd, "exe", buffer, sizeof(buffer));
+		return length > 0 ? std::string(buffer, static_cast<std::size_t>(length)) : std::string();
+	}
+
+	/**
+	 * Parent pid and start time from /proc/<pid>/stat.
+	 */
+	void readStat(int pid_fd, ProcessInfo &info)
+	{
+		std::string stat;
+		if (!readFileAt(pid_fd, "stat", stat))
+		{
+			return;
+		}
+
+		// The command name may contain spaces and parentheses, fields resume after the last ')'
+		std::size_t position = stat.rfind(')');
+		if (position == std::string::npos)
+		{
+			return;
+		}
+
+		for (int field = 2; field < k_start_time_field && position != std::string::npos; ++field)
+		{
+			position = stat.find(' ', position + 1);
+			if (field == k_parent_pid_field - 1 && position != std::string::npos)
+			{
+				std::from_chars(stat.data() + position + 1, stat.data() + stat.size(), info.parent_pid);
+			}
+		}
+		if (position == std::string::npos)
+		{
+			return;
+		}
+
+		std::from_chars(stat.data() + position + 1, stat.data() + stat.size(), info.start_ticks);
+	}
+
+	std::chrono::system_clock::time_point bootTime()
+	{
+		static const std::chrono::system_clock::time_point boot_time = [] {
+			std::string stat;
+			if (!readFileAt(AT_FDCWD, "/proc/stat", stat))
+			{
+				return std::chrono::system_clock::time_point();
+			}
+
+			const std::size_t position = stat.find("\nbtime ");
+			int64_t			  seconds  = 0;
+			if (position != std::string::npos)
+			{
+				std::from_chars(stat.data() + position + 7, stat.data() + stat.size(), seconds);
+			}
+			return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+		}();
+		return boot_time;
+	}
+
+	void fillInfo(int pid_fd, ProcessInfo &info)
+	{
+		struct stat pid_stat;
+		if (fstat(pid_fd, &pid_stat) == 0)
+		{
+			info.uid = pid_stat.st_uid;
+		}
+		if (info.executable.empty())
+		{
+			info.executable = readExecutable(pid_fd);
+		}
+		readStat(pid_fd, info);
+	}
+
+	/**
+	 * comm and cmdline decide almost every match, the exe link is only
+	 * resolved for processes that neither of them matched.
+	 */
+	bool matchProcess(int pid_fd, std::string_view name, ProcessInfo &info)
+	{
+		if (!readFileAt(pid_fd, "comm", info.name))
+		{
+			return false;
+		}
+		if (!info.name.empty() && info.name.back() == '\n')
+		{
+			info.name.pop_back();
+		}
+
+		std::string cmdline;
+		readFileAt(pid_fd, "cmdline", cmdline);
+		info.arguments = splitArguments(cmdline);
+
+		bool matched = info.name == name.substr(0, k_comm_length) ||
+					   (!info.arguments.empty() && baseName(info.arguments.front()) == name);
+
+		if (!matched)
+		{
+			info.executable = readExecutable(pid_fd);
+
+			constexpr std::string_view k_deleted  = " (deleted)";
+			std::string_view		   executable = info.executable;
+			if (executable.size() > k_deleted.size() &&
+				executable.substr(executable.size() - k_deleted.size()) == k_deleted)
+			{
+				executable.remove_suffix(k_deleted.size());
+			}
+			matched = !executable.empty() && baseName(executable) == name;
+		}
+
+		return matched;
+	}
+
+	template<typename Visitor>
+	void forEachPid(Visitor &&visitor)
+	{
+		const FileDescriptor proc_fd(open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+		if (proc_fd.get() < 0)
+		{
+			return;
+		}
+
+		alignas(LinuxDirent64) char buffer[k_dirent_buffer_size];
+
+		while (true)
+		{
+			const long length = syscall(SYS_getdents64, proc_fd.get(), buffer, sizeof(buffer));
+			if (length <= 0)
+			{
+				return;
+			}
+
+			for (long offset = 0; offset < length;)
+			{
+				const auto *entry = reinterpret_cast<const LinuxDirent64 *>(buffer + offset);
+				offset			 += entry->d_reclen;
+
+				pid_t		pid	   = 0;
+				const char *end	   = entry->d_name + std::strlen(entry->d_name);
+				const auto	result = std::from_chars(entry->d_name, end, pid);
+				if (entry->d_type != DT_DIR || result.ec != std::errc() || result.ptr != end)
+				{
+					continue;
+				}
+
+				const FileDescriptor pid_fd(openat(proc_fd.get(), entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+				if (pid_fd.get() >= 0)
+				{
+					visitor(pid, pid_fd.get());
+				}
+			}
+		}
+	}
+} // namespace
+
+std::chrono::system_clock::time_point ProcessInfo::startTime() const
+{
+	static const long ticks_per_second = sysconf(_SC_CLK_TCK);
+	if (ticks_per_second <= 0)
+	{
+		return bootTime();
+	}
+	return bootTime() + std::chrono::milliseconds(start_ticks * 1000 / static_cast<uint64_t>(ticks_per_second));
+}
+
+std::string_view ProcessInfo::argumentValue(std::string_view option) const
+{
+	for (std::size_t i = 1; i < arguments.size(); ++i)
+	{
+		const std::string_view argument = arguments[i];
+		if (argument == option)
+		{
+			return i + 1 < arguments.size() ? std::string_view(arguments[i + 1]) : std::string_view();
+		}
+		if (argument.size() > option.size() && argument.substr(0, option.size()) == option &&
+			argument[option.size()] == '=')
+		{
+			return argument.substr(option.size() + 1);
+		}
+	}
+	return {};
+}
+
+std::vector<ProcessInfo> ProcessScanner::findByName(std::string_view name)
+{
+	std::vector<ProcessInfo> processes;
+
+	forEachPid([&](pid_t pid, int pid_fd) {
+		ProcessInfo info;
+		if (matchProcess(pid_fd, name, info))
+		{
+			info.pid = pid;
+			fillInfo(pid_fd, info);
+			processes.push_back(std::move(info));
+		}
+	});
+
+	return processes;
+}
+
+bool ProcessScanner::isRunning(std::string_view name, pid_t ignored_pid)
+{
+	for (const ProcessInfo &process : findByName(name))
+	{
+		if (process.pid != ignored_pid)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ProcessScanner::inspect(pid_t pid, ProcessInfo &info)
+{
+	const std::string	 path = "/proc/" + std::to_string(pid);
+	const FileDescriptor pid_fd(open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+	if (pid_fd.get() < 0)
+	{
+		return false;
+	}
+
+	info = ProcessInfo();
+	if (!readFileAt(pid_fd.get(), "comm", info.name))
+	{
+		return false;
+	}
+	if (!info.name.empty() && info.name.back() == '\n')
+	{
+		info.name.pop_back();
+	}
+
+	std::string cmdline;
+	readFileAt(pid_fd.get(), "cmdline", cmdline);
+	info.arguments = splitArguments(cmdline);
+	info.pid	   = pid;
+	fillInfo(pid_fd.get(), info);
+	return true;
+}
+} // namespace UTILS
@@ -0,0 +1,53 @@
+#ifndef PROCESS_SCANNER_HPP
+#define PROCESS_SCANNER_HPP
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief A process found under /proc.
+ */
+struct ProcessInfo
+{
+	pid_t					 pid		= 0;
+	pid_t					 parent_pid = 0;
+	uid_t					 uid		= 0;
+	std::string				 name;		 // /proc/<pid>/comm, threads may rename it
+	std::string				 executable; // empty when the exe link is not readable
+	std::vector<std::string> arguments;	 // argv, arguments[0] included
+	uint64_t				 start_ticks = 0; // clock ticks since boot
+
+	std::chrono::system_clock::time_point startTime() const;
+
+	/**
+	 * Value following `option` in argv, given either as `-c value` or
+	 * `--option=value`. Empty when absent.
+	 */
+	std::string_view argumentValue(std::string_view option) const;
+};
+
+/**
+ * @brief Looks up processes by walking /proc directly, without fork/exec.
+ *
+ * Directory entries are read with getdents64 and every file is opened
+ * relative to the /proc descriptor. A process matches by name when its comm,
+ * the base name of argv[0] or of its executable equals the name, the same
+ * rules pidof uses (Suricata renames its main thread to "Suricata-Main").
+ * Processes that exit during the scan are skipped.
+ */
+class ProcessScanner
+{
+public:
+	static std::vector<ProcessInfo> findByName(std::string_view name);
+	static bool						isRunning(std::string_view name, pid_t ignored_pid = 0);
+
+	static bool inspect(pid_t pid, ProcessInfo &info);
+};
+} // namespace UTILS
+
+#endif // PROCESS_SCANNER_HPP
@@ -0,0 +1,422 @@
+#include "rule_evaluator.hpp"
+
+#include "mapped_file.hpp"
+#include "pcap_reader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_max_flows  = 65536;
+	constexpr std::size_t k_batch_size = 256;
+
+	constexpr uint8_t k_protocol_icmp	= 1;
+	constexpr uint8_t k_protocol_tcp	= 6;
+	constexpr uint8_t k_protocol_udp	= 17;
+	constexpr uint8_t k_protocol_icmpv6 = 58;
+	constexpr uint8_t k_protocol_sctp	= 132;
+
+	enum ProtocolClass : uint8_t
+	{
+		ProtocolTcp	  = 1 << 0,
+		ProtocolUdp	  = 1 << 1,
+		ProtocolIcmp  = 1 << 2,
+		ProtocolOther = 1 << 3,
+		ProtocolAny	  = ProtocolTcp | ProtocolUdp | ProtocolIcmp | ProtocolOther
+	};
+
+	struct ProtocolName
+	{
+		std::string_view name;
+		uint8_t			 protocols;
+	};
+
+	// App-layer protocols stand for the transports they run over, anything unknown matches all
+	constexpr std::array<ProtocolName, 17> k_protocol_names = {{
+		{"tcp", ProtocolTcp},
+		{"tcp-pkt", ProtocolTcp},
+		{"tcp-stream", ProtocolTcp},
+		{"udp", ProtocolUdp},
+		{"icmp", ProtocolIcmp},
+		{"icmpv4", ProtocolIcmp},
+		{"icmpv6", ProtocolIcmp},
+		{"http", ProtocolTcp},
+		{"http1", ProtocolTcp},
+		{"http2", ProtocolTcp},
+		{"tls", ProtocolTcp},
+		{"ssh", ProtocolTcp},
+		{"ftp", ProtocolTcp},
+		{"smtp", ProtocolTcp},
+		{"smb", ProtocolTcp},
+		{"dns", ProtocolTcp | ProtocolUdp},
+		{"sctp", ProtocolOther},
+	}};
+
+	// Options that only describe the rule, ignoring them does not change what matches
+	constexpr std::array<std::string_view, 6> k_descriptive_options = {"classtype", "metadata", "reference",
+																	   "priority",	"gid",		"target"};
+
+	uint8_t protocolClasses(std::string_view name)
+	{
+		for (const ProtocolName &entry : k_protocol_names)
+		{
+			if (entry.name.size() == name.size() &&
+				std::equal(name.begin(), name.end(), entry.name.begin(), [](char left, char right) {
+					return (left | 0x20) == right;
+				}))
+			{
+				return entry.protocols;
+			}
+		}
+		return ProtocolAny;
+	}
+
+	uint8_t protocolClass(uint8_t protocol)
+	{
+		switch (protocol)
+		{
+			case k_protocol_tcp:
+				return ProtocolTcp;
+			case k_protocol_udp:
+				return ProtocolUdp;
+			case k_protocol_icmp:
+			case k_protocol_icmpv6:
+				return ProtocolIcmp;
+			default:
+				return ProtocolOther;
+		}
+	}
+
+	bool hasPorts(uint8_t protocol)
+	{
+		return protocol == k_protocol_tcp || protocol == k_protocol_udp || protocol == k_protocol_sctp;
+	}
+
+	/**
+	 * IPv4 addresses are stored IPv4-mapped in the flow key.
+	 */
+	bool ipv4Address(const uint8_t *address, uint32_t &value)
+	{
+		static constexpr uint8_t k_mapped_prefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+		if (std::memcmp(address, k_mapped_prefix, sizeof(k_mapped_prefix)) != 0)
+		{
+			return false;
+		}
+		value = static_cast<uint32_t>(address[12]) << 24 | static_cast<uint32_t>(address[13]) << 16 |
+				static_cast<uint32_t>(address[14]) << 8 | address[15];
+		return true;
+	}
+
+	/**
+	 * Variables and IPv6 blocks are not resolved and match anything. A list
+	 * matches when one of its positive elements does, or it has none, and
+	 * none of its negated elements excludes the value.
+	 */
+	bool termMatches(const std::vector<RuleTerm> &terms, std::size_t index, bool has_value, uint32_t value)
+	{
+		const RuleTerm &term	= terms[index];
+		bool			matched = false;
+
+		switch (term.kind)
+		{
+			case RuleTerm::Kind::Any:
+			case RuleTerm::Kind::Variable:
+			case RuleTerm::Kind::Ipv6:
+				return true;
+			case RuleTerm::Kind::Ipv4:
+			case RuleTerm::Kind::Port:
+				matched = has_value && value >= term.first && value <= term.last;
+				break;
+			case RuleTerm::Kind::List:
+			{
+				bool positive		  = false;
+				bool positive_matched = false;
+				bool excluded		  = false;
+				for (std::size_t child = index + 1; child < term.end;
+					 child			   = terms[child].kind == RuleTerm::Kind::List ? terms[child].end : child + 1)
+				{
+					const bool child_matched = termMatches(terms, child, has_value, value);
+					if (terms[child].negated)
+					{
+						excluded = excluded || !child_matched;
+					}
+					else
+					{
+						positive		 = true;
+						positive_matched = positive_matched || child_matched;
+					}
+				}
+				matched = (!positive || positive_matched) && !excluded;
+				break;
+			}
+		}
+
+		return term.negated ? !matched : matched;
+	}
+
+	/**
+	 * The flow: keyword, flow_flags are RuleOption::FlowFlag bits. Fragments
+	 * are not tracked, only_frag never matches.
+	 */
+	bool flowMatches(const Flow &flow, FlowDirection direction, uint16_t flow_flags)
+	{
+		if ((flow_flags & RuleOption::FlowToServer) && direction != FlowDirection::ToServer)
+		{
+			return false;
+		}
+		if ((flow_flags & RuleOption::FlowToClient) && direction != FlowDirection::ToClient)
+		{
+			return false;
+		}
+
+		const bool established = flow.established();
+		if ((flow_flags & RuleOption::FlowEstablished) && !established)
+		{
+			return false;
+		}
+		if ((flow_flags & RuleOption::FlowNotEstablished) && established)
+		{
+			return false;
+		}
+
+		// Without reassembly only_stream is approximated by payload of an established TCP session
+		if ((flow_flags & RuleOption::FlowOnlyStream) && !(flow.key.protocol == k_protocol_tcp && established))
+		{
+			return false;
+		}
+		return (flow_flags & RuleOption::FlowOnlyFrag) == 0;
+	}
+} // namespace
+
+RuleEvaluator::RuleEvaluator() :
+	m_flows(k_max_flows),
+	m_error(0)
+{}
+
+bool RuleEvaluator::add(std::string_view text, RuleError &error)
+{
+	if (!RuleParser::parse(text, m_rule, error))
+	{
+		m_statistics.rejected++;
+		return false;
+	}
+
+	Header header;
+	header.sid				= m_rule.sid;
+	header.protocols		= protocolClasses(m_rule.slice(m_rule.protocol));
+	header.bidirectional	= m_rule.bidirectional;
+	header.source			= m_rule.source;
+	header.source_port		= m_rule.source_port;
+	header.destination		= m_rule.destination;
+	header.destination_port = m_rule.destination_port;
+	header.terms			= m_rule.terms;
+
+	bool approximated = false;
+	for (const RuleOption &option : m_rule.options)
+	{
+		if (option.kind == RuleOption::Kind::Flow)
+		{
+			header.flow_flags = option.flags;
+		}
+		else if (option.kind == RuleOption::Kind::Pcre)
+		{
+			approximated = true;
+		}
+		else if (option.kind == RuleOption::Kind::Other)
+		{
+			const bool descriptive = std::find(k_descriptive_options.begin(), k_descriptive_options.end(),
+											   m_rule.slice(option.name)) != k_descriptive_options.end();
+			approximated		   = approximated || !descriptive;
+		}
+	}
+
+	m_matcher.add(m_rule);
+	m_headers.push_back(std::move(header));
+	m_statistics.rules++;
+	m_statistics.approximated += approximated ? 1 : 0;
+	return true;
+}
+
+bool RuleEvaluator::loadFile(const std::string &path)
+{
+	MappedFile file;
+	if (!file.open(path))
+	{
+		m_error = file.error();
+		return false;
+	}
+
+	const std::string_view text = file.view();
+	std::string			   rule;
+	RuleError			   error;
+
+	std::size_t position = 0;
+	while (position < text.size())
+	{
+		std::size_t end = text.find('\n', position);
+		if (end == std::string_view::npos)
+		{
+			end = text.size();
+		}
+
+		std::string_view line = text.substr(position, end - position);
+		position			  = end + 1;
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.remove_suffix(1);
+		}
+
+		if (!line.empty() && line.back() == '\\')
+		{
+			rule.append(line.substr(0, line.size() - 1));
+			continue;
+		}
+		rule.append(line);
+
+		const std::size_t first = rule.find_first_not_of(" \t");
+		if (first != std::string::npos && rule[first] != '#')
+		{
+			add(rule, error);
+		}
+		rule.clear();
+	}
+
+	return true;
+}
+
+void RuleEvaluator::compile()
+{
+	m_matcher.compile();
+	m_alerts.assign(m_headers.size(), 0);
+}
+
+bool RuleEvaluator::evaluateFile(const std::string &path)
+{
+	const auto started = std::chrono::steady_clock::now();
+
+	PcapReader reader;
+	if (!reader.open(path))
+	{
+		m_error = reader.error();
+		return false;
+	}
+
+	std::array<PcapPacket, k_batch_size> batch;
+	while (const std::size_t count = reader.read(batch))
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const PcapPacket &packet = batch[i];
+			evaluate(packet.data, packet.captured_length, packet.link_type, packet.timestamp_ns / 1000);
+		}
+	}
+
+	m_statistics.elapsed +=
+		std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+
+	m_error = reader.error();
+	return m_error == 0;
+}
+
+void RuleEvaluator::evaluate(const uint8_t *data, std::size_t length, uint32_t link_type, uint64_t timestamp_us)
+{
+	m_statistics.packets++;
+
+	DecodedPacket packet;
+	if (m_decoder.decode(data, length, link_type, packet) != DecodedPacket::Status::Ok)
+	{
+		return;
+	}
+	m_statistics.decoded++;
+
+	FlowDirection direction = FlowDirection::ToServer;
+	const Flow	 *flow		= m_flows.update(packet.key, packet.tcp_flags, packet.payload_length, timestamp_us, direction);
+
+	const std::string_view payload(reinterpret_cast<const char *>(data) + packet.payload_offset, packet.payload_length);
+	m_matches.clear();
+	m_matcher.match(payload, m_scratch, m_matches);
+
+	for (const uint32_t rule : m_matches)
+	{
+		const Header &header = m_headers[rule];
+		if (!headerMatches(header, packet.key))
+		{
+			continue;
+		}
+
+		// A full table leaves the packet without a flow, only rules without flow: can still match
+		if (header.flow_flags != 0 && (flow == nullptr || !flowMatches(*flow, direction, header.flow_flags)))
+		{
+			continue;
+		}
+
+		m_alerts[rule]++;
+		m_statistics.alerts++;
+	}
+}
+
+bool RuleEvaluator::headerMatches(const Header &header, const FlowKey &key) const
+{
+	if ((header.protocols & protocolClass(key.protocol)) == 0)
+	{
+		return false;
+	}
+
+	uint32_t   source		   = 0;
+	uint32_t   destination	   = 0;
+	const bool has_source	   = ipv4Address(key.source, source);
+	const bool has_destination = ipv4Address(key.destination, destination);
+	const bool has_ports	   = hasPorts(key.protocol);
+
+	const auto oriented = [&](bool has_from, uint32_t from, uint16_t from_port, bool has_to, uint32_t to, uint16_t to_port) {
+		return termMatches(header.terms, header.source, has_from, from) &&
+			   termMatches(header.terms, header.source_port, has_ports, from_port) &&
+			   termMatches(header.terms, header.destination, has_to, to) &&
+			   termMatches(header.terms, header.destination_port, has_ports, to_port);
+	};
+
+	return oriented(has_source, source, key.source_port, has_destination, destination, key.destination_port) ||
+		   (header.bidirectional &&
+			oriented(has_destination, destination, key.destination_port, has_source, source, key.source_port));
+}
+
+std::vector<uint32_t> RuleEvaluator::alertedSids() const
+{
+	std::vector<uint32_t> sids;
+	for (std::size_t rule = 0; rule < m_alerts.size(); ++rule)
+	{
+		if (m_alerts[rule] != 0)
+		{
+			sids.push_back(m_headers[rule].sid);
+		}
+	}
+
+	std::sort(sids.begin(), sids.end());
+	sids.erase(std::unique(sids.begin(), sids.end()), sids.end());
+	return sids;
+}
+
+uint64_t RuleEvaluator::alerts(uint32_t sid) const
+{
+	uint64_t count = 0;
+	for (std::size_t rule = 0; rule < m_alerts.size(); ++rule)
+	{
+		count += m_headers[rule].sid == sid ? m_alerts[rule] : 0;
+	}
+	return count;
+}
+
+int RuleEvaluator::error() const
+{
+	return m_error;
+}
+
+const RuleEvaluator::Statistics &RuleEvaluator::statistics() const
+{
+	return m_statistics;
+}
+} // namespace UTILS
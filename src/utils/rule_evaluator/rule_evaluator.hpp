@@ -0,0 +1,113 @@
+#ifndef RULE_EVALUATOR_HPP
+#define RULE_EVALUATOR_HPP
+
+#include "content_matcher.hpp"
+#include "flow_table.hpp"
+#include "packet_decoder.hpp"
+#include "rule_parser.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief In-process approximation of Suricata's detection over a capture.
+ *
+ * Rules are parsed by RuleParser and all their contents are compiled into
+ * one ContentMatcher. A capture is read with PcapReader, every frame is
+ * decoded by PacketDecoder and accounted to its connection in a FlowTable,
+ * then its payload is scanned once for the whole rule set. A candidate
+ * alerts when its protocol, addresses, ports and flow options agree with
+ * the packet, at most once per packet as Suricata does.
+ *
+ * Meant for grading many rule sets in milliseconds, not for replacing the
+ * engine: there is no stream reassembly and no app-layer parsing, address
+ * and port variables match anything, and pcre and every option besides
+ * content, its modifiers and flow are not evaluated. Such a rule may alert
+ * where Suricata would not, it is counted in Statistics::approximated.
+ */
+class RuleEvaluator
+{
+public:
+	struct Statistics
+	{
+		std::size_t				  rules		   = 0;
+		std::size_t				  rejected	   = 0; // lines RuleParser refused
+		std::size_t				  approximated = 0; // rules with options that are not evaluated
+		uint64_t				  packets	   = 0;
+		uint64_t				  decoded	   = 0; // packets decoded down to the transport layer
+		uint64_t				  alerts	   = 0;
+		std::chrono::microseconds elapsed{0};
+	};
+
+public:
+	RuleEvaluator();
+
+	/**
+	 * Has to be called before compile(), the text is not kept.
+	 */
+	bool add(std::string_view text, RuleError &error);
+
+	/**
+	 * Adds every rule of a rules file, commented out rules are skipped and
+	 * lines ending with a backslash continue on the next one. False when the
+	 * file cannot be read.
+	 */
+	bool loadFile(const std::string &path);
+	void compile();
+
+	/**
+	 * Replays a pcap or pcapng file, alerts add up over calls. False when
+	 * the file cannot be read, error() holds the errno.
+	 */
+	bool evaluateFile(const std::string &path);
+	void evaluate(const uint8_t *data, std::size_t length, uint32_t link_type, uint64_t timestamp_us);
+
+	/**
+	 * SIDs that alerted at least once, in ascending order.
+	 */
+	std::vector<uint32_t> alertedSids() const;
+	uint64_t			  alerts(uint32_t sid) const;
+
+	int				  error() const;
+	const Statistics &statistics() const;
+
+private:
+	/**
+	 * What a packet has to satisfy besides the contents.
+	 */
+	struct Header
+	{
+		uint32_t			  sid			   = 0;
+		uint8_t				  protocols		   = 0; // ProtocolClass bits
+		bool				  bidirectional	   = false;
+		uint16_t			  flow_flags	   = 0; // RuleOption::FlowFlag bits
+		uint16_t			  source		   = 0;
+		uint16_t			  source_port	   = 0;
+		uint16_t			  destination	   = 0;
+		uint16_t			  destination_port = 0;
+		std::vector<RuleTerm> terms;
+	};
+
+	bool headerMatches(const Header &header, const FlowKey &key) const;
+
+private:
+	ContentMatcher			m_matcher;
+	ContentMatcher::Scratch m_scratch;
+	PacketDecoder			m_decoder;
+	FlowTable				m_flows;
+	std::vector<Header>		m_headers; // indexed like the matcher's rules
+	std::vector<uint64_t>	m_alerts;  // per rule
+	std::vector<uint32_t>	m_matches;
+	Rule					m_rule; // parse storage, reused
+	int						m_error;
+	Statistics				m_statistics;
+};
+} // namespace UTILS
+
+#endif // RULE_EVALUATOR_HPP
@@ -0,0 +1,403 @@
+#include "rule_index.hpp"
+
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+#include <sys/mman.h>
+#include <thread>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_chunk_size = 1024 * 1024;
+
+	const std::string_view k_actions[] = {"alert", "drop", "pass", "reject", "rejectsrc", "rejectdst", "rejectboth"};
+
+	struct Chunk
+	{
+		uint32_t	file_index = 0;
+		std::size_t begin	   = 0;
+		std::size_t end		   = 0;
+	};
+
+	struct ChunkResult
+	{
+		std::vector<RuleLocation> rules; // line numbers relative to the chunk until merged
+		uint32_t				  lines			 = 0;
+		std::size_t				  disabled_rules = 0;
+	};
+
+	bool isSpace(char character)
+	{
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	std::string_view trimLeft(std::string_view text)
+	{
+		std::size_t position = 0;
+		while (position < text.size() && isSpace(text[position]))
+		{
+			++position;
+		}
+		return text.substr(position);
+	}
+
+	std::string_view trimRight(std::string_view text)
+	{
+		while (!text.empty() && (isSpace(text.back()) || text.back() == '\n'))
+		{
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	/**
+	 * A backslash as the last visible character joins the next line.
+	 */
+	bool continues(std::string_view line)
+	{
+		line = trimRight(line);
+		return !line.empty() && line.back() == '\\';
+	}
+
+	bool startsWithAction(std::string_view text)
+	{
+		return std::any_of(std::begin(k_actions), std::end(k_actions), [&](std::string_view action) {
+			return text.size() > action.size() && text.substr(0, action.size()) == action && isSpace(text[action.size()]);
+		});
+	}
+
+	uint32_t parseNumber(std::string_view text)
+	{
+		text		   = trimLeft(trimRight(text));
+		uint32_t value = 0;
+		std::from_chars(text.data(), text.data() + text.size(), value);
+		return value;
+	}
+
+	std::string unquote(std::string_view value)
+	{
+		value = trimLeft(trimRight(value));
+		if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+		{
+			value = value.substr(1, value.size() - 2);
+		}
+
+		std::string text;
+		text.reserve(value.size());
+		for (std::size_t i = 0; i < value.size(); ++i)
+		{
+			if (value[i] == '\\' && i + 1 < value.size())
+			{
+				++i;
+			}
+			text += value[i];
+		}
+		return text;
+	}
+
+	/**
+	 * Walks "name:value;" options, honouring quotes and backslash escapes, and
+	 * keeps the few the index needs.
+	 */
+	void parseOptions(std::string_view rule, RuleLocation &location)
+	{
+		const std::size_t open = rule.find('(');
+		if (open == std::string_view::npos)
+		{
+			return;
+		}
+
+		std::size_t position = open + 1;
+		while (position < rule.size())
+		{
+			while (position < rule.size() && isSpace(rule[position]))
+			{
+				++position;
+			}
+
+			const std::size_t name_begin = position;
+			while (position < rule.size() && rule[position] != ':' && rule[position] != ';' && rule[position] != ')')
+			{
+				++position;
+			}
+			if (position >= rule.size() || rule[position] == ')')
+			{
+				return;
+			}
+
+			const std::string_view name = trimRight(rule.substr(name_begin, position - name_begin));
+			std::string_view	   value;
+
+			if (rule[position] == ':')
+			{
+				const std::size_t value_begin = ++position;
+				bool			  quoted	  = false;
+				while (position < rule.size() && (quoted || rule[position] != ';'))
+				{
+					if (rule[position] == '\\')
+					{
+						++position;
+					}
+					else if (rule[position] == '"')
+					{
+						quoted = !quoted;
+					}
+					++position;
+				}
+				value = rule.substr(value_begin, std::min(position, rule.size()) - value_begin);
+			}
+			++position;
+
+			if (name == "sid")
+			{
+				location.sid = parseNumber(value);
+			}
+			else if (name == "rev")
+			{
+				location.rev = parseNumber(value);
+			}
+			else if (name == "msg")
+			{
+				location.msg = unquote(value);
+			}
+		}
+	}
+
+	void parseChunk(std::string_view text, uint32_t file_index, ChunkResult &result)
+	{
+		std::string joined;
+		std::size_t position = 0;
+		uint32_t	line	 = 0;
+
+		while (position < text.size())
+		{
+			// Gather one logical line, physical lines ending in a backslash are joined
+			const uint32_t	 first_line = ++line;
+			std::size_t		 end		= text.find('\n', position);
+			end							= end == std::string_view::npos ? text.size() : end;
+			std::string_view logical	= text.substr(position, end - position);
+			position					= end + 1;
+
+			if (continues(logical))
+			{
+				joined.clear();
+				std::string_view physical = logical;
+				while (true)
+				{
+					physical = trimRight(physical);
+					if (physical.empty() || physical.back() != '\\' || position >= text.size())
+					{
+						joined.append(physical);
+						break;
+					}
+					joined.append(physical.substr(0, physical.size() - 1));
+
+					end		 = text.find('\n', position);
+					end		 = end == std::string_view::npos ? text.size() : end;
+					physical = text.substr(position, end - position);
+					position = end + 1;
+					++line;
+				}
+				logical = joined;
+			}
+
+			logical = trimLeft(logical);
+			if (logical.empty())
+			{
+				continue;
+			}
+			if (logical.front() == '#')
+			{
+				if (startsWithAction(trimLeft(logical.substr(1))))
+				{
+					++result.disabled_rules;
+				}
+				continue;
+			}
+
+			RuleLocation location;
+			location.file_index = file_index;
+			location.line		= first_line;
+			parseOptions(logical, location);
+			result.rules.push_back(std::move(location));
+		}
+
+		result.lines = line;
+	}
+
+	/**
+	 * Chunk ends are moved forward to the next line end that is not a
+	 * continuation, so no rule is ever split between two chunks.
+	 */
+	void splitFile(std::string_view text, uint32_t file_index, std::vector<Chunk> &chunks)
+	{
+		std::size_t begin = 0;
+		while (begin < text.size())
+		{
+			std::size_t end = text.size();
+			if (text.size() - begin > k_chunk_size)
+			{
+				// rfind() yields npos for the first line, npos + 1 wraps to 0
+				std::size_t line_start = text.rfind('\n', begin + k_chunk_size - 1) + 1;
+				std::size_t newline	   = text.find('\n', begin + k_chunk_size);
+				while (newline != std::string_view::npos && continues(text.substr(line_start, newline - line_start)))
+				{
+					line_start = newline + 1;
+					newline	   = text.find('\n', line_start);
+				}
+				end = newline == std::string_view::npos ? text.size() : newline + 1;
+			}
+
+			chunks.push_back({file_index, begin, end});
+			begin = end;
+		}
+	}
+} // namespace
+
+void RuleIndex::load(const std::vector<std::string> &files, unsigned threads)
+{
+	const auto started = std::chrono::steady_clock::now();
+
+	m_files = files;
+	m_missing_files.clear();
+	m_rules.clear();
+	m_duplicates.clear();
+	m_without_sid.clear();
+	m_statistics	   = Statistics();
+	m_statistics.files = files.size();
+
+	std::vector<MappedFile> mapped(files.size());
+	std::vector<Chunk>		chunks;
+
+	for (std::size_t index = 0; index < files.size(); ++index)
+	{
+		if (!mapped[index].open(files[index]))
+		{
+			m_missing_files.push_back(files[index]);
+			continue;
+		}
+		mapped[index].advise(MADV_SEQUENTIAL);
+		m_statistics.bytes += mapped[index].size();
+		splitFile(mapped[index].view(), static_cast<uint32_t>(index), chunks);
+	}
+
+	std::vector<ChunkResult> results(chunks.size());
+	std::atomic<std::size_t> next{0};
+
+	const auto worker = [&]() {
+		for (std::size_t index = next++; index < chunks.size(); index = next++)
+		{
+			const Chunk &chunk = chunks[index];
+			parseChunk(mapped[chunk.file_index].view().substr(chunk.begin, chunk.end - chunk.begin), chunk.file_index,
+					   results[index]);
+		}
+	};
+
+	if (threads == 0)
+	{
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(chunks.size())));
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (unsigned i = 1; i < threads; ++i)
+	{
+		pool.emplace_back(worker);
+	}
+	worker();
+	for (std::thread &thread : pool)
+	{
+		thread.join();
+	}
+
+	// Chunks are in file and offset order, merging them in sequence restores absolute line numbers
+	m_rules.reserve(std::accumulate(results.begin(), results.end(), std::size_t(0), [](std::size_t sum, const auto &result) {
+		return sum + result.rules.size();
+	}));
+
+	uint32_t line_base	   = 0;
+	uint32_t previous_file = 0;
+	for (std::size_t index = 0; index < chunks.size(); ++index)
+	{
+		if (index == 0 || chunks[index].file_index != previous_file)
+		{
+			line_base	  = 0;
+			previous_file = chunks[index].file_index;
+		}
+
+		ChunkResult &result = results[index];
+
+		m_statistics.disabled_rules += result.disabled_rules;
+		m_statistics.rules			+= result.rules.size();
+
+		for (RuleLocation &location : result.rules)
+		{
+			location.line += line_base;
+			if (location.sid == 0)
+			{
+				m_without_sid.push_back(std::move(location));
+				continue;
+			}
+
+			const auto [it, inserted] = m_rules.try_emplace(location.sid, location);
+			if (!inserted)
+			{
+				m_duplicates.push_back({it->second, std::move(location)});
+			}
+		}
+		line_base += result.lines;
+	}
+
+	m_statistics.chunks	 = chunks.size();
+	m_statistics.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+}
+
+const RuleLocation *RuleIndex::find(uint32_t sid) const
+{
+	const auto it = m_rules.find(sid);
+	return it != m_rules.end() ? &it->second : nullptr;
+}
+
+std::size_t RuleIndex::size() const
+{
+	return m_rules.size();
+}
+
+const std::vector<std::string> &RuleIndex::files() const
+{
+	return m_files;
+}
+
+const std::string &RuleIndex::filePath(const RuleLocation &location) const
+{
+	return m_files[location.file_index];
+}
+
+const std::vector<std::string> &RuleIndex::missingFiles() const
+{
+	return m_missing_files;
+}
+
+const std::vector<RuleIndex::Duplicate> &RuleIndex::duplicates() const
+{
+	return m_duplicates;
+}
+
+const std::vector<RuleLocation> &RuleIndex::rulesWithoutSid() const
+{
+	return m_without_sid;
+}
+
+const RuleIndex::Statistics &RuleIndex::statistics() const
+{
+	return m_statistics;
+}
+} // namespace UTILS
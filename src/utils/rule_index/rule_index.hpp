@@ -0,0 +1,79 @@
+#ifndef RULE_INDEX_HPP
+#define RULE_INDEX_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Where a rule was found and what it is called.
+ */
+struct RuleLocation
+{
+	uint32_t	sid		   = 0; // 0 when the rule has none
+	uint32_t	rev		   = 0;
+	uint32_t	file_index = 0; // into RuleIndex::files()
+	uint32_t	line	   = 0; // first line of the rule, 1 based
+	std::string msg;
+};
+
+/**
+ * @brief SID index over a set of Suricata rule files.
+ *
+ * Every file is memory mapped and cut into chunks of about a megabyte at
+ * line ends that do not continue the rule on the next line, all chunks of
+ * all files are then parsed on one thread per core. Commented out rules
+ * are counted but not indexed, rules spread over several lines with a
+ * trailing backslash are joined. The first rule seen for a SID in file and
+ * line order wins, later ones are reported as duplicates.
+ */
+class RuleIndex
+{
+public:
+	struct Duplicate
+	{
+		RuleLocation first;
+		RuleLocation second;
+	};
+
+	struct Statistics
+	{
+		std::size_t				  files			 = 0;
+		std::size_t				  chunks		 = 0;
+		uint64_t				  bytes			 = 0;
+		std::size_t				  rules			 = 0;
+		std::size_t				  disabled_rules = 0;
+		std::chrono::microseconds elapsed{0};
+	};
+
+public:
+	/**
+	 * Replaces the current contents. threads == 0 uses one per core.
+	 */
+	void load(const std::vector<std::string> &files, unsigned threads = 0);
+
+	const RuleLocation *find(uint32_t sid) const;
+	std::size_t			size() const;
+
+	const std::vector<std::string>	&files() const;
+	const std::string				&filePath(const RuleLocation &location) const;
+	const std::vector<std::string>	&missingFiles() const;
+	const std::vector<Duplicate>	&duplicates() const;
+	const std::vector<RuleLocation> &rulesWithoutSid() const;
+	const Statistics				&statistics() const;
+
+private:
+	std::vector<std::string>				   m_files;
+	std::vector<std::string>				   m_missing_files;
+	std::unordered_map<uint32_t, RuleLocation> m_rules;
+	std::vector<Duplicate>					   m_duplicates;
+	std::vector<RuleLocation>				   m_without_sid;
+	Statistics								   m_statistics;
+};
+} // namespace UTILS
+
+#endif // RULE_INDEX_HPP
@@ -0,0 +1,1054 @@
+#include "rule_parser.hpp"
+
+#include <algorithm>
+#include <charconv>
+
+namespace UTILS
+{
+namespace
+{
+	using Code	   = RuleError::Code;
+	using Kind	   = RuleOption::Kind;
+	using TermKind = RuleTerm::Kind;
+
+	constexpr std::size_t k_max_terms	   = 0xffff; // term indices are 16 bit
+	constexpr int		  k_max_list_depth = 16;
+
+	struct ActionName
+	{
+		std::string_view name;
+		Rule::Action	 action;
+	};
+
+	constexpr ActionName k_actions[] = {
+		{"alert", Rule::Action::Alert},
+		{"drop", Rule::Action::Drop},
+		{"pass", Rule::Action::Pass},
+		{"reject", Rule::Action::Reject},
+		{"rejectsrc", Rule::Action::RejectSrc},
+		{"rejectdst", Rule::Action::RejectDst},
+		{"rejectboth", Rule::Action::RejectBoth},
+	};
+
+	// Packet level protocols and the application layers Suricata 6 and 7 accept in the header
+	constexpr std::string_view k_protocols[] = {
+		"ip", "tcp", "udp", "icmp", "icmpv4", "icmpv6", "sctp", "pkthdr", "tcp-pkt", "tcp-stream", "http", "http1", "http2",
+		"ftp", "ftp-data", "tls", "ssl", "smb", "dcerpc", "dns", "ssh", "smtp", "imap", "modbus", "dnp3", "enip", "nfs",
+		"ikev2", "ike", "krb5", "ntp", "dhcp", "rfb", "rdp", "snmp", "sip", "mqtt", "quic", "tftp", "pgsql", "telnet",
+		"websocket", "ldap", "bittorrent-dht"
+	};
+
+	struct OptionName
+	{
+		std::string_view name;
+		Kind			 kind;
+	};
+
+	constexpr OptionName k_options[] = {
+		{"msg", Kind::Msg},
+		{"content", Kind::Content},
+		{"pcre", Kind::Pcre},
+		{"flow", Kind::Flow},
+		{"sid", Kind::Sid},
+		{"rev", Kind::Rev},
+		{"nocase", Kind::Nocase},
+		{"offset", Kind::Offset},
+		{"depth", Kind::Depth},
+		{"distance", Kind::Distance},
+		{"within", Kind::Within},
+		{"fast_pattern", Kind::FastPattern},
+	};
+
+	struct FlowName
+	{
+		std::string_view name;
+		uint16_t		 flag;
+	};
+
+	constexpr FlowName k_flow_keywords[] = {
+		{"to_server", RuleOption::FlowToServer},
+		{"from_client", RuleOption::FlowToServer},
+		{"to_client", RuleOption::FlowToClient},
+		{"from_server", RuleOption::FlowToClient},
+		{"established", RuleOption::FlowEstablished},
+		{"not_established", RuleOption::FlowNotEstablished},
+		{"stateless", RuleOption::FlowStateless},
+		{"only_stream", RuleOption::FlowOnlyStream},
+		{"no_stream", RuleOption::FlowNoStream},
+		{"only_frag", RuleOption::FlowOnlyFrag},
+		{"no_frag", RuleOption::FlowNoFrag},
+	};
+
+	// Pairs of flow keywords that cannot be combined
+	constexpr uint16_t k_flow_conflicts[][2] = {
+		{RuleOption::FlowToServer, RuleOption::FlowToClient},
+		{RuleOption::FlowEstablished, RuleOption::FlowNotEstablished},
+		{RuleOption::FlowEstablished, RuleOption::FlowStateless},
+		{RuleOption::FlowOnlyStream, RuleOption::FlowNoStream},
+		{RuleOption::FlowOnlyFrag, RuleOption::FlowNoFrag},
+	};
+
+	constexpr std::string_view k_pcre_modifiers = "ismxAEGORUIPHDMCSYVWZTQBJ";
+
+	bool isSpace(char character)
+	{
+		return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+	}
+
+	bool isDigit(char character)
+	{
+		return character >= '0' && character <= '9';
+	}
+
+	bool isHex(char character)
+	{
+		return isDigit(character) || (character >= 'a' && character <= 'f') || (character >= 'A' && character <= 'F');
+	}
+
+	bool isAlpha(char character)
+	{
+		return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+	}
+
+	bool isNameChar(char character)
+	{
+		return isAlpha(character) || isDigit(character) || character == '_' || character == '.' || character == '-';
+	}
+
+	bool parseUnsigned(std::string_view text, uint32_t max, uint32_t &value)
+	{
+		if (text.empty() || !std::all_of(text.begin(), text.end(), isDigit))
+		{
+			return false;
+		}
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && value <= max;
+	}
+
+	bool parseIpv4(std::string_view text, uint32_t &address)
+	{
+		address = 0;
+		for (int octet = 0; octet < 4; ++octet)
+		{
+			const std::size_t dot = octet < 3 ? text.find('.') : text.size();
+			uint32_t		  value;
+			if (dot == std::string_view::npos || dot > 3 || !parseUnsigned(text.substr(0, dot), 255, value))
+			{
+				return false;
+			}
+			address = (address << 8) | value;
+			text.remove_prefix(octet < 3 ? dot + 1 : dot);
+		}
+		return text.empty();
+	}
+
+	bool parseIpv6(std::string_view text)
+	{
+		if (text.size() < 2 || text.find(":::") != std::string_view::npos)
+		{
+			return false;
+		}
+		const std::size_t compressed = text.find("::");
+		if (compressed != std::string_view::npos && text.find("::", compressed + 1) != std::string_view::npos)
+		{
+			return false;
+		}
+		// An embedded IPv4 tail ("::ffff:1.2.3.4") may only follow the last colon
+		const std::size_t last_colon = text.rfind(':');
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			if (!isHex(text[i]) && text[i] != ':' && !(text[i] == '.' && i > last_colon))
+			{
+				return false;
+			}
+		}
+		uint32_t ipv4;
+		return text.find('.') == std::string_view::npos || parseIpv4(text.substr(last_colon + 1), ipv4);
+	}
+
+	/**
+	 * Offset of the first malformed byte of a content value, npos if it is
+	 * well formed. Decoded bytes go to bytes unless it is null.
+	 */
+	std::size_t contentErrorAt(std::string_view value, std::string *bytes)
+	{
+		if (value.empty())
+		{
+			return 0;
+		}
+
+		bool		hex		  = false;
+		std::size_t hex_begin = 0;
+		int			nibble	  = -1;
+
+		for (std::size_t i = 0; i < value.size(); ++i)
+		{
+			const char character = value[i];
+			if (hex)
+			{
+				if (character == '|')
+				{
+					if (nibble >= 0)
+					{
+						return i - 1;
+					}
+					hex = false;
+				}
+				else if (isHex(character))
+				{
+					const int digit = isDigit(character) ? character - '0' : (character | 0x20) - 'a' + 10;
+					if (nibble < 0)
+					{
+						nibble = digit;
+					}
+					else
+					{
+						if (bytes)
+						{
+							bytes->push_back(static_cast<char>(nibble << 4 | digit));
+						}
+						nibble = -1;
+					}
+				}
+				else if (character != ' ')
+				{
+					return i;
+				}
+				continue;
+			}
+
+			if (character == '|')
+			{
+				hex		  = true;
+				hex_begin = i;
+			}
+			else if (character == '\\')
+			{
+				if (i + 1 >= value.size() || (value[i + 1] != '"' && value[i + 1] != ';' && value[i + 1] != '\\'))
+				{
+					return i;
+				}
+				if (bytes)
+				{
+					bytes->push_back(value[++i]);
+				}
+				else
+				{
+					++i;
+				}
+			}
+			else if (character == '"' || character == ';')
+			{
+				return i;
+			}
+			else if (bytes)
+			{
+				bytes->push_back(character);
+			}
+		}
+		return hex ? hex_begin : std::string_view::npos;
+	}
+
+	RuleSpan makeSpan(std::size_t begin, std::size_t end)
+	{
+		return {static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)};
+	}
+
+	class Parser
+	{
+	public:
+		Parser(std::string_view text, Rule &rule, RuleError &error) :
+			m_text(text),
+			m_rule(rule),
+			m_error(error)
+		{}
+
+		bool parse();
+
+	private:
+		bool fail(Code code, std::size_t begin, std::size_t end);
+		void skipSpaces();
+
+		/**
+		 * End of the header token at the cursor, brackets may enclose spaces.
+		 */
+		std::size_t tokenEnd() const;
+
+		bool parseAction();
+		bool parseProtocol();
+		bool parseField(bool port, uint16_t &root);
+		bool parseTerm(std::size_t &position, std::size_t end, bool port, int depth);
+		bool parseElement(std::size_t begin, std::size_t end, bool port, RuleTerm &term);
+		bool parseDirection();
+		bool parseOptions();
+		bool interpretOption(RuleOption &option, std::size_t option_begin, bool has_value);
+		bool parseQuoted(RuleOption &option, bool allow_negation);
+		bool parseFlow(RuleOption &option);
+		bool parseModifier(RuleOption &option, bool has_value);
+
+	private:
+		std::string_view m_text;
+		Rule			&m_rule;
+		RuleError		&m_error;
+		std::size_t		 m_position		= 0;
+		int				 m_last_content = -1;
+	};
+
+	bool Parser::fail(Code code, std::size_t begin, std::size_t end)
+	{
+		m_error.code = code;
+		m_error.span = makeSpan(begin, std::max(begin, std::min(end, m_text.size())));
+		return false;
+	}
+
+	void Parser::skipSpaces()
+	{
+		while (m_position < m_text.size() && isSpace(m_text[m_position]))
+		{
+			++m_position;
+		}
+	}
+
+	std::size_t Parser::tokenEnd() const
+	{
+		int			depth = 0;
+		std::size_t end	  = m_position;
+		for (; end < m_text.size(); ++end)
+		{
+			const char character = m_text[end];
+			if (character == '[')
+			{
+				++depth;
+			}
+			else if (character == ']')
+			{
+				--depth;
+			}
+			else if (depth <= 0 && (isSpace(character) || character == '('))
+			{
+				break;
+			}
+		}
+		return end;
+	}
+
+	bool Parser::parse()
+	{
+		m_rule.text = m_text;
+		m_rule.terms.clear();
+		m_rule.options.clear();
+		m_rule.bidirectional = false;
+		m_rule.sid			 = 0;
+		m_rule.rev			 = 0;
+		m_error				 = RuleError();
+
+		skipSpaces();
+		if (m_position >= m_text.size())
+		{
+			return fail(Code::EmptyRule, 0, m_text.size());
+		}
+
+		return parseAction() && parseProtocol() && parseField(false, m_rule.source) &&
+			   parseField(true, m_rule.source_port) && parseDirection() && parseField(false, m_rule.destination) &&
+			   parseField(true, m_rule.destination_port) && parseOptions();
+	}
+
+	bool Parser::parseAction()
+	{
+		const std::size_t	   begin = m_position;
+		const std::size_t	   end	 = tokenEnd();
+		const std::string_view name	 = m_text.substr(begin, end - begin);
+
+		const auto it = std::find_if(std::begin(k_actions), std::end(k_actions), [&](const ActionName &action) {
+			return action.name == name;
+		});
+		if (it == std::end(k_actions))
+		{
+			return fail(Code::UnknownAction, begin, end);
+		}
+
+		m_rule.action	   = it->action;
+		m_rule.action_span = makeSpan(begin, end);
+		m_position		   = end;
+		return true;
+	}
+
+	bool Parser::parseProtocol()
+	{
+		skipSpaces();
+		const std::size_t begin = m_position;
+		const std::size_t end	= tokenEnd();
+		if (begin == end)
+		{
+			return fail(Code::MissingProtocol, begin, end);
+		}
+
+		const std::string_view name = m_text.substr(begin, end - begin);
+		if (std::find(std::begin(k_protocols), std::end(k_protocols), name) == std::end(k_protocols))
+		{
+			return fail(Code::UnknownProtocol, begin, end);
+		}
+
+		m_rule.protocol = makeSpan(begin, end);
+		m_position		= end;
+		return true;
+	}
+
+	bool Parser::parseField(bool port, uint16_t &root)
+	{
+		skipSpaces();
+		const std::size_t end = tokenEnd();
+		if (m_position == end)
+		{
+			return fail(port ? Code::MissingPort : Code::MissingAddress, m_position, m_position);
+		}
+		if (end == m_text.size() && std::count(m_text.begin() + m_position, m_text.end(), '[') >
+										std::count(m_text.begin() + m_position, m_text.end(), ']'))
+		{
+			// An unclosed list swallowed the rest of the rule, point at the list instead
+			std::size_t list_end = m_position;
+			while (list_end < m_text.size() && !isSpace(m_text[list_end]))
+			{
+				++list_end;
+			}
+			return fail(Code::UnbalancedList, m_position, list_end);
+		}
+
+		root = static_cast<uint16_t>(m_rule.terms.size());
+		if (!parseTerm(m_position, end, port, 0))
+		{
+			return false;
+		}
+		if (m_position != end)
+		{
+			// A closing bracket without an opening one
+			return fail(Code::UnbalancedList, m_position, end);
+		}
+		return true;
+	}
+
+	bool Parser::parseTerm(std::size_t &position, std::size_t end, bool port, int depth)
+	{
+		while (position < end && isSpace(m_text[position]))
+		{
+			++position;
+		}
+
+		const std::size_t begin	  = position;
+		bool			  negated = false;
+		if (position < end && m_text[position] == '!')
+		{
+			negated = true;
+			++position;
+		}
+
+		if (m_rule.terms.size() >= k_max_terms || depth > k_max_list_depth)
+		{
+			return fail(Code::TooComplex, begin, end);
+		}
+
+		const std::size_t index = m_rule.terms.size();
+		m_rule.terms.emplace_back();
+		m_rule.terms[index].negated = negated;
+
+		if (position < end && m_text[position] == '[')
+		{
+			m_rule.terms[index].kind = TermKind::List;
+			++position;
+
+			while (true)
+			{
+				if (!parseTerm(position, end, port, depth + 1))
+				{
+					return false;
+				}
+				while (position < end && isSpace(m_text[position]))
+				{
+					++position;
+				}
+				if (position >= end)
+				{
+					return fail(Code::UnbalancedList, begin, end);
+				}
+				if (m_text[position] == ']')
+				{
+					++position;
+					break;
+				}
+				if (m_text[position] != ',')
+				{
+					return fail(port ? Code::InvalidPort : Code::InvalidAddress, position, position + 1);
+				}
+				++position;
+			}
+		}
+		else
+		{
+			const std::size_t element_begin = position;
+			while (position < end && m_text[position] != ',' && m_text[position] != ']' && m_text[position] != '[' &&
+				   !isSpace(m_text[position]))
+			{
+				++position;
+			}
+			if (!parseElement(element_begin, position, port, m_rule.terms[index]))
+			{
+				return false;
+			}
+		}
+
+		m_rule.terms[index].end	 = static_cast<uint16_t>(m_rule.terms.size());
+		m_rule.terms[index].span = makeSpan(begin, position);
+		return true;
+	}
+
+	bool Parser::parseElement(std::size_t begin, std::size_t end, bool port, RuleTerm &term)
+	{
+		const std::string_view text	   = m_text.substr(begin, end - begin);
+		const Code			   invalid = port ? Code::InvalidPort : Code::InvalidAddress;
+
+		if (text.empty())
+		{
+			return fail(invalid, begin, begin + 1);
+		}
+		if (text == "any")
+		{
+			term.kind = TermKind::Any;
+			return true;
+		}
+		if (text.front() == '$')
+		{
+			term.kind = TermKind::Variable;
+			if (text.size() == 1 || !std::all_of(text.begin() + 1, text.end(), [](char character) {
+					return isAlpha(character) || isDigit(character) || character == '_';
+				}))
+			{
+				return fail(invalid, begin, end);
+			}
+			return true;
+		}
+
+		if (port)
+		{
+			// 80, 1024:, :1023, 1024:65535
+			const std::size_t colon = text.find(':');
+			term.kind				= TermKind::Port;
+			if (colon == std::string_view::npos)
+			{
+				if (!parseUnsigned(text, 65535, term.first))
+				{
+					return fail(invalid, begin, end);
+				}
+				term.last = term.first;
+				return true;
+			}
+
+			const std::string_view low	= text.substr(0, colon);
+			const std::string_view high = text.substr(colon + 1);
+			term.first					= 0;
+			term.last					= 65535;
+			if ((low.empty() && high.empty()) || (!low.empty() && !parseUnsigned(low, 65535, term.first)) ||
+				(!high.empty() && !parseUnsigned(high, 65535, term.last)) || term.first > term.last)
+			{
+				return fail(invalid, begin, end);
+			}
+			return true;
+		}
+
+		const std::size_t	   slash   = text.find('/');
+		const std::string_view address = text.substr(0, slash);
+		const std::string_view mask	   = slash == std::string_view::npos ? std::string_view() : text.substr(slash + 1);
+
+		if (address.find(':') != std::string_view::npos)
+		{
+			uint32_t prefix = 128;
+			if (!parseIpv6(address) || (slash != std::string_view::npos && !parseUnsigned(mask, 128, prefix)))
+			{
+				return fail(invalid, begin, end);
+			}
+			term.kind	= TermKind::Ipv6;
+			term.prefix = static_cast<uint8_t>(slash == std::string_view::npos ? 0 : prefix);
+			return true;
+		}
+
+		term.kind = TermKind::Ipv4;
+
+		const std::size_t dash = address.find('-');
+		if (dash != std::string_view::npos)
+		{
+			if (slash != std::string_view::npos || !parseIpv4(address.substr(0, dash), term.first) ||
+				!parseIpv4(address.substr(dash + 1), term.last) || term.first > term.last)
+			{
+				return fail(invalid, begin, end);
+			}
+			return true;
+		}
+
+		uint32_t value;
+		if (!parseIpv4(address, value))
+		{
+			return fail(invalid, begin, slash == std::string_view::npos ? end : begin + slash);
+		}
+
+		uint32_t prefix = 32;
+		if (slash != std::string_view::npos)
+		{
+			uint32_t netmask;
+			if (parseIpv4(mask, netmask))
+			{
+				// Dotted netmask, the set bits have to be contiguous
+				prefix = 0;
+				while (prefix < 32 && (netmask & (0x80000000u >> prefix)))
+				{
+					++prefix;
+				}
+				if (prefix < 32 && (netmask << prefix) != 0)
+				{
+					return fail(invalid, begin + slash + 1, end);
+				}
+			}
+			else if (!parseUnsigned(mask, 32, prefix))
+			{
+				return fail(invalid, begin + slash + 1, end);
+			}
+			term.prefix = static_cast<uint8_t>(prefix);
+		}
+
+		const uint32_t netmask = prefix == 0 ? 0 : ~0u << (32 - prefix);
+		term.first			   = value & netmask;
+		term.last			   = term.first | ~netmask;
+		return true;
+	}
+
+	bool Parser::parseDirection()
+	{
+		skipSpaces();
+		const std::size_t	   begin = m_position;
+		const std::size_t	   end	 = tokenEnd();
+		const std::string_view arrow = m_text.substr(begin, end - begin);
+
+		if (arrow != "->" && arrow != "<>")
+		{
+			return fail(Code::InvalidDirection, begin, std::max(end, begin + 1));
+		}
+
+		m_rule.bidirectional = arrow == "<>";
+		m_rule.direction	 = makeSpan(begin, end);
+		m_position			 = end;
+		return true;
+	}
+
+	bool Parser::parseOptions()
+	{
+		skipSpaces();
+		if (m_position >= m_text.size() || m_text[m_position] != '(')
+		{
+			return fail(Code::MissingOptions, m_position, tokenEnd());
+		}
+
+		const std::size_t open = m_position++;
+		m_last_content		   = -1;
+
+		while (true)
+		{
+			skipSpaces();
+			if (m_position >= m_text.size())
+			{
+				return fail(Code::UnterminatedOptions, open, m_text.size());
+			}
+			if (m_text[m_position] == ')')
+			{
+				break;
+			}
+
+			const std::size_t option_begin = m_position;
+			while (m_position < m_text.size() && isNameChar(m_text[m_position]))
+			{
+				++m_position;
+			}
+
+			RuleOption option;
+			option.name = makeSpan(option_begin, m_position);
+			if (option.name.length == 0)
+			{
+				return fail(Code::InvalidOptionName, m_position, m_position + 1);
+			}
+
+			skipSpaces();
+			bool has_value = false;
+			if (m_position < m_text.size() && m_text[m_position] == ':')
+			{
+				// Values end at the first unescaped semicolon, Suricata does not look at quotes
+				const std::size_t value_begin = ++m_position;
+				while (m_position < m_text.size() && m_text[m_position] != ';')
+				{
+					m_position += m_text[m_position] == '\\' ? 2 : 1;
+				}
+				if (m_position >= m_text.size())
+				{
+					const std::size_t close = m_text.rfind(')');
+					return fail(Code::MissingSemicolon, option_begin,
+								close != std::string_view::npos && close > value_begin ? close : m_text.size());
+				}
+
+				std::size_t value_end = m_position;
+				std::size_t trimmed	  = value_begin;
+				while (trimmed < value_end && isSpace(m_text[trimmed]))
+				{
+					++trimmed;
+				}
+				while (value_end > trimmed && isSpace(m_text[value_end - 1]))
+				{
+					--value_end;
+				}
+				option.value = makeSpan(trimmed, value_end);
+				has_value	 = true;
+			}
+			else if (m_position >= m_text.size() || m_text[m_position] == ')')
+			{
+				return fail(Code::MissingSemicolon, option_begin, m_position);
+			}
+			else if (m_text[m_position] != ';')
+			{
+				return fail(Code::InvalidOptionName, option_begin, m_position + 1);
+			}
+
+			++m_position; // the semicolon
+			if (!interpretOption(option, option_begin, has_value))
+			{
+				return false;
+			}
+			m_rule.options.push_back(option);
+		}
+
+		const std::size_t close = m_position++;
+		skipSpaces();
+		if (m_position < m_text.size())
+		{
+			return fail(Code::TrailingText, m_position, m_text.size());
+		}
+		if (m_rule.sid == 0)
+		{
+			return fail(Code::MissingSid, open, close + 1);
+		}
+		return true;
+	}
+
+	bool Parser::interpretOption(RuleOption &option, std::size_t option_begin, bool has_value)
+	{
+		const std::string_view name = m_rule.slice(option.name);
+		for (const OptionName &known : k_options)
+		{
+			if (known.name == name)
+			{
+				option.kind = known.kind;
+				break;
+			}
+		}
+
+		const std::size_t option_end =
+			option.value.length ? option.value.offset + option.value.length : option_begin + name.size();
+
+		switch (option.kind)
+		{
+			case Kind::Msg:
+			case Kind::Content:
+			case Kind::Pcre:
+				if (!has_value || option.value.length == 0)
+				{
+					return fail(Code::MissingValue, option_begin, option_end);
+				}
+				if (!parseQuoted(option, option.kind != Kind::Msg))
+				{
+					return false;
+				}
+				if (option.kind == Kind::Content)
+				{
+					const std::size_t error = contentErrorAt(m_rule.slice(option.value), nullptr);
+					if (error != std::string_view::npos)
+					{
+						const std::size_t offset = option.value.offset + error;
+						return fail(Code::InvalidContent, offset, option.value.length ? offset + 1 : option_end);
+					}
+					m_last_content = static_cast<int>(m_rule.options.size());
+				}
+				else if (option.kind == Kind::Pcre)
+				{
+					const std::string_view pattern = m_rule.slice(option.value);
+					const std::size_t	   close   = pattern.rfind('/');
+					if (pattern.size() < 3 || pattern.front() != '/' || close == 0 || close == 1)
+					{
+						return fail(Code::InvalidPcre, option.value.offset, option.value.offset + option.value.length);
+					}
+					for (std::size_t i = close + 1; i < pattern.size(); ++i)
+					{
+						if (k_pcre_modifiers.find(pattern[i]) == std::string_view::npos)
+						{
+							return fail(Code::InvalidPcre, option.value.offset + i, option.value.offset + i + 1);
+						}
+					}
+				}
+				return true;
+			case Kind::Flow:
+				if (!has_value || option.value.length == 0)
+				{
+					return fail(Code::MissingValue, option_begin, option_end);
+				}
+				if (m_rule.find(Kind::Flow))
+				{
+					return fail(Code::DuplicateOption, option_begin, option_end);
+				}
+				return parseFlow(option);
+			case Kind::Sid:
+			case Kind::Rev: {
+				if (!has_value || option.value.length == 0)
+				{
+					return fail(Code::MissingValue, option_begin, option_end);
+				}
+				if (m_rule.find(option.kind))
+				{
+					return fail(Code::DuplicateOption, option_begin, option_end);
+				}
+				uint32_t value;
+				if (!parseUnsigned(m_rule.slice(option.value), 0x7fffffff, value) || (option.kind == Kind::Sid && value == 0))
+				{
+					return fail(Code::InvalidNumber, option.value.offset, option.value.offset + option.value.length);
+				}
+				option.number = static_cast<int32_t>(value);
+				if (option.kind == Kind::Sid)
+				{
+					m_rule.sid = value;
+				}
+				else
+				{
+					m_rule.rev = value;
+				}
+				return true;
+			}
+			case Kind::Nocase:
+			case Kind::Offset:
+			case Kind::Depth:
+			case Kind::Distance:
+			case Kind::Within:
+			case Kind::FastPattern:
+				if (m_last_content < 0)
+				{
+					return fail(Code::ModifierWithoutContent, option_begin, option_end);
+				}
+				option.content = static_cast<uint16_t>(m_last_content);
+				return parseModifier(option, has_value);
+			case Kind::Other:
+				return true;
+		}
+		return true;
+	}
+
+	bool Parser::parseQuoted(RuleOption &option, bool allow_negation)
+	{
+		std::size_t begin = option.value.offset;
+		std::size_t end	  = begin + option.value.length;
+
+		if (allow_negation && m_text[begin] == '!')
+		{
+			option.negated = true;
+			++begin;
+			while (begin < end && isSpace(m_text[begin]))
+			{
+				++begin;
+			}
+		}
+		if (begin >= end || m_text[begin] != '"')
+		{
+			return fail(Code::UnterminatedString, begin, begin + 1);
+		}
+		// The closing quote must not be escaped, an even run of backslashes before it escapes only themselves
+		std::size_t backslashes = 0;
+		while (end - 2 - backslashes > begin && m_text[end - 2 - backslashes] == '\\')
+		{
+			++backslashes;
+		}
+		if (end - begin < 2 || m_text[end - 1] != '"' || backslashes % 2 != 0)
+		{
+			return fail(Code::UnterminatedString, begin, end);
+		}
+
+		option.value = makeSpan(begin + 1, end - 1);
+		return true;
+	}
+
+	bool Parser::parseFlow(RuleOption &option)
+	{
+		const std::size_t value_end = option.value.offset + option.value.length;
+		std::size_t		  position	= option.value.offset;
+
+		while (position <= value_end)
+		{
+			std::size_t comma = m_text.find(',', position);
+			comma			  = comma == std::string_view::npos || comma > value_end ? value_end : comma;
+
+			std::size_t begin = position;
+			std::size_t end	  = comma;
+			while (begin < end && isSpace(m_text[begin]))
+			{
+				++begin;
+			}
+			while (end > begin && isSpace(m_text[end - 1]))
+			{
+				--end;
+			}
+
+			const std::string_view keyword = m_text.substr(begin, end - begin);
+			const auto it = std::find_if(std::begin(k_flow_keywords), std::end(k_flow_keywords), [&](const FlowName &flow) {
+				return flow.name == keyword;
+			});
+			if (it == std::end(k_flow_keywords))
+			{
+				return fail(Code::InvalidFlow, begin, std::max(end, begin + 1));
+			}
+			option.flags |= it->flag;
+			position	  = comma + 1;
+		}
+
+		for (const auto &conflict : k_flow_conflicts)
+		{
+			if ((option.flags & conflict[0]) && (option.flags & conflict[1]))
+			{
+				return fail(Code::ConflictingFlow, option.value.offset, value_end);
+			}
+		}
+		return true;
+	}
+
+	bool Parser::parseModifier(RuleOption &option, bool has_value)
+	{
+		if (option.kind == Kind::FastPattern)
+		{
+			return true; // "only" and "offset,length" forms are not interpreted
+		}
+		if (option.kind == Kind::Nocase)
+		{
+			return !has_value || fail(Code::UnexpectedValue, option.value.offset, option.value.offset + option.value.length);
+		}
+
+		const std::size_t value_end = option.value.offset + option.value.length;
+		if (!has_value || option.value.length == 0)
+		{
+			return fail(Code::MissingValue, option.name.offset, option.name.offset + option.name.length);
+		}
+
+		const std::string_view value = m_rule.slice(option.value);
+		if (isAlpha(value.front()) || value.front() == '_')
+		{
+			// A byte_extract variable, only known at match time
+			return true;
+		}
+
+		const bool negative = value.front() == '-';
+		if (negative && option.kind != Kind::Distance)
+		{
+			return fail(Code::InvalidNumber, option.value.offset, value_end);
+		}
+		uint32_t number;
+		if (!parseUnsigned(value.substr(negative ? 1 : 0), 65535, number))
+		{
+			return fail(Code::InvalidNumber, option.value.offset, value_end);
+		}
+		option.number = negative ? -static_cast<int32_t>(number) : static_cast<int32_t>(number);
+		return true;
+	}
+} // namespace
+
+std::string_view Rule::slice(RuleSpan span) const
+{
+	return text.substr(span.offset, span.length);
+}
+
+const RuleOption *Rule::find(RuleOption::Kind kind) const
+{
+	const auto it = std::find_if(options.begin(), options.end(), [&](const RuleOption &option) {
+		return option.kind == kind;
+	});
+	return it != options.end() ? &*it : nullptr;
+}
+
+std::size_t Rule::count(RuleOption::Kind kind) const
+{
+	return std::count_if(options.begin(), options.end(), [&](const RuleOption &option) {
+		return option.kind == kind;
+	});
+}
+
+bool RuleParser::parse(std::string_view text, Rule &rule, RuleError &error)
+{
+	return Parser(text, rule, error).parse();
+}
+
+bool RuleParser::decodeContent(std::string_view value, std::string &bytes)
+{
+	bytes.clear();
+	return contentErrorAt(value, &bytes) == std::string_view::npos;
+}
+
+const char *RuleParser::describe(RuleError::Code code)
+{
+	switch (code)
+	{
+		case Code::None:
+			return "no error";
+		case Code::EmptyRule:
+			return "empty rule";
+		case Code::UnknownAction:
+			return "unknown action";
+		case Code::MissingProtocol:
+			return "missing protocol";
+		case Code::UnknownProtocol:
+			return "unknown protocol";
+		case Code::MissingAddress:
+			return "missing address";
+		case Code::InvalidAddress:
+			return "invalid address";
+		case Code::MissingPort:
+			return "missing port";
+		case Code::InvalidPort:
+			return "invalid port";
+		case Code::UnbalancedList:
+			return "unbalanced brackets";
+		case Code::InvalidDirection:
+			return "direction must be -> or <>";
+		case Code::MissingOptions:
+			return "missing option list";
+		case Code::UnterminatedOptions:
+			return "option list is not closed";
+		case Code::MissingSemicolon:
+			return "option is not terminated by a semicolon";
+		case Code::InvalidOptionName:
+			return "invalid option name";
+		case Code::MissingValue:
+			return "option needs a value";
+		case Code::UnexpectedValue:
+			return "option takes no value";
+		case Code::UnterminatedString:
+			return "value must be a quoted string";
+		case Code::InvalidContent:
+			return "invalid content";
+		case Code::InvalidPcre:
+			return "invalid pcre";
+		case Code::InvalidFlow:
+			return "unknown flow keyword";
+		case Code::ConflictingFlow:
+			return "conflicting flow keywords";
+		case Code::InvalidNumber:
+			return "invalid number";
+		case Code::ModifierWithoutContent:
+			return "content modifier without a preceding content";
+		case Code::DuplicateOption:
+			return "option given twice";
+		case Code::MissingSid:
+			return "rule has no sid";
+		case Code::TrailingText:
+			return "text after the option list";
+		case Code::TooComplex:
+			return "address or port list is too large";
+	}
+	return "unknown error";
+}
+} // namespace UTILS
@@ -0,0 +1,200 @@
+#ifndef RULE_PARSER_HPP
+#define RULE_PARSER_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Byte range in the parsed rule text.
+ */
+struct RuleSpan
+{
+	uint32_t offset = 0;
+	uint32_t length = 0;
+};
+
+/**
+ * @brief One address or port expression of the rule header.
+ *
+ * Terms are stored in preorder, a list is followed by its elements and
+ * end is the index just past its last element.
+ */
+struct RuleTerm
+{
+	enum class Kind : uint8_t
+	{
+		Any,
+		Variable, // $HOME_NET, $HTTP_PORTS
+		Ipv4,	  // single address, CIDR block or range, see first and last
+		Ipv6,	  // only validated, the value is left in the span
+		Port,	  // single port or range, see first and last
+		List
+	};
+
+	Kind	 kind	 = Kind::Any;
+	bool	 negated = false;
+	uint8_t	 prefix	 = 0; // CIDR prefix length, 0 without one
+	uint16_t end	 = 0;
+	uint32_t first	 = 0; // lowest address (host order) or port
+	uint32_t last	 = 0; // highest address or port
+	RuleSpan span;
+};
+
+/**
+ * @brief One "name:value;" entry of the option list.
+ */
+struct RuleOption
+{
+	enum class Kind : uint8_t
+	{
+		Msg,
+		Content,
+		Pcre,
+		Flow,
+		Sid,
+		Rev,
+		Nocase, // content modifiers, see RuleOption::content
+		Offset,
+		Depth,
+		Distance,
+		Within,
+		FastPattern,
+		Other // not interpreted
+	};
+
+	enum FlowFlag : uint16_t
+	{
+		FlowToServer	   = 1 << 0, // also from_client
+		FlowToClient	   = 1 << 1, // also from_server
+		FlowEstablished	   = 1 << 2,
+		FlowNotEstablished = 1 << 3,
+		FlowStateless	   = 1 << 4,
+		FlowOnlyStream	   = 1 << 5,
+		FlowNoStream	   = 1 << 6,
+		FlowOnlyFrag	   = 1 << 7,
+		FlowNoFrag		   = 1 << 8
+	};
+
+	Kind	 kind	 = Kind::Other;
+	bool	 negated = false; // content:!"..."
+	uint16_t flags	 = 0;	  // FlowFlag bits
+	uint16_t content = 0;	  // modifiers: index of the content option they apply to
+	int32_t	 number	 = 0;	  // sid, rev, offset, depth, distance and within
+	RuleSpan name;
+	RuleSpan value; // without the quotes for msg, content and pcre
+};
+
+/**
+ * @brief A parsed rule, spans point into text.
+ *
+ * The text is not copied, it has to outlive the rule. Parsing into the
+ * same object again reuses the term and option storage.
+ */
+struct Rule
+{
+	enum class Action : uint8_t
+	{
+		Alert,
+		Drop,
+		Pass,
+		Reject,
+		RejectSrc,
+		RejectDst,
+		RejectBoth
+	};
+
+	std::string_view text;
+
+	Action	 action = Action::Alert;
+	RuleSpan action_span;
+	RuleSpan protocol;
+	bool	 bidirectional = false; // "<>" instead of "->"
+	RuleSpan direction;
+
+	// Root terms of the four header fields, indices into terms
+	uint16_t source			  = 0;
+	uint16_t source_port	  = 0;
+	uint16_t destination	  = 0;
+	uint16_t destination_port = 0;
+
+	std::vector<RuleTerm>	terms;
+	std::vector<RuleOption> options;
+
+	uint32_t sid = 0;
+	uint32_t rev = 0;
+
+	std::string_view  slice(RuleSpan span) const;
+	const RuleOption *find(RuleOption::Kind kind) const;
+	std::size_t		  count(RuleOption::Kind kind) const;
+};
+
+/**
+ * @brief Why a rule was rejected and where.
+ */
+struct RuleError
+{
+	enum class Code : uint8_t
+	{
+		None,
+		EmptyRule,
+		UnknownAction,
+		MissingProtocol,
+		UnknownProtocol,
+		MissingAddress,
+		InvalidAddress,
+		MissingPort,
+		InvalidPort,
+		UnbalancedList,
+		InvalidDirection,
+		MissingOptions,
+		UnterminatedOptions,
+		MissingSemicolon,
+		InvalidOptionName,
+		MissingValue,
+		UnexpectedValue,
+		UnterminatedString,
+		InvalidContent,
+		InvalidPcre,
+		InvalidFlow,
+		ConflictingFlow,
+		InvalidNumber,
+		ModifierWithoutContent,
+		DuplicateOption,
+		MissingSid,
+		TrailingText,
+		TooComplex
+	};
+
+	Code	 code = Code::None;
+	RuleSpan span; // points at the offending text, zero length at the end of input
+};
+
+/**
+ * @brief Recursive descent parser for single Suricata rules.
+ *
+ * Covers the header (action, protocol, addresses, ports, direction) and
+ * the option list. msg, content, pcre, flow, sid, rev and the content
+ * modifiers are checked and interpreted, any other well formed option is
+ * kept as Other. Nothing is allocated besides the term and option vectors
+ * of the rule, the first error stops the parse.
+ */
+class RuleParser
+{
+public:
+	static bool parse(std::string_view text, Rule &rule, RuleError &error);
+
+	/**
+	 * Content bytes with |hex| blocks and escapes resolved, false if the
+	 * value is malformed.
+	 */
+	static bool decodeContent(std::string_view value, std::string &bytes);
+
+	static const char *describe(RuleError::Code code);
+};
+} // namespace UTILS
+
+#endif // RULE_PARSER_HPP
@@ -0,0 +1,471 @@
+#include "rule_profile.hpp"
+
+#include "line_tailer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <iterator>
+#include <unistd.h>
+#include <utility>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::string_view k_whitespace		= " \t\r\n";
+	constexpr std::string_view k_section_prefix = "Stats for:";
+	constexpr std::string_view k_total_section	= "total";
+	constexpr std::size_t	   k_max_label_words = 3; // "Avg No Match"
+
+	std::string_view trim(std::string_view text)
+	{
+		const std::size_t begin = text.find_first_not_of(k_whitespace);
+		if (begin == std::string_view::npos)
+		{
+			return {};
+		}
+		const std::size_t end = text.find_last_not_of(k_whitespace);
+		return text.substr(begin, end - begin + 1);
+	}
+
+	void split(std::string_view text, std::vector<std::string_view> &fields)
+	{
+		fields.clear();
+		std::size_t position = 0;
+		while (true)
+		{
+			const std::size_t begin = text.find_first_not_of(k_whitespace, position);
+			if (begin == std::string_view::npos)
+			{
+				return;
+			}
+			const std::size_t end = std::min(text.find_first_of(k_whitespace, begin), text.size());
+			fields.push_back(text.substr(begin, end - begin));
+			position = end;
+		}
+	}
+
+	template <typename T>
+	bool parseNumber(std::string_view text, T &value)
+	{
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+} // namespace
+
+RuleProfileParser::RuleProfileParser() :
+	m_keyword_table(false),
+	m_lines(0),
+	m_malformed(0)
+{}
+
+void RuleProfileParser::feed(std::string_view line)
+{
+	m_lines++;
+
+	line = trim(line);
+	if (line.empty())
+	{
+		m_columns.clear();
+		return;
+	}
+
+	// Rulers frame the date, the section name and the column header
+	if (line.front() == '-')
+	{
+		return;
+	}
+
+	if (line.starts_with(k_section_prefix))
+	{
+		m_section = std::string(trim(line.substr(k_section_prefix.size())));
+		m_columns.clear();
+		return;
+	}
+
+	if (readHeader(line) || m_columns.empty())
+	{
+		return;
+	}
+
+	// Anything that is not shaped like a row, the next "Date:" line for one, ends the table
+	split(line, m_fields);
+	if (m_fields.size() != m_columns.size())
+	{
+		m_columns.clear();
+		return;
+	}
+
+	if (!(m_keyword_table ? readKeyword(m_fields) : readRule(m_fields)))
+	{
+		m_malformed++;
+	}
+}
+
+bool RuleProfileParser::parseFile(const std::string &path)
+{
+	if (access(path.c_str(), R_OK) != 0)
+	{
+		return false;
+	}
+
+	// The dump is read in buffer sized pieces, lines are handed over as views into the buffer
+	LineTailer tailer(path);
+	tailer.poll([this](std::string_view line) {
+		feed(line);
+	});
+	m_columns.clear();
+	return true;
+}
+
+void RuleProfileParser::reset()
+{
+	m_columns.clear();
+	m_keyword_table = false;
+	m_section.clear();
+	m_rules.clear();
+	m_keywords.clear();
+	m_rule_slots.clear();
+	m_keyword_slots.clear();
+	m_lines		= 0;
+	m_malformed = 0;
+}
+
+const std::vector<RuleProfile> &RuleProfileParser::rules() const
+{
+	return m_rules;
+}
+
+std::vector<RuleProfile> RuleProfileParser::topRules(std::size_t count, SortKey key) const
+{
+	const auto value = [key](const RuleProfile &rule) {
+		switch (key)
+		{
+			case SortKey::Ticks:
+				return static_cast<double>(rule.ticks);
+			case SortKey::Checks:
+				return static_cast<double>(rule.checks);
+			case SortKey::AverageTicks:
+				return rule.average_ticks;
+		}
+		return 0.0;
+	};
+
+	std::vector<RuleProfile> top = m_rules;
+	count						 = std::min(count, top.size());
+	std::partial_sort(top.begin(), top.begin() + static_cast<std::ptrdiff_t>(count), top.end(),
+					  [&](const RuleProfile &left, const RuleProfile &right) {
+						  const double left_value  = value(left);
+						  const double right_value = value(right);
+						  return left_value != right_value ? left_value > right_value : left.sid < right.sid;
+					  });
+	top.resize(count);
+	return top;
+}
+
+uint64_t RuleProfileParser::totalTicks() const
+{
+	uint64_t total = 0;
+	for (const RuleProfile &rule : m_rules)
+	{
+		total += rule.ticks;
+	}
+	return total;
+}
+
+std::vector<KeywordProfile> RuleProfileParser::keywords() const
+{
+	std::vector<KeywordProfile> keywords;
+
+	const bool has_total = std::any_of(m_keywords.begin(), m_keywords.end(), [](const KeywordProfile &keyword) {
+		return keyword.section == k_total_section;
+	});
+
+	if (has_total)
+	{
+		std::copy_if(m_keywords.begin(), m_keywords.end(), std::back_inserter(keywords),
+					 [](const KeywordProfile &keyword) {
+						 return keyword.section == k_total_section;
+					 });
+	}
+	else
+	{
+		// Per buffer sections only, the averages are weighted by the checks behind them
+		std::unordered_map<std::string, std::size_t> slots;
+		std::vector<std::pair<double, double>>		 weighted; // match and no match ticks per keyword
+		for (const KeywordProfile &entry : m_keywords)
+		{
+			const auto [slot, inserted] = slots.try_emplace(entry.keyword, keywords.size());
+			if (inserted)
+			{
+				keywords.push_back({entry.keyword, std::string(k_total_section)});
+				weighted.emplace_back(0.0, 0.0);
+			}
+
+			KeywordProfile &keyword	 = keywords[slot->second];
+			keyword.ticks			+= entry.ticks;
+			keyword.checks			+= entry.checks;
+			keyword.matches			+= entry.matches;
+			keyword.max_ticks		 = std::max(keyword.max_ticks, entry.max_ticks);
+
+			weighted[slot->second].first  += entry.average_match * static_cast<double>(entry.matches);
+			weighted[slot->second].second += entry.average_no_match * static_cast<double>(entry.checks - entry.matches);
+		}
+
+		for (std::size_t i = 0; i < keywords.size(); ++i)
+		{
+			KeywordProfile &keyword = keywords[i];
+			const uint64_t	misses	= keyword.checks - keyword.matches;
+
+			keyword.average_ticks	 = keyword.checks > 0 ? static_cast<double>(keyword.ticks) / keyword.checks : 0.0;
+			keyword.average_match	 = keyword.matches > 0 ? weighted[i].first / keyword.matches : 0.0;
+			keyword.average_no_match = misses > 0 ? weighted[i].second / misses : 0.0;
+		}
+	}
+
+	std::sort(keywords.begin(), keywords.end(), [](const KeywordProfile &left, const KeywordProfile &right) {
+		return left.ticks != right.ticks ? left.ticks > right.ticks : left.keyword < right.keyword;
+	});
+	return keywords;
+}
+
+uint64_t RuleProfileParser::lines() const
+{
+	return m_lines;
+}
+
+uint64_t RuleProfileParser::malformed() const
+{
+	return m_malformed;
+}
+
+bool RuleProfileParser::readHeader(std::string_view line)
+{
+	static constexpr std::array<std::pair<std::string_view, Column>, 14> labels = {{
+		{"Num", Column::Number},
+		{"Rule", Column::Sid},
+		{"Gid", Column::Gid},
+		{"Rev", Column::Rev},
+		{"Keyword", Column::Keyword},
+		{"Ticks", Column::Ticks},
+		{"%", Column::Percent},
+		{"Checks", Column::Checks},
+		{"Matches", Column::Matches},
+		{"Max Ticks", Column::MaxTicks},
+		{"Avg Ticks", Column::AverageTicks},
+		{"Avg", Column::AverageTicks},
+		{"Avg Match", Column::AverageMatch},
+		{"Avg No Match", Column::AverageNoMatch},
+	}};
+
+	// Cheap rejection first, this runs for every row of the table
+	if (!line.starts_with("Num") && !line.starts_with("Keyword"))
+	{
+		return false;
+	}
+
+	split(line, m_fields);
+
+	std::vector<Column> columns;
+	std::string			label;
+	for (std::size_t i = 0; i < m_fields.size();)
+	{
+		// Longest label first, "Avg No Match" must not be read as "Avg" and two unknown columns
+		std::size_t words = std::min(k_max_label_words, m_fields.size() - i);
+		Column		column = Column::Unknown;
+		for (; words > 0; --words)
+		{
+			label.assign(m_fields[i]);
+			for (std::size_t word = 1; word < words; ++word)
+			{
+				label.append(" ").append(m_fields[i + word]);
+			}
+
+			const auto found = std::find_if(labels.begin(), labels.end(), [&](const auto &entry) {
+				return entry.first == label;
+			});
+			if (found != labels.end())
+			{
+				column = found->second;
+				break;
+			}
+		}
+
+		columns.push_back(column);
+		i += std::max<std::size_t>(words, 1);
+	}
+
+	const bool keyword_table = columns.front() == Column::Keyword;
+	const bool rule_table	 = std::find(columns.begin(), columns.end(), Column::Sid) != columns.end();
+	const bool has_cost		 = std::find(columns.begin(), columns.end(), Column::Checks) != columns.end();
+	if ((!keyword_table && !rule_table) || !has_cost)
+	{
+		return false;
+	}
+
+	m_columns		= std::move(columns);
+	m_keyword_table = keyword_table;
+	return true;
+}
+
+bool RuleProfileParser::readRule(const std::vector<std::string_view> &fields)
+{
+	RuleProfile rule;
+	bool		has_sid		= false;
+	bool		has_ticks	= false;
+	bool		has_average = false;
+
+	for (std::size_t i = 0; i < fields.size(); ++i)
+	{
+		const std::string_view field = fields[i];
+		bool				   parsed = true;
+		switch (m_columns[i])
+		{
+			case Column::Sid:
+				parsed	= parseNumber(field, rule.sid);
+				has_sid = parsed;
+				break;
+			case Column::Gid:
+				parsed = parseNumber(field, rule.gid);
+				break;
+			case Column::Rev:
+				parsed = parseNumber(field, rule.rev);
+				break;
+			case Column::Ticks:
+				parsed	  = parseNumber(field, rule.ticks);
+				has_ticks = parsed;
+				break;
+			case Column::Percent:
+				parsed = parseNumber(field, rule.percent);
+				break;
+			case Column::Checks:
+				parsed = parseNumber(field, rule.checks);
+				break;
+			case Column::Matches:
+				parsed = parseNumber(field, rule.matches);
+				break;
+			case Column::MaxTicks:
+				parsed = parseNumber(field, rule.max_ticks);
+				break;
+			case Column::AverageTicks:
+				parsed		= parseNumber(field, rule.average_ticks);
+				has_average = parsed;
+				break;
+			case Column::AverageMatch:
+				parsed = parseNumber(field, rule.average_match);
+				break;
+			case Column::AverageNoMatch:
+				parsed = parseNumber(field, rule.average_no_match);
+				break;
+			default:
+				break;
+		}
+
+		if (!parsed)
+		{
+			return false;
+		}
+	}
+
+	if (!has_sid)
+	{
+		return false;
+	}
+
+	if (!has_ticks)
+	{
+		rule.ticks = static_cast<uint64_t>(rule.average_ticks * static_cast<double>(rule.checks));
+	}
+	else if (!has_average && rule.checks > 0)
+	{
+		rule.average_ticks = static_cast<double>(rule.ticks) / rule.checks;
+	}
+
+	const uint64_t key			= (static_cast<uint64_t>(rule.gid) << 32) | rule.sid;
+	const auto [slot, inserted] = m_rule_slots.try_emplace(key, m_rules.size());
+	if (inserted)
+	{
+		m_rules.push_back(rule);
+	}
+	else
+	{
+		m_rules[slot->second] = rule;
+	}
+	return true;
+}
+
+bool RuleProfileParser::readKeyword(const std::vector<std::string_view> &fields)
+{
+	KeywordProfile keyword;
+	bool		   has_ticks   = false;
+	bool		   has_average = false;
+
+	keyword.section = m_section.empty() ? std::string(k_total_section) : m_section;
+
+	for (std::size_t i = 0; i < fields.size(); ++i)
+	{
+		const std::string_view field = fields[i];
+		bool				   parsed = true;
+		switch (m_columns[i])
+		{
+			case Column::Keyword:
+				keyword.keyword = std::string(field);
+				break;
+			case Column::Ticks:
+				parsed	  = parseNumber(field, keyword.ticks);
+				has_ticks = parsed;
+				break;
+			case Column::Checks:
+				parsed = parseNumber(field, keyword.checks);
+				break;
+			case Column::Matches:
+				parsed = parseNumber(field, keyword.matches);
+				break;
+			case Column::MaxTicks:
+				parsed = parseNumber(field, keyword.max_ticks);
+				break;
+			case Column::AverageTicks:
+				parsed		= parseNumber(field, keyword.average_ticks);
+				has_average = parsed;
+				break;
+			case Column::AverageMatch:
+				parsed = parseNumber(field, keyword.average_match);
+				break;
+			case Column::AverageNoMatch:
+				parsed = parseNumber(field, keyword.average_no_match);
+				break;
+			default:
+				break;
+		}
+
+		if (!parsed)
+		{
+			return false;
+		}
+	}
+
+	if (!has_ticks)
+	{
+		keyword.ticks = static_cast<uint64_t>(keyword.average_ticks * static_cast<double>(keyword.checks));
+	}
+	else if (!has_average && keyword.checks > 0)
+	{
+		keyword.average_ticks = static_cast<double>(keyword.ticks) / keyword.checks;
+	}
+
+	std::string key				= keyword.section;
+	key						   += '\n';
+	key						   += keyword.keyword;
+	const auto [slot, inserted] = m_keyword_slots.try_emplace(std::move(key), m_keywords.size());
+	if (inserted)
+	{
+		m_keywords.push_back(std::move(keyword));
+	}
+	else
+	{
+		m_keywords[slot->second] = std::move(keyword);
+	}
+	return true;
+}
+} // namespace UTILS
@@ -0,0 +1,126 @@
+#ifndef RULE_PROFILE_HPP
+#define RULE_PROFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Cost of one rule as reported in rule_perf.log.
+ */
+struct RuleProfile
+{
+	uint32_t gid			  = 1;
+	uint32_t sid			  = 0;
+	uint32_t rev			  = 0;
+	uint64_t ticks			  = 0;
+	uint64_t checks			  = 0;
+	uint64_t matches		  = 0;
+	uint64_t max_ticks		  = 0;
+	double	 percent		  = 0.0; // share of the ticks of all profiled rules
+	double	 average_ticks	  = 0.0; // per check
+	double	 average_match	  = 0.0; // per check that matched
+	double	 average_no_match = 0.0;
+};
+
+/**
+ * @brief Cost of one keyword as reported in keyword_perf.log.
+ */
+struct KeywordProfile
+{
+	std::string	keyword;
+	std::string	section; // "total" or the inspection buffer
+	uint64_t	ticks			 = 0;
+	uint64_t	checks			 = 0;
+	uint64_t	matches			 = 0;
+	uint64_t	max_ticks		 = 0;
+	double		average_ticks	 = 0.0;
+	double		average_match	 = 0.0;
+	double		average_no_match = 0.0;
+};
+
+/**
+ * @brief Line by line parser of Suricata's text profiling dumps.
+ *
+ * Both rule_perf.log and keyword_perf.log are understood. A table is
+ * recognised by its column header, columns are mapped by name so the
+ * layouts of different Suricata versions parse alike, and every following
+ * row with the same number of fields is taken until the table ends. Rules
+ * show up once per sort order and once per dump, each is kept once and a
+ * later row replaces an earlier one, so memory grows with the number of
+ * rules rather than with the size of the dump. parseFile() streams the log
+ * through LineTailer.
+ */
+class RuleProfileParser
+{
+public:
+	enum class SortKey
+	{
+		Ticks,
+		Checks,
+		AverageTicks
+	};
+
+public:
+	RuleProfileParser();
+
+	void feed(std::string_view line);
+	bool parseFile(const std::string &path);
+	void reset();
+
+	const std::vector<RuleProfile> &rules() const;
+	std::vector<RuleProfile>		topRules(std::size_t count, SortKey key) const;
+	uint64_t						totalTicks() const;
+
+	/**
+	 * The "total" section when the dump has one, otherwise every section
+	 * summed per keyword. Sorted by ticks, most expensive first.
+	 */
+	std::vector<KeywordProfile> keywords() const;
+
+	uint64_t lines() const;
+	uint64_t malformed() const; // rows inside a table that could not be read
+
+private:
+	enum class Column : uint8_t
+	{
+		Unknown,
+		Number,
+		Sid,
+		Gid,
+		Rev,
+		Keyword,
+		Ticks,
+		Percent,
+		Checks,
+		Matches,
+		MaxTicks,
+		AverageTicks,
+		AverageMatch,
+		AverageNoMatch
+	};
+
+	bool readHeader(std::string_view line);
+	bool readRule(const std::vector<std::string_view> &fields);
+	bool readKeyword(const std::vector<std::string_view> &fields);
+
+private:
+	std::vector<Column>							 m_columns;		  // of the table being read, empty outside of one
+	bool										 m_keyword_table;
+	std::string									 m_section;
+	std::vector<RuleProfile>					 m_rules;
+	std::vector<KeywordProfile>					 m_keywords;
+	std::unordered_map<uint64_t, std::size_t>	 m_rule_slots;	  // gid << 32 | sid to m_rules
+	std::unordered_map<std::string, std::size_t> m_keyword_slots; // section and keyword to m_keywords
+	std::vector<std::string_view>				 m_fields;
+	uint64_t									 m_lines;
+	uint64_t									 m_malformed;
+};
+} // namespace UTILS
+
+#endif // RULE_PROFILE_HPP
@@ -4,6 +4,7 @@
 #include "spdlog_wrapper.hpp"
 
 #include <QApplication>
+#include <QFileInfo>
 #include <qfontdatabase.h>
 #include <qvariant.h>
 
@@ -48,6 +49,20 @@ void SettingsManager::populateSettings()
 		Group::APPLICATION);
 	populateSetting(Setting::LAST_OPEN_PANEL, DEFAULTS::d_settings_setting_last_open_panel,
 					QVariant::fromValue(DEFAULTS::d_application_default_panel), Group::APPLICATION);
+	populateSetting(Setting::CAPTURE_INTERFACES, DEFAULTS::d_settings_setting_capture_ifaces, QString(),
+					Group::APPLICATION); // comma separated, empty - ranked automatically
+	populateSetting(Setting::VALIDATION_MODE, DEFAULTS::d_settings_setting_validation_mode, QString("live"),
+					Group::APPLICATION); // live or offline
+	populateSetting(Setting::OFFLINE_CAPTURE, DEFAULTS::d_settings_setting_offline_capture, QString(),
+					Group::APPLICATION); // pcap replayed in offline mode, empty - the bundled one
+	populateSetting(Setting::OFFLINE_SCENARIO, DEFAULTS::d_settings_setting_offline_scenario, QString(),
+					Group::APPLICATION); // TrafficScenario file generated instead of the capture
+	populateSetting(Setting::OFFLINE_EXPECTED_ALERTS, DEFAULTS::d_settings_setting_offline_alerts, 1,
+					Group::APPLICATION); // at least this many alerts for the replay to pass
+	populateSetting(Setting::EXPECTED_SIDS, DEFAULTS::d_settings_setting_expected_sids, QString(),
+					Group::APPLICATION); // comma separated rules that have to fire, empty - any alert passes
+	populateSetting(Setting::RULE_PROFILING, DEFAULTS::d_settings_setting_rule_profiling, false,
+					Group::APPLICATION); // offline mode only, needs Suricata built with --enable-profiling
 
 	// [Language defaults]
 	populateSetting(Setting::TRANSLATION_LANG, DEFAULTS::d_settings_setting_translation_lang,
@@ -304,6 +319,13 @@ bool SettingsManager::isChanged(Setting setting) const
 	return this->m_changed_settings.contains(setting);
 }
 
+QString SettingsManager::getSettingsDirectory() const
+{
+	QMutexLocker locker(&this->m_mutex);
+
+	return QFileInfo(this->m_settings->fileName()).absolutePath();
+}
+
 void SettingsManager::clearChanges()
 {
 	QMutexLocker locker(&this->m_mutex);
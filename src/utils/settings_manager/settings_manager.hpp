@@ -22,6 +22,13 @@ public:
 	{
 		WINDOW_RECT,
 		LAST_OPEN_PANEL,
+		CAPTURE_INTERFACES,
+		VALIDATION_MODE,
+		OFFLINE_CAPTURE,
+		OFFLINE_SCENARIO,
+		OFFLINE_EXPECTED_ALERTS,
+		EXPECTED_SIDS,
+		RULE_PROFILING,
 
 		TRANSLATION_LANG,
 
@@ -54,6 +61,8 @@ public:
 
 	bool isChanged(Setting setting) const;
 
+	QString getSettingsDirectory() const;
+
 	void clearChanges();
 	void saveChanges();
 	void discardChanges();
@@ -0,0 +1,341 @@
+#include "stage_timer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_sub_bucket_bits = 2; // log2 of StageHistogram::d_sub_buckets
+	const std::string	  k_file_header		= "# stage_timings 1";
+
+	std::string formatMilliseconds(std::chrono::microseconds elapsed)
+	{
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.1f ms", static_cast<double>(elapsed.count()) / 1000.0);
+		return buffer;
+	}
+} // namespace
+
+void StageHistogram::add(std::chrono::microseconds elapsed)
+{
+	const uint64_t microseconds = elapsed.count() > 0 ? static_cast<uint64_t>(elapsed.count()) : 0;
+
+	++m_buckets[bucketIndex(microseconds)];
+	m_min	= m_count == 0 ? microseconds : std::min(m_min, microseconds);
+	m_max	= std::max(m_max, microseconds);
+	m_last	= microseconds;
+	m_total += microseconds;
+	++m_count;
+}
+
+void StageHistogram::clear()
+{
+	*this = StageHistogram();
+}
+
+uint64_t StageHistogram::count() const
+{
+	return m_count;
+}
+
+std::chrono::microseconds StageHistogram::total() const
+{
+	return std::chrono::microseconds(m_total);
+}
+
+std::chrono::microseconds StageHistogram::min() const
+{
+	return std::chrono::microseconds(m_min);
+}
+
+std::chrono::microseconds StageHistogram::max() const
+{
+	return std::chrono::microseconds(m_max);
+}
+
+std::chrono::microseconds StageHistogram::last() const
+{
+	return std::chrono::microseconds(m_last);
+}
+
+std::chrono::microseconds StageHistogram::percentile(double fraction) const
+{
+	if (m_count == 0)
+	{
+		return std::chrono::microseconds(0);
+	}
+
+	const double rank	   = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(m_count);
+	uint64_t	 cumulative = 0;
+
+	for (std::size_t index = 0; index < d_bucket_count; ++index)
+	{
+		if (m_buckets[index] == 0)
+		{
+			continue;
+		}
+
+		const uint64_t previous = cumulative;
+		cumulative			   += m_buckets[index];
+		if (static_cast<double>(cumulative) < rank)
+		{
+			continue;
+		}
+
+		const double lower	  = static_cast<double>(bucketLowerBound(index));
+		const double upper	  = static_cast<double>(bucketLowerBound(index + 1));
+		const double position = (rank - static_cast<double>(previous)) / static_cast<double>(m_buckets[index]);
+		const auto	 value	  = static_cast<uint64_t>(lower + (upper - lower) * position);
+		return std::chrono::microseconds(std::clamp(value, m_min, m_max));
+	}
+
+	return std::chrono::microseconds(m_max);
+}
+
+std::string StageHistogram::serialize() const
+{
+	std::ostringstream text;
+	text << m_count << ' ' << m_total << ' ' << m_min << ' ' << m_max << ' ' << m_last;
+
+	// Sparse, a stage rarely spreads over more than a few buckets
+	for (std::size_t index = 0; index < d_bucket_count; ++index)
+	{
+		if (m_buckets[index] != 0)
+		{
+			text << ' ' << index << ':' << m_buckets[index];
+		}
+	}
+	return text.str();
+}
+
+bool StageHistogram::deserialize(const std::string &text)
+{
+	StageHistogram	   histogram;
+	std::istringstream fields(text);
+
+	fields >> histogram.m_count >> histogram.m_total >> histogram.m_min >> histogram.m_max >> histogram.m_last;
+	if (!fields)
+	{
+		return false;
+	}
+
+	uint64_t	bucketed = 0;
+	std::string entry;
+	while (fields >> entry)
+	{
+		const std::size_t colon = entry.find(':');
+		std::size_t		  index = 0;
+		uint64_t		  value = 0;
+		if (colon == std::string::npos ||
+			std::from_chars(entry.data(), entry.data() + colon, index).ec != std::errc() ||
+			std::from_chars(entry.data() + colon + 1, entry.data() + entry.size(), value).ec != std::errc() ||
+			index >= d_bucket_count)
+		{
+			return false;
+		}
+		histogram.m_buckets[index]	= value;
+		bucketed				   += value;
+	}
+
+	if (bucketed != histogram.m_count)
+	{
+		return false;
+	}
+
+	*this = histogram;
+	return true;
+}
+
+std::size_t StageHistogram::bucketIndex(uint64_t microseconds)
+{
+	if (microseconds < d_sub_buckets)
+	{
+		return static_cast<std::size_t>(microseconds);
+	}
+
+	// Octave from the leading bit, sub bucket from the two bits following it
+	const std::size_t octave = static_cast<std::size_t>(std::bit_width(microseconds)) - 1 - k_sub_bucket_bits;
+	const std::size_t sub	 = static_cast<std::size_t>(microseconds >> octave) & (d_sub_buckets - 1);
+	return std::min((octave + 1) * d_sub_buckets + sub, d_bucket_count - 1);
+}
+
+uint64_t StageHistogram::bucketLowerBound(std::size_t index)
+{
+	if (index < d_sub_buckets)
+	{
+		return index;
+	}
+
+	const std::size_t octave = index / d_sub_buckets - 1;
+	const std::size_t sub	 = index % d_sub_buckets;
+	return static_cast<uint64_t>(d_sub_buckets + sub) << octave;
+}
+
+void StageTimings::beginRun()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_current_run.clear();
+	m_run_started = std::chrono::steady_clock::now();
+}
+
+void StageTimings::record(const std::string &stage, std::chrono::microseconds elapsed)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto it = std::find_if(m_current_run.begin(), m_current_run.end(), [&](const Sample &sample) {
+		return sample.stage == stage;
+	});
+	if (it != m_current_run.end())
+	{
+		it->elapsed += elapsed;
+	}
+	else
+	{
+		m_current_run.push_back({stage, elapsed});
+	}
+}
+
+void StageTimings::endRun()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (const Sample &sample : m_current_run)
+	{
+		histogram(sample.stage).add(sample.elapsed);
+	}
+	m_last_run		= std::move(m_current_run);
+	m_last_run_wall = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_run_started);
+	m_current_run.clear();
+}
+
+std::vector<StageTimings::Sample> StageTimings::lastRun() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_last_run;
+}
+
+std::chrono::microseconds StageTimings::lastRunWall() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_last_run_wall;
+}
+
+std::vector<StageTimings::Stage> StageTimings::stages() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stages;
+}
+
+std::string StageTimings::summary() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::string summary;
+	for (const Sample &sample : m_last_run)
+	{
+		summary += sample.stage + " " + formatMilliseconds(sample.elapsed) + ", ";
+	}
+	return summary + "wall " + formatMilliseconds(m_last_run_wall);
+}
+
+bool StageTimings::load(const std::string &file_path)
+{
+	std::ifstream file(file_path);
+	std::string	  line;
+	if (!std::getline(file, line) || line != k_file_header)
+	{
+		return false;
+	}
+
+	std::vector<Stage> stages;
+	while (std::getline(file, line))
+	{
+		const std::size_t tab = line.find('\t');
+		if (tab == std::string::npos)
+		{
+			continue;
+		}
+
+		Stage stage;
+		stage.name = line.substr(0, tab);
+		if (!stage.histogram.deserialize(line.substr(tab + 1)))
+		{
+			return false;
+		}
+		stages.push_back(std::move(stage));
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stages = std::move(stages);
+	return true;
+}
+
+bool StageTimings::save(const std::string &file_path) const
+{
+	const std::string temporary_path = file_path + ".tmp";
+	{
+		std::ofstream file(temporary_path, std::ios::trunc);
+		file << k_file_header << '\n';
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const Stage &stage : m_stages)
+		{
+			file << stage.name << '\t' << stage.histogram.serialize() << '\n';
+		}
+
+		if (!file.flush())
+		{
+			return false;
+		}
+	}
+
+	return std::rename(temporary_path.c_str(), file_path.c_str()) == 0;
+}
+
+StageHistogram &StageTimings::histogram(const std::string &stage)
+{
+	const auto it = std::find_if(m_stages.begin(), m_stages.end(), [&](const Stage &entry) {
+		return entry.name == stage;
+	});
+	if (it != m_stages.end())
+	{
+		return it->histogram;
+	}
+
+	m_stages.push_back({stage, StageHistogram()});
+	return m_stages.back().histogram;
+}
+
+StageScope::StageScope(StageTimings &timings, std::string stage) :
+	m_timings(timings),
+	m_stage(std::move(stage)),
+	m_started(std::chrono::steady_clock::now()),
+	m_stopped(false)
+{}
+
+StageScope::~StageScope()
+{
+	stop();
+}
+
+void StageScope::stop()
+{
+	if (m_stopped)
+	{
+		return;
+	}
+	m_stopped = true;
+	m_timings.record(m_stage, elapsed());
+}
+
+std::chrono::microseconds StageScope::elapsed() const
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_started);
+}
+} // namespace UTILS
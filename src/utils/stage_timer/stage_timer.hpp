@@ -0,0 +1,136 @@
+#ifndef STAGE_TIMER_HPP
+#define STAGE_TIMER_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Log-linear histogram of stage durations in microseconds.
+ *
+ * Every power of two is split into four buckets, so a percentile is never
+ * off by more than a quarter of its octave while the whole range up to
+ * about nineteen hours fits into a fixed array.
+ */
+class StageHistogram
+{
+public:
+	static constexpr std::size_t d_sub_buckets	= 4;
+	static constexpr std::size_t d_octaves		= 36;
+	static constexpr std::size_t d_bucket_count = d_sub_buckets * d_octaves;
+
+public:
+	void add(std::chrono::microseconds elapsed);
+	void clear();
+
+	uint64_t				  count() const;
+	std::chrono::microseconds total() const;
+	std::chrono::microseconds min() const;
+	std::chrono::microseconds max() const;
+	std::chrono::microseconds last() const;
+
+	/**
+	 * Interpolated within the bucket holding the requested rank, clamped to
+	 * the observed min and max. Zero for an empty histogram.
+	 */
+	std::chrono::microseconds percentile(double fraction) const;
+
+	std::string serialize() const;
+	bool		deserialize(const std::string &text);
+
+private:
+	static std::size_t bucketIndex(uint64_t microseconds);
+	static uint64_t	   bucketLowerBound(std::size_t index);
+
+private:
+	std::array<uint64_t, d_bucket_count> m_buckets{};
+
+	uint64_t m_count = 0;
+	uint64_t m_total = 0;
+	uint64_t m_min	 = 0;
+	uint64_t m_max	 = 0;
+	uint64_t m_last	 = 0;
+};
+
+/**
+ * @brief Per-stage durations of repeated pipeline runs.
+ *
+ * A run is framed by beginRun() and endRun(). Stages recorded more than once
+ * inside a run are summed, the per-run totals go into the histograms when
+ * the run ends. Stages may overlap, the wall clock time of the run is kept
+ * separately. Stages keep the order they were first seen in, the file
+ * written by save() is plain text with one stage per line.
+ */
+class StageTimings
+{
+public:
+	struct Sample
+	{
+		std::string				  stage;
+		std::chrono::microseconds elapsed{0};
+	};
+
+	struct Stage
+	{
+		std::string	   name;
+		StageHistogram histogram;
+	};
+
+public:
+	void beginRun();
+	void record(const std::string &stage, std::chrono::microseconds elapsed);
+	void endRun();
+
+	std::vector<Sample>		  lastRun() const;
+	std::chrono::microseconds lastRunWall() const;
+	std::vector<Stage>		  stages() const;
+
+	/**
+	 * "name 12.3 ms, ..., wall 45.6 ms" for the last finished run.
+	 */
+	std::string summary() const;
+
+	bool load(const std::string &file_path);
+	bool save(const std::string &file_path) const;
+
+private:
+	StageHistogram &histogram(const std::string &stage);
+
+private:
+	mutable std::mutex					  m_mutex;
+	std::chrono::steady_clock::time_point m_run_started;
+	std::chrono::microseconds			  m_last_run_wall{0};
+	std::vector<Sample>					  m_current_run;
+	std::vector<Sample>					  m_last_run;
+	std::vector<Stage>					  m_stages;
+};
+
+/**
+ * @brief Records the time between construction and stop() or destruction.
+ */
+class StageScope
+{
+public:
+	StageScope(StageTimings &timings, std::string stage);
+	~StageScope();
+
+	StageScope(const StageScope &)			  = delete;
+	StageScope &operator=(const StageScope &) = delete;
+
+	void					  stop();
+	std::chrono::microseconds elapsed() const;
+
+private:
+	StageTimings						 &m_timings;
+	std::string							  m_stage;
+	std::chrono::steady_clock::time_point m_started;
+	bool								  m_stopped;
+};
+} // namespace UTILS
+
+#endif // STAGE_TIMER_HPP
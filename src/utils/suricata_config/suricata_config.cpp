@@ -0,0 +1,622 @@
+#include "suricata_config.hpp"
+
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <sys/mman.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr int			   k_max_include_depth = 8;
+	constexpr std::string_view k_default_log_dir   = "/var/log/suricata";
+	constexpr std::string_view k_include_tag	   = "!include";
+
+	struct Segment
+	{
+		std::string_view key;
+		int				 index = -1;
+
+		bool isIndex() const
+		{
+			return index >= 0;
+		}
+
+		bool is(std::string_view name) const
+		{
+			return index < 0 && key == name;
+		}
+	};
+
+	struct Frame
+	{
+		int		indent;
+		Segment segment;
+		int		next_index = 0;
+	};
+
+	std::string_view trim(std::string_view value)
+	{
+		const auto first = value.find_first_not_of(" \t");
+		if (first == std::string_view::npos)
+		{
+			return {};
+		}
+		const auto last = value.find_last_not_of(" \t");
+		return value.substr(first, last - first + 1);
+	}
+
+	std::string_view unquote(std::string_view value)
+	{
+		if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front())
+		{
+			return value.substr(1, value.size() - 2);
+		}
+		return value;
+	}
+
+	/**
+	 * Removes a trailing comment, '#' only starts one at the beginning of the
+	 * line or after whitespace and never inside quotes.
+	 */
+	std::string_view stripComment(std::string_view line)
+	{
+		char quote = 0;
+		for (std::size_t i = 0; i < line.size(); ++i)
+		{
+			const char c = line[i];
+			if (quote != 0)
+			{
+				if (c == quote)
+				{
+					quote = 0;
+				}
+			}
+			else if (c == '"' || c == '\'')
+			{
+				quote = c;
+			}
+			else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t'))
+			{
+				return line.substr(0, i);
+			}
+		}
+		return line;
+	}
+
+	/**
+	 * Position of the ':' separating a mapping key from its value.
+	 */
+	std::size_t findKeySeparator(std::string_view content)
+	{
+		char quote = 0;
+		for (std::size_t i = 0; i < content.size(); ++i)
+		{
+			const char c = content[i];
+			if (quote != 0)
+			{
+				if (c == quote)
+				{
+					quote = 0;
+				}
+			}
+			else if ((c == '"' || c == '\'') && i == 0)
+			{
+				quote = c;
+			}
+			else if (c == '[' || c == '{')
+			{
+				return std::string_view::npos;
+			}
+			else if (c == ':' && (i + 1 == content.size() || content[i + 1] == ' ' || content[i + 1] == '\t'))
+			{
+				return i;
+			}
+		}
+		return std::string_view::npos;
+	}
+
+	template<typename Callback>
+	void forEachFlowItem(std::string_view value, Callback callback)
+	{
+		if (value.size() < 2 || value.front() != '[' || value.back() != ']')
+		{
+			callback(unquote(value));
+			return;
+		}
+
+		value = value.substr(1, value.size() - 2);
+		while (!value.empty())
+		{
+			const auto		 comma = value.find(',');
+			std::string_view item  = trim(value.substr(0, comma));
+			if (!item.empty())
+			{
+				callback(unquote(item));
+			}
+			if (comma == std::string_view::npos)
+			{
+				break;
+			}
+			value.remove_prefix(comma + 1);
+		}
+	}
+
+	std::string directoryOf(const std::string &path)
+	{
+		const auto slash = path.rfind('/');
+		if (slash == std::string::npos)
+		{
+			return ".";
+		}
+		return slash == 0 ? "/" : path.substr(0, slash);
+	}
+
+	std::string joinPath(const std::string &directory, std::string_view name)
+	{
+		if (name.empty() || name.front() == '/' || directory.empty())
+		{
+			return std::string(name);
+		}
+
+		std::string path = directory;
+		if (path.back() != '/')
+		{
+			path.push_back('/');
+		}
+		path.append(name);
+		return path;
+	}
+
+	class Parser
+	{
+	public:
+		Parser(SuricataConfig &config, std::vector<std::string> &include_stack) :
+			m_config(config),
+			m_include_stack(include_stack)
+		{}
+
+		void parse(std::string_view buffer, const std::string &base_directory, const std::vector<Segment> &prefix)
+		{
+			m_base_directory = base_directory;
+			m_prefix		 = prefix;
+
+			int block_scalar_indent = -1;
+
+			std::size_t position = 0;
+			while (position < buffer.size())
+			{
+				std::size_t end = buffer.find('\n', position);
+				if (end == std::string_view::npos)
+				{
+					end = buffer.size();
+				}
+
+				std::string_view line = buffer.substr(position, end - position);
+				position			  = end + 1;
+
+				if (!line.empty() && line.back() == '\r')
+				{
+					line.remove_suffix(1);
+				}
+
+				const auto indent_end = line.find_first_not_of(" \t");
+				if (indent_end == std::string_view::npos)
+				{
+					continue;
+				}
+
+				const int indent = static_cast<int>(indent_end);
+
+				if (block_scalar_indent >= 0)
+				{
+					if (indent > block_scalar_indent)
+					{
+						continue;
+					}
+					block_scalar_indent = -1;
+				}
+
+				const std::string_view content = trim(stripComment(line.substr(indent_end)));
+				if (content.empty())
+				{
+					continue;
+				}
+
+				if (indent == 0 && (content.front() == '%' || content.substr(0, 3) == "---" || content == "..."))
+				{
+					continue;
+				}
+
+				if (content.front() == '-' && (content.size() == 1 || content[1] == ' ' || content[1] == '\t'))
+				{
+					processSequenceItem(indent, content, block_scalar_indent);
+				}
+				else
+				{
+					processKey(indent, content, block_scalar_indent);
+				}
+			}
+		}
+
+	private:
+		void processSequenceItem(int indent, std::string_view content, int &block_scalar_indent)
+		{
+			while (!m_frames.empty() && (m_frames.back().indent > indent ||
+										 (m_frames.back().indent == indent && m_frames.back().segment.isIndex())))
+			{
+				m_frames.pop_back();
+			}
+
+			int &counter = m_frames.empty() ? m_root_index : m_frames.back().next_index;
+			m_frames.push_back(Frame{indent, Segment{{}, counter++}});
+
+			const std::string_view rest = content.substr(1);
+			const auto			   skip = rest.find_first_not_of(" \t");
+			if (skip == std::string_view::npos)
+			{
+				return;
+			}
+
+			const std::string_view item = rest.substr(skip);
+			if (findKeySeparator(item) != std::string_view::npos)
+			{
+				processKey(indent + 1 + static_cast<int>(skip), item, block_scalar_indent);
+				return;
+			}
+
+			emit({}, unquote(item), true);
+		}
+
+		void processKey(int indent, std::string_view content, int &block_scalar_indent)
+		{
+			while (!m_frames.empty() && m_frames.back().indent >= indent)
+			{
+				m_frames.pop_back();
+			}
+
+			const std::size_t separator = findKeySeparator(content);
+			if (separator == std::string_view::npos)
+			{
+				// Continuation of a multi-line plain scalar, nothing we need
+				return;
+			}
+
+			const Segment	 key{unquote(trim(content.substr(0, separator)))};
+			std::string_view value = trim(content.substr(separator + 1));
+
+			if (!value.empty() && value.front() == '&')
+			{
+				const auto anchor_end = value.find_first_of(" \t");
+				value = anchor_end == std::string_view::npos ? std::string_view() : trim(value.substr(anchor_end));
+			}
+
+			if (value.empty())
+			{
+				emit(key, {}, false);
+				m_frames.push_back(Frame{indent, key});
+				return;
+			}
+
+			if (value.substr(0, k_include_tag.size()) == k_include_tag)
+			{
+				std::vector<Segment> prefix = currentPath();
+				prefix.push_back(key);
+				include(unquote(trim(value.substr(k_include_tag.size()))), prefix);
+				return;
+			}
+
+			if (value.front() == '|' || value.front() == '>')
+			{
+				block_scalar_indent = indent;
+				emit(key, {}, false);
+				return;
+			}
+
+			emit(key, unquote(value), true);
+		}
+
+		std::vector<Segment> currentPath() const
+		{
+			std::vector<Segment> path = m_prefix;
+			for (const Frame &frame : m_frames)
+			{
+				path.push_back(frame.segment);
+			}
+			return path;
+		}
+
+		void emit(const Segment &leaf, std::string_view value, bool has_value)
+		{
+			m_path.clear();
+			m_path.insert(m_path.end(), m_prefix.begin(), m_prefix.end());
+			for (const Frame &frame : m_frames)
+			{
+				m_path.push_back(frame.segment);
+			}
+			if (!leaf.key.empty())
+			{
+				m_path.push_back(leaf);
+			}
+
+			handle(m_path, value, has_value);
+		}
+
+		void handle(const std::vector<Segment> &path, std::string_view value, bool has_value)
+		{
+			const std::size_t depth = path.size();
+			if (depth == 0)
+			{
+				return;
+			}
+
+			const Segment &root = path[0];
+
+			if (depth == 1 && has_value)
+			{
+				if (root.is("default-log-dir"))
+				{
+					m_config.default_log_dir = std::string(value);
+				}
+				else if (root.is("default-rule-path"))
+				{
+					m_config.default_rule_path = std::string(value);
+				}
+				else if (root.is("include"))
+				{
+					forEachFlowItem(value, [this](std::string_view file) {
+						include(file, {});
+					});
+				}
+				else if (root.is("rule-files"))
+				{
+					forEachFlowItem(value, [this](std::string_view file) {
+						m_config.rule_files.emplace_back(file);
+					});
+				}
+				return;
+			}
+
+			if (depth == 2 && has_value && path[1].isIndex())
+			{
+				if (root.is("include"))
+				{
+					include(value, {});
+				}
+				else if (root.is("rule-files"))
+				{
+					m_config.rule_files.emplace_back(value);
+				}
+				return;
+			}
+
+			if (depth == 3 && has_value && root.is("vars"))
+			{
+				if (path[1].is("address-groups"))
+				{
+					m_config.address_groups.emplace_back(path[2].key, value);
+				}
+				else if (path[1].is("port-groups"))
+				{
+					m_config.port_groups.emplace_back(path[2].key, value);
+				}
+				return;
+			}
+
+			if (root.is("outputs") && depth >= 3 && path[1].isIndex())
+			{
+				handleOutput(path, value, has_value);
+				return;
+			}
+
+			if (root.is("af-packet") && depth == 3 && path[1].isIndex() && has_value)
+			{
+				const auto index = static_cast<std::size_t>(path[1].index);
+				if (m_config.af_packet.size() <= index)
+				{
+					m_config.af_packet.resize(index + 1);
+				}
+
+				SuricataConfig::AfPacketInterface &interface = m_config.af_packet[index];
+				if (path[2].is("interface"))
+				{
+					interface.interface = std::string(value);
+				}
+				else if (path[2].is("cluster-id"))
+				{
+					interface.cluster_id = std::string(value);
+				}
+				else if (path[2].is("cluster-type"))
+				{
+					interface.cluster_type = std::string(value);
+				}
+				else if (path[2].is("threads"))
+				{
+					interface.threads = std::string(value);
+				}
+			}
+		}
+
+		void handleOutput(const std::vector<Segment> &path, std::string_view value, bool has_value)
+		{
+			SuricataConfig::LogOutput *output = nullptr;
+			int						  *owner  = nullptr;
+
+			if (path[2].is("fast"))
+			{
+				output = &m_config.fast;
+				owner  = &m_fast_item;
+			}
+			else if (path[2].is("eve-log"))
+			{
+				output = &m_config.eve;
+				owner  = &m_eve_item;
+			}
+			else
+			{
+				return;
+			}
+
+			// Only the first output of each kind is taken into account
+			if (*owner < 0)
+			{
+				*owner			= path[1].index;
+				output->present = true;
+				output->index	= path[1].index;
+			}
+			else if (*owner != path[1].index)
+			{
+				return;
+			}
+
+			const std::size_t depth = path.size();
+
+			if (depth == 4 && has_value)
+			{
+				if (path[3].is("enabled"))
+				{
+					output->enabled = SuricataConfigParser::isTrue(value);
+				}
+				else if (path[3].is("filename"))
+				{
+					output->filename = std::string(value);
+				}
+			}
+			else if (depth == 5 && has_value && path[3].is("types") && path[4].isIndex())
+			{
+				output->types.emplace_back(value);
+			}
+			else if (depth == 6 && !has_value && path[3].is("types") && path[4].isIndex())
+			{
+				output->types.emplace_back(path[5].key);
+			}
+		}
+
+		void include(std::string_view file, const std::vector<Segment> &prefix)
+		{
+			const std::string path = joinPath(m_base_directory, file);
+
+			if (static_cast<int>(m_include_stack.size()) >= k_max_include_depth)
+			{
+				m_config.errors.push_back("Include depth exceeded at " + path);
+				return;
+			}
+
+			char resolved[PATH_MAX];
+			if (realpath(path.c_str(), resolved) == nullptr)
+			{
+				m_config.errors.push_back("Unable to resolve include " + path);
+				return;
+			}
+
+			const std::string canonical(resolved);
+			if (std::find(m_include_stack.begin(), m_include_stack.end(), canonical) != m_include_stack.end())
+			{
+				m_config.errors.push_back("Recursive include of " + canonical);
+				return;
+			}
+
+			MappedFile mapped(canonical);
+			if (!mapped.isOpen())
+			{
+				m_config.errors.push_back("Unable to open include " + canonical);
+				return;
+			}
+			mapped.advise(MADV_SEQUENTIAL);
+
+			m_config.includes.push_back(canonical);
+			m_include_stack.push_back(canonical);
+
+			Parser nested(m_config, m_include_stack);
+			nested.parse(mapped.view(), directoryOf(canonical), prefix);
+
+			m_include_stack.pop_back();
+		}
+
+	private:
+		SuricataConfig			 &m_config;
+		std::vector<std::string> &m_include_stack;
+
+		std::string			 m_base_directory;
+		std::vector<Segment> m_prefix;
+		std::vector<Frame>	 m_frames;
+		std::vector<Segment> m_path;
+
+		int m_root_index = 0;
+		int m_fast_item	 = -1;
+		int m_eve_item	 = -1;
+	};
+} // namespace
+
+std::string SuricataConfig::resolveLogPath(const std::string &filename) const
+{
+	if (filename.empty() || filename.front() == '/')
+	{
+		return filename;
+	}
+	return joinPath(default_log_dir.empty() ? std::string(k_default_log_dir) : default_log_dir, filename);
+}
+
+std::vector<std::string> SuricataConfig::resolveRuleFiles() const
+{
+	std::vector<std::string> paths;
+	paths.reserve(rule_files.size());
+	for (const std::string &rule_file : rule_files)
+	{
+		paths.push_back(joinPath(default_rule_path, rule_file));
+	}
+	return paths;
+}
+
+const SuricataConfig::LogOutput *SuricataConfig::alertOutput() const
+{
+	if (fast.enabled && !fast.filename.empty())
+	{
+		return &fast;
+	}
+	if (eve.enabled && (eve.types.empty() || std::find(eve.types.begin(), eve.types.end(), "alert") != eve.types.end()))
+	{
+		return &eve;
+	}
+	return nullptr;
+}
+
+bool SuricataConfigParser::parseFile(const std::string &path, SuricataConfig &config)
+{
+	MappedFile mapped(path);
+	if (!mapped.isOpen())
+	{
+		config.errors.push_back("Unable to open " + path);
+		return false;
+	}
+	mapped.advise(MADV_SEQUENTIAL);
+
+	std::vector<std::string> include_stack;
+
+	char resolved[PATH_MAX];
+	if (realpath(path.c_str(), resolved) != nullptr)
+	{
+		include_stack.emplace_back(resolved);
+	}
+
+	Parser parser(config, include_stack);
+	parser.parse(mapped.view(), directoryOf(path), {});
+	return true;
+}
+
+void SuricataConfigParser::parseBuffer(std::string_view buffer, const std::string &base_directory, SuricataConfig &config)
+{
+	std::vector<std::string> include_stack;
+
+	Parser parser(config, include_stack);
+	parser.parse(buffer, base_directory, {});
+}
+
+bool SuricataConfigParser::isTrue(std::string_view value)
+{
+	return value == "yes" || value == "true" || value == "on" || value == "1" || value == "Yes" || value == "True";
+}
+} // namespace UTILS
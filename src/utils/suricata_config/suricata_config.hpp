@@ -0,0 +1,87 @@
+#ifndef SURICATA_CONFIG_HPP
+#define SURICATA_CONFIG_HPP
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Fields of suricata.yaml the application cares about.
+ */
+struct SuricataConfig
+{
+	struct LogOutput
+	{
+		bool					 present = false;
+		bool					 enabled = false;
+		int						 index	 = -1; // position in the outputs sequence
+		std::string				 filename;
+		std::vector<std::string> types; // eve-log only
+	};
+
+	struct AfPacketInterface
+	{
+		std::string interface;
+		std::string cluster_id;
+		std::string cluster_type;
+		std::string threads;
+	};
+
+	using Variable = std::pair<std::string, std::string>;
+
+	std::string default_log_dir;
+	std::string default_rule_path;
+
+	LogOutput fast;
+	LogOutput eve;
+
+	std::vector<AfPacketInterface> af_packet;
+	std::vector<Variable>		   address_groups;
+	std::vector<Variable>		   port_groups;
+	std::vector<std::string>	   rule_files;
+
+	std::vector<std::string> includes; // resolved paths of every included file that was parsed
+	std::vector<std::string> errors;
+
+	/**
+	 * Resolves an output filename the way Suricata does, relative names live
+	 * in default-log-dir which itself defaults to /var/log/suricata.
+	 */
+	std::string resolveLogPath(const std::string &filename) const;
+
+	/**
+	 * Resolves rule-files entries against default-rule-path.
+	 */
+	std::vector<std::string> resolveRuleFiles() const;
+
+	/**
+	 * The output alerts are read from: fast when it is enabled with a file
+	 * name, otherwise eve-log when it carries alert records. Null if neither.
+	 */
+	const LogOutput *alertOutput() const;
+};
+
+/**
+ * @brief Single pass, indentation aware parser for the YAML subset used by
+ *        suricata.yaml.
+ *
+ * The file is memory mapped and scanned line by line while a stack of open
+ * mappings and sequences tracks the current node path, so comments, nesting
+ * and sequence items are handled without building a document tree. Both the
+ * top level `include:` directive and `key: !include file` are followed
+ * relative to the including file.
+ */
+class SuricataConfigParser
+{
+public:
+	static bool parseFile(const std::string &path, SuricataConfig &config);
+	static void parseBuffer(std::string_view buffer, const std::string &base_directory, SuricataConfig &config);
+
+	static bool isTrue(std::string_view value);
+};
+} // namespace UTILS
+
+#endif // SURICATA_CONFIG_HPP
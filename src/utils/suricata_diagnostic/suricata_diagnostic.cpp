@@ -0,0 +1,215 @@
+#include "suricata_diagnostic.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+namespace UTILS
+{
+namespace
+{
+	using Severity = SuricataDiagnostic::Severity;
+
+	struct LevelName
+	{
+		std::string_view name;
+		Severity		 severity;
+	};
+
+	// Long names, the one-letter forms of Suricata 7 verbose output and Suricata 6 <Level> tags
+	constexpr LevelName k_level_names[] = {
+		{"Emergency", Severity::Critical}, {"Alert", Severity::Critical},	{"Critical", Severity::Critical},
+		{"Error", Severity::Error},		   {"Warning", Severity::Warning},	{"Notice", Severity::Info},
+		{"Info", Severity::Info},		   {"Perf", Severity::Info},		{"Config", Severity::Info},
+		{"Debug", Severity::Info},		   {"Em", Severity::Critical},		{"A", Severity::Critical},
+		{"C", Severity::Critical},		   {"E", Severity::Error},			{"W", Severity::Warning},
+		{"N", Severity::Info},			   {"i", Severity::Info},			{"I", Severity::Info},
+	};
+
+	// Errors after which suricata -T can only fail
+	constexpr std::string_view k_fatal_markers[] = {
+		"Failed to parse configuration file",
+		"failed to load yaml",
+		"SC_ERR_CONF_YAML_ERROR",
+		"SC_ERR_FATAL",
+		"SC_ERR_INITIALIZATION",
+		"Loading signatures failed",
+		"Configuration provided was unsuccessfully loaded",
+		"engine initialization failed",
+	};
+
+	bool findLevel(std::string_view name, Severity &severity)
+	{
+		const auto it = std::find_if(std::begin(k_level_names), std::end(k_level_names), [&](const LevelName &level) {
+			return level.name == name;
+		});
+		if (it == std::end(k_level_names))
+		{
+			return false;
+		}
+		severity = it->severity;
+		return true;
+	}
+
+	std::string_view trim(std::string_view text)
+	{
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+		{
+			text.remove_prefix(1);
+		}
+		while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+		{
+			text.remove_suffix(1);
+		}
+		return text;
+	}
+
+	bool containsIgnoringCase(std::string_view text, std::string_view needle)
+	{
+		return std::search(text.begin(), text.end(), needle.begin(), needle.end(), [](char left, char right) {
+				   return std::tolower(static_cast<unsigned char>(left)) == std::tolower(static_cast<unsigned char>(right));
+			   }) != text.end();
+	}
+
+	int parseLine(std::string_view text)
+	{
+		int value = 0;
+		std::from_chars(text.data(), text.data() + text.size(), value);
+		return value;
+	}
+
+	/**
+	 * "Error: detect: message", the module is optional and never contains spaces.
+	 */
+	bool parseSuricata7(std::string_view line, SuricataDiagnostic &diagnostic)
+	{
+		const std::size_t colon = line.find(':');
+		if (colon == std::string_view::npos || !findLevel(line.substr(0, colon), diagnostic.severity))
+		{
+			return false;
+		}
+
+		std::string_view  rest		 = trim(line.substr(colon + 1));
+		const std::size_t module_end = rest.find(": ");
+		if (module_end != std::string_view::npos && rest.substr(0, module_end).find(' ') == std::string_view::npos)
+		{
+			diagnostic.module = rest.substr(0, module_end);
+			rest			  = trim(rest.substr(module_end + 1));
+		}
+		diagnostic.message = rest;
+		return true;
+	}
+
+	/**
+	 * "[pid] date -- time - (file.c:123) <Error> (Function) -- [ERRCODE: ...] - message"
+	 */
+	bool parseSuricata6(std::string_view line, SuricataDiagnostic &diagnostic)
+	{
+		const std::size_t open = line.find(" <");
+		if (open == std::string_view::npos)
+		{
+			return false;
+		}
+		const std::size_t close = line.find('>', open);
+		if (close == std::string_view::npos || !findLevel(line.substr(open + 2, close - open - 2), diagnostic.severity))
+		{
+			return false;
+		}
+
+		// The message follows the last " - " separator, the error code is kept for the fatal check
+		std::string_view  rest		= line.substr(close + 1);
+		const std::size_t error_code = rest.find("[ERRCODE:");
+		const std::size_t separator	 = rest.find(" - ", error_code == std::string_view::npos ? 0 : error_code);
+		diagnostic.message			 = trim(separator == std::string_view::npos ? rest : rest.substr(separator + 3));
+		if (error_code != std::string_view::npos)
+		{
+			const std::size_t code_end = rest.find(']', error_code);
+			diagnostic.module		   = trim(rest.substr(error_code + 9, code_end == std::string_view::npos
+																			 ? std::string_view::npos
+																			 : code_end - error_code - 9));
+		}
+		return true;
+	}
+
+	/**
+	 * Signature text is quoted and may contain anything, locations are only
+	 * looked for outside of quotes.
+	 */
+	void findLocation(std::string_view message, SuricataDiagnostic &diagnostic)
+	{
+		constexpr std::string_view k_from_file = "from file ";
+		constexpr std::string_view k_at_line   = " at line ";
+
+		std::string unquoted;
+		unquoted.reserve(message.size());
+		bool quoted = false;
+		for (std::size_t i = 0; i < message.size(); ++i)
+		{
+			if (message[i] == '"' && (i == 0 || message[i - 1] != '\\'))
+			{
+				quoted = !quoted;
+				unquoted += ' ';
+			}
+			else
+			{
+				unquoted += quoted ? ' ' : message[i];
+			}
+		}
+
+		std::size_t path_start = unquoted.find(k_from_file);
+		path_start			   = path_start != std::string::npos ? path_start + k_from_file.size() : unquoted.find(" /");
+		if (path_start != std::string::npos)
+		{
+			path_start = unquoted.find('/', path_start);
+		}
+		if (path_start != std::string::npos)
+		{
+			std::size_t path_end = unquoted.find_first_of(" \t,;'", path_start);
+			path_end			 = path_end == std::string::npos ? unquoted.size() : path_end;
+			std::string path	 = unquoted.substr(path_start, path_end - path_start);
+			while (!path.empty() && (path.back() == ':' || path.back() == '.' || path.back() == ')'))
+			{
+				path.pop_back();
+			}
+			diagnostic.file = path;
+		}
+
+		const std::size_t at_line = unquoted.find(k_at_line);
+		if (at_line != std::string::npos)
+		{
+			diagnostic.line = parseLine(std::string_view(unquoted).substr(at_line + k_at_line.size()));
+		}
+	}
+} // namespace
+
+std::string SuricataDiagnostic::location() const
+{
+	if (file.empty())
+	{
+		return line > 0 ? "line " + std::to_string(line) : std::string();
+	}
+	return line > 0 ? file + ":" + std::to_string(line) : file;
+}
+
+bool SuricataDiagnostics::classify(std::string_view line, SuricataDiagnostic &diagnostic)
+{
+	diagnostic = SuricataDiagnostic();
+
+	line = trim(line);
+	if (line.empty() || !(parseSuricata7(line, diagnostic) || parseSuricata6(line, diagnostic)))
+	{
+		return false;
+	}
+
+	findLocation(diagnostic.message, diagnostic);
+
+	diagnostic.fatal = diagnostic.severity == Severity::Critical;
+	if (diagnostic.severity == Severity::Error)
+	{
+		diagnostic.fatal = std::any_of(std::begin(k_fatal_markers), std::end(k_fatal_markers), [&](std::string_view marker) {
+			return containsIgnoringCase(diagnostic.message, marker) || containsIgnoringCase(diagnostic.module, marker);
+		});
+	}
+	return true;
+}
+} // namespace UTILS
@@ -0,0 +1,55 @@
+#ifndef SURICATA_DIAGNOSTIC_HPP
+#define SURICATA_DIAGNOSTIC_HPP
+
+#include <string>
+#include <string_view>
+
+namespace UTILS
+{
+/**
+ * @brief One classified line of Suricata console output.
+ */
+struct SuricataDiagnostic
+{
+	enum class Severity
+	{
+		Info,
+		Warning,
+		Error,
+		Critical // Critical, Alert and Emergency, Suricata exits right after them
+	};
+
+	Severity	severity = Severity::Info;
+	bool		fatal	 = false; // the run cannot succeed any more
+	std::string module;			  // "detect", "conf-yaml-loader", the ERRCODE for Suricata 6 output
+	std::string message;
+	std::string file; // rule or config file the message points at, if any
+	int			line = 0;
+
+	/**
+	 * "file:line", "file" or "line N", empty without location.
+	 */
+	std::string location() const;
+};
+
+/**
+ * @brief Classifies Suricata log lines as they are printed.
+ *
+ * Understands the Suricata 7 console format ("Error: detect: ...", also
+ * with one-letter levels) and the Suricata 6 one ("... - <Error> -
+ * [ERRCODE: SC_ERR_...(N)] - ..."). Errors that abort the run, a broken
+ * YAML file or failed initialization, are flagged fatal. File and line are
+ * taken from the "from file X at line N" rule loader messages and from
+ * paths and "at line N" mentioned outside of quoted signature text.
+ */
+class SuricataDiagnostics
+{
+public:
+	/**
+	 * False for lines without a recognised log level.
+	 */
+	static bool classify(std::string_view line, SuricataDiagnostic &diagnostic);
+};
+} // namespace UTILS
+
+#endif // SURICATA_DIAGNOSTIC_HPP
@@ -0,0 +1,210 @@
+#include "suricata_session.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::chrono::milliseconds k_connect_retry_interval{50};
+	constexpr std::chrono::milliseconds k_exit_poll_interval{10};
+
+	std::string describeStatus(int status)
+	{
+		if (WIFEXITED(status))
+		{
+			return "exited with code " + std::to_string(WEXITSTATUS(status));
+		}
+		if (WIFSIGNALED(status))
+		{
+			return "killed by signal " + std::to_string(WTERMSIG(status));
+		}
+		return "stopped";
+	}
+} // namespace
+
+SuricataSession::SuricataSession() :
+	m_pid(-1)
+{}
+
+SuricataSession::~SuricataSession()
+{
+	stop();
+}
+
+bool SuricataSession::start(const std::string &program, const std::vector<std::string> &arguments,
+							const std::string &socket_path, const std::string &output_path,
+							std::chrono::milliseconds timeout)
+{
+	stop();
+
+	m_socket_path = socket_path;
+	m_output_path = output_path;
+
+	// A socket left behind by a crashed instance would accept nothing but look ready
+	unlink(socket_path.c_str());
+
+	std::vector<char *> argv;
+	argv.reserve(arguments.size() + 2);
+	argv.push_back(const_cast<char *>(program.c_str()));
+	for (const std::string &argument : arguments)
+	{
+		argv.push_back(const_cast<char *>(argument.c_str()));
+	}
+	argv.push_back(nullptr);
+
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+	const int spawned = posix_spawn(&m_pid, program.c_str(), &actions, nullptr, argv.data(), environ);
+	posix_spawn_file_actions_destroy(&actions);
+
+	if (spawned != 0)
+	{
+		m_pid	= -1;
+		m_error = program + ": " + std::strerror(spawned);
+		return false;
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		if (!isRunning())
+		{
+			return false;
+		}
+
+		const auto remaining =
+			std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+		if (access(socket_path.c_str(), F_OK) == 0 && m_socket.connect(socket_path, remaining))
+		{
+			m_error.clear();
+			return true;
+		}
+
+		std::this_thread::sleep_for(k_connect_retry_interval);
+	}
+
+	m_error = "command socket " + socket_path + " not ready within " + std::to_string(timeout.count()) + " ms";
+	stop();
+	return false;
+}
+
+void SuricataSession::stop(std::chrono::milliseconds timeout)
+{
+	if (m_pid <= 0)
+	{
+		m_socket.disconnect();
+		return;
+	}
+
+	// Ask politely first, Suricata flushes its outputs on a regular shutdown
+	if (m_socket.isConnected())
+	{
+		m_socket.shutdown();
+	}
+
+	if (!waitForExit(timeout))
+	{
+		kill(m_pid, SIGTERM);
+		if (!waitForExit(timeout))
+		{
+			kill(m_pid, SIGKILL);
+			waitpid(m_pid, nullptr, 0);
+		}
+	}
+
+	m_pid = -1;
+	unlink(m_socket_path.c_str());
+}
+
+bool SuricataSession::isRunning()
+{
+	if (m_pid <= 0)
+	{
+		return false;
+	}
+
+	int			status = 0;
+	const pid_t result = waitpid(m_pid, &status, WNOHANG);
+	if (result == 0)
+	{
+		return true;
+	}
+
+	m_error = result == m_pid ? "suricata " + describeStatus(status) : std::string("waitpid: ") + std::strerror(errno);
+	m_pid	= -1;
+	m_socket.disconnect();
+	return false;
+}
+
+pid_t SuricataSession::pid() const
+{
+	return m_pid;
+}
+
+const std::string &SuricataSession::error() const
+{
+	return m_error;
+}
+
+const std::string &SuricataSession::outputPath() const
+{
+	return m_output_path;
+}
+
+SuricataSocket &SuricataSession::socket()
+{
+	return m_socket;
+}
+
+bool SuricataSession::ensureConnected()
+{
+	if (!isRunning())
+	{
+		return false;
+	}
+	if (m_socket.isConnected())
+	{
+		return true;
+	}
+	if (!m_socket.connect(m_socket_path))
+	{
+		m_error = m_socket.error();
+		return false;
+	}
+	return true;
+}
+
+bool SuricataSession::waitForExit(std::chrono::milliseconds timeout)
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	while (true)
+	{
+		const pid_t result = waitpid(m_pid, nullptr, WNOHANG);
+		if (result == m_pid || (result < 0 && errno == ECHILD))
+		{
+			return true;
+		}
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+		std::this_thread::sleep_for(k_exit_poll_interval);
+	}
+}
+} // namespace UTILS
@@ -0,0 +1,63 @@
+#ifndef SURICATA_SESSION_HPP
+#define SURICATA_SESSION_HPP
+
+#include "suricata_socket.hpp"
+
+#include <chrono>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Owns one long running Suricata process and its command socket.
+ *
+ * The arguments must enable the unix command socket at `socket_path`, either
+ * with `--unix-socket=` (pcap processing mode) or with
+ * `--set unix-command.enabled=yes` next to a live capture. start() returns
+ * once the socket accepts the handshake, which happens after rules are
+ * loaded. The process is spawned directly rather than through QProcess so
+ * the session can be driven from whichever worker thread runs a check.
+ */
+class SuricataSession
+{
+public:
+	static constexpr std::chrono::milliseconds d_stop_timeout{5000};
+
+public:
+	SuricataSession();
+	~SuricataSession();
+
+	SuricataSession(const SuricataSession &)			= delete;
+	SuricataSession &operator=(const SuricataSession &) = delete;
+
+	bool start(const std::string &program, const std::vector<std::string> &arguments, const std::string &socket_path,
+			   const std::string &output_path, std::chrono::milliseconds timeout);
+	void stop(std::chrono::milliseconds timeout = d_stop_timeout);
+
+	bool  isRunning();
+	pid_t pid() const;
+
+	const std::string &error() const;
+	const std::string &outputPath() const;
+
+	/**
+	 * Reconnects if Suricata dropped the connection, false when it is gone.
+	 */
+	SuricataSocket &socket();
+	bool			ensureConnected();
+
+private:
+	bool waitForExit(std::chrono::milliseconds timeout);
+
+private:
+	pid_t		   m_pid;
+	std::string	   m_socket_path;
+	std::string	   m_output_path;
+	std::string	   m_error;
+	SuricataSocket m_socket;
+};
+} // namespace UTILS
+
+#endif // SURICATA_SESSION_HPP
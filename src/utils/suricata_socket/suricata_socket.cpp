@@ -0,0 +1,575 @@
+#include "suricata_socket.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::string_view k_protocol_version = "0.2";
+	constexpr std::size_t	   k_read_chunk_size  = 64 * 1024;
+
+	std::string_view skipWhitespace(std::string_view text)
+	{
+		while (!text.empty() && (text.front() == ' ' || text.front() == '\t' || text.front() == '\r' ||
+								 text.front() == '\n'))
+		{
+			text.remove_prefix(1);
+		}
+		return text;
+	}
+
+	/**
+	 * Length of the JSON value at the start of `text`, 0 when malformed.
+	 */
+	std::size_t valueLength(std::string_view text)
+	{
+		int	 depth	   = 0;
+		bool in_string = false;
+
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			const char c = text[i];
+			if (in_string)
+			{
+				if (c == '\\')
+				{
+					++i;
+				}
+				else if (c == '"')
+				{
+					in_string = false;
+					if (depth == 0)
+					{
+						return i + 1;
+					}
+				}
+				continue;
+			}
+
+			switch (c)
+			{
+				case '"':
+					in_string = true;
+					break;
+				case '{':
+				case '[':
+					depth++;
+					break;
+				case '}':
+				case ']':
+					if (--depth == 0)
+					{
+						return i + 1;
+					}
+					if (depth < 0)
+					{
+						return i;
+					}
+					break;
+				case ',':
+					if (depth == 0)
+					{
+						return i;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+		return depth == 0 && !in_string ? text.size() : 0;
+	}
+
+	/**
+	 * Raw text of a top level member of a JSON object, empty when missing.
+	 */
+	std::string_view memberValue(std::string_view object, std::string_view key)
+	{
+		object = skipWhitespace(object);
+		if (object.empty() || object.front() != '{')
+		{
+			return {};
+		}
+		object.remove_prefix(1);
+
+		while (true)
+		{
+			object = skipWhitespace(object);
+			if (object.empty() || object.front() != '"')
+			{
+				return {};
+			}
+
+			const std::size_t key_length = valueLength(object);
+			if (key_length < 2)
+			{
+				return {};
+			}
+			const std::string_view name = object.substr(1, key_length - 2);
+
+			object = skipWhitespace(object.substr(key_length));
+			if (object.empty() || object.front() != ':')
+			{
+				return {};
+			}
+			object = skipWhitespace(object.substr(1));
+
+			std::size_t value_length = valueLength(object);
+			if (value_length == 0)
+			{
+				return {};
+			}
+
+			std::string_view value = object.substr(0, value_length);
+			while (!value.empty() && (value.back() == ' ' || value.back() == '\n' || value.back() == '\r'))
+			{
+				value.remove_suffix(1);
+			}
+			if (name == key)
+			{
+				return value;
+			}
+
+			object = skipWhitespace(object.substr(value_length));
+			if (object.empty() || object.front() != ',')
+			{
+				return {};
+			}
+			object.remove_prefix(1);
+		}
+	}
+
+	/**
+	 * Decodes a JSON string value, \u escapes outside ASCII are kept verbatim.
+	 */
+	bool unquote(std::string_view value, std::string &text)
+	{
+		if (value.size() < 2 || value.front() != '"' || value.back() != '"')
+		{
+			return false;
+		}
+
+		text.clear();
+		for (std::size_t i = 1; i + 1 < value.size(); ++i)
+		{
+			char c = value[i];
+			if (c == '\\' && i + 2 < value.size())
+			{
+				c = value[++i];
+				switch (c)
+				{
+					case 'n':
+						c = '\n';
+						break;
+					case 't':
+						c = '\t';
+						break;
+					case 'r':
+						c = '\r';
+						break;
+					case 'b':
+						c = '\b';
+						break;
+					case 'f':
+						c = '\f';
+						break;
+					case 'u':
+					{
+						unsigned code = 0;
+						const auto result =
+							i + 4 < value.size() ? std::from_chars(value.data() + i + 1, value.data() + i + 5, code, 16)
+												 : std::from_chars_result{nullptr, std::errc::invalid_argument};
+						if (result.ec != std::errc() || code > 0x7f)
+						{
+							text += "\\u";
+							continue;
+						}
+						c  = static_cast<char>(code);
+						i += 4;
+						break;
+					}
+					default:
+						break;
+				}
+			}
+			text += c;
+		}
+		return true;
+	}
+
+	bool parseResponse(std::string_view reply, SuricataSocket::Response &response)
+	{
+		std::string status;
+		if (!unquote(memberValue(reply, "return"), status))
+		{
+			return false;
+		}
+		response.ok		 = status == "OK";
+		response.message = std::string(memberValue(reply, "message"));
+		return true;
+	}
+
+	std::string messageText(const SuricataSocket::Response &response)
+	{
+		std::string text;
+		return unquote(response.message, text) ? text : response.message;
+	}
+} // namespace
+
+SuricataSocket::SuricataSocket() :
+	m_fd(-1)
+{}
+
+SuricataSocket::~SuricataSocket()
+{
+	disconnect();
+}
+
+bool SuricataSocket::connect(const std::string &path, std::chrono::milliseconds timeout)
+{
+	disconnect();
+
+	sockaddr_un address = {};
+	address.sun_family	= AF_UNIX;
+	if (path.size() >= sizeof(address.sun_path))
+	{
+		m_error = "socket path is too long: " + path;
+		return false;
+	}
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (m_fd < 0)
+	{
+		m_error = std::strerror(errno);
+		return false;
+	}
+
+	if (::connect(m_fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+	{
+		m_error = path + ": " + std::strerror(errno);
+		disconnect();
+		return false;
+	}
+
+	std::string reply;
+	Response	response;
+	if (!exchange("{\"version\": " + quote(k_protocol_version) + "}", reply, timeout))
+	{
+		disconnect();
+		return false;
+	}
+
+	if (!parseResponse(reply, response) || !response.ok)
+	{
+		m_error = "version handshake rejected: " + reply;
+		disconnect();
+		return false;
+	}
+
+	m_error.clear();
+	return true;
+}
+
+void SuricataSocket::disconnect()
+{
+	if (m_fd >= 0)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+	m_buffer.clear();
+}
+
+bool SuricataSocket::isConnected() const
+{
+	return m_fd >= 0;
+}
+
+const std::string &SuricataSocket::error() const
+{
+	return m_error;
+}
+
+bool SuricataSocket::command(const std::string &name, Response &response, const std::string &arguments,
+							 std::chrono::milliseconds timeout)
+{
+	response = Response();
+
+	if (!isConnected())
+	{
+		m_error = "not connected";
+		return false;
+	}
+
+	std::string request = "{\"command\": " + quote(name);
+	if (!arguments.empty())
+	{
+		request += ", \"arguments\": " + arguments;
+	}
+	request += "}";
+
+	std::string reply;
+	if (!exchange(request, reply, timeout))
+	{
+		disconnect();
+		return false;
+	}
+
+	if (!parseResponse(reply, response))
+	{
+		m_error = "malformed response: " + reply;
+		return false;
+	}
+	return true;
+}
+
+bool SuricataSocket::simpleCommand(const std::string &name, Response &response, const std::string &arguments,
+								   std::chrono::milliseconds timeout)
+{
+	if (!command(name, response, arguments, timeout))
+	{
+		return false;
+	}
+	if (!response.ok)
+	{
+		m_error = name + ": " + messageText(response);
+		return false;
+	}
+	return true;
+}
+
+bool SuricataSocket::reloadRules(std::chrono::milliseconds timeout)
+{
+	// Blocks on the Suricata side until the new detection engine is live
+	Response response;
+	return simpleCommand("reload-rules", response, {}, timeout);
+}
+
+bool SuricataSocket::interfaces(std::vector<std::string> &names)
+{
+	names.clear();
+
+	Response response;
+	if (!simpleCommand("iface-list", response))
+	{
+		return false;
+	}
+
+	std::string_view list = skipWhitespace(memberValue(response.message, "ifaces"));
+	if (list.empty() || list.front() != '[')
+	{
+		m_error = "iface-list: unexpected answer " + response.message;
+		return false;
+	}
+	list.remove_prefix(1);
+
+	while (true)
+	{
+		list = skipWhitespace(list);
+		if (list.empty() || list.front() == ']')
+		{
+			return true;
+		}
+
+		const std::size_t length = valueLength(list);
+		std::string		  name;
+		if (length == 0 || !unquote(list.substr(0, length), name))
+		{
+			m_error = "iface-list: unexpected answer " + response.message;
+			return false;
+		}
+		names.push_back(std::move(name));
+
+		list = skipWhitespace(list.substr(length));
+		if (!list.empty() && list.front() == ',')
+		{
+			list.remove_prefix(1);
+		}
+	}
+}
+
+bool SuricataSocket::submitPcap(const std::string &file_path, const std::string &output_dir)
+{
+	Response response;
+	return simpleCommand("pcap-file", response,
+						 "{\"filename\": " + quote(file_path) + ", \"output-dir\": " + quote(output_dir) + "}");
+}
+
+bool SuricataSocket::pcapQueue(PcapQueue &queue)
+{
+	queue = PcapQueue();
+
+	Response queued;
+	if (!simpleCommand("pcap-file-number", queued))
+	{
+		return false;
+	}
+
+	unsigned	pending = 0;
+	const auto	result	= std::from_chars(queued.message.data(), queued.message.data() + queued.message.size(), pending);
+	if (result.ec != std::errc())
+	{
+		m_error = "pcap-file-number: unexpected answer " + queued.message;
+		return false;
+	}
+
+	Response current;
+	if (!simpleCommand("pcap-current", current))
+	{
+		return false;
+	}
+
+	queue.pending = pending;
+	queue.current = messageText(current);
+	if (queue.current == "None")
+	{
+		queue.current.clear();
+	}
+	return true;
+}
+
+bool SuricataSocket::dumpCounters(std::string &counters)
+{
+	Response response;
+	if (!simpleCommand("dump-counters", response))
+	{
+		return false;
+	}
+	counters = std::move(response.message);
+	return true;
+}
+
+bool SuricataSocket::shutdown()
+{
+	Response response;
+	const bool sent = simpleCommand("shutdown", response);
+	disconnect();
+	return sent;
+}
+
+std::string SuricataSocket::quote(std::string_view text)
+{
+	std::string quoted;
+	quoted.reserve(text.size() + 2);
+	quoted += '"';
+
+	for (const char c : text)
+	{
+		switch (c)
+		{
+			case '"':
+				quoted += "\\\"";
+				break;
+			case '\\':
+				quoted += "\\\\";
+				break;
+			case '\n':
+				quoted += "\\n";
+				break;
+			case '\r':
+				quoted += "\\r";
+				break;
+			case '\t':
+				quoted += "\\t";
+				break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					static constexpr char k_hex[] = "0123456789abcdef";
+					quoted += "\\u00";
+					quoted += k_hex[(c >> 4) & 0xf];
+					quoted += k_hex[c & 0xf];
+				}
+				else
+				{
+					quoted += c;
+				}
+				break;
+		}
+	}
+
+	quoted += '"';
+	return quoted;
+}
+
+bool SuricataSocket::exchange(const std::string &request, std::string &reply, std::chrono::milliseconds timeout)
+{
+	const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+	for (std::size_t sent = 0; sent < request.size();)
+	{
+		const ssize_t written = send(m_fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+		if (written < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			m_error = std::string("send: ") + std::strerror(errno);
+			return false;
+		}
+		sent += static_cast<std::size_t>(written);
+	}
+
+	char chunk[k_read_chunk_size];
+
+	while (true)
+	{
+		const std::size_t newline = m_buffer.find('\n');
+		if (newline != std::string::npos)
+		{
+			reply = m_buffer.substr(0, newline);
+			m_buffer.erase(0, newline + 1);
+			return true;
+		}
+
+		const auto remaining =
+			std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+		if (remaining.count() <= 0)
+		{
+			m_error = "timed out waiting for a response";
+			return false;
+		}
+
+		pollfd	  descriptor = {m_fd, POLLIN, 0};
+		const int ready		 = poll(&descriptor, 1, static_cast<int>(remaining.count()));
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			m_error = std::string("poll: ") + std::strerror(errno);
+			return false;
+		}
+		if (ready == 0)
+		{
+			continue;
+		}
+
+		const ssize_t length = recv(m_fd, chunk, sizeof(chunk), 0);
+		if (length < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			m_error = std::string("recv: ") + std::strerror(errno);
+			return false;
+		}
+		if (length == 0)
+		{
+			m_error = "connection closed by Suricata";
+			return false;
+		}
+		m_buffer.append(chunk, static_cast<std::size_t>(length));
+	}
+}
+} // namespace UTILS
@@ -0,0 +1,82 @@
+#ifndef SURICATA_SOCKET_HPP
+#define SURICATA_SOCKET_HPP
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Client of the Suricata unix command socket, speaking the same JSON
+ *        protocol as suricatasc.
+ *
+ * connect() performs the version handshake, after which every command is a
+ * single request/response exchange. Protocol 0.2 terminates each response
+ * with a newline, which is used for framing. All calls block for at most
+ * the given timeout.
+ */
+class SuricataSocket
+{
+public:
+	struct Response
+	{
+		bool		ok = false;
+		std::string message; // raw JSON value of the "message" member
+	};
+
+	/**
+	 * State of the pcap-file queue in unix socket runmode.
+	 */
+	struct PcapQueue
+	{
+		unsigned	pending = 0; // files waiting, the one being processed is not counted
+		std::string current;	 // file being processed, empty when none
+	};
+
+	static constexpr std::chrono::milliseconds d_default_timeout{5000};
+
+public:
+	SuricataSocket();
+	~SuricataSocket();
+
+	SuricataSocket(const SuricataSocket &)			  = delete;
+	SuricataSocket &operator=(const SuricataSocket &) = delete;
+
+	bool connect(const std::string &path, std::chrono::milliseconds timeout = d_default_timeout);
+	void disconnect();
+	bool isConnected() const;
+
+	const std::string &error() const;
+
+	/**
+	 * Sends a command, `arguments` is a JSON object or empty. Returns false
+	 * when the exchange failed, a NOK answer still returns true with
+	 * `response.ok` unset.
+	 */
+	bool command(const std::string &name, Response &response, const std::string &arguments = {},
+				 std::chrono::milliseconds timeout = d_default_timeout);
+
+	bool reloadRules(std::chrono::milliseconds timeout);
+	bool interfaces(std::vector<std::string> &names);
+	bool submitPcap(const std::string &file_path, const std::string &output_dir);
+	bool pcapQueue(PcapQueue &queue);
+	bool dumpCounters(std::string &counters);
+	bool shutdown();
+
+	static std::string quote(std::string_view text);
+
+private:
+	bool exchange(const std::string &request, std::string &reply, std::chrono::milliseconds timeout);
+	bool simpleCommand(const std::string &name, Response &response, const std::string &arguments = {},
+					   std::chrono::milliseconds timeout = d_default_timeout);
+
+private:
+	int			m_fd;
+	std::string m_buffer;
+	std::string m_error;
+};
+} // namespace UTILS
+
+#endif // SURICATA_SOCKET_HPP
@@ -0,0 +1,165 @@
+#include "task_graph.hpp"
+
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace UTILS
+{
+TaskGraph::TaskGraph(QObject *parent) :
+	QObject(parent),
+	m_elapsed_ms(0)
+{}
+
+TaskGraph::~TaskGraph()
+{
+	m_pool.waitForDone();
+}
+
+int TaskGraph::addTask(const QString &name, const Task &task, const QList<int> &dependencies)
+{
+	const int id = static_cast<int>(m_nodes.size());
+	for (int dependency : dependencies)
+	{
+		if (dependency < 0 || dependency >= id)
+		{
+			return -1;
+		}
+	}
+
+	Node node;
+	node.name		  = name;
+	node.task		  = task;
+	node.dependencies = dependencies.size();
+	m_nodes.push_back(std::move(node));
+
+	for (int dependency : dependencies)
+	{
+		m_nodes[dependency].dependents.append(id);
+	}
+	return id;
+}
+
+bool TaskGraph::run()
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	m_first_failure.clear();
+	m_completed.clear();
+
+	QList<int> ready;
+	for (std::size_t id = 0; id < m_nodes.size(); ++id)
+	{
+		Node &node	 = m_nodes[id];
+		node.state	 = TaskState::Pending;
+		node.waiting = node.dependencies;
+		if (node.waiting == 0)
+		{
+			ready.append(static_cast<int>(id));
+		}
+	}
+
+	// Tasks mostly wait on processes and sleeps, one thread each keeps the critical path short
+	m_pool.setMaxThreadCount(std::max(1, static_cast<int>(m_nodes.size())));
+
+	int	 running = 0;
+	bool failed	 = false;
+
+	while (true)
+	{
+		if (!failed)
+		{
+			for (int id : ready)
+			{
+				m_nodes[id].started_at = timer.elapsed();
+				emit taskStarted(m_nodes[id].name);
+				start(id);
+				++running;
+			}
+		}
+		ready.clear();
+
+		if (running == 0)
+		{
+			break;
+		}
+
+		QList<Completion> completed;
+		{
+			QMutexLocker locker(&m_completed_mutex);
+			while (m_completed.isEmpty())
+			{
+				m_completed_condition.wait(&m_completed_mutex);
+			}
+			completed.swap(m_completed);
+		}
+
+		for (const Completion &completion : completed)
+		{
+			Node &node = m_nodes[completion.id];
+			node.state = completion.succeeded ? TaskState::Succeeded : TaskState::Failed;
+			--running;
+
+			emit taskFinished(node.name, completion.succeeded, timer.elapsed() - node.started_at);
+
+			if (!completion.succeeded)
+			{
+				if (!failed)
+				{
+					m_first_failure = node.name;
+				}
+				failed = true;
+				continue;
+			}
+
+			for (int dependent : node.dependents)
+			{
+				if (--m_nodes[dependent].waiting == 0)
+				{
+					ready.append(dependent);
+				}
+			}
+		}
+	}
+
+	for (Node &node : m_nodes)
+	{
+		if (node.state == TaskState::Pending)
+		{
+			node.state = TaskState::Skipped;
+		}
+	}
+
+	m_elapsed_ms = timer.elapsed();
+	return !failed;
+}
+
+TaskGraph::TaskState TaskGraph::state(int id) const
+{
+	return id >= 0 && id < static_cast<int>(m_nodes.size()) ? m_nodes[id].state : TaskState::Skipped;
+}
+
+QString TaskGraph::firstFailure() const
+{
+	return m_first_failure;
+}
+
+qint64 TaskGraph::elapsedMs() const
+{
+	return m_elapsed_ms;
+}
+
+void TaskGraph::start(int id)
+{
+	m_nodes[id].state = TaskState::Running;
+
+	QtConcurrent::run(&m_pool, [this, id]() {
+		const bool succeeded = m_nodes[id].task();
+
+		QMutexLocker locker(&m_completed_mutex);
+		m_completed.append({id, succeeded});
+		m_completed_condition.wakeAll();
+	});
+}
+} // namespace UTILS
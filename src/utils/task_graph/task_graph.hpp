@@ -0,0 +1,96 @@
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <functional>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Runs a set of dependent checks, each as soon as its inputs are done.
+ *
+ * Tasks are added together with the ids of the tasks they depend on, which
+ * must already be added, so the graph cannot contain a cycle. run() blocks
+ * the calling thread and starts every ready task on a private pool through
+ * QtConcurrent. The pool is private because the caller itself usually is a
+ * global pool thread, waiting there for tasks queued behind it would
+ * deadlock on machines with few cores.
+ *
+ * A task failing stops new tasks from being started, the running ones are
+ * waited for and everything left over is marked skipped. Signals are emitted
+ * from the thread calling run(), receivers in other threads get them queued.
+ */
+class TaskGraph : public QObject
+{
+	Q_OBJECT
+	Q_DISABLE_COPY_MOVE(TaskGraph)
+
+signals:
+	void taskStarted(const QString &name);
+	void taskFinished(const QString &name, bool succeeded, qint64 elapsed_ms);
+
+public:
+	using Task = std::function<bool()>;
+
+	enum class TaskState
+	{
+		Pending,
+		Running,
+		Succeeded,
+		Failed,
+		Skipped
+	};
+
+public:
+	explicit TaskGraph(QObject *parent = nullptr);
+	~TaskGraph() override;
+
+	/**
+	 * Returns the task id, -1 when a dependency is unknown.
+	 */
+	int	 addTask(const QString &name, const Task &task, const QList<int> &dependencies = {});
+	bool run();
+
+	TaskState state(int id) const;
+	QString	  firstFailure() const;
+	qint64	  elapsedMs() const;
+
+private:
+	struct Node
+	{
+		QString	   name;
+		Task	   task;
+		QList<int> dependents;
+		int		   dependencies = 0;
+		int		   waiting		= 0;
+		qint64	   started_at	= 0;
+		TaskState  state		= TaskState::Pending;
+	};
+
+	struct Completion
+	{
+		int	 id;
+		bool succeeded;
+	};
+
+	void start(int id);
+
+private:
+	std::vector<Node> m_nodes; // not a QVector, workers read tasks while states change
+	QThreadPool		  m_pool;
+	QString			  m_first_failure;
+	qint64			  m_elapsed_ms;
+
+	QMutex			  m_completed_mutex;
+	QWaitCondition	  m_completed_condition;
+	QList<Completion> m_completed;
+};
+} // namespace UTILS
+
+#endif // TASK_GRAPH_HPP
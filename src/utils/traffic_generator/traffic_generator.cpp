@@ -0,0 +1,766 @@
+#include "traffic_generator.hpp"
+
+#include "net_checksum.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <charconv>
+#include <cstring>
+
+namespace UTILS
+{
+namespace
+{
+	constexpr std::size_t k_ethernet_length = 14;
+	constexpr std::size_t k_ipv4_length		= 20;
+	constexpr std::size_t k_tcp_length		= 20;
+	constexpr std::size_t k_udp_length		= 8;
+	constexpr std::size_t k_icmp_length		= 8;
+	constexpr std::size_t k_l4_offset		= k_ethernet_length + k_ipv4_length;
+	constexpr std::size_t k_max_datagram	= 1472;
+
+	constexpr uint8_t k_protocol_icmp = 1;
+	constexpr uint8_t k_protocol_tcp  = 6;
+	constexpr uint8_t k_protocol_udp  = 17;
+
+	constexpr uint8_t k_tcp_fin = 0x01;
+	constexpr uint8_t k_tcp_syn = 0x02;
+	constexpr uint8_t k_tcp_psh = 0x08;
+	constexpr uint8_t k_tcp_ack = 0x10;
+
+	constexpr uint8_t k_icmp_echo_reply	  = 0;
+	constexpr uint8_t k_icmp_echo_request = 8;
+
+	constexpr uint8_t k_client_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+	constexpr uint8_t k_server_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+
+	constexpr uint64_t k_base_timestamp_ns	= 1700000000ull * 1000000000ull;
+	constexpr uint64_t k_packet_interval_ns = 10000;
+
+	constexpr uint16_t	  k_ephemeral_port_base	 = 40000;
+	constexpr uint16_t	  k_dns_port			 = 53;
+	constexpr uint32_t	  k_dns_ttl				 = 300;
+	constexpr std::size_t k_icmp_default_payload = 48;
+
+	void put16(uint8_t *data, uint16_t value)
+	{
+		data[0] = static_cast<uint8_t>(value >> 8);
+		data[1] = static_cast<uint8_t>(value);
+	}
+
+	void put32(uint8_t *data, uint32_t value)
+	{
+		data[0] = static_cast<uint8_t>(value >> 24);
+		data[1] = static_cast<uint8_t>(value >> 16);
+		data[2] = static_cast<uint8_t>(value >> 8);
+		data[3] = static_cast<uint8_t>(value);
+	}
+
+	void append16(std::vector<uint8_t> &buffer, uint16_t value)
+	{
+		buffer.push_back(static_cast<uint8_t>(value >> 8));
+		buffer.push_back(static_cast<uint8_t>(value));
+	}
+
+	void append32(std::vector<uint8_t> &buffer, uint32_t value)
+	{
+		append16(buffer, static_cast<uint16_t>(value >> 16));
+		append16(buffer, static_cast<uint16_t>(value));
+	}
+
+	int hexValue(char c)
+	{
+		if (c >= '0' && c <= '9')
+		{
+			return c - '0';
+		}
+		if (c >= 'a' && c <= 'f')
+		{
+			return c - 'a' + 10;
+		}
+		if (c >= 'A' && c <= 'F')
+		{
+			return c - 'A' + 10;
+		}
+		return -1;
+	}
+
+	/**
+	 * Splits on blanks, keeping quoted parts together and resolving escapes
+	 * inside them.
+	 */
+	bool tokenize(std::string_view line, std::vector<std::string> &tokens, std::string &error)
+	{
+		tokens.clear();
+
+		std::string token;
+		bool		in_token  = false;
+		bool		in_quotes = false;
+
+		for (std::size_t i = 0; i < line.size(); ++i)
+		{
+			const char c = line[i];
+
+			if (in_quotes)
+			{
+				if (c == '"')
+				{
+					in_quotes = false;
+				}
+				else if (c == '\\' && i + 1 < line.size())
+				{
+					const char escaped = line[++i];
+					switch (escaped)
+					{
+						case 'r':
+							token += '\r';
+							break;
+						case 'n':
+							token += '\n';
+							break;
+						case 't':
+							token += '\t';
+							break;
+						case 'x': {
+							const int high = i + 1 < line.size() ? hexValue(line[i + 1]) : -1;
+							const int low  = i + 2 < line.size() ? hexValue(line[i + 2]) : -1;
+							if (high < 0 || low < 0)
+							{
+								error = "invalid \\x escape";
+								return false;
+							}
+							token += static_cast<char>(high * 16 + low);
+							i	  += 2;
+							break;
+						}
+						default:
+							token += escaped;
+							break;
+					}
+				}
+				else
+				{
+					token += c;
+				}
+				continue;
+			}
+
+			if (c == '#')
+			{
+				break;
+			}
+
+			if (c == ' ' || c == '\t' || c == '\r')
+			{
+				if (in_token)
+				{
+					tokens.push_back(std::move(token));
+					token.clear();
+					in_token = false;
+				}
+				continue;
+			}
+
+			in_token = true;
+			if (c == '"')
+			{
+				in_quotes = true;
+			}
+			else
+			{
+				token += c;
+			}
+		}
+
+		if (in_quotes)
+		{
+			error = "unterminated string";
+			return false;
+		}
+
+		if (in_token)
+		{
+			tokens.push_back(std::move(token));
+		}
+		return true;
+	}
+
+	bool parseAddress(const std::string &text, uint32_t &address)
+	{
+		in_addr parsed;
+		if (inet_pton(AF_INET, text.c_str(), &parsed) != 1)
+		{
+			return false;
+		}
+		address = ntohl(parsed.s_addr);
+		return true;
+	}
+
+	template<typename T>
+	bool parseNumber(std::string_view text, T &value)
+	{
+		const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		return result.ec == std::errc() && result.ptr == text.data() + text.size();
+	}
+
+	bool parseEndpoint(const std::string &text, uint32_t &address, uint16_t &port)
+	{
+		const std::size_t colon = text.find(':');
+		if (colon == std::string::npos)
+		{
+			return parseAddress(text, address);
+		}
+		return parseAddress(text.substr(0, colon), address) &&
+			   parseNumber(std::string_view(text).substr(colon + 1), port) && port != 0;
+	}
+
+	bool encodeName(const std::string &name, std::vector<uint8_t> &buffer)
+	{
+		std::size_t start = 0;
+		while (start < name.size())
+		{
+			std::size_t end = name.find('.', start);
+			if (end == std::string::npos)
+			{
+				end = name.size();
+			}
+
+			const std::size_t length = end - start;
+			if (length == 0 || length > 63)
+			{
+				return false;
+			}
+
+			buffer.push_back(static_cast<uint8_t>(length));
+			buffer.insert(buffer.end(), name.begin() + start, name.begin() + end);
+			start = end + 1;
+		}
+		buffer.push_back(0);
+		return buffer.size() <= 12 + 255;
+	}
+
+	uint16_t rotatePort(uint16_t base, uint64_t repetition)
+	{
+		return static_cast<uint16_t>(1024 + (base - 1024 + repetition) % (65536 - 1024));
+	}
+} // namespace
+
+bool TrafficScenario::parse(std::string_view text, TrafficScenario &scenario, std::string &error)
+{
+	scenario = TrafficScenario();
+
+	std::vector<std::string> tokens;
+	std::size_t				 line_number = 0;
+
+	while (!text.empty())
+	{
+		const std::size_t newline = text.find('\n');
+		const std::string_view line = text.substr(0, newline);
+		text = newline == std::string_view::npos ? std::string_view() : text.substr(newline + 1);
+		line_number++;
+
+		auto fail = [&](const std::string &message) {
+			error = "line " + std::to_string(line_number) + ": " + message;
+			return false;
+		};
+
+		if (!tokenize(line, tokens, error))
+		{
+			return fail(error);
+		}
+
+		if (tokens.empty())
+		{
+			continue;
+		}
+
+		if (tokens[0] == "repeat")
+		{
+			if (tokens.size() != 2 || !parseNumber(tokens[1], scenario.repeat) || scenario.repeat == 0)
+			{
+				return fail("expected 'repeat <count>'");
+			}
+			continue;
+		}
+
+		Flow flow;
+		if (tokens[0] == "icmp")
+		{
+			flow.kind = Kind::IcmpEcho;
+		}
+		else if (tokens[0] == "tcp")
+		{
+			flow.kind = Kind::Tcp;
+		}
+		else if (tokens[0] == "udp")
+		{
+			flow.kind = Kind::Udp;
+		}
+		else if (tokens[0] == "dns")
+		{
+			flow.kind = Kind::Dns;
+		}
+		else
+		{
+			return fail("unknown flow kind '" + tokens[0] + "'");
+		}
+
+		if (tokens.size() < 4 || tokens[2] != ">")
+		{
+			return fail("expected '<kind> <client>[:port] > <server>[:port]'");
+		}
+		if (!parseEndpoint(tokens[1], flow.client, flow.client_port))
+		{
+			return fail("invalid client endpoint '" + tokens[1] + "'");
+		}
+		if (!parseEndpoint(tokens[3], flow.server, flow.server_port))
+		{
+			return fail("invalid server endpoint '" + tokens[3] + "'");
+		}
+
+		for (std::size_t i = 4; i < tokens.size(); ++i)
+		{
+			const std::size_t equals = tokens[i].find('=');
+			if (equals == std::string::npos)
+			{
+				return fail("expected key=value, got '" + tokens[i] + "'");
+			}
+
+			const std::string key	= tokens[i].substr(0, equals);
+			const std::string value = tokens[i].substr(equals + 1);
+
+			if (key == "count")
+			{
+				if (!parseNumber(value, flow.count) || flow.count == 0)
+				{
+					return fail("invalid count '" + value + "'");
+				}
+			}
+			else if (key == "payload")
+			{
+				flow.payload = value;
+			}
+			else if (key == "response")
+			{
+				flow.response = value;
+			}
+			else if (key == "query" && flow.kind == Kind::Dns)
+			{
+				flow.query = value;
+			}
+			else if (key == "answer" && flow.kind == Kind::Dns)
+			{
+				if (!parseAddress(value, flow.answer))
+				{
+					return fail("invalid answer address '" + value + "'");
+				}
+			}
+			else
+			{
+				return fail("unknown option '" + key + "'");
+			}
+		}
+
+		if (flow.kind == Kind::Dns)
+		{
+			std::vector<uint8_t> encoded;
+			if (flow.query.empty() || !encodeName(flow.query, encoded))
+			{
+				return fail("dns flow needs a valid query=<name>");
+			}
+			if (flow.server_port == 0)
+			{
+				flow.server_port = k_dns_port;
+			}
+		}
+		else if (flow.kind != Kind::IcmpEcho && flow.server_port == 0)
+		{
+			return fail("server port is required");
+		}
+
+		if (flow.kind != Kind::Tcp && (flow.payload.size() > k_max_datagram || flow.response.size() > k_max_datagram))
+		{
+			return fail("payload does not fit into a single datagram");
+		}
+
+		if (flow.client_port == 0)
+		{
+			flow.client_port = k_ephemeral_port_base;
+		}
+
+		scenario.flows.push_back(std::move(flow));
+	}
+
+	if (scenario.flows.empty())
+	{
+		error = "scenario does not describe any flows";
+		return false;
+	}
+	return true;
+}
+
+TrafficGenerator::TrafficGenerator(TrafficScenario scenario) :
+	m_repeat(scenario.repeat),
+	m_frame{},
+	m_writer(nullptr),
+	m_timestamp_ns(k_base_timestamp_ns),
+	m_ip_id(1)
+{
+	m_flows.reserve(scenario.flows.size());
+
+	// Payloads are rendered once, repetitions only patch ids and ports
+	for (TrafficScenario::Flow &flow : scenario.flows)
+	{
+		PreparedFlow prepared;
+
+		switch (flow.kind)
+		{
+			case TrafficScenario::Kind::IcmpEcho:
+				if (flow.payload.empty())
+				{
+					for (std::size_t i = 0; i < k_icmp_default_payload; ++i)
+					{
+						prepared.request.push_back(static_cast<uint8_t>(0x10 + i));
+					}
+				}
+				else
+				{
+					prepared.request.assign(flow.payload.begin(), flow.payload.end());
+				}
+				break;
+			case TrafficScenario::Kind::Tcp:
+			case TrafficScenario::Kind::Udp:
+				prepared.request.assign(flow.payload.begin(), flow.payload.end());
+				prepared.response.assign(flow.response.begin(), flow.response.end());
+				break;
+			case TrafficScenario::Kind::Dns: {
+				std::vector<uint8_t> question;
+				encodeName(flow.query, question);
+				append16(question, 1); // A
+				append16(question, 1); // IN
+
+				append16(prepared.request, 0);		// id, patched per message
+				append16(prepared.request, 0x0100); // RD
+				append16(prepared.request, 1);
+				append16(prepared.request, 0);
+				append16(prepared.request, 0);
+				append16(prepared.request, 0);
+				prepared.request.insert(prepared.request.end(), question.begin(), question.end());
+
+				append16(prepared.response, 0);
+				append16(prepared.response, 0x8180); // QR RD RA, NOERROR
+				append16(prepared.response, 1);
+				append16(prepared.response, flow.answer != 0 ? 1 : 0);
+				append16(prepared.response, 0);
+				append16(prepared.response, 0);
+				prepared.response.insert(prepared.response.end(), question.begin(), question.end());
+				if (flow.answer != 0)
+				{
+					append16(prepared.response, 0xc00c); // pointer to the question name
+					append16(prepared.response, 1);
+					append16(prepared.response, 1);
+					append32(prepared.response, k_dns_ttl);
+					append16(prepared.response, 4);
+					append32(prepared.response, flow.answer);
+				}
+				break;
+			}
+		}
+
+		prepared.flow = std::move(flow);
+		m_flows.push_back(std::move(prepared));
+	}
+}
+
+bool TrafficGenerator::generate(PcapWriter &writer)
+{
+	const auto started = std::chrono::steady_clock::now();
+
+	m_writer	   = &writer;
+	m_timestamp_ns = k_base_timestamp_ns;
+	m_ip_id		   = 1;
+	m_statistics   = Statistics();
+
+	bool success = true;
+	for (uint64_t repetition = 0; success && repetition < m_repeat; ++repetition)
+	{
+		for (const PreparedFlow &prepared : m_flows)
+		{
+			if (!generateFlow(prepared, repetition))
+			{
+				success = false;
+				break;
+			}
+		}
+	}
+
+	m_writer			 = nullptr;
+	m_statistics.elapsed = std::chrono::steady_clock::now() - started;
+	return success;
+}
+
+bool TrafficGenerator::generate(const std::string &path, PcapWriter::Format format)
+{
+	PcapWriter writer;
+	if (!writer.open(path, format))
+	{
+		return false;
+	}
+
+	const bool generated = generate(writer);
+	return writer.close() && generated;
+}
+
+const TrafficGenerator::Statistics &TrafficGenerator::statistics() const
+{
+	return m_statistics;
+}
+
+bool TrafficGenerator::generateFlow(const PreparedFlow &prepared, uint64_t repetition)
+{
+	switch (prepared.flow.kind)
+	{
+		case TrafficScenario::Kind::IcmpEcho:
+			return generateIcmp(prepared, repetition);
+		case TrafficScenario::Kind::Tcp:
+			return generateTcp(prepared, repetition);
+		case TrafficScenario::Kind::Udp:
+		case TrafficScenario::Kind::Dns:
+			return generateUdp(prepared, repetition);
+	}
+	return false;
+}
+
+bool TrafficGenerator::generateIcmp(const PreparedFlow &prepared, uint64_t repetition)
+{
+	const TrafficScenario::Flow &flow		= prepared.flow;
+	const uint16_t				 identifier = rotatePort(flow.client_port, repetition);
+
+	for (uint32_t i = 0; i < flow.count; ++i)
+	{
+		const uint16_t sequence = static_cast<uint16_t>(i + 1);
+		if (!emitIcmp(flow.client, flow.server, true, k_icmp_echo_request, identifier, sequence,
+					  prepared.request.data(), prepared.request.size()) ||
+			!emitIcmp(flow.server, flow.client, false, k_icmp_echo_reply, identifier, sequence,
+					  prepared.request.data(), prepared.request.size()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TrafficGenerator::generateTcp(const PreparedFlow &prepared, uint64_t repetition)
+{
+	const TrafficScenario::Flow &flow = prepared.flow;
+	const Endpoint				 client{flow.client, rotatePort(flow.client_port, repetition)};
+	const Endpoint				 server{flow.server, flow.server_port};
+
+	uint32_t client_seq = 0x10000000u + static_cast<uint32_t>(repetition * 7919);
+	uint32_t server_seq = 0x20000000u + static_cast<uint32_t>(repetition * 104729);
+
+	auto send = [&](bool from_client, const std::vector<uint8_t> &data) {
+		const Endpoint &source		= from_client ? client : server;
+		const Endpoint &destination = from_client ? server : client;
+		uint32_t	   &seq			= from_client ? client_seq : server_seq;
+		uint32_t	   &ack			= from_client ? server_seq : client_seq;
+
+		for (std::size_t offset = 0; offset < data.size(); offset += d_max_segment)
+		{
+			const std::size_t length = std::min(d_max_segment, data.size() - offset);
+			const bool		  last	 = offset + length == data.size();
+			const uint8_t	  flags	 = last ? (k_tcp_psh | k_tcp_ack) : k_tcp_ack;
+
+			if (!emitTcp(source, destination, from_client, seq, ack, flags, data.data() + offset, length))
+			{
+				return false;
+			}
+			seq += static_cast<uint32_t>(length);
+
+			if (!emitTcp(destination, source, !from_client, ack, seq, k_tcp_ack, nullptr, 0))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+
+	if (!emitTcp(client, server, true, client_seq, 0, k_tcp_syn, nullptr, 0) ||
+		!emitTcp(server, client, false, server_seq, client_seq + 1, k_tcp_syn | k_tcp_ack, nullptr, 0))
+	{
+		return false;
+	}
+	client_seq += 1;
+	server_seq += 1;
+
+	if (!emitTcp(client, server, true, client_seq, server_seq, k_tcp_ack, nullptr, 0))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < flow.count; ++i)
+	{
+		if (!send(true, prepared.request) || !send(false, prepared.response))
+		{
+			return false;
+		}
+	}
+
+	if (!emitTcp(client, server, true, client_seq, server_seq, k_tcp_fin | k_tcp_ack, nullptr, 0) ||
+		!emitTcp(server, client, false, server_seq, client_seq + 1, k_tcp_fin | k_tcp_ack, nullptr, 0))
+	{
+		return false;
+	}
+
+	return emitTcp(client, server, true, client_seq + 1, server_seq + 1, k_tcp_ack, nullptr, 0);
+}
+
+bool TrafficGenerator::generateUdp(const PreparedFlow &prepared, uint64_t repetition)
+{
+	const TrafficScenario::Flow &flow = prepared.flow;
+	const Endpoint				 client{flow.client, rotatePort(flow.client_port, repetition)};
+	const Endpoint				 server{flow.server, flow.server_port};
+	const bool					 dns = flow.kind == TrafficScenario::Kind::Dns;
+
+	for (uint32_t i = 0; i < flow.count; ++i)
+	{
+		// DNS transaction ids live in the first two bytes of both messages
+		uint8_t *l4_payload = m_frame.data() + k_l4_offset + k_udp_length;
+		const uint16_t transaction = static_cast<uint16_t>(repetition * flow.count + i);
+
+		std::memcpy(l4_payload, prepared.request.data(), prepared.request.size());
+		if (dns)
+		{
+			put16(l4_payload, transaction);
+		}
+		if (!emitUdp(client, server, true, nullptr, prepared.request.size()))
+		{
+			return false;
+		}
+
+		if (prepared.response.empty())
+		{
+			continue;
+		}
+
+		std::memcpy(l4_payload, prepared.response.data(), prepared.response.size());
+		if (dns)
+		{
+			put16(l4_payload, transaction);
+		}
+		if (!emitUdp(server, client, false, nullptr, prepared.response.size()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TrafficGenerator::emitTcp(const Endpoint &source, const Endpoint &destination, bool from_client, uint32_t seq,
+							   uint32_t ack, uint8_t flags, const uint8_t *payload, std::size_t length)
+{
+	uint8_t *tcp = m_frame.data() + k_l4_offset;
+
+	put16(tcp, source.port);
+	put16(tcp + 2, destination.port);
+	put32(tcp + 4, seq);
+	put32(tcp + 8, (flags & k_tcp_ack) ? ack : 0);
+	tcp[12] = static_cast<uint8_t>((k_tcp_length / 4) << 4);
+	tcp[13] = flags;
+	put16(tcp + 14, 65535);
+	put16(tcp + 16, 0);
+	put16(tcp + 18, 0);
+
+	if (length > 0)
+	{
+		std::memcpy(tcp + k_tcp_length, payload, length);
+	}
+
+	const uint16_t checksum = InternetChecksum::ipv4Transport(source.address, destination.address, k_protocol_tcp, tcp,
+															  k_tcp_length + length);
+	std::memcpy(tcp + 16, &checksum, sizeof(checksum));
+
+	return emitIpv4(source.address, destination.address, from_client, k_protocol_tcp, k_tcp_length + length);
+}
+
+bool TrafficGenerator::emitUdp(const Endpoint &source, const Endpoint &destination, bool from_client,
+							   const uint8_t *payload, std::size_t length)
+{
+	uint8_t *udp = m_frame.data() + k_l4_offset;
+
+	put16(udp, source.port);
+	put16(udp + 2, destination.port);
+	put16(udp + 4, static_cast<uint16_t>(k_udp_length + length));
+	put16(udp + 6, 0);
+
+	// A null payload means it was already placed into the frame
+	if (payload != nullptr && length > 0)
+	{
+		std::memcpy(udp + k_udp_length, payload, length);
+	}
+
+	uint16_t checksum = InternetChecksum::ipv4Transport(source.address, destination.address, k_protocol_udp, udp,
+														k_udp_length + length);
+	if (checksum == 0)
+	{
+		checksum = 0xffff;
+	}
+	std::memcpy(udp + 6, &checksum, sizeof(checksum));
+
+	return emitIpv4(source.address, destination.address, from_client, k_protocol_udp, k_udp_length + length);
+}
+
+bool TrafficGenerator::emitIcmp(uint32_t source, uint32_t destination, bool from_client, uint8_t type,
+								uint16_t identifier, uint16_t sequence, const uint8_t *payload, std::size_t length)
+{
+	uint8_t *icmp = m_frame.data() + k_l4_offset;
+
+	icmp[0] = type;
+	icmp[1] = 0;
+	put16(icmp + 2, 0);
+	put16(icmp + 4, identifier);
+	put16(icmp + 6, sequence);
+	std::memcpy(icmp + k_icmp_length, payload, length);
+
+	const uint16_t checksum = InternetChecksum::compute(icmp, k_icmp_length + length);
+	std::memcpy(icmp + 2, &checksum, sizeof(checksum));
+
+	return emitIpv4(source, destination, from_client, k_protocol_icmp, k_icmp_length + length);
+}
+
+bool TrafficGenerator::emitIpv4(uint32_t source, uint32_t destination, bool from_client, uint8_t protocol,
+								std::size_t l4_length)
+{
+	uint8_t *frame = m_frame.data();
+
+	std::memcpy(frame, from_client ? k_server_mac : k_client_mac, 6);
+	std::memcpy(frame + 6, from_client ? k_client_mac : k_server_mac, 6);
+	put16(frame + 12, 0x0800);
+
+	uint8_t *ip = frame + k_ethernet_length;
+	ip[0]		= 0x45;
+	ip[1]		= 0;
+	put16(ip + 2, static_cast<uint16_t>(k_ipv4_length + l4_length));
+	put16(ip + 4, m_ip_id++);
+	put16(ip + 6, 0x4000); // DF
+	ip[8] = 64;
+	ip[9] = protocol;
+	put16(ip + 10, 0);
+	put32(ip + 12, source);
+	put32(ip + 16, destination);
+
+	const uint16_t checksum = InternetChecksum::compute(ip, k_ipv4_length);
+	std::memcpy(ip + 10, &checksum, sizeof(checksum));
+
+	const std::size_t frame_length = k_l4_offset + l4_length;
+	if (!m_writer->write(m_timestamp_ns, frame, frame_length))
+	{
+		return false;
+	}
+
+	m_timestamp_ns			 += k_packet_interval_ns;
+	m_statistics.packets	 += 1;
+	m_statistics.bytes		 += frame_length;
+	return true;
+}
+} // namespace UTILS
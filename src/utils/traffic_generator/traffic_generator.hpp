@@ -0,0 +1,125 @@
+#ifndef TRAFFIC_GENERATOR_HPP
+#define TRAFFIC_GENERATOR_HPP
+
+#include "pcap_writer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Compact description of synthetic IPv4 test traffic.
+ *
+ * One flow per line, `#` starts a comment:
+ *
+ *     repeat 1000
+ *     icmp 192.168.100.10 > 1.1.1.1 count=2
+ *     tcp  10.0.0.1:40000 > 10.0.0.2:80 payload="GET / HTTP/1.1\r\n\r\n" response="HTTP/1.1 200 OK\r\n\r\n"
+ *     udp  10.0.0.1 > 10.0.0.2:514 payload="<13>test"
+ *     dns  10.0.0.1 > 8.8.8.8 query=example.com answer=93.184.216.34
+ *
+ * Payload strings understand \r, \n, \t, \\, \" and \xHH escapes. Every
+ * repetition uses a fresh client port (or ICMP identifier), so each one is a
+ * separate flow for the IDS.
+ */
+struct TrafficScenario
+{
+	enum class Kind
+	{
+		IcmpEcho,
+		Tcp,
+		Udp,
+		Dns
+	};
+
+	struct Flow
+	{
+		Kind		kind		= Kind::IcmpEcho;
+		uint32_t	client		= 0; // host byte order
+		uint32_t	server		= 0;
+		uint16_t	client_port = 0; // 0 - ephemeral
+		uint16_t	server_port = 0; // 0 - protocol default
+		uint32_t	count		= 1; // echo pairs for ICMP, messages otherwise
+		std::string payload;
+		std::string response;
+		std::string query;
+		uint32_t	answer = 0;
+	};
+
+	std::vector<Flow> flows;
+	uint64_t		  repeat = 1;
+
+	static bool parse(std::string_view text, TrafficScenario &scenario, std::string &error);
+};
+
+/**
+ * @brief Renders a TrafficScenario into a capture file.
+ *
+ * Frames are assembled in a single preallocated buffer and only the fields
+ * that change between packets are rewritten, checksums included.
+ */
+class TrafficGenerator
+{
+public:
+	struct Statistics
+	{
+		uint64_t				 packets = 0;
+		uint64_t				 bytes	 = 0;
+		std::chrono::nanoseconds elapsed = std::chrono::nanoseconds::zero();
+	};
+
+public:
+	explicit TrafficGenerator(TrafficScenario scenario);
+
+	bool generate(PcapWriter &writer);
+	bool generate(const std::string &path, PcapWriter::Format format = PcapWriter::Format::Pcap);
+
+	const Statistics &statistics() const;
+
+private:
+	struct Endpoint
+	{
+		uint32_t address;
+		uint16_t port;
+	};
+
+	struct PreparedFlow
+	{
+		TrafficScenario::Flow flow;
+		std::vector<uint8_t>  request;
+		std::vector<uint8_t>  response;
+	};
+
+	static constexpr std::size_t d_max_segment	  = 1460;
+	static constexpr std::size_t d_frame_capacity = 14 + 20 + 20 + d_max_segment;
+
+	bool generateFlow(const PreparedFlow &prepared, uint64_t repetition);
+	bool generateIcmp(const PreparedFlow &prepared, uint64_t repetition);
+	bool generateTcp(const PreparedFlow &prepared, uint64_t repetition);
+	bool generateUdp(const PreparedFlow &prepared, uint64_t repetition);
+
+	bool emitTcp(const Endpoint &source, const Endpoint &destination, bool from_client, uint32_t seq, uint32_t ack,
+				 uint8_t flags, const uint8_t *payload, std::size_t length);
+	bool emitUdp(const Endpoint &source, const Endpoint &destination, bool from_client, const uint8_t *payload,
+				 std::size_t length);
+	bool emitIcmp(uint32_t source, uint32_t destination, bool from_client, uint8_t type, uint16_t identifier,
+				  uint16_t sequence, const uint8_t *payload, std::size_t length);
+	bool emitIpv4(uint32_t source, uint32_t destination, bool from_client, uint8_t protocol, std::size_t l4_length);
+
+private:
+	std::vector<PreparedFlow>				 m_flows;
+	uint64_t								 m_repeat;
+	std::array<uint8_t, d_frame_capacity>	 m_frame;
+	PcapWriter								*m_writer;
+	uint64_t								 m_timestamp_ns;
+	uint16_t								 m_ip_id;
+	Statistics								 m_statistics;
+};
+} // namespace UTILS
+
+#endif // TRAFFIC_GENERATOR_HPP
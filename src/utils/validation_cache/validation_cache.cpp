@@ -0,0 +1,116 @@
+#include "validation_cache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace UTILS
+{
+namespace
+{
+	const std::string k_file_header = "# validation_cache 1";
+} // namespace
+
+ValidationCache::ValidationCache(std::string file_path) :
+	m_file_path(std::move(file_path))
+{}
+
+bool ValidationCache::load(ValidationRecord &record) const
+{
+	std::ifstream file(m_file_path);
+	std::string	  line;
+	if (!std::getline(file, line) || line != k_file_header)
+	{
+		return false;
+	}
+
+	ValidationRecord loaded;
+	bool			 has_key = false;
+
+	while (std::getline(file, line))
+	{
+		std::istringstream fields(line);
+		std::string		   name;
+		fields >> name;
+
+		if (name == "key")
+		{
+			fields >> std::hex >> loaded.key;
+			has_key = static_cast<bool>(fields);
+		}
+		else if (name == "validated_at")
+		{
+			fields >> loaded.validated_at;
+		}
+		else if (name == "elapsed_ms")
+		{
+			fields >> loaded.elapsed_ms;
+		}
+		else if (name == "config")
+		{
+			fields >> std::ws;
+			std::getline(fields, loaded.config_path);
+		}
+		else if (name == "verdict")
+		{
+			// The path goes last, it may contain spaces
+			ValidationRecord::ConfigVerdict verdict;
+			fields >> verdict.verdict >> verdict.error_count >> verdict.elapsed_ms >> std::ws;
+			std::getline(fields, verdict.path);
+			if (verdict.path.empty())
+			{
+				return false;
+			}
+			loaded.verdicts.push_back(std::move(verdict));
+		}
+
+		if (fields.bad())
+		{
+			return false;
+		}
+	}
+
+	if (!has_key || loaded.config_path.empty())
+	{
+		return false;
+	}
+
+	record = std::move(loaded);
+	return true;
+}
+
+bool ValidationCache::save(const ValidationRecord &record) const
+{
+	const std::string temporary_path = m_file_path + ".tmp";
+	{
+		std::ofstream file(temporary_path, std::ios::trunc);
+		file << k_file_header << '\n';
+		file << "key " << std::hex << record.key << std::dec << '\n';
+		file << "validated_at " << record.validated_at << '\n';
+		file << "elapsed_ms " << record.elapsed_ms << '\n';
+		file << "config " << record.config_path << '\n';
+		for (const ValidationRecord::ConfigVerdict &verdict : record.verdicts)
+		{
+			file << "verdict " << verdict.verdict << ' ' << verdict.error_count << ' ' << verdict.elapsed_ms << ' '
+				 << verdict.path << '\n';
+		}
+
+		if (!file.flush())
+		{
+			return false;
+		}
+	}
+
+	return std::rename(temporary_path.c_str(), m_file_path.c_str()) == 0;
+}
+
+void ValidationCache::clear() const
+{
+	std::remove(m_file_path.c_str());
+}
+
+const std::string &ValidationCache::filePath() const
+{
+	return m_file_path;
+}
+} // namespace UTILS
@@ -0,0 +1,52 @@
+#ifndef VALIDATION_CACHE_HPP
+#define VALIDATION_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UTILS
+{
+/**
+ * @brief Outcome of a successful validation and the inputs it was made for.
+ */
+struct ValidationRecord
+{
+	struct ConfigVerdict
+	{
+		std::string path;
+		int			verdict		= 0; // caller defined
+		int			error_count = 0;
+		int64_t		elapsed_ms	= 0;
+	};
+
+	uint64_t				   key			= 0; // content hash of everything the verdict depends on
+	int64_t					   validated_at = 0; // seconds since the epoch
+	int64_t					   elapsed_ms	= 0; // wall clock time of the validation
+	std::string				   config_path;		 // the selected configuration
+	std::vector<ConfigVerdict> verdicts;
+};
+
+/**
+ * @brief Single record store for the last successful validation.
+ *
+ * Plain text, one field per line. Written to a temporary file first and
+ * renamed over the old one, a crash never leaves a half written record.
+ */
+class ValidationCache
+{
+public:
+	explicit ValidationCache(std::string file_path);
+
+	bool load(ValidationRecord &record) const;
+	bool save(const ValidationRecord &record) const;
+	void clear() const;
+
+	const std::string &filePath() const;
+
+private:
+	std::string m_file_path;
+};
+} // namespace UTILS
+
+#endif // VALIDATION_CACHE_HPP